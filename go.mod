@@ -7,7 +7,6 @@ toolchain go1.24.4
 require (
 	github.com/schollz/progressbar/v3 v3.18.0
 	github.com/spf13/cobra v1.9.1
-	golang.org/x/sync v0.16.0
 	gopkg.in/yaml.v3 v3.0.1
 )
 
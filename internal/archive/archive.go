@@ -0,0 +1,267 @@
+// Package archive reads source snapshots in .zip, .tar and .tar.gz files
+// without extracting them. Once Load has indexed an archive, its members
+// are addressed as if the archive were a directory, as in
+// release.tar.gz/src/main.go, and Read returns their content. Release
+// closes what the loaded archives hold open.
+package archive
+
+import (
+	"archive/tar"
+	"archive/zip"
+	"bytes"
+	"compress/gzip"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"strings"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/vitruves/gop/internal/memlimit"
+)
+
+// Member is a regular file in an archive. Name uses forward slashes and is
+// relative to the archive.
+type Member struct {
+	Name    string
+	Size    int64
+	ModTime time.Time
+}
+
+// archive holds what Read needs. Zip members are inflated on demand. Tar
+// members are found by their offset in data: the .tar itself, or for a
+// compressed tar a spill file the members were decompressed into in the
+// single pass gzip allows. Either way no member is held in memory.
+type archive struct {
+	members map[string]Member
+	zip     map[string]*zip.File
+	tar     map[string]int64
+	data    io.ReaderAt
+	file    io.Closer
+}
+
+// close releases the archive's open file and deletes its spill, if any.
+func (a *archive) close() error {
+	if a.file == nil {
+		return nil
+	}
+	return a.file.Close()
+}
+
+var (
+	mu     sync.RWMutex
+	loaded = map[string]*archive{}
+	count  atomic.Int32
+)
+
+// IsArchive reports whether path names an archive Load reads.
+func IsArchive(path string) bool {
+	lower := strings.ToLower(path)
+	for _, ext := range []string{".zip", ".tar", ".tar.gz", ".tgz"} {
+		if strings.HasSuffix(lower, ext) {
+			return true
+		}
+	}
+	return false
+}
+
+// Load indexes the archive at path and returns its regular files. A .zip
+// keeps only its directory and a .tar the offsets of its members; a .tar.gz
+// is decompressed once into a temporary file. Loading an archive again
+// returns the same members.
+func Load(path string) ([]Member, error) {
+	path = filepath.Clean(path)
+	var a *archive
+	var members []Member
+	var err error
+	if strings.HasSuffix(strings.ToLower(path), ".zip") {
+		a, members, err = loadZip(path)
+	} else {
+		a, members, err = loadTar(path)
+	}
+	if err != nil {
+		return nil, fmt.Errorf("failed to read archive %s: %w", path, err)
+	}
+
+	mu.Lock()
+	if old, ok := loaded[path]; ok {
+		old.close()
+	} else {
+		count.Add(1)
+	}
+	a.members = make(map[string]Member, len(members))
+	for _, member := range members {
+		a.members[member.Name] = member
+	}
+	loaded[path] = a
+	mu.Unlock()
+	return members, nil
+}
+
+func loadZip(path string) (*archive, []Member, error) {
+	file, err := zip.OpenReader(path)
+	if err != nil {
+		return nil, nil, err
+	}
+	a := &archive{zip: make(map[string]*zip.File), file: file}
+	var members []Member
+	for _, f := range file.File {
+		name := cleanName(f.Name)
+		if name == "" || !f.Mode().IsRegular() {
+			continue
+		}
+		a.zip[name] = f
+		members = append(members, Member{Name: name, Size: int64(f.UncompressedSize64), ModTime: f.Modified})
+	}
+	return a, members, nil
+}
+
+func loadTar(path string) (*archive, []Member, error) {
+	file, err := os.Open(path)
+	if err != nil {
+		return nil, nil, err
+	}
+
+	// A plain tar is read in place, so the offset of a member is where
+	// the file stands once its header is read. A compressed one cannot be
+	// read at an offset, so its members are copied out to a spill.
+	a := &archive{tar: make(map[string]int64), data: file, file: file}
+	var r io.Reader = file
+	var spill *memlimit.Spill
+	if lower := strings.ToLower(path); strings.HasSuffix(lower, ".gz") || strings.HasSuffix(lower, ".tgz") {
+		zr, err := gzip.NewReader(file)
+		if err != nil {
+			file.Close()
+			return nil, nil, err
+		}
+		defer file.Close()
+		defer zr.Close()
+		if spill, err = memlimit.NewSpill(); err != nil {
+			return nil, nil, err
+		}
+		r, a.data, a.file = zr, spill, spill
+	}
+
+	var members []Member
+	tr := tar.NewReader(r)
+	for {
+		header, err := tr.Next()
+		if err == io.EOF {
+			return a, members, nil
+		}
+		if err != nil {
+			a.close()
+			return nil, nil, err
+		}
+		name := cleanName(header.Name)
+		if name == "" || header.Typeflag != tar.TypeReg {
+			continue
+		}
+		if spill != nil {
+			a.tar[name] = spill.Size()
+			_, err = io.Copy(spill, tr)
+		} else {
+			a.tar[name], err = file.Seek(0, io.SeekCurrent)
+		}
+		if err != nil {
+			a.close()
+			return nil, nil, err
+		}
+		members = append(members, Member{Name: name, Size: header.Size, ModTime: header.ModTime})
+	}
+}
+
+// cleanName makes name relative to the archive, without "./" or "/" in
+// front and without ".." climbing out of it. Directories come out empty.
+func cleanName(name string) string {
+	return strings.TrimPrefix(filepath.ToSlash(filepath.Clean("/"+name)), "/")
+}
+
+// Read returns the content of the archive member path names. ok is false
+// when path is not inside a loaded archive, which costs nothing while no
+// archive is loaded.
+func Read(path string) (data []byte, ok bool, err error) {
+	if count.Load() == 0 {
+		return nil, false, nil
+	}
+	path = filepath.Clean(path)
+
+	mu.RLock()
+	defer mu.RUnlock()
+	for root, a := range loaded {
+		if !strings.HasPrefix(path, root+string(filepath.Separator)) {
+			continue
+		}
+		name := filepath.ToSlash(path[len(root)+1:])
+		if a.tar != nil {
+			offset, found := a.tar[name]
+			if !found {
+				return nil, true, os.ErrNotExist
+			}
+			data = make([]byte, a.members[name].Size)
+			_, err = a.data.ReadAt(data, offset)
+			return data, true, err
+		}
+		f, found := a.zip[name]
+		if !found {
+			return nil, true, os.ErrNotExist
+		}
+		rc, err := f.Open()
+		if err != nil {
+			return nil, true, err
+		}
+		defer rc.Close()
+		var buf bytes.Buffer
+		buf.Grow(int(f.UncompressedSize64))
+		_, err = io.Copy(&buf, rc)
+		return buf.Bytes(), true, err
+	}
+	return nil, false, nil
+}
+
+// Stat returns the member path names in a loaded archive. ok is false when
+// path is not inside one or names no member.
+func Stat(path string) (member Member, ok bool) {
+	if count.Load() == 0 {
+		return Member{}, false
+	}
+	path = filepath.Clean(path)
+
+	mu.RLock()
+	defer mu.RUnlock()
+	for root, a := range loaded {
+		if !strings.HasPrefix(path, root+string(filepath.Separator)) {
+			continue
+		}
+		name := filepath.ToSlash(path[len(root)+1:])
+		member, ok = a.members[name]
+		return member, ok
+	}
+	return Member{}, false
+}
+
+// Release closes every loaded archive and deletes the temporary files of
+// compressed tars. Their members cannot be read afterwards.
+func Release() error {
+	mu.Lock()
+	defer mu.Unlock()
+	var err error
+	for path, a := range loaded {
+		if cerr := a.close(); err == nil {
+			err = cerr
+		}
+		delete(loaded, path)
+		count.Add(-1)
+	}
+	return err
+}
+
+// ReadFile is os.ReadFile that also reads archive members.
+func ReadFile(path string) ([]byte, error) {
+	if data, ok, err := Read(path); ok {
+		return data, err
+	}
+	return os.ReadFile(path)
+}
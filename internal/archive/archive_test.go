@@ -0,0 +1,140 @@
+package archive
+
+import (
+	"archive/tar"
+	"archive/zip"
+	"compress/gzip"
+	"io"
+	"os"
+	"path/filepath"
+	"testing"
+
+	"github.com/vitruves/gop/internal/memlimit"
+)
+
+var snapshot = map[string]string{
+	"src/main.go":   "package main\n",
+	"src/lib/a.py":  "def a():\n    pass\n",
+	"README.md":     "# snapshot\n",
+	"../outside.go": "package outside\n",
+}
+
+// names are the members of snapshot as Load reports them.
+var names = map[string]string{
+	"src/main.go":  "src/main.go",
+	"src/lib/a.py": "src/lib/a.py",
+	"README.md":    "README.md",
+	"outside.go":   "../outside.go",
+}
+
+func writeZip(t *testing.T, path string) {
+	file, err := os.Create(path)
+	if err != nil {
+		t.Fatalf("Failed to create archive: %v", err)
+	}
+	defer file.Close()
+	zw := zip.NewWriter(file)
+	zw.Create("src/")
+	for name, content := range snapshot {
+		w, err := zw.Create(name)
+		if err != nil {
+			t.Fatalf("Failed to add %s: %v", name, err)
+		}
+		w.Write([]byte(content))
+	}
+	if err := zw.Close(); err != nil {
+		t.Fatalf("Failed to write archive: %v", err)
+	}
+}
+
+func writeTar(t *testing.T, path string) {
+	file, err := os.Create(path)
+	if err != nil {
+		t.Fatalf("Failed to create archive: %v", err)
+	}
+	defer file.Close()
+	var w io.Writer = file
+	if filepath.Ext(path) == ".gz" {
+		zw := gzip.NewWriter(file)
+		defer zw.Close()
+		w = zw
+	}
+	tw := tar.NewWriter(w)
+	tw.WriteHeader(&tar.Header{Name: "src/", Mode: 0755, Typeflag: tar.TypeDir})
+	tw.WriteHeader(&tar.Header{Name: "src/link.go", Linkname: "main.go", Typeflag: tar.TypeSymlink})
+	for name, content := range snapshot {
+		tw.WriteHeader(&tar.Header{Name: "./" + name, Mode: 0644, Size: int64(len(content)), Typeflag: tar.TypeReg})
+		tw.Write([]byte(content))
+	}
+	if err := tw.Close(); err != nil {
+		t.Fatalf("Failed to write archive: %v", err)
+	}
+}
+
+func TestLoadAndRead(t *testing.T) {
+	dir := t.TempDir()
+	zipPath, tarPath, gzPath := filepath.Join(dir, "snap.zip"), filepath.Join(dir, "snap.tar"), filepath.Join(dir, "snap.tar.gz")
+	writeZip(t, zipPath)
+	writeTar(t, tarPath)
+	writeTar(t, gzPath)
+	defer Release()
+
+	if data, ok, _ := Read(filepath.Join(zipPath, "src", "main.go")); ok || data != nil {
+		t.Error("Read should not find members before the archive is loaded")
+	}
+
+	for _, path := range []string{zipPath, tarPath, gzPath} {
+		if !IsArchive(path) {
+			t.Errorf("%s should be an archive", path)
+		}
+		members, err := Load(path)
+		if err != nil {
+			t.Fatalf("Failed to load %s: %v", path, err)
+		}
+		if len(members) != len(names) {
+			t.Errorf("%s: expected the %d regular files, got %+v", path, len(names), members)
+		}
+		for _, member := range members {
+			content := snapshot[names[member.Name]]
+			if member.Size != int64(len(content)) {
+				t.Errorf("%s: %s has size %d, expected %d", path, member.Name, member.Size, len(content))
+			}
+			data, err := ReadFile(filepath.Join(path, filepath.FromSlash(member.Name)))
+			if err != nil || string(data) != content {
+				t.Errorf("%s: read %s as %q, %v", path, member.Name, data, err)
+			}
+		}
+		if _, ok, err := Read(filepath.Join(path, "missing.go")); !ok || !os.IsNotExist(err) {
+			t.Errorf("%s: a missing member should not exist, got %v", path, err)
+		}
+	}
+
+	if _, ok, _ := Read(filepath.Join(dir, "snap.go")); ok {
+		t.Error("Files outside archives should be left to the file system")
+	}
+	if IsArchive("main.go") {
+		t.Error("main.go is not an archive")
+	}
+}
+
+func TestRelease(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "snap.tar.gz")
+	writeTar(t, path)
+	if _, err := Load(path); err != nil {
+		t.Fatalf("Failed to load %s: %v", path, err)
+	}
+	var size int64
+	for _, content := range snapshot {
+		size += int64(len(content))
+	}
+	if spill := loaded[path].file.(*memlimit.Spill); spill.Size() != size {
+		t.Errorf("Expected the %d bytes of members in the spill, got %d", size, spill.Size())
+	}
+
+	if err := Release(); err != nil {
+		t.Errorf("Release failed: %v", err)
+	}
+	if _, ok, _ := Read(filepath.Join(path, "src", "main.go")); ok {
+		t.Error("Members should not be read after Release")
+	}
+}
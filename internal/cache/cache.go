@@ -0,0 +1,223 @@
+package cache
+
+import (
+	"bytes"
+	"crypto/sha256"
+	"encoding/gob"
+	"os"
+	"path/filepath"
+	"sort"
+	"sync"
+	"time"
+
+	"github.com/vitruves/gop/internal/archive"
+)
+
+// DefaultDir is where the commands keep their caches unless told otherwise.
+const DefaultDir = ".gop-cache"
+
+// Cache stores one serialized result per source file. An entry is valid while
+// the file keeps its size and modification time; when only the time changed,
+// as after a fresh checkout, the content hash decides. A nil *Cache is a valid
+// cache that never hits, so callers do not need to special-case a disabled
+// cache.
+type Cache struct {
+	path    string
+	version string
+
+	mu      sync.Mutex
+	entries map[string]*entry
+	seen    map[string]bool
+	dirty   bool
+	hits    int
+}
+
+type entry struct {
+	Size    int64
+	ModTime int64
+	Hash    [sha256.Size]byte
+	Data    []byte
+}
+
+type snapshot struct {
+	Version string
+	Entries map[string]*entry
+}
+
+// Open loads dir/name.gob. A missing, unreadable or outdated cache file gives
+// an empty cache; version should change whenever the cached type does.
+func Open(dir, name, version string) *Cache {
+	c := &Cache{
+		path:    filepath.Join(dir, name+".gob"),
+		version: version,
+		entries: make(map[string]*entry),
+		seen:    make(map[string]bool),
+	}
+
+	file, err := os.Open(c.path)
+	if err != nil {
+		return c
+	}
+	defer file.Close()
+
+	var snap snapshot
+	if err := gob.NewDecoder(file).Decode(&snap); err != nil || snap.Version != version {
+		return c
+	}
+	if snap.Entries != nil {
+		c.entries = snap.Entries
+	}
+
+	return c
+}
+
+// Get decodes the cached result for path into v and reports whether it was
+// still valid.
+func (c *Cache) Get(path string, size int64, modTime time.Time, v any) bool {
+	if c == nil {
+		return false
+	}
+
+	c.mu.Lock()
+	e, ok := c.entries[path]
+	c.seen[path] = true
+	c.mu.Unlock()
+
+	if !ok || e.Size != size {
+		return false
+	}
+
+	if e.ModTime != modTime.UnixNano() {
+		hash, err := hashFile(path)
+		if err != nil || hash != e.Hash {
+			return false
+		}
+		c.mu.Lock()
+		e.ModTime = modTime.UnixNano()
+		c.dirty = true
+		c.mu.Unlock()
+	}
+
+	if err := gob.NewDecoder(bytes.NewReader(e.Data)).Decode(v); err != nil {
+		return false
+	}
+
+	c.mu.Lock()
+	c.hits++
+	c.mu.Unlock()
+	return true
+}
+
+// Put records v as the result for path, whose content hashed to hash. The
+// hash must come from the bytes v was computed from, so the file is not
+// read again and the entry cannot describe a newer version of it.
+func (c *Cache) Put(path string, size int64, modTime time.Time, hash [sha256.Size]byte, v any) {
+	if c == nil {
+		return
+	}
+
+	var data bytes.Buffer
+	if err := gob.NewEncoder(&data).Encode(v); err != nil {
+		return
+	}
+
+	c.mu.Lock()
+	c.entries[path] = &entry{Size: size, ModTime: modTime.UnixNano(), Hash: hash, Data: data.Bytes()}
+	c.seen[path] = true
+	c.dirty = true
+	c.mu.Unlock()
+}
+
+// Unseen returns, sorted, the paths of entries that no Get or Put has
+// touched in this run.
+func (c *Cache) Unseen() []string {
+	if c == nil {
+		return nil
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	var paths []string
+	for path := range c.entries {
+		if !c.seen[path] {
+			paths = append(paths, path)
+		}
+	}
+	sort.Strings(paths)
+	return paths
+}
+
+// Hits returns how many results were served from the cache.
+func (c *Cache) Hits() int {
+	if c == nil {
+		return 0
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+	return c.hits
+}
+
+// Save writes the cache back if anything changed. Entries for files that were
+// not part of this run are kept unless the file no longer exists.
+func (c *Cache) Save() error {
+	if c == nil {
+		return nil
+	}
+
+	c.mu.Lock()
+	defer c.mu.Unlock()
+
+	for path := range c.entries {
+		if c.seen[path] {
+			continue
+		}
+		if _, err := os.Stat(path); os.IsNotExist(err) {
+			delete(c.entries, path)
+			c.dirty = true
+		}
+	}
+
+	if !c.dirty {
+		return nil
+	}
+
+	if err := os.MkdirAll(filepath.Dir(c.path), 0755); err != nil {
+		return err
+	}
+
+	tmp, err := os.CreateTemp(filepath.Dir(c.path), filepath.Base(c.path)+".*.tmp")
+	if err != nil {
+		return err
+	}
+	defer os.Remove(tmp.Name())
+
+	if err := gob.NewEncoder(tmp).Encode(snapshot{Version: c.version, Entries: c.entries}); err != nil {
+		tmp.Close()
+		return err
+	}
+	if err := tmp.Close(); err != nil {
+		return err
+	}
+
+	if err := os.Rename(tmp.Name(), c.path); err != nil {
+		return err
+	}
+
+	c.dirty = false
+	return nil
+}
+
+// Hash is the content hash Put expects.
+func Hash(content []byte) [sha256.Size]byte {
+	return sha256.Sum256(content)
+}
+
+func hashFile(path string) ([sha256.Size]byte, error) {
+	content, err := archive.ReadFile(path)
+	if err != nil {
+		return [sha256.Size]byte{}, err
+	}
+	return Hash(content), nil
+}
@@ -0,0 +1,82 @@
+package cache
+
+import (
+	"os"
+	"path/filepath"
+	"testing"
+	"time"
+)
+
+type result struct {
+	Names []string
+}
+
+func stat(t *testing.T, path string) (int64, time.Time) {
+	t.Helper()
+	info, err := os.Stat(path)
+	if err != nil {
+		t.Fatalf("Failed to stat file: %v", err)
+	}
+	return info.Size(), info.ModTime()
+}
+
+func TestCacheRoundTrip(t *testing.T) {
+	dir := t.TempDir()
+	cacheDir := filepath.Join(dir, DefaultDir)
+	source := filepath.Join(dir, "main.go")
+	if err := os.WriteFile(source, []byte("package main"), 0644); err != nil {
+		t.Fatalf("Failed to create file: %v", err)
+	}
+	size, modTime := stat(t, source)
+
+	c := Open(cacheDir, "test", "v1")
+	var got result
+	if c.Get(source, size, modTime, &got) {
+		t.Error("Empty cache should not hit")
+	}
+	c.Put(source, size, modTime, Hash([]byte("package main")), result{Names: []string{"main"}})
+	if err := c.Save(); err != nil {
+		t.Fatalf("Failed to save cache: %v", err)
+	}
+
+	c = Open(cacheDir, "test", "v1")
+	if !c.Get(source, size, modTime, &got) || len(got.Names) != 1 || got.Names[0] != "main" {
+		t.Errorf("Should serve the stored result, got %+v", got)
+	}
+
+	touched := modTime.Add(time.Hour)
+	if err := os.Chtimes(source, touched, touched); err != nil {
+		t.Fatalf("Failed to touch file: %v", err)
+	}
+	if !c.Get(source, size, touched, &got) {
+		t.Error("Should fall back to the content hash when only the mtime changed")
+	}
+
+	if err := os.WriteFile(source, []byte("package demo"), 0644); err != nil {
+		t.Fatalf("Failed to rewrite file: %v", err)
+	}
+	size, modTime = stat(t, source)
+	if c.Get(source, size, modTime.Add(time.Hour), &got) {
+		t.Error("Should miss once the content changed")
+	}
+	if c.Hits() != 2 {
+		t.Errorf("Expected 2 hits, got %d", c.Hits())
+	}
+
+	if Open(cacheDir, "test", "v2").Get(source, size, modTime, &got) {
+		t.Error("Should discard a cache written with another version")
+	}
+
+	// Archive members are not on disk; Put must not need to read them.
+	member := filepath.Join(dir, "snapshot.tar", "lib.go")
+	c.Put(member, 3, modTime, Hash([]byte("lib")), result{Names: []string{"lib"}})
+	if !c.Get(member, 3, modTime, &got) || got.Names[0] != "lib" {
+		t.Error("Should cache a file that only exists inside an archive")
+	}
+
+	var disabled *Cache
+	disabled.Put(source, size, modTime, Hash(nil), result{})
+	if disabled.Get(source, size, modTime, &got) || disabled.Save() != nil {
+		t.Error("A nil cache should never hit")
+	}
+}
@@ -0,0 +1,246 @@
+package callgraph
+
+import (
+	"bufio"
+	"encoding/json"
+	"fmt"
+	"io"
+	"slices"
+	"strconv"
+)
+
+// Symbols interns names to dense int32 IDs, so the graph and the resolver
+// compare integers instead of strings.
+type Symbols struct {
+	ids   map[string]int32
+	names []string
+}
+
+func NewSymbols() *Symbols {
+	return &Symbols{ids: make(map[string]int32)}
+}
+
+// Intern returns the ID of name, assigning the next free one if needed.
+func (s *Symbols) Intern(name string) int32 {
+	if id, ok := s.ids[name]; ok {
+		return id
+	}
+	id := int32(len(s.names))
+	s.ids[name] = id
+	s.names = append(s.names, name)
+	return id
+}
+
+// Lookup returns the ID of name without assigning one.
+func (s *Symbols) Lookup(name string) (int32, bool) {
+	id, ok := s.ids[name]
+	return id, ok
+}
+
+func (s *Symbols) Name(id int32) string {
+	return s.names[id]
+}
+
+func (s *Symbols) Len() int {
+	return len(s.names)
+}
+
+// Builder collects directed edges between nodes [0, n).
+type Builder struct {
+	nodes int
+	from  []int32
+	to    []int32
+}
+
+func NewBuilder(nodes int) *Builder {
+	return &Builder{nodes: nodes}
+}
+
+func (b *Builder) AddEdge(from, to int32) {
+	b.from = append(b.from, from)
+	b.to = append(b.to, to)
+}
+
+// Graph stores edges in compressed sparse row form in both directions:
+// the callees of node n are out.targets[out.offsets[n]:out.offsets[n+1]],
+// sorted and without duplicates, and in mirrors that for callers.
+type Graph struct {
+	out csr
+	in  csr
+}
+
+type csr struct {
+	offsets []int32
+	targets []int32
+}
+
+// Build sorts the collected edges into a Graph, dropping duplicates. It runs
+// in time linear in the number of edges, apart from sorting each row.
+func (b *Builder) Build() *Graph {
+	out := group(b.nodes, b.from, b.to)
+	b.from, b.to = nil, nil
+
+	// Deduplicate each row in place and compact the targets.
+	write := int32(0)
+	start := int32(0)
+	for n := 0; n < b.nodes; n++ {
+		end := out.offsets[n+1]
+		row := out.targets[start:end]
+		slices.Sort(row)
+		out.offsets[n] = write
+		for i, target := range row {
+			if i > 0 && target == row[i-1] {
+				continue
+			}
+			out.targets[write] = target
+			write++
+		}
+		start = end
+	}
+	out.offsets[b.nodes] = write
+	out.targets = out.targets[:write:write]
+
+	// The transpose of a graph with sorted rows has sorted rows as well.
+	from := make([]int32, 0, write)
+	for n := 0; n < b.nodes; n++ {
+		for i := out.offsets[n]; i < out.offsets[n+1]; i++ {
+			from = append(from, int32(n))
+		}
+	}
+	in := group(b.nodes, out.targets, from)
+
+	return &Graph{out: out, in: in}
+}
+
+// group is a counting sort of the edges by key.
+func group(nodes int, keys, values []int32) csr {
+	offsets := make([]int32, nodes+1)
+	for _, key := range keys {
+		offsets[key+1]++
+	}
+	for n := 0; n < nodes; n++ {
+		offsets[n+1] += offsets[n]
+	}
+
+	targets := make([]int32, len(keys))
+	next := make([]int32, nodes)
+	copy(next, offsets[:nodes])
+	for i, key := range keys {
+		targets[next[key]] = values[i]
+		next[key]++
+	}
+
+	return csr{offsets: offsets, targets: targets}
+}
+
+func (g *Graph) Nodes() int {
+	return len(g.out.offsets) - 1
+}
+
+func (g *Graph) Edges() int {
+	return len(g.out.targets)
+}
+
+// Callees returns the nodes n calls. The slice must not be modified.
+func (g *Graph) Callees(n int32) []int32 {
+	return g.out.targets[g.out.offsets[n]:g.out.offsets[n+1]]
+}
+
+// Callers returns the nodes calling n. The slice must not be modified.
+func (g *Graph) Callers(n int32) []int32 {
+	return g.in.targets[g.in.offsets[n]:g.in.offsets[n+1]]
+}
+
+// Reachable marks every node reachable from roots.
+func (g *Graph) Reachable(roots []int32) []bool {
+	seen := make([]bool, g.Nodes())
+	queue := make([]int32, 0, len(roots))
+	for _, root := range roots {
+		if !seen[root] {
+			seen[root] = true
+			queue = append(queue, root)
+		}
+	}
+
+	for len(queue) > 0 {
+		n := queue[len(queue)-1]
+		queue = queue[:len(queue)-1]
+		for _, callee := range g.Callees(n) {
+			if !seen[callee] {
+				seen[callee] = true
+				queue = append(queue, callee)
+			}
+		}
+	}
+
+	return seen
+}
+
+// Node describes one graph node for export.
+type Node struct {
+	Name string `json:"name"`
+	File string `json:"file,omitempty"`
+	Line int    `json:"line,omitempty"`
+	Kind string `json:"kind"`
+}
+
+// WriteJSON writes {"nodes": [...], "edges": [[from, to], ...]}, where the
+// edge endpoints index into nodes.
+func (g *Graph) WriteJSON(w io.Writer, nodes []Node) error {
+	bw := bufio.NewWriterSize(w, 256*1024)
+
+	bw.WriteString("{\"nodes\":[")
+	for i, node := range nodes {
+		if i > 0 {
+			bw.WriteByte(',')
+		}
+		data, err := json.Marshal(node)
+		if err != nil {
+			return err
+		}
+		bw.Write(data)
+	}
+
+	bw.WriteString("],\"edges\":[")
+	first := true
+	var buf []byte
+	for n := 0; n < g.Nodes(); n++ {
+		for _, callee := range g.Callees(int32(n)) {
+			if !first {
+				bw.WriteByte(',')
+			}
+			first = false
+			buf = append(buf[:0], '[')
+			buf = strconv.AppendInt(buf, int64(n), 10)
+			buf = append(buf, ',')
+			buf = strconv.AppendInt(buf, int64(callee), 10)
+			buf = append(buf, ']')
+			bw.Write(buf)
+		}
+	}
+	bw.WriteString("]}\n")
+
+	return bw.Flush()
+}
+
+// WriteDOT writes the graph in Graphviz format.
+func (g *Graph) WriteDOT(w io.Writer, nodes []Node) error {
+	bw := bufio.NewWriterSize(w, 256*1024)
+
+	bw.WriteString("digraph calls {\n")
+	for i, node := range nodes {
+		shape := "box"
+		if node.Kind != "function" {
+			shape = "note"
+		}
+		fmt.Fprintf(bw, "  n%d [label=%s shape=%s];\n", i, strconv.Quote(node.Name), shape)
+	}
+	for n := 0; n < g.Nodes(); n++ {
+		for _, callee := range g.Callees(int32(n)) {
+			fmt.Fprintf(bw, "  n%d -> n%d;\n", n, callee)
+		}
+	}
+	bw.WriteString("}\n")
+
+	return bw.Flush()
+}
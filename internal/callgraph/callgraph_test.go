@@ -0,0 +1,54 @@
+package callgraph
+
+import (
+	"bytes"
+	"strings"
+	"testing"
+)
+
+func TestBuildAndReach(t *testing.T) {
+	b := NewBuilder(5)
+	b.AddEdge(0, 2)
+	b.AddEdge(0, 1)
+	b.AddEdge(0, 2)
+	b.AddEdge(1, 2)
+	b.AddEdge(3, 4)
+	g := b.Build()
+
+	if g.Edges() != 4 {
+		t.Errorf("Expected 4 edges after dedup, got %d", g.Edges())
+	}
+	if callees := g.Callees(0); len(callees) != 2 || callees[0] != 1 || callees[1] != 2 {
+		t.Errorf("Expected callees [1 2], got %v", callees)
+	}
+	if callers := g.Callers(2); len(callers) != 2 || callers[0] != 0 || callers[1] != 1 {
+		t.Errorf("Expected callers [0 1], got %v", callers)
+	}
+
+	reachable := g.Reachable([]int32{0})
+	for n, want := range []bool{true, true, true, false, false} {
+		if reachable[n] != want {
+			t.Errorf("Node %d reachable = %v, expected %v", n, reachable[n], want)
+		}
+	}
+
+	nodes := make([]Node, 5)
+	for i := range nodes {
+		nodes[i] = Node{Name: string(rune('a' + i)), Kind: "function"}
+	}
+	var buf bytes.Buffer
+	if err := g.WriteJSON(&buf, nodes); err != nil {
+		t.Fatalf("Failed to write JSON: %v", err)
+	}
+	if !strings.Contains(buf.String(), `"edges":[[0,1],[0,2],[1,2],[3,4]]`) {
+		t.Errorf("Unexpected JSON: %s", buf.String())
+	}
+
+	symbols := NewSymbols()
+	if symbols.Intern("run") != 0 || symbols.Intern("stop") != 1 || symbols.Intern("run") != 0 {
+		t.Error("Intern should assign dense stable IDs")
+	}
+	if id, ok := symbols.Lookup("stop"); !ok || symbols.Name(id) != "stop" {
+		t.Error("Lookup should find interned names")
+	}
+}
@@ -0,0 +1,200 @@
+package cmd
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"strings"
+
+	"github.com/schollz/progressbar/v3"
+	"github.com/spf13/cobra"
+	"github.com/vitruves/gop/internal/memlimit"
+	"github.com/vitruves/gop/internal/pool"
+	"github.com/vitruves/gop/internal/registry"
+	"github.com/vitruves/gop/internal/source"
+	"github.com/vitruves/gop/internal/timings"
+	"github.com/vitruves/gop/internal/walker"
+)
+
+var (
+	analyzeOutputDir      string
+	analyzeRegistryFormat string
+)
+
+var analyzeCmd = &cobra.Command{
+	Use:   "analyze",
+	Short: "Generate stats, the function registry and placeholders in one pass",
+	Long: `Read every file once and produce the reports of stats, function-registry and placeholders
+together: stats.txt, registry.<format> and placeholders.txt in the output directory.`,
+	RunE: runAnalyze,
+}
+
+func init() {
+	analyzeCmd.Flags().StringVarP(&analyzeOutputDir, "output", "o", "gop-report", "Directory for the reports")
+	analyzeCmd.Flags().StringVar(&analyzeRegistryFormat, "registry-format", "md", "Registry format (md, txt, yaml, json, ndjson, or csv)")
+	analyzeCmd.Flags().BoolVar(&registryAddRelations, "add-relations", false, "Analyze function call relationships")
+	analyzeCmd.Flags().BoolVar(&registryByScript, "by-script", false, "Group functions by script/file")
+	analyzeCmd.Flags().BoolVar(&registryNoDocs, "no-docs", false, "Leave out doc comments; Go files then parse without comments")
+	addSkipFlags(analyzeCmd)
+}
+
+func runAnalyze(cmd *cobra.Command, args []string) error {
+	if verbose {
+		logInfo("Starting combined analysis")
+	}
+
+	if err := os.MkdirAll(analyzeOutputDir, 0755); err != nil {
+		logError(fmt.Sprintf("Failed to create output directory: %v", err))
+		return err
+	}
+	collector, err := registry.NewCollector(registry.Config{
+		Language:     language,
+		Jobs:         jobs,
+		Verbose:      verbose,
+		OutputFile:   filepath.Join(analyzeOutputDir, "registry."+analyzeRegistryFormat),
+		ByScript:     registryByScript,
+		AddRelations: registryAddRelations,
+		NoDocs:       registryNoDocs,
+		MaxMemory:    maxMemory,
+	})
+	if err != nil {
+		logError(err.Error())
+		return err
+	}
+
+	placeholderExts := make(map[string]bool)
+	for _, ext := range sourceExtensions {
+		placeholderExts[ext] = true
+	}
+
+	bar := progressbar.NewOptions(-1,
+		progressbar.OptionSetDescription("Analyzing files"),
+		progressbar.OptionShowCount(),
+		progressbar.OptionSetRenderBlankState(true),
+		progressbar.OptionClearOnFinish(),
+	)
+
+	endAnalyze := timings.Phase("analyze")
+	progress := pool.NewProgress(func(n int) { bar.Add(n) })
+	totals := newStatsTotals(jobs)
+	found := pool.NewResults[[]Placeholder](jobs)
+	var skips skipCounts
+	limit := collector.Limit()
+	files, walkErr := walker.Stream(walkerConfig(nil))
+	admitted := memlimit.Admit(limit, files, func(file walker.File) int64 { return file.Size })
+
+	// Each file is read once and its bytes go to all three analyses in the
+	// same worker. The skips decide what stats and placeholders count; the
+	// registry parses every file it covers, as function-registry does.
+	count := pool.Each(jobs, admitted, func(worker, idx int, file walker.File) {
+		defer progress.Add(1)
+		defer limit.Release(file.Size)
+		large := skips.tooLarge(file)
+		parsed := collector.Accepts(file.Path)
+		if large && !parsed {
+			collector.Add(idx, file.Path, nil)
+			return
+		}
+
+		start := timings.Now()
+		src, err := source.Open(file.Path)
+		if err != nil {
+			logError(fmt.Sprintf("Error reading %s: %v", file.Path, err))
+			collector.Add(idx, file.Path, nil)
+			return
+		}
+		defer src.Close()
+		skip := large
+		var fileStats FileStats
+		var placeholders []Placeholder
+		if !large {
+			err = source.Protect(func() {
+				content := src.Bytes()
+				if skip, _ = skips.sniffContent(content); skip {
+					return
+				}
+				fileStats = statsFor(file.Path, content)
+				if placeholderExts[filepath.Ext(file.Path)] {
+					placeholders = scanPlaceholders(file.Path, content)
+				}
+			})
+		}
+		if err != nil {
+			logError(fmt.Sprintf("Error reading %s: %v", file.Path, err))
+			collector.Add(idx, file.Path, nil)
+			return
+		}
+
+		if !skip {
+			totals.add(worker, idx, fileStats)
+			if placeholders != nil {
+				found.Set(worker, idx, placeholders)
+			}
+		}
+		if parsed {
+			collector.Add(idx, file.Path, src)
+		} else {
+			collector.Add(idx, file.Path, nil)
+		}
+		timings.File(detectLanguage(file.Path), file.Size, start)
+	})
+
+	progress.Stop()
+	bar.Finish()
+	endAnalyze()
+
+	if err := <-walkErr; err != nil {
+		logError(fmt.Sprintf("Failed to collect files: %v", err))
+		return err
+	}
+	if count == 0 {
+		logWarning("No files found")
+		return nil
+	}
+
+	stats := &CodebaseStats{LanguageStats: make(map[string]LanguageStats)}
+	totals.merge(stats)
+	stats.SkippedFiles = skips.String()
+
+	var placeholders []Placeholder
+	for _, filePlaceholders := range found.Ordered(count) {
+		placeholders = append(placeholders, filePlaceholders...)
+	}
+
+	endOutput := timings.Phase("output")
+	err = os.WriteFile(filepath.Join(analyzeOutputDir, "stats.txt"), []byte(formatStats(stats)), 0644)
+	if err == nil {
+		err = os.WriteFile(filepath.Join(analyzeOutputDir, "placeholders.txt"), []byte(formatPlaceholders(placeholders)), 0644)
+	}
+	endOutput()
+	if err != nil {
+		logError(fmt.Sprintf("Failed to write report: %v", err))
+		return err
+	}
+	if collector.Files() > 0 {
+		if err := collector.Finish(); err != nil {
+			return err
+		}
+	}
+
+	if verbose {
+		logInfo(fmt.Sprintf("Analyzed %d files, %d with a parser, found %d placeholders", stats.TotalFiles, collector.Files(), len(placeholders)))
+	}
+	logSuccess(fmt.Sprintf("Reports written to %s", analyzeOutputDir))
+	return nil
+}
+
+// formatPlaceholders is the plain text form of displayPlaceholders.
+func formatPlaceholders(placeholders []Placeholder) string {
+	types, typeGroups := groupPlaceholders(placeholders)
+
+	var sb strings.Builder
+	sb.WriteString(fmt.Sprintf("# Placeholders\n\nFound %d placeholders\n", len(placeholders)))
+	for _, ptype := range types {
+		sb.WriteString(fmt.Sprintf("\n=== %s ===\n", strings.ToUpper(ptype)))
+		for _, item := range typeGroups[ptype] {
+			sb.WriteString(fmt.Sprintf("%s:%d:%d - %s\n", item.File, item.Line, item.Column, item.Content))
+		}
+	}
+	return sb.String()
+}
@@ -0,0 +1,381 @@
+package cmd
+
+import (
+	"bufio"
+	"encoding/json"
+	"fmt"
+	"net/http"
+	"net/http/httptest"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+
+	"github.com/vitruves/gop/internal/corpus"
+	"github.com/vitruves/gop/internal/registry"
+	"github.com/vitruves/gop/internal/walker"
+)
+
+const placeholderSample = "package main\r\n" +
+	"// TODO: replace this\n" +
+	"// Fixme(alice) handle errors\n" +
+	"const host = \"localhost\"\n" +
+	"const addr = \"192.168.1.10\"\n" +
+	"password = \"hunter2\"\n" +
+	"testMode = true\n" +
+	"debug = true\n" +
+	"fmt.Print(\"x\")\n" +
+	"exit(1)\n" +
+	"panic!(\"boom\")\n" +
+	"// Not Implemented yet, quick and dirty workaround\n" +
+	"var sample = DummyValue\n" +
+	"func clean() int { return 42 }\n" +
+	"x := 1.5 // no placeholder here\n" +
+	"// trailing line without newline: HACK"
+
+// scanAllPatterns is the reference scanner: every pattern on every line.
+func scanAllPatterns(t *testing.T, filePath string) []Placeholder {
+	file, err := os.Open(filePath)
+	if err != nil {
+		t.Fatalf("Failed to open file: %v", err)
+	}
+	defer file.Close()
+
+	var placeholders []Placeholder
+	scanner := bufio.NewScanner(file)
+	lineNum := 1
+	for scanner.Scan() {
+		placeholders = matchPlaceholders(placeholders, filePath, lineNum, scanner.Text(), ^uint32(0))
+		lineNum++
+	}
+	return placeholders
+}
+
+func TestScanFileForPlaceholders(t *testing.T) {
+	testFile := filepath.Join(t.TempDir(), "sample.go")
+	if err := os.WriteFile(testFile, []byte(placeholderSample), 0644); err != nil {
+		t.Fatalf("Failed to create test file: %v", err)
+	}
+
+	got, err := scanFileForPlaceholders(testFile, nil)
+	if err != nil {
+		t.Fatalf("Failed to scan file: %v", err)
+	}
+	expected := scanAllPatterns(t, testFile)
+
+	if len(got) != len(expected) {
+		t.Fatalf("Expected %d placeholders, got %d", len(expected), len(got))
+	}
+	for i := range expected {
+		if got[i] != expected[i] {
+			t.Errorf("Placeholder %d: expected %+v, got %+v", i, expected[i], got[i])
+		}
+	}
+
+	types := make(map[string]bool)
+	for _, p := range got {
+		types[p.Type] = true
+	}
+	for _, ptype := range []string{"comment", "hardcoded_host", "ip_address", "hardcoded_secret", "test_flag", "debug_flag", "debug_print", "exit_call", "exception", "unimplemented", "quick_fix", "example_data", "temporary"} {
+		if !types[ptype] {
+			t.Errorf("Should report a %s placeholder", ptype)
+		}
+	}
+}
+
+func TestPlaceholderOrder(t *testing.T) {
+	content := "exit(1) // temporary workaround, TODO: remove\n" + placeholderSample
+	got := scanPlaceholders("order.go", []byte(content))
+	if len(got) < 3 || got[0].Line != 1 || got[1].Line != 1 || got[2].Line != 1 {
+		t.Fatalf("Expected several placeholders on line 1, got %+v", got)
+	}
+	for i := 1; i < len(got); i++ {
+		prev, p := got[i-1], got[i]
+		if p.Line < prev.Line || p.Line == prev.Line && p.Column < prev.Column {
+			t.Errorf("Placeholder %+v comes after %+v", p, prev)
+		}
+	}
+
+	report := formatPlaceholders(got)
+	if report != formatPlaceholders(scanPlaceholders("order.go", []byte(content))) {
+		t.Error("Report should be the same on every run")
+	}
+	types, _ := groupPlaceholders(got)
+	last := -1
+	for _, ptype := range types {
+		at := strings.Index(report, "=== "+strings.ToUpper(ptype)+" ===")
+		if at < last {
+			t.Errorf("Type %s is out of order in %q", ptype, report)
+		}
+		last = at
+	}
+}
+
+func BenchmarkScanFileForPlaceholders(b *testing.B) {
+	var source strings.Builder
+	for i := 0; i < 200; i++ {
+		source.WriteString("func compute(values []int) int {\n\ttotal := 0\n\tfor _, v := range values {\n\t\ttotal += v\n\t}\n\treturn total\n}\n\n")
+	}
+	source.WriteString(placeholderSample)
+
+	testFile := filepath.Join(b.TempDir(), "bench.go")
+	if err := os.WriteFile(testFile, []byte(source.String()), 0644); err != nil {
+		b.Fatalf("Failed to create test file: %v", err)
+	}
+
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, err := scanFileForPlaceholders(testFile, nil); err != nil {
+			b.Fatalf("Failed to scan file: %v", err)
+		}
+	}
+}
+
+func BenchmarkScanCorpusForPlaceholders(b *testing.B) {
+	corpus.EachSource(b, func(b *testing.B, language, path, source string) {
+		for i := 0; i < b.N; i++ {
+			if _, err := scanFileForPlaceholders(path, nil); err != nil {
+				b.Fatalf("Failed to scan file: %v", err)
+			}
+		}
+	})
+}
+
+func BenchmarkAnalyzeFile(b *testing.B) {
+	corpus.EachSource(b, func(b *testing.B, language, path, source string) {
+		for i := 0; i < b.N; i++ {
+			if _, err := analyzeFile(path, nil); err != nil {
+				b.Fatalf("Failed to analyze file: %v", err)
+			}
+		}
+	})
+}
+
+func TestProfiling(t *testing.T) {
+	dir := t.TempDir()
+	cpuProfile = filepath.Join(dir, "cpu.pprof")
+	memProfile = filepath.Join(dir, "mem.pprof")
+	traceFile = filepath.Join(dir, "run.trace")
+	defer func() { cpuProfile, memProfile, traceFile = "", "", "" }()
+
+	if err := startProfiling(); err != nil {
+		t.Fatalf("startProfiling failed: %v", err)
+	}
+	if _, err := scanFileForPlaceholders("cmd_test.go", nil); err != nil {
+		t.Fatalf("Failed to scan file: %v", err)
+	}
+	if err := stopProfiling(); err != nil {
+		t.Fatalf("stopProfiling failed: %v", err)
+	}
+
+	for _, path := range []string{cpuProfile, memProfile, traceFile} {
+		if info, err := os.Stat(path); err != nil || info.Size() == 0 {
+			t.Errorf("%s should have been written", filepath.Base(path))
+		}
+	}
+}
+
+func TestAnalyzeFile(t *testing.T) {
+	dir := t.TempDir()
+	long := "var long = \"" + strings.Repeat("x", 100<<10) + "\"\n"
+	files := map[string]string{
+		"main.go": "package main\r\n\r\nimport \"fmt\"\r\n// comment\r\ntype point struct{}\r\n" +
+			"def notPython():\n" + long + "func main() {\n\tfmt.Println()\n}",
+		"tool.py": "import os\nfrom x import y\n\n# comment\nclass A:\n    async def f(self):\n        pass\n",
+		"lib.c":   "#include <stdio.h>\n/* comment */\nstatic int add(int a, int b) {\n  return a + b;\n}\n  \t \n",
+	}
+	want := map[string]FileStats{
+		"main.go": {Language: "Go", Lines: 10, BlankLines: 1, CommentLines: 1, CodeLines: 8, Functions: 1, Classes: 1, Imports: 1},
+		"tool.py": {Language: "Python", Lines: 7, BlankLines: 1, CommentLines: 1, CodeLines: 5, Functions: 1, Classes: 1, Imports: 2},
+		"lib.c":   {Language: "C", Lines: 6, BlankLines: 1, CommentLines: 1, CodeLines: 4, Functions: 1, Imports: 1},
+	}
+
+	for name, content := range files {
+		path := filepath.Join(dir, name)
+		if err := os.WriteFile(path, []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to write file: %v", err)
+		}
+		stats, err := analyzeFile(path, nil)
+		if err != nil {
+			t.Fatalf("analyzeFile(%s) failed: %v", name, err)
+		}
+		expected := want[name]
+		expected.File, expected.Size = path, int64(len(content))
+		if stats != expected {
+			t.Errorf("%s: expected %+v, got %+v", name, expected, stats)
+		}
+	}
+}
+
+func TestStatsTotals(t *testing.T) {
+	var files []FileStats
+	for i := 0; i < 200; i++ {
+		lang := []string{"Go", "Python", "C"}[i%3]
+		files = append(files, FileStats{File: fmt.Sprintf("f%03d", i), Language: lang, Lines: (i * 37) % 50, CodeLines: i % 7, Functions: i % 5, Size: int64(i)})
+	}
+
+	// Keeping every file is what the report used to do.
+	want := &CodebaseStats{LanguageStats: make(map[string]LanguageStats)}
+	for _, fileStats := range files {
+		want.FileStats = append(want.FileStats, fileStats)
+		updateStats(want, fileStats)
+	}
+	want.TotalFiles = len(want.FileStats)
+
+	totals := newStatsTotals(3)
+	for i, fileStats := range files {
+		totals.add((i*7)%3, i, fileStats)
+	}
+	totals.add(0, len(files), FileStats{})
+	got := &CodebaseStats{LanguageStats: make(map[string]LanguageStats)}
+	totals.merge(got)
+
+	if len(got.FileStats) != topFiles {
+		t.Errorf("Expected %d top files, got %d", topFiles, len(got.FileStats))
+	}
+	if formatStats(got) != formatStats(want) {
+		t.Errorf("Report differs:\n got %s\nwant %s", formatStats(got), formatStats(want))
+	}
+}
+
+func TestSkipCounts(t *testing.T) {
+	dir := t.TempDir()
+	write := func(name, content string) walker.File {
+		path := filepath.Join(dir, name)
+		if err := os.WriteFile(path, []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to write file: %v", err)
+		}
+		return walker.File{Path: path, Size: int64(len(content))}
+	}
+	source := write("main.go", "package main\n")
+	binary := write("logo.png", "\x89PNG\r\n\x1a\n\x00\x00")
+	generated := write("api.pb.go", "// Code generated by protoc-gen-go. DO NOT EDIT.\npackage api\n")
+
+	var skips skipCounts
+	if skip, gen := skips.sniff(source); skip || gen {
+		t.Error("Source files should not be skipped")
+	}
+	if skip, _ := skips.sniff(binary); !skip {
+		t.Error("Binary files should always be skipped")
+	}
+	if skip, gen := skips.sniff(generated); skip || !gen {
+		t.Error("Generated files should only be skipped with --skip-generated")
+	}
+
+	skipGenerated, maxFileSize = true, 20
+	defer func() { skipGenerated, maxFileSize = false, 0 }()
+	if skip, _ := skips.sniff(generated); !skip {
+		t.Error("--skip-generated should skip generated files")
+	}
+	if !skips.tooLarge(generated) || skips.tooLarge(source) {
+		t.Error("Only files over --max-file-size should be too large")
+	}
+	if got := skips.String(); got != "1 binary, 1 generated, 1 over --max-file-size" {
+		t.Errorf("Unexpected summary %q", got)
+	}
+}
+
+func TestServeIndex(t *testing.T) {
+	dir := t.TempDir()
+	include, recursive, language = []string{dir}, true, "go"
+	defer func() { include, recursive, language = nil, false, "" }()
+	write := func(name, content string) {
+		path := filepath.Join(dir, name)
+		if err := os.MkdirAll(filepath.Dir(path), 0755); err != nil {
+			t.Fatalf("Failed to create directory: %v", err)
+		}
+		if err := os.WriteFile(path, []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to write file: %v", err)
+		}
+	}
+	query := func(handler http.Handler, url string, v any) {
+		recorder := httptest.NewRecorder()
+		handler.ServeHTTP(recorder, httptest.NewRequest("GET", url, nil))
+		if err := json.Unmarshal(recorder.Body.Bytes(), v); err != nil {
+			t.Fatalf("%s: invalid JSON %q: %v", url, recorder.Body.String(), err)
+		}
+	}
+
+	write("a.go", "package a\n\n// TODO: finish\nfunc A() {}\n")
+	index, err := newServeIndex()
+	if err != nil {
+		t.Fatalf("newServeIndex failed: %v", err)
+	}
+	if n := index.refresh(nil); n != 1 {
+		t.Fatalf("Expected 1 file indexed, got %d", n)
+	}
+	handler := index.handler()
+
+	var functions []registry.Function
+	query(handler, "/functions?name=A", &functions)
+	if len(functions) != 1 || functions[0].Line != 4 {
+		t.Errorf("Expected A on line 4, got %+v", functions)
+	}
+
+	write("sub/b.go", "package sub\n\nfunc B() {}\n")
+	index.refresh(index.expand([]string{filepath.Join(dir, "sub")}))
+	query(handler, "/functions", &functions)
+	if len(functions) != 2 {
+		t.Errorf("A new directory's files should be indexed, got %+v", functions)
+	}
+
+	var placeholders []Placeholder
+	query(handler, "/placeholders?type=comment", &placeholders)
+	if len(placeholders) != 1 || placeholders[0].Line != 3 {
+		t.Errorf("Expected the TODO on line 3, got %+v", placeholders)
+	}
+
+	if err := os.RemoveAll(filepath.Join(dir, "sub")); err != nil {
+		t.Fatalf("Failed to remove directory: %v", err)
+	}
+	index.refresh(index.expand([]string{filepath.Join(dir, "sub")}))
+	var stats CodebaseStats
+	query(handler, "/stats", &stats)
+	if stats.TotalFiles != 1 || stats.TotalFunctions != 1 {
+		t.Errorf("Files of a removed directory should be forgotten, got %d files and %d functions", stats.TotalFiles, stats.TotalFunctions)
+	}
+	var status serveStatus
+	query(handler, "/status", &status)
+	if status.Files != 1 || status.Functions != 1 || status.Generation != 3 {
+		t.Errorf("Unexpected status %+v", status)
+	}
+}
+
+func TestAnalyze(t *testing.T) {
+	dir := t.TempDir()
+	files := map[string]string{
+		"main.go":  "package main\n\n// TODO: wire flags\nfunc main() {}\n",
+		"tool.py":  "def run():\n    pass\n",
+		"logo.png": "\x89PNG\r\n\x1a\n\x00\x00",
+		// Skipped from the stats, but still a part of the registry.
+		"gen.go": "// Code generated by stringer. DO NOT EDIT.\n\npackage main\n\nfunc generatedName() {}\n",
+	}
+	for name, content := range files {
+		if err := os.WriteFile(filepath.Join(dir, name), []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to write file: %v", err)
+		}
+	}
+	include, language, analyzeOutputDir, skipGenerated = []string{dir}, "go", t.TempDir(), true
+	defer func() { include, language, analyzeOutputDir, skipGenerated = nil, "", "gop-report", false }()
+
+	if err := runAnalyze(nil, nil); err != nil {
+		t.Fatalf("runAnalyze failed: %v", err)
+	}
+	read := func(name string) string {
+		data, err := os.ReadFile(filepath.Join(analyzeOutputDir, name))
+		if err != nil {
+			t.Fatalf("Failed to read %s: %v", name, err)
+		}
+		return string(data)
+	}
+
+	if stats := read("stats.txt"); !strings.Contains(stats, "**Total Files**: 2") || !strings.Contains(stats, "**Skipped Files**: 1 binary, 1 generated") {
+		t.Errorf("Unexpected stats report:\n%s", stats)
+	}
+	if registry := read("registry.md"); !strings.Contains(registry, "main") || !strings.Contains(registry, "generatedName") || strings.Contains(registry, "run") {
+		t.Errorf("The registry should hold the Go functions only:\n%s", registry)
+	}
+	if placeholders := read("placeholders.txt"); !strings.Contains(placeholders, "=== COMMENT ===\n"+filepath.Join(dir, "main.go")+":3:") {
+		t.Errorf("Unexpected placeholders report:\n%s", placeholders)
+	}
+}
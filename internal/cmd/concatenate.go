@@ -11,6 +11,12 @@ var (
 	addLineNumbers  bool
 	addHeaders      bool
 	outputFile      string
+	maxTokens       int
+	maxBytes        int64
+	rank            string
+	priority        []string
+	shards          int
+	shardSize       int64
 )
 
 var concatenateCmd = &cobra.Command{
@@ -26,6 +32,12 @@ func init() {
 	concatenateCmd.Flags().BoolVar(&addLineNumbers, "add-line-numbers", false, "Add line numbers to each line")
 	concatenateCmd.Flags().BoolVar(&addHeaders, "add-headers", false, "Add file headers to separate scripts")
 	concatenateCmd.Flags().StringVarP(&outputFile, "output", "o", "", "Output file (if not specified, output to console)")
+	concatenateCmd.Flags().IntVar(&maxTokens, "max-tokens", 0, "Stop adding files once the output reaches this many estimated tokens")
+	concatenateCmd.Flags().Int64Var(&maxBytes, "max-bytes", 0, "Stop adding files once the output reaches this many bytes")
+	concatenateCmd.Flags().StringVar(&rank, "rank", "walk", "Order files for --max-tokens/--max-bytes (walk, recent, size, central)")
+	concatenateCmd.Flags().StringSliceVar(&priority, "priority", nil, "Glob patterns whose files are added first, in order, under a budget")
+	concatenateCmd.Flags().IntVar(&shards, "shards", 0, "Split the output into this many files plus a JSON manifest (needs --output)")
+	concatenateCmd.Flags().Int64Var(&shardSize, "shard-size", 0, "Split the output into files of about this many bytes plus a JSON manifest (needs --output)")
 }
 
 func runConcatenate(cmd *cobra.Command, args []string) error {
@@ -35,6 +47,7 @@ func runConcatenate(cmd *cobra.Command, args []string) error {
 		Exclude:        exclude,
 		Recursive:      recursive,
 		Depth:          depth,
+		NoGitignore:    noGitignore,
 		Jobs:           jobs,
 		Verbose:        verbose,
 		RemoveTests:    removeTests,
@@ -42,6 +55,14 @@ func runConcatenate(cmd *cobra.Command, args []string) error {
 		AddLineNumbers: addLineNumbers,
 		AddHeaders:     addHeaders,
 		OutputFile:     outputFile,
+		MaxTokens:      maxTokens,
+		MaxBytes:       maxBytes,
+		Rank:           rank,
+		Priority:       priority,
+		Shards:         shards,
+		ShardSize:      shardSize,
+		MaxMemory:      maxMemory,
+		Files:          changedFiles,
 	}
 
 	return concatenate.Run(config)
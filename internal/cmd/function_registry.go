@@ -11,6 +11,8 @@ var (
 	registryOnlyHeaderFiles bool
 	registryAddRelations    bool
 	registryOnlyDeadCode    bool
+	registryCallGraph       string
+	registryNoDocs          bool
 )
 
 var functionRegistryCmd = &cobra.Command{
@@ -22,11 +24,13 @@ including usage, availability (private/public), call relationships, and more.`,
 }
 
 func init() {
-	functionRegistryCmd.Flags().StringVarP(&registryOutputFile, "output", "o", "", "Output file (.md, .txt, .yaml, .json, or .csv)")
+	functionRegistryCmd.Flags().StringVarP(&registryOutputFile, "output", "o", "", "Output file (.md, .txt, .yaml, .json, .ndjson, or .csv)")
 	functionRegistryCmd.Flags().BoolVar(&registryByScript, "by-script", false, "Group functions by script/file")
 	functionRegistryCmd.Flags().BoolVar(&registryOnlyHeaderFiles, "only-header-files", false, "For C/C++: only analyze header files")
 	functionRegistryCmd.Flags().BoolVar(&registryAddRelations, "add-relations", false, "Analyze function call relationships")
 	functionRegistryCmd.Flags().BoolVar(&registryOnlyDeadCode, "only-dead-code", false, "Show only unused/dead functions")
+	functionRegistryCmd.Flags().StringVar(&registryCallGraph, "call-graph", "", "Write the resolved call graph to a file (.dot or .json)")
+	functionRegistryCmd.Flags().BoolVar(&registryNoDocs, "no-docs", false, "Leave out doc comments; Go files then parse without comments")
 }
 
 func runFunctionRegistry(cmd *cobra.Command, args []string) error {
@@ -36,6 +40,7 @@ func runFunctionRegistry(cmd *cobra.Command, args []string) error {
 		Exclude:         exclude,
 		Recursive:       recursive,
 		Depth:           depth,
+		NoGitignore:     noGitignore,
 		Jobs:            jobs,
 		Verbose:         verbose,
 		OutputFile:      registryOutputFile,
@@ -43,6 +48,13 @@ func runFunctionRegistry(cmd *cobra.Command, args []string) error {
 		OnlyHeaderFiles: registryOnlyHeaderFiles,
 		AddRelations:    registryAddRelations,
 		OnlyDeadCode:    registryOnlyDeadCode,
+		CallGraphFile:   registryCallGraph,
+		NoDocs:          registryNoDocs,
+		MaxMemory:       maxMemory,
+		Files:           changedFiles,
+	}
+	if useCache {
+		config.CacheDir = cacheDir
 	}
 
 	return registry.Run(config)
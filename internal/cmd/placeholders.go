@@ -1,19 +1,20 @@
 package cmd
 
 import (
-	"bufio"
-	"context"
+	"crypto/sha256"
 	"fmt"
-	"io/fs"
-	"os"
-	"path/filepath"
 	"regexp"
+	"sort"
 	"strings"
-	"sync"
 
 	"github.com/schollz/progressbar/v3"
 	"github.com/spf13/cobra"
-	"golang.org/x/sync/semaphore"
+	"github.com/vitruves/gop/internal/archive"
+	"github.com/vitruves/gop/internal/cache"
+	"github.com/vitruves/gop/internal/memlimit"
+	"github.com/vitruves/gop/internal/pool"
+	"github.com/vitruves/gop/internal/timings"
+	"github.com/vitruves/gop/internal/walker"
 )
 
 type Placeholder struct {
@@ -31,223 +32,255 @@ var placeholdersCmd = &cobra.Command{
 	RunE:  runPlaceholders,
 }
 
+func init() {
+	addSkipFlags(placeholdersCmd)
+}
+
 func runPlaceholders(cmd *cobra.Command, args []string) error {
 	if verbose {
 		logInfo("Starting placeholder search")
 	}
 
-	files, err := collectSourceFiles()
-	if err != nil {
-		logError(fmt.Sprintf("Failed to collect files: %v", err))
-		return err
-	}
-
-	if len(files) == 0 {
-		logWarning("No files found")
-		return nil
-	}
-
-	if verbose {
-		logInfo(fmt.Sprintf("Scanning %d files for placeholders", len(files)))
-	}
-
-	var allPlaceholders []Placeholder
-	var mu sync.Mutex
-
-	bar := progressbar.NewOptions(len(files),
+	bar := progressbar.NewOptions(-1,
 		progressbar.OptionSetDescription("Scanning for placeholders"),
 		progressbar.OptionShowCount(),
 		progressbar.OptionSetRenderBlankState(true),
 		progressbar.OptionClearOnFinish(),
 	)
 
-	sem := semaphore.NewWeighted(int64(jobs))
-	var wg sync.WaitGroup
-
-	for _, file := range files {
-		wg.Add(1)
-		go func(filePath string) {
-			defer wg.Done()
-			sem.Acquire(context.Background(), 1)
-			defer sem.Release(1)
+	endScan := timings.Phase("scan")
+	progress := pool.NewProgress(func(n int) { bar.Add(n) })
+	found := pool.NewResults[[]Placeholder](jobs)
+
+	var skips skipCounts
+	fileCache := openCache("placeholders", placeholderCacheVersion)
+	limit := memlimit.New(maxMemory)
+	files, walkErr := walker.Stream(walkerConfig(sourceExtensions))
+	admitted := memlimit.Admit(limit, files, func(file walker.File) int64 { return file.Size })
+
+	count := pool.Each(jobs, admitted, func(worker, idx int, file walker.File) {
+		defer progress.Add(1)
+		defer limit.Release(file.Size)
+		if skips.tooLarge(file) {
+			return
+		}
 
-			placeholders, err := scanFileForPlaceholders(filePath)
+		var placeholders []Placeholder
+		if !fileCache.Get(file.Path, file.Size, file.ModTime, &placeholders) {
+			skip, generated := skips.sniff(file)
+			if skip {
+				return
+			}
+			var err error
+			start := timings.Now()
+			var hash [sha256.Size]byte
+			placeholders, err = scanFileForPlaceholders(file.Path, hashFor(fileCache, &hash))
+			if timings.Enabled() {
+				timings.File(detectLanguage(file.Path), file.Size, start)
+			}
 			if err != nil {
-				logError(fmt.Sprintf("Error scanning %s: %v", filePath, err))
+				logError(fmt.Sprintf("Error scanning %s: %v", file.Path, err))
 				return
 			}
+			if !generated {
+				fileCache.Put(file.Path, file.Size, file.ModTime, hash, placeholders)
+			}
+		}
 
-			mu.Lock()
-			allPlaceholders = append(allPlaceholders, placeholders...)
-			bar.Add(1)
-			mu.Unlock()
-		}(file)
-	}
+		found.Set(worker, idx, placeholders)
+	})
 
-	wg.Wait()
+	progress.Stop()
 	bar.Finish()
+	endScan()
+
+	var allPlaceholders []Placeholder
+	for _, placeholders := range found.Ordered(count) {
+		allPlaceholders = append(allPlaceholders, placeholders...)
+	}
+	saveCache(fileCache)
+
+	if err := <-walkErr; err != nil {
+		logError(fmt.Sprintf("Failed to collect files: %v", err))
+		return err
+	}
+
+	if count == 0 {
+		logWarning("No files found")
+		return nil
+	}
+
+	if verbose {
+		logInfo(fmt.Sprintf("Scanned %d files for placeholders", count-int(skips.total())))
+	}
+	if skips.total() > 0 {
+		logInfo("Skipped files: " + skips.String())
+	}
 
 	if len(allPlaceholders) == 0 {
 		logSuccess("No placeholders found")
 		return nil
 	}
 
+	endOutput := timings.Phase("output")
 	displayPlaceholders(allPlaceholders)
+	endOutput()
 	logSuccess(fmt.Sprintf("Found %d placeholders", len(allPlaceholders)))
 
 	return nil
 }
 
-func collectSourceFiles() ([]string, error) {
-	var files []string
-	extensions := []string{".py", ".rs", ".go", ".c", ".cpp", ".cxx", ".cc", ".h", ".hpp", ".hxx", ".hh", ".js", ".ts", ".java", ".kt", ".swift", ".rb", ".php"}
+// placeholderCacheVersion must change whenever placeholderPatterns or
+// Placeholder change.
+const placeholderCacheVersion = "placeholders-2"
+
+var sourceExtensions = []string{".py", ".rs", ".go", ".c", ".cpp", ".cxx", ".cc", ".h", ".hpp", ".hxx", ".hh", ".js", ".ts", ".java", ".kt", ".swift", ".rb", ".php"}
+
+// placeholderPatterns pairs each placeholder regex with the literal keywords
+// one of which must appear, case-insensitively, on any line it can match.
+// Lines that contain none of them are never handed to the regex engine.
+var placeholderPatterns = []struct {
+	regex    *regexp.Regexp
+	ptype    string
+	keywords []string
+}{
+	{regexp.MustCompile(`(?i)#?\s*(TODO|FIXME|HACK|XXX|BUG|NOTE)(\([^)]*\))?\s*:?\s*(.+)`), "comment",
+		[]string{"todo", "fixme", "hack", "xxx", "bug", "note"}},
+	{regexp.MustCompile(`(?i)placeholder|temp|temporary|dummy|mock|stub|simple|simplification|basic|minimal|naive|hardcode|hardcoded`), "temporary",
+		[]string{"placeholder", "temp", "dummy", "mock", "stub", "simple", "simplification", "basic", "minimal", "naive", "hardcode"}},
+	{regexp.MustCompile(`\b(localhost|127\.0\.0\.1|0\.0\.0\.0)\b`), "hardcoded_host",
+		[]string{"localhost", "127.0.0.1", "0.0.0.0"}},
+	{regexp.MustCompile(`\b\d{1,3}\.\d{1,3}\.\d{1,3}\.\d{1,3}\b`), "ip_address",
+		[]string{"0.", "1.", "2.", "3.", "4.", "5.", "6.", "7.", "8.", "9."}},
+	{regexp.MustCompile(`\b(password|passwd|secret|key|token)\s*[=:]\s*["']([^"']+)["']`), "hardcoded_secret",
+		[]string{"password", "passwd", "secret", "key", "token"}},
+	{regexp.MustCompile(`\btest\w*\s*=\s*true\b`), "test_flag",
+		[]string{"test"}},
+	{regexp.MustCompile(`\bdebug\s*=\s*true\b`), "debug_flag",
+		[]string{"debug"}},
+	{regexp.MustCompile(`\b(print|console\.log|fmt\.Print|println!|cout\s*<<)\s*\(`), "debug_print",
+		[]string{"print", "console.log", "cout"}},
+	{regexp.MustCompile(`\b(exit|quit|abort)\s*\(`), "exit_call",
+		[]string{"exit", "quit", "abort"}},
+	{regexp.MustCompile(`\bthrow\s+new\s+Exception\(|panic!\(|unreachable!\(`), "exception",
+		[]string{"throw", "panic!(", "unreachable!("}},
+	{regexp.MustCompile(`(?i)\b(implement|implementation|implement this|not implemented|unimplemented|not done|incomplete)\b`), "unimplemented",
+		[]string{"implement", "not done", "incomplete"}},
+	{regexp.MustCompile(`(?i)\b(example|sample|demo|test data|fake data)\b`), "example_data",
+		[]string{"example", "sample", "demo", "test data", "fake data"}},
+	{regexp.MustCompile(`(?i)\b(quick|dirty|quick and dirty|workaround|kludge|band-aid|bandaid)\b`), "quick_fix",
+		[]string{"quick", "dirty", "workaround", "kludge", "band-aid", "bandaid"}},
+}
 
-	startDir := "."
-	if len(include) > 0 {
-		for _, path := range include {
-			matches, err := filepath.Glob(path)
-			if err != nil {
-				return nil, err
-			}
-			files = append(files, matches...)
+// placeholderKeywords maps every keyword to the bit set of the patterns in
+// placeholderPatterns that it can trigger.
+var placeholderKeywords = func() *keywordMatcher {
+	keywords := make(map[string]uint32)
+	for i, pattern := range placeholderPatterns {
+		for _, keyword := range pattern.keywords {
+			keywords[keyword] |= 1 << uint(i)
 		}
-		return files, nil
 	}
+	return newKeywordMatcher(keywords)
+}()
+
+// scanFileForPlaceholders makes one pass over the file's bytes, feeding them
+// through the keyword automaton and splitting lines as it goes. Only the
+// patterns whose keywords were seen on a line are then run against it. When
+// hash is not nil it is set to the cache hash of the bytes scanned.
+func scanFileForPlaceholders(filePath string, hash *[sha256.Size]byte) ([]Placeholder, error) {
+	content, err := archive.ReadFile(filePath)
+	if err != nil {
+		return nil, err
+	}
+	if hash != nil {
+		*hash = cache.Hash(content)
+	}
+	return scanPlaceholders(filePath, content), nil
+}
 
-	err := filepath.WalkDir(startDir, func(path string, d fs.DirEntry, err error) error {
-		if err != nil {
-			return err
+// scanPlaceholders finds the placeholders in content, read from filePath.
+func scanPlaceholders(filePath string, content []byte) []Placeholder {
+	var placeholders []Placeholder
+	lineNum := 1
+	lineStart := 0
+	state := int32(0)
+	var lineMask uint32
+
+	for i := 0; i <= len(content); i++ {
+		if i < len(content) && content[i] != '\n' {
+			var mask uint32
+			state, mask = placeholderKeywords.step(state, content[i])
+			lineMask |= mask
+			continue
 		}
-
-		if d.IsDir() {
-			if shouldExcludeDirPlaceholders(path, exclude) {
-				return filepath.SkipDir
-			}
-			if !recursive && path != startDir {
-				return filepath.SkipDir
-			}
-			if depth > 0 {
-				relPath, _ := filepath.Rel(startDir, path)
-				if strings.Count(relPath, string(filepath.Separator)) >= depth {
-					return filepath.SkipDir
-				}
-			}
-			return nil
+		if i == len(content) && lineStart == i {
+			break
 		}
 
-		if isValidSourceFile(path, extensions) && !shouldExcludeFile(path, exclude) {
-			files = append(files, path)
+		if lineMask != 0 {
+			line := strings.TrimSuffix(string(content[lineStart:i]), "\r")
+			placeholders = matchPlaceholders(placeholders, filePath, lineNum, line, lineMask)
 		}
 
-		return nil
-	})
-
-	return files, err
-}
-
-func isValidSourceFile(path string, extensions []string) bool {
-	ext := filepath.Ext(path)
-	for _, validExt := range extensions {
-		if ext == validExt {
-			return true
-		}
+		lineNum++
+		lineStart = i + 1
+		state = 0
+		lineMask = 0
 	}
-	return false
-}
 
-func shouldExcludeFile(path string, exclude []string) bool {
-	for _, excludePattern := range exclude {
-		if matched, _ := filepath.Match(excludePattern, path); matched {
-			return true
-		}
-	}
-	return false
+	return placeholders
 }
 
-func shouldExcludeDirPlaceholders(path string, exclude []string) bool {
-	excludeDirs := []string{".git", "node_modules", "__pycache__", ".pytest_cache", "target", "build", "dist", "vendor"}
-	
-	for _, excludePattern := range exclude {
-		if matched, _ := filepath.Match(excludePattern, path); matched {
-			return true
+// matchPlaceholders appends the placeholders on line in column order.
+func matchPlaceholders(placeholders []Placeholder, filePath string, lineNum int, line string, mask uint32) []Placeholder {
+	first := len(placeholders)
+	for i, pattern := range placeholderPatterns {
+		if mask&(1<<uint(i)) == 0 {
+			continue
 		}
-	}
-	
-	for _, excludeDir := range excludeDirs {
-		if strings.Contains(path, excludeDir) {
-			return true
+		matches := pattern.regex.FindAllStringIndex(line, -1)
+		for _, match := range matches {
+			placeholder := Placeholder{
+				File:    filePath,
+				Line:    lineNum,
+				Column:  match[0] + 1,
+				Content: strings.TrimSpace(line),
+				Type:    pattern.ptype,
+			}
+			placeholders = append(placeholders, placeholder)
 		}
 	}
-	
-	return false
-}
-
-func scanFileForPlaceholders(filePath string) ([]Placeholder, error) {
-	file, err := os.Open(filePath)
-	if err != nil {
-		return nil, err
+	if mask&(mask-1) != 0 {
+		onLine := placeholders[first:]
+		sort.SliceStable(onLine, func(i, j int) bool { return onLine[i].Column < onLine[j].Column })
 	}
-	defer file.Close()
+	return placeholders
+}
 
-	var placeholders []Placeholder
-	scanner := bufio.NewScanner(file)
-	lineNum := 1
+func displayPlaceholders(placeholders []Placeholder) {
+	types, typeGroups := groupPlaceholders(placeholders)
+	for _, ptype := range types {
+		fmt.Printf("\n\033[1;36m=== %s ===\033[0m\n", strings.ToUpper(ptype))
 
-	patterns := []struct {
-		regex *regexp.Regexp
-		ptype string
-	}{
-		{regexp.MustCompile(`(?i)#?\s*(TODO|FIXME|HACK|XXX|BUG|NOTE)(\([^)]*\))?\s*:?\s*(.+)`), "comment"},
-		{regexp.MustCompile(`(?i)placeholder|temp|temporary|dummy|mock|stub|simple|simplification|basic|minimal|naive|hardcode|hardcoded`), "temporary"},
-		{regexp.MustCompile(`\b(localhost|127\.0\.0\.1|0\.0\.0\.0)\b`), "hardcoded_host"},
-		{regexp.MustCompile(`\b\d{1,3}\.\d{1,3}\.\d{1,3}\.\d{1,3}\b`), "ip_address"},
-		{regexp.MustCompile(`\b(password|passwd|secret|key|token)\s*[=:]\s*["']([^"']+)["']`), "hardcoded_secret"},
-		{regexp.MustCompile(`\btest\w*\s*=\s*true\b`), "test_flag"},
-		{regexp.MustCompile(`\bdebug\s*=\s*true\b`), "debug_flag"},
-		{regexp.MustCompile(`\b(print|console\.log|fmt\.Print|println!|cout\s*<<)\s*\(`), "debug_print"},
-		{regexp.MustCompile(`\b(exit|quit|abort)\s*\(`), "exit_call"},
-		{regexp.MustCompile(`\bthrow\s+new\s+Exception\(|panic!\(|unreachable!\(`), "exception"},
-		{regexp.MustCompile(`(?i)\b(implement|implementation|implement this|not implemented|unimplemented|not done|incomplete)\b`), "unimplemented"},
-		{regexp.MustCompile(`(?i)\b(example|sample|demo|test data|fake data)\b`), "example_data"},
-		{regexp.MustCompile(`(?i)\b(quick|dirty|quick and dirty|workaround|kludge|band-aid|bandaid)\b`), "quick_fix"},
-	}
-
-	for scanner.Scan() {
-		line := scanner.Text()
-		
-		for _, pattern := range patterns {
-			matches := pattern.regex.FindAllStringIndex(line, -1)
-			for _, match := range matches {
-				placeholder := Placeholder{
-					File:    filePath,
-					Line:    lineNum,
-					Column:  match[0] + 1,
-					Content: strings.TrimSpace(line),
-					Type:    pattern.ptype,
-				}
-				placeholders = append(placeholders, placeholder)
-			}
+		for _, item := range typeGroups[ptype] {
+			fmt.Printf("\033[33m%s:%d:%d\033[0m - %s\n",
+				item.File, item.Line, item.Column, item.Content)
 		}
-		
-		lineNum++
 	}
-
-	return placeholders, scanner.Err()
 }
 
-func displayPlaceholders(placeholders []Placeholder) {
+// groupPlaceholders groups placeholders by type, keeping their file and line
+// order within each, and returns the types in alphabetical order.
+func groupPlaceholders(placeholders []Placeholder) ([]string, map[string][]Placeholder) {
 	typeGroups := make(map[string][]Placeholder)
-	
 	for _, p := range placeholders {
 		typeGroups[p.Type] = append(typeGroups[p.Type], p)
 	}
-
-	for ptype, items := range typeGroups {
-		fmt.Printf("\n\033[1;36m=== %s ===\033[0m\n", strings.ToUpper(ptype))
-		
-		for _, item := range items {
-			fmt.Printf("\033[33m%s:%d:%d\033[0m - %s\n", 
-				item.File, item.Line, item.Column, item.Content)
-		}
+	types := make([]string, 0, len(typeGroups))
+	for ptype := range typeGroups {
+		types = append(types, ptype)
 	}
-}
\ No newline at end of file
+	sort.Strings(types)
+	return types, typeGroups
+}
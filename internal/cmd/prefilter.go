@@ -0,0 +1,93 @@
+package cmd
+
+// keywordMatcher is an Aho-Corasick automaton over lower-cased ASCII
+// keywords. Each keyword carries a bit mask, and feeding bytes through the
+// automaton yields the union of the masks of every keyword that ends at the
+// current position. Bytes that occur in no keyword share one input class, so
+// the transition table stays small.
+type keywordMatcher struct {
+	classes    [256]uint8
+	numClasses int
+	next       []int32
+	masks      []uint32
+}
+
+func newKeywordMatcher(keywords map[string]uint32) *keywordMatcher {
+	m := &keywordMatcher{numClasses: 1}
+	for keyword := range keywords {
+		for i := 0; i < len(keyword); i++ {
+			c := lower(keyword[i])
+			if m.classes[c] == 0 {
+				m.classes[c] = uint8(m.numClasses)
+				m.numClasses++
+			}
+		}
+	}
+	for c := 'A'; c <= 'Z'; c++ {
+		m.classes[c] = m.classes[c+'a'-'A']
+	}
+
+	// Build the trie; -1 marks a missing edge until the failure pass fills it.
+	m.addState()
+	for keyword, mask := range keywords {
+		state := int32(0)
+		for i := 0; i < len(keyword); i++ {
+			edge := int(state)*m.numClasses + int(m.classes[lower(keyword[i])])
+			if m.next[edge] < 0 {
+				m.next[edge] = m.addState()
+			}
+			state = m.next[edge]
+		}
+		m.masks[state] |= mask
+	}
+
+	// Breadth-first failure links, folded directly into the transition table.
+	fail := make([]int32, len(m.masks))
+	var queue []int32
+	for class := 0; class < m.numClasses; class++ {
+		if child := m.next[class]; child > 0 {
+			queue = append(queue, child)
+		} else {
+			m.next[class] = 0
+		}
+	}
+	for len(queue) > 0 {
+		state := queue[0]
+		queue = queue[1:]
+		m.masks[state] |= m.masks[fail[state]]
+		for class := 0; class < m.numClasses; class++ {
+			edge := int(state)*m.numClasses + class
+			fallback := m.next[int(fail[state])*m.numClasses+class]
+			if child := m.next[edge]; child >= 0 {
+				fail[child] = fallback
+				queue = append(queue, child)
+			} else {
+				m.next[edge] = fallback
+			}
+		}
+	}
+
+	return m
+}
+
+func (m *keywordMatcher) addState() int32 {
+	for i := 0; i < m.numClasses; i++ {
+		m.next = append(m.next, -1)
+	}
+	m.masks = append(m.masks, 0)
+	return int32(len(m.masks) - 1)
+}
+
+// step advances the automaton by one input byte and returns the new state
+// together with the masks of the keywords ending there.
+func (m *keywordMatcher) step(state int32, c byte) (int32, uint32) {
+	state = m.next[int(state)*m.numClasses+int(m.classes[c])]
+	return state, m.masks[state]
+}
+
+func lower(c byte) byte {
+	if c >= 'A' && c <= 'Z' {
+		return c + 'a' - 'A'
+	}
+	return c
+}
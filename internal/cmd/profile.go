@@ -0,0 +1,91 @@
+package cmd
+
+import (
+	"fmt"
+	"os"
+	"runtime"
+	"runtime/pprof"
+	"runtime/trace"
+
+	"github.com/vitruves/gop/internal/timings"
+)
+
+var (
+	showTimings bool
+	cpuProfile  string
+	memProfile  string
+	traceFile   string
+
+	// profileFiles are the CPU profile and trace files being written.
+	profileFiles []*os.File
+)
+
+// startProfiling turns on what --timings, --cpuprofile and --trace ask
+// for. stopProfiling must run however the command ends.
+func startProfiling() error {
+	if showTimings {
+		timings.Enable()
+	}
+
+	if cpuProfile != "" {
+		file, err := os.Create(cpuProfile)
+		if err != nil {
+			return fmt.Errorf("failed to create CPU profile: %w", err)
+		}
+		profileFiles = append(profileFiles, file)
+		if err := pprof.StartCPUProfile(file); err != nil {
+			return fmt.Errorf("failed to start CPU profile: %w", err)
+		}
+	}
+
+	if traceFile != "" {
+		file, err := os.Create(traceFile)
+		if err != nil {
+			return fmt.Errorf("failed to create trace: %w", err)
+		}
+		profileFiles = append(profileFiles, file)
+		if err := trace.Start(file); err != nil {
+			return fmt.Errorf("failed to start trace: %w", err)
+		}
+	}
+	return nil
+}
+
+// stopProfiling finishes the profiles, writes the heap profile and prints
+// the timings to stderr.
+func stopProfiling() error {
+	var first error
+	keep := func(err error) {
+		if err != nil && first == nil {
+			first = err
+		}
+	}
+
+	if cpuProfile != "" {
+		pprof.StopCPUProfile()
+	}
+	if traceFile != "" {
+		trace.Stop()
+	}
+	for _, file := range profileFiles {
+		keep(file.Close())
+	}
+	profileFiles = nil
+
+	if memProfile != "" {
+		file, err := os.Create(memProfile)
+		if err != nil {
+			keep(fmt.Errorf("failed to create memory profile: %w", err))
+		} else {
+			// Collect first so the profile shows live memory at the end.
+			runtime.GC()
+			keep(pprof.WriteHeapProfile(file))
+			keep(file.Close())
+		}
+	}
+
+	if timings.Enabled() {
+		keep(timings.Report(os.Stderr))
+	}
+	return first
+}
@@ -1,21 +1,37 @@
 package cmd
 
 import (
+	"crypto/sha256"
 	"fmt"
 	"runtime"
+	"runtime/debug"
 	"time"
 
 	"github.com/spf13/cobra"
+	"github.com/vitruves/gop/internal/archive"
+	"github.com/vitruves/gop/internal/cache"
+	"github.com/vitruves/gop/internal/gitdiff"
+	"github.com/vitruves/gop/internal/walker"
 )
 
 var (
-	language  string
-	include   []string
-	exclude   []string
-	recursive bool
-	depth     int
-	jobs      int
-	verbose   bool
+	language    string
+	include     []string
+	exclude     []string
+	recursive   bool
+	depth       int
+	noGitignore bool
+	jobs        int
+	verbose     bool
+	useCache    bool
+	cacheDir    string
+	since       string
+	changed     bool
+	maxMemory   int64
+
+	// changedFiles is the candidate set from --since or --changed, or nil
+	// when the tree is walked.
+	changedFiles []string
 )
 
 var rootCmd = &cobra.Command{
@@ -23,25 +39,121 @@ var rootCmd = &cobra.Command{
 	Short: "A tool to provide utilities to help code with AI",
 	Long: `gop is a CLI tool that provides various utilities to help with AI-assisted coding.
 It can concatenate code files, create function registries, find placeholders, and generate statistics.`,
+	PersistentPreRunE: setupRun,
 }
 
 func Execute() error {
-	return rootCmd.Execute()
+	err := rootCmd.Execute()
+	if perr := stopProfiling(); err == nil {
+		err = perr
+	}
+	if aerr := archive.Release(); err == nil {
+		err = aerr
+	}
+	return err
 }
 
 func init() {
-	rootCmd.PersistentFlags().StringVarP(&language, "language", "l", "", "Programming language (python,rust,go,c,cpp)")
+	rootCmd.PersistentFlags().StringVarP(&language, "language", "l", "", "Programming language (python,rust,go,c,cpp), a comma-separated list of them, or auto for all")
 	rootCmd.PersistentFlags().StringArrayVarP(&include, "include", "i", []string{}, "Include directories or files (supports wildcards)")
 	rootCmd.PersistentFlags().StringArrayVarP(&exclude, "exclude", "e", []string{}, "Exclude directories or files")
 	rootCmd.PersistentFlags().BoolVarP(&recursive, "recursive", "R", false, "Recursively process all directories")
 	rootCmd.PersistentFlags().IntVarP(&depth, "depth", "d", -1, "Maximum depth for recursive processing")
+	rootCmd.PersistentFlags().BoolVar(&noGitignore, "no-gitignore", false, "Do not honour .gitignore files while walking")
 	rootCmd.PersistentFlags().IntVarP(&jobs, "jobs", "j", runtime.NumCPU(), "Number of CPU cores to use")
 	rootCmd.PersistentFlags().BoolVarP(&verbose, "verbose", "v", false, "Enable verbose output")
+	rootCmd.PersistentFlags().BoolVar(&useCache, "cache", false, "Reuse per-file results from previous runs")
+	rootCmd.PersistentFlags().StringVar(&cacheDir, "cache-dir", cache.DefaultDir, "Directory for the --cache files")
+	rootCmd.PersistentFlags().StringVar(&since, "since", "", "Only process files changed since this git revision, including uncommitted and untracked files")
+	rootCmd.PersistentFlags().BoolVar(&changed, "changed", false, "Only process files with uncommitted changes (same as --since HEAD)")
+	rootCmd.PersistentFlags().Int64Var(&maxMemory, "max-memory", 0, "Bound memory to about this many bytes: fewer files are read at once and kept results spill to temporary files")
+	rootCmd.PersistentFlags().BoolVar(&showTimings, "timings", false, "Report time, CPU, allocations and throughput per phase and language on stderr")
+	rootCmd.PersistentFlags().StringVar(&cpuProfile, "cpuprofile", "", "Write a CPU profile to this file")
+	rootCmd.PersistentFlags().StringVar(&memProfile, "memprofile", "", "Write a heap profile to this file when the command ends")
+	rootCmd.PersistentFlags().StringVar(&traceFile, "trace", "", "Write an execution trace to this file")
 
 	rootCmd.AddCommand(concatenateCmd)
 	rootCmd.AddCommand(functionRegistryCmd)
 	rootCmd.AddCommand(placeholdersCmd)
 	rootCmd.AddCommand(statsCmd)
+	rootCmd.AddCommand(serveCmd)
+	rootCmd.AddCommand(analyzeCmd)
+}
+
+// setupRun runs before every command, once the flags are parsed.
+func setupRun(cmd *cobra.Command, args []string) error {
+	if err := startProfiling(); err != nil {
+		return err
+	}
+	if maxMemory > 0 {
+		// The collector works harder as the heap nears the limit, instead of
+		// letting garbage grow it past.
+		debug.SetMemoryLimit(maxMemory)
+	}
+	return resolveChangedFiles(cmd, args)
+}
+
+// resolveChangedFiles asks git once for the files --since or --changed
+// selects, before any command walks the tree.
+func resolveChangedFiles(cmd *cobra.Command, args []string) error {
+	rev := since
+	if rev == "" && changed {
+		rev = "HEAD"
+	}
+	if rev == "" {
+		return nil
+	}
+
+	files, err := gitdiff.ChangedFiles(rev)
+	if err != nil {
+		return err
+	}
+	logInfo(fmt.Sprintf("%d files changed since %s", len(files), rev))
+	changedFiles = files
+	return nil
+}
+
+// walkerConfig builds the shared file discovery settings from the global
+// flags. An empty extension list accepts every file.
+func walkerConfig(extensions []string) walker.Config {
+	return walker.Config{
+		Include:     include,
+		Exclude:     exclude,
+		Recursive:   recursive,
+		Depth:       depth,
+		Jobs:        jobs,
+		NoGitignore: noGitignore,
+		Extensions:  extensions,
+		Files:       changedFiles,
+	}
+}
+
+// openCache returns the named per-file cache, or nil when --cache is off.
+func openCache(name, version string) *cache.Cache {
+	if !useCache {
+		return nil
+	}
+	return cache.Open(cacheDir, name, version)
+}
+
+// hashFor returns hash for the worker to fill when c needs content hashes,
+// and nil when there is no cache, so nothing is hashed.
+func hashFor(c *cache.Cache, hash *[sha256.Size]byte) *[sha256.Size]byte {
+	if c == nil {
+		return nil
+	}
+	return hash
+}
+
+// saveCache persists c and reports how much of the run it served.
+func saveCache(c *cache.Cache) {
+	if c == nil {
+		return
+	}
+	logInfo(fmt.Sprintf("Served %d files from cache", c.Hits()))
+	if err := c.Save(); err != nil {
+		logWarning(fmt.Sprintf("Failed to save cache: %v", err))
+	}
 }
 
 func logInfo(msg string) {
@@ -0,0 +1,420 @@
+package cmd
+
+import (
+	"encoding/json"
+	"fmt"
+	"io/fs"
+	"net"
+	"net/http"
+	"os"
+	"os/signal"
+	"path/filepath"
+	"sort"
+	"strings"
+	"sync"
+	"syscall"
+	"time"
+
+	"github.com/spf13/cobra"
+	"github.com/vitruves/gop/internal/pool"
+	"github.com/vitruves/gop/internal/registry"
+	"github.com/vitruves/gop/internal/source"
+	"github.com/vitruves/gop/internal/walker"
+	"github.com/vitruves/gop/internal/watch"
+)
+
+var (
+	serveSocket string
+	serveAddr   string
+	servePoll   bool
+)
+
+var serveCmd = &cobra.Command{
+	Use:   "serve",
+	Short: "Keep results in memory and answer queries over a socket",
+	Long: `Analyze the codebase once, keep the function registry, statistics and placeholders in memory,
+update them as files change, and answer JSON queries over a Unix socket or HTTP:
+
+  /functions?name=&file=     functions of the registry (without call relations)
+  /placeholders?file=&type=  placeholders
+  /stats                     codebase statistics
+  /status                    number of files, updates so far and when the last one was`,
+	RunE: runServe,
+}
+
+func init() {
+	serveCmd.Flags().StringVar(&serveSocket, "socket", "", "Unix socket to listen on (default serve.sock in --cache-dir)")
+	serveCmd.Flags().StringVar(&serveAddr, "addr", "", "Listen on this TCP address instead, such as 127.0.0.1:7777")
+	serveCmd.Flags().BoolVar(&servePoll, "poll", false, "Poll for changes instead of using file notifications")
+	addSkipFlags(serveCmd)
+}
+
+func runServe(cmd *cobra.Command, args []string) error {
+	index, err := newServeIndex()
+	if err != nil {
+		logError(err.Error())
+		return err
+	}
+
+	start := time.Now()
+	files := index.refresh(nil)
+	logSuccess(fmt.Sprintf("Indexed %d files in %s", files, time.Since(start).Round(time.Millisecond)))
+
+	matcher := walker.NewMatcher(exclude)
+	watcher, err := watch.New(watch.Config{
+		Roots:   serveRoots(),
+		SkipDir: func(path string) bool { return !recursive || matcher.ExcludedDir(path) },
+		Poll:    servePoll,
+	})
+	if err != nil {
+		logError(fmt.Sprintf("Failed to watch files: %v", err))
+		return err
+	}
+	defer watcher.Close()
+	if watcher.Native() {
+		index.watcher = "notify"
+	}
+
+	go func() {
+		for paths := range watcher.Changes() {
+			start := time.Now()
+			n := index.refresh(index.expand(paths))
+			if verbose {
+				logInfo(fmt.Sprintf("Updated %d files in %s", n, time.Since(start).Round(time.Microsecond)))
+			}
+		}
+	}()
+
+	listener, address, err := serveListen()
+	if err != nil {
+		logError(fmt.Sprintf("Failed to listen: %v", err))
+		return err
+	}
+	if serveAddr == "" {
+		defer os.Remove(address)
+	}
+
+	server := &http.Server{Handler: index.handler()}
+	served := make(chan error, 1)
+	go func() { served <- server.Serve(listener) }()
+	logSuccess(fmt.Sprintf("Listening on %s", address))
+
+	signals := make(chan os.Signal, 1)
+	signal.Notify(signals, os.Interrupt, syscall.SIGTERM)
+	select {
+	case <-signals:
+		server.Close()
+		return nil
+	case err := <-served:
+		logError(fmt.Sprintf("Server stopped: %v", err))
+		return err
+	}
+}
+
+// serveListen opens --addr, or else the Unix socket, replacing a socket
+// left behind by a previous run.
+func serveListen() (net.Listener, string, error) {
+	if serveAddr != "" {
+		listener, err := net.Listen("tcp", serveAddr)
+		return listener, serveAddr, err
+	}
+
+	socket := serveSocket
+	if socket == "" {
+		socket = filepath.Join(cacheDir, "serve.sock")
+	}
+	if err := os.MkdirAll(filepath.Dir(socket), 0755); err != nil {
+		return nil, "", err
+	}
+	if info, err := os.Lstat(socket); err == nil && info.Mode()&fs.ModeSocket != 0 {
+		os.Remove(socket)
+	}
+	listener, err := net.Listen("unix", socket)
+	return listener, socket, err
+}
+
+// serveRoots returns the directories to watch: the include directories, the
+// directories of included files, or the working directory.
+func serveRoots() []string {
+	if len(include) == 0 {
+		return []string{"."}
+	}
+	seen := make(map[string]bool)
+	var roots []string
+	for _, pattern := range include {
+		matches, _ := filepath.Glob(pattern)
+		for _, match := range matches {
+			if info, err := os.Stat(match); err == nil && !info.IsDir() {
+				match = filepath.Dir(match)
+			}
+			if !seen[match] {
+				seen[match] = true
+				roots = append(roots, match)
+			}
+		}
+	}
+	return roots
+}
+
+// serveIndex is what gop serve keeps in memory: the results of stats,
+// placeholders and function-registry for every file, replaced one file at
+// a time as files change.
+type serveIndex struct {
+	functions       *registry.Index
+	placeholderExts map[string]bool
+	watcher         string
+
+	mu           sync.RWMutex
+	stats        map[string]FileStats
+	placeholders map[string][]Placeholder
+	generation   int
+	updated      time.Time
+}
+
+func newServeIndex() (*serveIndex, error) {
+	functions, err := registry.NewIndex(registry.Config{Language: language})
+	if err != nil {
+		return nil, err
+	}
+	index := &serveIndex{
+		functions:       functions,
+		placeholderExts: make(map[string]bool),
+		watcher:         "poll",
+		stats:           make(map[string]FileStats),
+		placeholders:    make(map[string][]Placeholder),
+	}
+	for _, ext := range sourceExtensions {
+		index.placeholderExts[ext] = true
+	}
+	return index, nil
+}
+
+// expand turns changed paths into the files to look at again: the paths
+// themselves, every file below a changed directory, and every indexed file
+// below a directory that changed or went away.
+func (s *serveIndex) expand(paths []string) []string {
+	matcher := walker.NewMatcher(exclude)
+	candidates := make([]string, 0, len(paths))
+	var gone []string
+	for _, path := range paths {
+		candidates = append(candidates, path)
+		info, err := os.Stat(path)
+		switch {
+		case err != nil:
+			gone = append(gone, path+string(filepath.Separator))
+		case info.IsDir():
+			gone = append(gone, path+string(filepath.Separator))
+			filepath.WalkDir(path, func(file string, entry fs.DirEntry, err error) error {
+				if err != nil {
+					return nil
+				}
+				if entry.IsDir() {
+					if file != path && matcher.ExcludedDir(file) {
+						return filepath.SkipDir
+					}
+					return nil
+				}
+				candidates = append(candidates, file)
+				return nil
+			})
+		}
+	}
+
+	if len(gone) > 0 {
+		s.mu.RLock()
+		for file := range s.stats {
+			for _, prefix := range gone {
+				if strings.HasPrefix(file, prefix) {
+					candidates = append(candidates, file)
+					break
+				}
+			}
+		}
+		s.mu.RUnlock()
+	}
+	return candidates
+}
+
+// refresh analyzes again those of candidates the walk accepts and forgets
+// the rest. Nil candidates mean the whole walk. It returns the number of
+// files analyzed.
+func (s *serveIndex) refresh(candidates []string) int {
+	config := walkerConfig(nil)
+	if candidates != nil {
+		config.Files = candidates
+	}
+
+	var mu sync.Mutex
+	accepted := make(map[string]bool)
+	files, walkErr := walker.Stream(config)
+	count := pool.Each(jobs, files, func(_, _ int, file walker.File) {
+		s.analyze(file)
+		mu.Lock()
+		accepted[file.Path] = true
+		mu.Unlock()
+	})
+	if err := <-walkErr; err != nil {
+		logWarning(fmt.Sprintf("Failed to collect files: %v", err))
+	}
+
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	if candidates == nil {
+		for path := range s.stats {
+			candidates = append(candidates, path)
+		}
+	}
+	for _, path := range candidates {
+		if !accepted[path] {
+			s.forgetLocked(path)
+		}
+	}
+	s.generation++
+	s.updated = time.Now()
+	return count
+}
+
+// analyze runs every command on file and stores the results. The file is
+// read once, and not mapped since it may still be being written, so every
+// result describes the same version of it.
+func (s *serveIndex) analyze(file walker.File) {
+	var skips skipCounts
+	if skips.tooLarge(file) {
+		s.forget(file.Path)
+		return
+	}
+
+	src, err := source.Read(file.Path)
+	if err != nil {
+		if verbose {
+			logWarning(fmt.Sprintf("Error analyzing %s: %v", file.Path, err))
+		}
+		s.forget(file.Path)
+		return
+	}
+	defer src.Close()
+	content := src.Bytes()
+	if skip, _ := skips.sniffContent(content); skip {
+		s.forget(file.Path)
+		return
+	}
+
+	fileStats := statsFor(file.Path, content)
+	var placeholders []Placeholder
+	if s.placeholderExts[filepath.Ext(file.Path)] {
+		placeholders = scanPlaceholders(file.Path, content)
+	}
+	if s.functions.Accepts(file.Path) {
+		if err := s.functions.UpdateSource(file.Path, src); err != nil && verbose {
+			logWarning(fmt.Sprintf("Error parsing %s: %v", file.Path, err))
+		}
+	}
+
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	s.stats[file.Path] = fileStats
+	if len(placeholders) > 0 {
+		s.placeholders[file.Path] = placeholders
+	} else {
+		delete(s.placeholders, file.Path)
+	}
+}
+
+// forget removes every result for path.
+func (s *serveIndex) forget(path string) {
+	s.mu.Lock()
+	defer s.mu.Unlock()
+	s.forgetLocked(path)
+}
+
+// forgetLocked is forget with s.mu held.
+func (s *serveIndex) forgetLocked(path string) {
+	delete(s.stats, path)
+	delete(s.placeholders, path)
+	s.functions.Remove(path)
+}
+
+type serveStatus struct {
+	Files      int       `json:"files"`
+	Functions  int       `json:"functions"`
+	Generation int       `json:"generation"`
+	Updated    time.Time `json:"updated"`
+	Watcher    string    `json:"watcher"`
+}
+
+func (s *serveIndex) handler() http.Handler {
+	mux := http.NewServeMux()
+	mux.HandleFunc("/functions", func(w http.ResponseWriter, r *http.Request) {
+		query := r.URL.Query()
+		functions := s.functions.Functions(query.Get("name"), query.Get("file"))
+		if functions == nil {
+			functions = []registry.Function{}
+		}
+		writeServeJSON(w, functions)
+	})
+	mux.HandleFunc("/placeholders", func(w http.ResponseWriter, r *http.Request) {
+		query := r.URL.Query()
+		writeServeJSON(w, s.queryPlaceholders(query.Get("file"), query.Get("type")))
+	})
+	mux.HandleFunc("/stats", func(w http.ResponseWriter, r *http.Request) {
+		writeServeJSON(w, s.codebaseStats())
+	})
+	mux.HandleFunc("/status", func(w http.ResponseWriter, r *http.Request) {
+		s.mu.RLock()
+		status := serveStatus{Files: len(s.stats), Generation: s.generation, Updated: s.updated, Watcher: s.watcher}
+		s.mu.RUnlock()
+		status.Functions = s.functions.Summary().TotalFunctions
+		writeServeJSON(w, status)
+	})
+	return mux
+}
+
+func writeServeJSON(w http.ResponseWriter, v any) {
+	w.Header().Set("Content-Type", "application/json")
+	if err := json.NewEncoder(w).Encode(v); err != nil {
+		http.Error(w, err.Error(), http.StatusInternalServerError)
+	}
+}
+
+// sortedPaths returns the keys of m in order. s.mu must be held.
+func sortedPaths[V any](m map[string]V) []string {
+	paths := make([]string, 0, len(m))
+	for path := range m {
+		paths = append(paths, path)
+	}
+	sort.Strings(paths)
+	return paths
+}
+
+func (s *serveIndex) queryPlaceholders(file, ptype string) []Placeholder {
+	s.mu.RLock()
+	defer s.mu.RUnlock()
+	found := []Placeholder{}
+	for _, path := range sortedPaths(s.placeholders) {
+		if file != "" && path != file {
+			continue
+		}
+		for _, placeholder := range s.placeholders[path] {
+			if ptype == "" || placeholder.Type == ptype {
+				found = append(found, placeholder)
+			}
+		}
+	}
+	return found
+}
+
+func (s *serveIndex) codebaseStats() *CodebaseStats {
+	s.mu.RLock()
+	defer s.mu.RUnlock()
+	stats := &CodebaseStats{
+		LanguageStats: make(map[string]LanguageStats),
+		FileStats:     make([]FileStats, 0, len(s.stats)),
+	}
+	for _, path := range sortedPaths(s.stats) {
+		fileStats := s.stats[path]
+		stats.FileStats = append(stats.FileStats, fileStats)
+		updateStats(stats, fileStats)
+	}
+	stats.TotalFiles = len(stats.FileStats)
+	return stats
+}
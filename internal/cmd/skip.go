@@ -0,0 +1,98 @@
+package cmd
+
+import (
+	"fmt"
+	"strings"
+	"sync/atomic"
+
+	"github.com/spf13/cobra"
+	"github.com/vitruves/gop/internal/sniff"
+	"github.com/vitruves/gop/internal/walker"
+)
+
+var (
+	skipGenerated bool
+	maxFileSize   int64
+)
+
+// addSkipFlags adds the flags that decide which files skipCounts passes
+// over.
+func addSkipFlags(cmd *cobra.Command) {
+	cmd.Flags().BoolVar(&skipGenerated, "skip-generated", false, "Skip generated and minified files")
+	cmd.Flags().Int64Var(&maxFileSize, "max-file-size", 0, "Skip files larger than this many bytes")
+}
+
+// skipCounts decides which files a command skips before reading them in
+// full, and counts them for its summary. Binary files are always skipped.
+type skipCounts struct {
+	binary    atomic.Int64
+	generated atomic.Int64
+	large     atomic.Int64
+}
+
+// tooLarge reports whether file is over --max-file-size. It needs no I/O,
+// so it runs before the cache is asked.
+func (s *skipCounts) tooLarge(file walker.File) bool {
+	if maxFileSize > 0 && file.Size > maxFileSize {
+		s.large.Add(1)
+		return true
+	}
+	return false
+}
+
+// sniff reads the head of file and reports whether to skip it and, if not,
+// whether it is generated. Generated files must not be cached, since
+// whether they count depends on --skip-generated. Files that cannot be read
+// are left to the command, which reports the error.
+func (s *skipCounts) sniff(file walker.File) (skip, generated bool) {
+	kind, err := sniff.File(file.Path)
+	if err != nil {
+		return false, false
+	}
+	return s.count(kind)
+}
+
+// sniffContent is sniff for a file whose content is already read.
+func (s *skipCounts) sniffContent(content []byte) (skip, generated bool) {
+	if len(content) > sniff.HeadSize {
+		return s.count(sniff.Classify(content[:sniff.HeadSize], true))
+	}
+	return s.count(sniff.Classify(content, false))
+}
+
+func (s *skipCounts) count(kind sniff.Kind) (skip, generated bool) {
+	switch kind {
+	case sniff.Binary:
+		s.binary.Add(1)
+		return true, false
+	case sniff.Generated:
+		if skipGenerated {
+			s.generated.Add(1)
+			return true, true
+		}
+		return false, true
+	}
+	return false, false
+}
+
+func (s *skipCounts) total() int64 {
+	return s.binary.Load() + s.generated.Load() + s.large.Load()
+}
+
+// String describes the skipped files, as in "3 binary, 1 generated".
+func (s *skipCounts) String() string {
+	var parts []string
+	for _, count := range []struct {
+		n    int64
+		what string
+	}{
+		{s.binary.Load(), "binary"},
+		{s.generated.Load(), "generated"},
+		{s.large.Load(), "over --max-file-size"},
+	} {
+		if count.n > 0 {
+			parts = append(parts, fmt.Sprintf("%d %s", count.n, count.what))
+		}
+	}
+	return strings.Join(parts, ", ")
+}
@@ -1,20 +1,22 @@
 package cmd
 
 import (
-	"bufio"
-	"context"
+	"crypto/sha256"
 	"fmt"
-	"io/fs"
-	"os"
 	"path/filepath"
 	"regexp"
 	"sort"
 	"strings"
-	"sync"
 
 	"github.com/schollz/progressbar/v3"
 	"github.com/spf13/cobra"
-	"golang.org/x/sync/semaphore"
+	"github.com/vitruves/gop/internal/cache"
+	"github.com/vitruves/gop/internal/compress"
+	"github.com/vitruves/gop/internal/memlimit"
+	"github.com/vitruves/gop/internal/pool"
+	"github.com/vitruves/gop/internal/source"
+	"github.com/vitruves/gop/internal/timings"
+	"github.com/vitruves/gop/internal/walker"
 )
 
 type FileStats struct {
@@ -41,6 +43,7 @@ type CodebaseStats struct {
 	TotalClasses      int
 	TotalImports      int
 	TotalSize         int64
+	SkippedFiles      string
 	LanguageStats     map[string]LanguageStats
 	FileStats         []FileStats
 }
@@ -66,7 +69,8 @@ var statsCmd = &cobra.Command{
 }
 
 func init() {
-	statsCmd.Flags().StringVarP(&statsOutputFile, "output", "o", "", "Output file (.txt)")
+	statsCmd.Flags().StringVarP(&statsOutputFile, "output", "o", "", "Output file (.txt, or .txt.gz to compress)")
+	addSkipFlags(statsCmd)
 }
 
 func runStats(cmd *cobra.Command, args []string) error {
@@ -74,72 +78,82 @@ func runStats(cmd *cobra.Command, args []string) error {
 		logInfo("Starting codebase analysis")
 	}
 
-	files, err := collectAllFiles()
-	if err != nil {
-		logError(fmt.Sprintf("Failed to collect files: %v", err))
-		return err
-	}
-
-	if len(files) == 0 {
-		logWarning("No files found")
-		return nil
-	}
-
-	if verbose {
-		logInfo(fmt.Sprintf("Analyzing %d files", len(files)))
-	}
-
 	stats := &CodebaseStats{
 		LanguageStats: make(map[string]LanguageStats),
-		FileStats:     make([]FileStats, 0, len(files)),
 	}
 
-	bar := progressbar.NewOptions(len(files),
+	bar := progressbar.NewOptions(-1,
 		progressbar.OptionSetDescription("Analyzing files"),
 		progressbar.OptionShowCount(),
 		progressbar.OptionSetRenderBlankState(true),
 		progressbar.OptionClearOnFinish(),
 	)
 
-	sem := semaphore.NewWeighted(int64(jobs))
-	var mu sync.Mutex
-	var wg sync.WaitGroup
-
-	results := make([]FileStats, len(files))
-
-	for i, file := range files {
-		wg.Add(1)
-		go func(idx int, filePath string) {
-			defer wg.Done()
-			sem.Acquire(context.Background(), 1)
-			defer sem.Release(1)
+	endAnalyze := timings.Phase("analyze")
+	progress := pool.NewProgress(func(n int) { bar.Add(n) })
+	totals := newStatsTotals(jobs)
+	limit := memlimit.New(maxMemory)
+
+	var skips skipCounts
+	fileCache := openCache("stats", statsCacheVersion)
+	files, walkErr := walker.Stream(walkerConfig(nil))
+	admitted := memlimit.Admit(limit, files, func(file walker.File) int64 { return file.Size })
+
+	count := pool.Each(jobs, admitted, func(worker, idx int, file walker.File) {
+		defer progress.Add(1)
+		defer limit.Release(file.Size)
+		if skips.tooLarge(file) {
+			return
+		}
 
-			fileStats, err := analyzeFile(filePath)
+		var fileStats FileStats
+		if !fileCache.Get(file.Path, file.Size, file.ModTime, &fileStats) {
+			skip, generated := skips.sniff(file)
+			if skip {
+				return
+			}
+			var err error
+			start := timings.Now()
+			var hash [sha256.Size]byte
+			fileStats, err = analyzeFile(file.Path, hashFor(fileCache, &hash))
+			timings.File(fileStats.Language, file.Size, start)
 			if err != nil {
-				logError(fmt.Sprintf("Error analyzing %s: %v", filePath, err))
+				logError(fmt.Sprintf("Error analyzing %s: %v", file.Path, err))
 				return
 			}
+			if !generated {
+				fileCache.Put(file.Path, file.Size, file.ModTime, hash, fileStats)
+			}
+		}
 
-			mu.Lock()
-			results[idx] = fileStats
-			bar.Add(1)
-			mu.Unlock()
-		}(i, file)
-	}
+		totals.add(worker, idx, fileStats)
+	})
 
-	wg.Wait()
+	progress.Stop()
 	bar.Finish()
+	endAnalyze()
+	saveCache(fileCache)
 
-	for _, fileStats := range results {
-		if fileStats.File != "" {
-			stats.FileStats = append(stats.FileStats, fileStats)
-			updateStats(stats, fileStats)
-		}
+	if err := <-walkErr; err != nil {
+		logError(fmt.Sprintf("Failed to collect files: %v", err))
+		return err
+	}
+
+	if count == 0 {
+		logWarning("No files found")
+		return nil
+	}
+
+	if verbose {
+		logInfo(fmt.Sprintf("Analyzed %d files", count))
 	}
 
-	stats.TotalFiles = len(stats.FileStats)
+	totals.merge(stats)
+	stats.SkippedFiles = skips.String()
 
-	err = displayStats(stats)
+	endOutput := timings.Phase("output")
+	err := displayStats(stats)
+	endOutput()
 	if err != nil {
 		logError(fmt.Sprintf("Failed to display stats: %v", err))
 		return err
@@ -149,192 +163,111 @@ func runStats(cmd *cobra.Command, args []string) error {
 	return nil
 }
 
-func collectAllFiles() ([]string, error) {
-	var files []string
+// statsCacheVersion must change whenever statsPatterns, statsLanguages or
+// FileStats change.
+const statsCacheVersion = "stats-2"
 
-	startDir := "."
-	if len(include) > 0 {
-		for _, path := range include {
-			matches, err := filepath.Glob(path)
-			if err != nil {
-				return nil, err
-			}
-			files = append(files, matches...)
-		}
-		return files, nil
-	}
-
-	err := filepath.WalkDir(startDir, func(path string, d fs.DirEntry, err error) error {
-		if err != nil {
-			return err
-		}
-
-		if d.IsDir() {
-			if shouldExcludeDirStats(path, exclude) {
-				return filepath.SkipDir
-			}
-			if !recursive && path != startDir {
-				return filepath.SkipDir
-			}
-			if depth > 0 {
-				relPath, _ := filepath.Rel(startDir, path)
-				if strings.Count(relPath, string(filepath.Separator)) >= depth {
-					return filepath.SkipDir
-				}
-			}
-			return nil
-		}
-
-		if !shouldExcludeFileStats(path, exclude) {
-			files = append(files, path)
-		}
-
-		return nil
-	})
-
-	return files, err
-}
-
-func analyzeFile(filePath string) (FileStats, error) {
-	file, err := os.Open(filePath)
-	if err != nil {
-		return FileStats{}, err
-	}
-	defer file.Close()
-
-	fileInfo, err := file.Stat()
-	if err != nil {
-		return FileStats{}, err
-	}
-
-	stats := FileStats{
-		File:     filePath,
-		Language: detectLanguage(filePath),
-		Size:     fileInfo.Size(),
-	}
-
-	scanner := bufio.NewScanner(file)
-
-	functionRegexes := []*regexp.Regexp{
+var statsPatterns = struct {
+	functions []*regexp.Regexp
+	classes   []*regexp.Regexp
+	imports   []*regexp.Regexp
+}{
+	functions: []*regexp.Regexp{
 		regexp.MustCompile(`^\s*(def|async def)\s+\w+`),                                    // Python
 		regexp.MustCompile(`^\s*(pub\s+)?fn\s+\w+`),                                        // Rust
 		regexp.MustCompile(`^\s*func\s+\w+`),                                               // Go
 		regexp.MustCompile(`^\s*(\w+\s+)*\w+\s+\w+\s*\(.*\)\s*[{;]`),                       // C/C++
 		regexp.MustCompile(`^\s*(public|private|protected)?\s*(static\s+)?\w+\s+\w+\s*\(`), // Java/C#
-	}
+	},
 
-	classRegexes := []*regexp.Regexp{
+	classes: []*regexp.Regexp{
 		regexp.MustCompile(`^\s*class\s+\w+`),           // Python, C++, Java, C#
 		regexp.MustCompile(`^\s*(pub\s+)?struct\s+\w+`), // Rust
 		regexp.MustCompile(`^\s*type\s+\w+\s+struct`),   // Go
-	}
+	},
 
-	importRegexes := []*regexp.Regexp{
+	imports: []*regexp.Regexp{
 		regexp.MustCompile(`^\s*(import|from\s+\w+\s+import)`), // Python
 		regexp.MustCompile(`^\s*use\s+`),                       // Rust
 		regexp.MustCompile(`^\s*import\s+`),                    // Go, Java
 		regexp.MustCompile(`^\s*#include\s+`),                  // C/C++
 		regexp.MustCompile(`^\s*using\s+`),                     // C#
-	}
-
-	for scanner.Scan() {
-		line := scanner.Text()
-		trimmed := strings.TrimSpace(line)
-
-		stats.Lines++
-
-		if trimmed == "" {
-			stats.BlankLines++
-		} else if isCommentLine(trimmed, stats.Language) {
-			stats.CommentLines++
-		} else {
-			stats.CodeLines++
-		}
+	},
+}
 
-		for _, regex := range functionRegexes {
-			if regex.MatchString(line) {
-				stats.Functions++
-				break
-			}
-		}
+// analyzeFile reads filePath once and computes its FileStats and, when hash
+// is not nil, the cache hash of the same bytes.
+func analyzeFile(filePath string, hash *[sha256.Size]byte) (FileStats, error) {
+	src, err := source.Open(filePath)
+	if err != nil {
+		return FileStats{}, err
+	}
+	defer src.Close()
 
-		for _, regex := range classRegexes {
-			if regex.MatchString(line) {
-				stats.Classes++
-				break
-			}
+	var stats FileStats
+	err = source.Protect(func() {
+		stats = statsFor(filePath, src.Bytes())
+		if hash != nil {
+			*hash = cache.Hash(src.Bytes())
 		}
+	})
+	return stats, err
+}
 
-		for _, regex := range importRegexes {
-			if regex.MatchString(line) {
-				stats.Imports++
-				break
-			}
-		}
+// statsFor computes the FileStats of content, read from filePath.
+func statsFor(filePath string, content []byte) FileStats {
+	stats := FileStats{
+		File:     filePath,
+		Language: detectLanguage(filePath),
+		Size:     int64(len(content)),
 	}
+	countLines(&stats, content, statsLanguageFor(stats.Language))
+	return stats
+}
 
-	return stats, scanner.Err()
+// languageMap maps file extensions to the names detectLanguage returns.
+var languageMap = map[string]string{
+	".py":    "Python",
+	".rs":    "Rust",
+	".go":    "Go",
+	".c":     "C",
+	".h":     "C",
+	".cpp":   "C++",
+	".cxx":   "C++",
+	".cc":    "C++",
+	".hpp":   "C++",
+	".hxx":   "C++",
+	".hh":    "C++",
+	".js":    "JavaScript",
+	".ts":    "TypeScript",
+	".java":  "Java",
+	".kt":    "Kotlin",
+	".swift": "Swift",
+	".rb":    "Ruby",
+	".php":   "PHP",
+	".cs":    "C#",
+	".sh":    "Shell",
+	".ps1":   "PowerShell",
+	".sql":   "SQL",
+	".xml":   "XML",
+	".html":  "HTML",
+	".css":   "CSS",
+	".json":  "JSON",
+	".yaml":  "YAML",
+	".yml":   "YAML",
+	".toml":  "TOML",
+	".md":    "Markdown",
+	".txt":   "Text",
 }
 
 func detectLanguage(filePath string) string {
-	ext := filepath.Ext(filePath)
-
-	languageMap := map[string]string{
-		".py":    "Python",
-		".rs":    "Rust",
-		".go":    "Go",
-		".c":     "C",
-		".h":     "C",
-		".cpp":   "C++",
-		".cxx":   "C++",
-		".cc":    "C++",
-		".hpp":   "C++",
-		".hxx":   "C++",
-		".hh":    "C++",
-		".js":    "JavaScript",
-		".ts":    "TypeScript",
-		".java":  "Java",
-		".kt":    "Kotlin",
-		".swift": "Swift",
-		".rb":    "Ruby",
-		".php":   "PHP",
-		".cs":    "C#",
-		".sh":    "Shell",
-		".ps1":   "PowerShell",
-		".sql":   "SQL",
-		".xml":   "XML",
-		".html":  "HTML",
-		".css":   "CSS",
-		".json":  "JSON",
-		".yaml":  "YAML",
-		".yml":   "YAML",
-		".toml":  "TOML",
-		".md":    "Markdown",
-		".txt":   "Text",
-	}
-
-	if lang, exists := languageMap[ext]; exists {
+	if lang, exists := languageMap[filepath.Ext(filePath)]; exists {
 		return lang
 	}
 
 	return "Unknown"
 }
 
-func isCommentLine(line, language string) bool {
-	switch language {
-	case "Python", "Ruby", "Shell":
-		return strings.HasPrefix(line, "#")
-	case "Rust", "Go", "C", "C++", "JavaScript", "TypeScript", "Java", "Kotlin", "Swift", "C#":
-		return strings.HasPrefix(line, "//") || strings.HasPrefix(line, "/*")
-	case "SQL":
-		return strings.HasPrefix(line, "--")
-	case "HTML", "XML":
-		return strings.HasPrefix(line, "<!--")
-	default:
-		return strings.HasPrefix(line, "#") || strings.HasPrefix(line, "//")
-	}
-}
-
 func updateStats(stats *CodebaseStats, fileStats FileStats) {
 	stats.TotalLines += fileStats.Lines
 	stats.TotalCodeLines += fileStats.CodeLines
@@ -355,11 +288,113 @@ func updateStats(stats *CodebaseStats, fileStats FileStats) {
 	stats.LanguageStats[fileStats.Language] = langStats
 }
 
+// topFiles is how many of the longest files the report lists.
+const topFiles = 10
+
+// statsTotals sums FileStats as the workers produce them instead of keeping
+// one per file. Each worker keeps its own sums, which do not depend on the
+// order files come in, and its topFiles longest files with their walk
+// position, which is all the report needs of them.
+type statsTotals struct {
+	workers []statsPart
+}
+
+type statsPart struct {
+	stats CodebaseStats
+	top   []rankedFile
+}
+
+type rankedFile struct {
+	index int
+	stats FileStats
+}
+
+func newStatsTotals(jobs int) *statsTotals {
+	if jobs < 1 {
+		jobs = 1
+	}
+	t := &statsTotals{workers: make([]statsPart, jobs)}
+	for i := range t.workers {
+		t.workers[i].stats.LanguageStats = make(map[string]LanguageStats)
+	}
+	return t
+}
+
+// longer orders files by lines, then by walk position.
+func (f rankedFile) longer(other rankedFile) bool {
+	if f.stats.Lines != other.stats.Lines {
+		return f.stats.Lines > other.stats.Lines
+	}
+	return f.index < other.index
+}
+
+// add counts fileStats for the file at walk position index. It must only be
+// called from the worker it names; files that were not analyzed have an
+// empty File and are left out.
+func (t *statsTotals) add(worker, index int, fileStats FileStats) {
+	if fileStats.File == "" {
+		return
+	}
+	part := &t.workers[worker]
+	part.stats.TotalFiles++
+	updateStats(&part.stats, fileStats)
+
+	file := rankedFile{index: index, stats: fileStats}
+	if len(part.top) == topFiles && !file.longer(part.top[topFiles-1]) {
+		return
+	}
+	i := sort.Search(len(part.top), func(i int) bool { return file.longer(part.top[i]) })
+	if len(part.top) < topFiles {
+		part.top = append(part.top, rankedFile{})
+	}
+	copy(part.top[i+1:], part.top[i:])
+	part.top[i] = file
+}
+
+// merge adds the workers' sums to stats and sets its FileStats to the
+// longest files in walk order, which formatStats ranks as it would the
+// whole list.
+func (t *statsTotals) merge(stats *CodebaseStats) {
+	var top []rankedFile
+	for _, part := range t.workers {
+		stats.TotalFiles += part.stats.TotalFiles
+		stats.TotalLines += part.stats.TotalLines
+		stats.TotalCodeLines += part.stats.TotalCodeLines
+		stats.TotalCommentLines += part.stats.TotalCommentLines
+		stats.TotalBlankLines += part.stats.TotalBlankLines
+		stats.TotalFunctions += part.stats.TotalFunctions
+		stats.TotalClasses += part.stats.TotalClasses
+		stats.TotalImports += part.stats.TotalImports
+		stats.TotalSize += part.stats.TotalSize
+		for lang, ls := range part.stats.LanguageStats {
+			sum := stats.LanguageStats[lang]
+			sum.Files += ls.Files
+			sum.Lines += ls.Lines
+			sum.CodeLines += ls.CodeLines
+			sum.CommentLines += ls.CommentLines
+			sum.Functions += ls.Functions
+			sum.Classes += ls.Classes
+			stats.LanguageStats[lang] = sum
+		}
+		top = append(top, part.top...)
+	}
+
+	sort.Slice(top, func(i, j int) bool { return top[i].longer(top[j]) })
+	if len(top) > topFiles {
+		top = top[:topFiles]
+	}
+	sort.Slice(top, func(i, j int) bool { return top[i].index < top[j].index })
+	stats.FileStats = make([]FileStats, len(top))
+	for i, file := range top {
+		stats.FileStats[i] = file.stats
+	}
+}
+
 func displayStats(stats *CodebaseStats) error {
 	output := formatStats(stats)
 
 	if statsOutputFile != "" {
-		return os.WriteFile(statsOutputFile, []byte(output), 0644)
+		return compress.WriteFile(statsOutputFile, []byte(output))
 	} else {
 		fmt.Print(output)
 		return nil
@@ -373,6 +408,9 @@ func formatStats(stats *CodebaseStats) string {
 
 	sb.WriteString("## Overall Summary\n")
 	sb.WriteString(fmt.Sprintf("- **Total Files**: %d\n", stats.TotalFiles))
+	if stats.SkippedFiles != "" {
+		sb.WriteString(fmt.Sprintf("- **Skipped Files**: %s\n", stats.SkippedFiles))
+	}
 	sb.WriteString(fmt.Sprintf("- **Total Lines**: %d\n", stats.TotalLines))
 	sb.WriteString(fmt.Sprintf("- **Code Lines**: %d (%.1f%%)\n", stats.TotalCodeLines, percentage(stats.TotalCodeLines, stats.TotalLines)))
 	sb.WriteString(fmt.Sprintf("- **Comment Lines**: %d (%.1f%%)\n", stats.TotalCommentLines, percentage(stats.TotalCommentLines, stats.TotalLines)))
@@ -395,8 +433,12 @@ func formatStats(stats *CodebaseStats) string {
 		langStats = append(langStats, langStat{lang, stat})
 	}
 
+	// Map order is random; languages with as many lines go by name.
 	sort.Slice(langStats, func(i, j int) bool {
-		return langStats[i].stats.Lines > langStats[j].stats.Lines
+		if langStats[i].stats.Lines != langStats[j].stats.Lines {
+			return langStats[i].stats.Lines > langStats[j].stats.Lines
+		}
+		return langStats[i].lang < langStats[j].lang
 	})
 
 	for _, ls := range langStats {
@@ -412,11 +454,12 @@ func formatStats(stats *CodebaseStats) string {
 
 	sb.WriteString("## Top Files by Size\n")
 
-	sort.Slice(stats.FileStats, func(i, j int) bool {
+	// Files of equal size stay in walk order.
+	sort.SliceStable(stats.FileStats, func(i, j int) bool {
 		return stats.FileStats[i].Lines > stats.FileStats[j].Lines
 	})
 
-	maxFiles := 10
+	maxFiles := topFiles
 	if len(stats.FileStats) < maxFiles {
 		maxFiles = len(stats.FileStats)
 	}
@@ -436,30 +479,3 @@ func percentage(part, total int) float64 {
 	}
 	return float64(part) / float64(total) * 100
 }
-
-func shouldExcludeDirStats(path string, exclude []string) bool {
-	excludeDirs := []string{".git", "node_modules", "__pycache__", ".pytest_cache", "target", "build", "dist", "vendor"}
-	
-	for _, excludePattern := range exclude {
-		if matched, _ := filepath.Match(excludePattern, path); matched {
-			return true
-		}
-	}
-	
-	for _, excludeDir := range excludeDirs {
-		if strings.Contains(path, excludeDir) {
-			return true
-		}
-	}
-	
-	return false
-}
-
-func shouldExcludeFileStats(path string, exclude []string) bool {
-	for _, excludePattern := range exclude {
-		if matched, _ := filepath.Match(excludePattern, path); matched {
-			return true
-		}
-	}
-	return false
-}
@@ -0,0 +1,338 @@
+package cmd
+
+import (
+	"bytes"
+	"regexp"
+	"unicode"
+	"unicode/utf8"
+)
+
+// lineDetector reports whether a line, starting at its first non-blank
+// byte, declares what it looks for.
+type lineDetector func(line []byte) bool
+
+// statsLanguage is what analyzeFile needs to know about one language: the
+// prefixes that start a comment line and the detectors for function, class
+// and import lines. Only these run on the language's files.
+type statsLanguage struct {
+	comments  [][]byte
+	functions []lineDetector
+	classes   []lineDetector
+	imports   []lineDetector
+}
+
+var (
+	hashComment  = [][]byte{[]byte("#")}
+	slashComment = [][]byte{[]byte("//"), []byte("/*")}
+)
+
+// statsLanguages maps detectLanguage names to their detectors. Languages
+// without an entry use defaultStatsLanguage.
+var statsLanguages = map[string]*statsLanguage{
+	"Python": {
+		comments:  hashComment,
+		functions: []lineDetector{pythonFunction},
+		classes:   []lineDetector{keywordName("class")},
+		imports:   []lineDetector{pythonImport},
+	},
+	"Rust": {
+		comments:  slashComment,
+		functions: []lineDetector{optionalPub("fn")},
+		classes:   []lineDetector{optionalPub("struct")},
+		imports:   []lineDetector{keywordSpace("use")},
+	},
+	"Go": {
+		comments:  slashComment,
+		functions: []lineDetector{keywordName("func")},
+		classes:   []lineDetector{goStruct},
+		imports:   []lineDetector{keywordSpace("import")},
+	},
+	"C": {
+		comments:  slashComment,
+		functions: []lineDetector{cFunction},
+		classes:   []lineDetector{keywordName("struct")},
+		imports:   []lineDetector{keywordSpace("#include")},
+	},
+	"C++": {
+		comments:  slashComment,
+		functions: []lineDetector{cFunction},
+		classes:   []lineDetector{keywordName("class"), keywordName("struct")},
+		imports:   []lineDetector{keywordSpace("#include"), keywordSpace("using")},
+	},
+	"Java": {
+		comments:  slashComment,
+		functions: []lineDetector{regexDetector(statsPatterns.functions[4])},
+		classes:   []lineDetector{keywordName("class")},
+		imports:   []lineDetector{keywordSpace("import")},
+	},
+	"C#": {
+		comments:  slashComment,
+		functions: []lineDetector{regexDetector(statsPatterns.functions[4])},
+		classes:   []lineDetector{keywordName("class")},
+		imports:   []lineDetector{keywordSpace("using")},
+	},
+}
+
+// defaultStatsLanguage runs every pattern of statsPatterns, for languages
+// that have no detectors of their own.
+var defaultStatsLanguage = func() *statsLanguage {
+	regexes := func(patterns []*regexp.Regexp) []lineDetector {
+		detectors := make([]lineDetector, len(patterns))
+		for i, pattern := range patterns {
+			detectors[i] = regexDetector(pattern)
+		}
+		return detectors
+	}
+	return &statsLanguage{
+		functions: regexes(statsPatterns.functions),
+		classes:   regexes(statsPatterns.classes),
+		imports:   regexes(statsPatterns.imports),
+	}
+}()
+
+// statsLanguageFor returns the detectors of language and the prefixes that
+// start its comment lines.
+func statsLanguageFor(language string) *statsLanguage {
+	if lang, ok := statsLanguages[language]; ok {
+		return lang
+	}
+	lang := *defaultStatsLanguage
+	switch language {
+	case "Ruby", "Shell":
+		lang.comments = hashComment
+	case "JavaScript", "TypeScript", "Kotlin", "Swift":
+		lang.comments = slashComment
+	case "SQL":
+		lang.comments = [][]byte{[]byte("--")}
+	case "HTML", "XML":
+		lang.comments = [][]byte{[]byte("<!--")}
+	default:
+		lang.comments = [][]byte{[]byte("#"), []byte("//")}
+	}
+	return &lang
+}
+
+// countLines classifies every line of content as blank, comment or code and
+// counts the declarations the language's detectors find on code lines.
+// Lines are split with bytes.IndexByte, which scans a vector at a time, and
+// a line is only looked at up to its first non-blank byte unless it is
+// code. There is no limit on line length.
+func countLines(stats *FileStats, content []byte, lang *statsLanguage) {
+	for len(content) > 0 {
+		line := content
+		if i := bytes.IndexByte(content, '\n'); i >= 0 {
+			line, content = content[:i], content[i+1:]
+		} else {
+			content = nil
+		}
+		stats.Lines++
+
+		start := firstNonBlank(line)
+		if start == len(line) {
+			stats.BlankLines++
+			continue
+		}
+		line = line[start:]
+		if hasAnyBytePrefix(line, lang.comments) {
+			stats.CommentLines++
+			continue
+		}
+		stats.CodeLines++
+
+		if detectAny(lang.functions, line) {
+			stats.Functions++
+		}
+		if detectAny(lang.classes, line) {
+			stats.Classes++
+		}
+		if detectAny(lang.imports, line) {
+			stats.Imports++
+		}
+	}
+}
+
+// firstNonBlank returns the offset of the first byte of line that is not
+// white space as strings.TrimSpace sees it, or len(line).
+func firstNonBlank(line []byte) int {
+	for i := 0; i < len(line); {
+		c := line[i]
+		if c < utf8.RuneSelf {
+			if c != ' ' && c != '\t' && c != '\r' && c != '\v' && c != '\f' {
+				return i
+			}
+			i++
+			continue
+		}
+		r, size := utf8.DecodeRune(line[i:])
+		if !unicode.IsSpace(r) {
+			return i
+		}
+		i += size
+	}
+	return len(line)
+}
+
+func hasAnyBytePrefix(line []byte, prefixes [][]byte) bool {
+	for _, prefix := range prefixes {
+		if bytes.HasPrefix(line, prefix) {
+			return true
+		}
+	}
+	return false
+}
+
+func detectAny(detectors []lineDetector, line []byte) bool {
+	for _, detect := range detectors {
+		if detect(line) {
+			return true
+		}
+	}
+	return false
+}
+
+func regexDetector(pattern *regexp.Regexp) lineDetector {
+	return pattern.Match
+}
+
+func isSpaceByte(c byte) bool {
+	return c == ' ' || c == '\t' || c == '\r' || c == '\f'
+}
+
+func isWordChar(c byte) bool {
+	return c == '_' || c >= '0' && c <= '9' || c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z'
+}
+
+// afterKeyword returns what follows keyword and at least one space at the
+// start of line.
+func afterKeyword(line []byte, keyword string) ([]byte, bool) {
+	if len(line) <= len(keyword) || string(line[:len(keyword)]) != keyword || !isSpaceByte(line[len(keyword)]) {
+		return nil, false
+	}
+	rest := line[len(keyword)+1:]
+	for len(rest) > 0 && isSpaceByte(rest[0]) {
+		rest = rest[1:]
+	}
+	return rest, true
+}
+
+// keywordSpace matches keyword followed by white space.
+func keywordSpace(keyword string) lineDetector {
+	return func(line []byte) bool {
+		_, ok := afterKeyword(line, keyword)
+		return ok
+	}
+}
+
+// keywordName matches keyword followed by white space and a name.
+func keywordName(keyword string) lineDetector {
+	return func(line []byte) bool {
+		rest, ok := afterKeyword(line, keyword)
+		return ok && len(rest) > 0 && isWordChar(rest[0])
+	}
+}
+
+// optionalPub matches keyword and a name, optionally after "pub".
+func optionalPub(keyword string) lineDetector {
+	named := keywordName(keyword)
+	return func(line []byte) bool {
+		if rest, ok := afterKeyword(line, "pub"); ok {
+			line = rest
+		}
+		return named(line)
+	}
+}
+
+var pythonDef = keywordName("def")
+
+func pythonFunction(line []byte) bool {
+	if bytes.HasPrefix(line, []byte("async def")) {
+		line = line[len("async "):]
+	}
+	return pythonDef(line)
+}
+
+// pythonImport matches "import..." and "from module import".
+func pythonImport(line []byte) bool {
+	if bytes.HasPrefix(line, []byte("import")) {
+		return true
+	}
+	rest, ok := afterKeyword(line, "from")
+	if !ok {
+		return false
+	}
+	n := 0
+	for n < len(rest) && isWordChar(rest[n]) {
+		n++
+	}
+	if n == 0 || n == len(rest) || !isSpaceByte(rest[n]) {
+		return false
+	}
+	for n < len(rest) && isSpaceByte(rest[n]) {
+		n++
+	}
+	return bytes.HasPrefix(rest[n:], []byte("import"))
+}
+
+// goStruct matches "type Name struct".
+func goStruct(line []byte) bool {
+	rest, ok := afterKeyword(line, "type")
+	if !ok {
+		return false
+	}
+	n := 0
+	for n < len(rest) && isWordChar(rest[n]) {
+		n++
+	}
+	if n == 0 || n == len(rest) || !isSpaceByte(rest[n]) {
+		return false
+	}
+	return bytes.HasPrefix(bytes.TrimLeft(rest[n:], " \t\r\f"), []byte("struct"))
+}
+
+// cFunction matches what looks like a C function declaration or header: two
+// or more names separated by white space, the last one followed by a
+// parenthesised list and then "{" or ";", as in "static int add(int a) {".
+func cFunction(line []byte) bool {
+	words := 0
+	i := 0
+	for {
+		start := i
+		for i < len(line) && isWordChar(line[i]) {
+			i++
+		}
+		if i == start {
+			return false
+		}
+		words++
+
+		spaced := i
+		for i < len(line) && isSpaceByte(line[i]) {
+			i++
+		}
+		if i < len(line) && line[i] == '(' && words >= 2 {
+			return closesWithBrace(line[i+1:])
+		}
+		if i == spaced {
+			return false
+		}
+	}
+}
+
+// closesWithBrace reports whether some ")" in rest is followed, after white
+// space, by "{" or ";".
+func closesWithBrace(rest []byte) bool {
+	for {
+		i := bytes.IndexByte(rest, ')')
+		if i < 0 {
+			return false
+		}
+		rest = rest[i+1:]
+		j := 0
+		for j < len(rest) && isSpaceByte(rest[j]) {
+			j++
+		}
+		if j < len(rest) && (rest[j] == '{' || rest[j] == ';') {
+			return true
+		}
+	}
+}
@@ -0,0 +1,244 @@
+// Package compress writes output files compressed by their extension:
+// names ending in .gz are written as gzip, compressed in parallel blocks.
+// Every other name is written as is.
+package compress
+
+import (
+	"bytes"
+	"compress/gzip"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"runtime"
+	"strings"
+	"sync"
+)
+
+// BlockSize is how much input each gzip member holds. Members are
+// compressed independently, so larger blocks compress slightly better and
+// smaller ones spread across cores sooner.
+const BlockSize = 1 << 20
+
+// Trim returns path without the extension that selects compression, so
+// the format of out.json.gz is read from out.json.
+func Trim(path string) string {
+	switch filepath.Ext(path) {
+	case ".gz", ".zst":
+		return strings.TrimSuffix(path, filepath.Ext(path))
+	}
+	return path
+}
+
+// Create creates path and returns a writer that compresses into it as its
+// extension asks. Closing the writer flushes the compressor and closes the
+// file.
+func Create(path string) (io.WriteCloser, error) {
+	ext := filepath.Ext(path)
+	if ext == ".zst" {
+		return nil, fmt.Errorf("%s: zstd output is not supported, use .gz", path)
+	}
+	file, err := os.Create(path)
+	if err != nil {
+		return nil, err
+	}
+	if ext != ".gz" {
+		return file, nil
+	}
+	return &closeBoth{WriteCloser: NewGzipWriter(file, runtime.GOMAXPROCS(0)), file: file}, nil
+}
+
+// Lazy is a file that is only created, through Create, on its first write,
+// so a run that produces no output leaves no empty file behind.
+type Lazy struct {
+	Path string
+	file io.WriteCloser
+}
+
+func (f *Lazy) Write(p []byte) (int, error) {
+	if err := f.Create(); err != nil {
+		return 0, err
+	}
+	return f.file.Write(p)
+}
+
+// Create creates the file now, empty if nothing was written, so that a
+// run with no output still replaces what an earlier run left at Path.
+func (f *Lazy) Create() error {
+	if f.file != nil {
+		return nil
+	}
+	file, err := Create(f.Path)
+	if err != nil {
+		return err
+	}
+	f.file = file
+	return nil
+}
+
+// Close closes the file if it was created. Closing again does nothing.
+func (f *Lazy) Close() error {
+	if f.file == nil {
+		return nil
+	}
+	err := f.file.Close()
+	f.file = nil
+	return err
+}
+
+// WriteFile is os.WriteFile through Create.
+func WriteFile(path string, data []byte) error {
+	w, err := Create(path)
+	if err != nil {
+		return err
+	}
+	_, err = w.Write(data)
+	if cerr := w.Close(); err == nil {
+		err = cerr
+	}
+	return err
+}
+
+type closeBoth struct {
+	io.WriteCloser
+	file   *os.File
+	closed bool
+}
+
+func (c *closeBoth) Close() error {
+	if c.closed {
+		return nil
+	}
+	c.closed = true
+	err := c.WriteCloser.Close()
+	if cerr := c.file.Close(); err == nil {
+		err = cerr
+	}
+	return err
+}
+
+// gzipWriter cuts its input into blocks, compresses each into a gzip member
+// of its own on up to jobs goroutines, and writes the members out in input
+// order. Concatenated members are a valid gzip stream, which gzip -d and
+// compress/gzip read back as the whole input.
+type gzipWriter struct {
+	out     io.Writer
+	buf     []byte
+	pending chan *gzipBlock
+	done    chan struct{}
+	wrote   bool
+	closed  bool
+
+	mu  sync.Mutex
+	err error
+}
+
+type gzipBlock struct {
+	data  []byte
+	out   bytes.Buffer
+	ready chan struct{}
+	err   error
+}
+
+var (
+	blockPool = sync.Pool{New: func() any { return make([]byte, 0, BlockSize) }}
+	gzipPool  = sync.Pool{New: func() any { return gzip.NewWriter(io.Discard) }}
+)
+
+// NewGzipWriter returns a writer that gzips into w on jobs goroutines. At
+// most twice jobs blocks are held in memory at once.
+func NewGzipWriter(w io.Writer, jobs int) io.WriteCloser {
+	if jobs < 1 {
+		jobs = 1
+	}
+	g := &gzipWriter{
+		out:     w,
+		buf:     blockPool.Get().([]byte),
+		pending: make(chan *gzipBlock, 2*jobs),
+		done:    make(chan struct{}),
+	}
+	go g.drain()
+	return g
+}
+
+func (g *gzipWriter) Write(p []byte) (int, error) {
+	if err := g.failed(); err != nil {
+		return 0, err
+	}
+	n := len(p)
+	for len(p) > 0 {
+		room := BlockSize - len(g.buf)
+		if room > len(p) {
+			room = len(p)
+		}
+		g.buf = append(g.buf, p[:room]...)
+		p = p[room:]
+		if len(g.buf) == BlockSize {
+			g.submit()
+		}
+	}
+	return n, nil
+}
+
+// Close compresses what is left and waits until every member is written.
+// Empty input still makes one empty member, so the file is valid gzip.
+// Closing again only reports the first error.
+func (g *gzipWriter) Close() error {
+	if g.closed {
+		return g.failed()
+	}
+	g.closed = true
+	if len(g.buf) > 0 || !g.wrote {
+		g.submit()
+	}
+	close(g.pending)
+	<-g.done
+	return g.failed()
+}
+
+func (g *gzipWriter) submit() {
+	block := &gzipBlock{data: g.buf, ready: make(chan struct{})}
+	g.buf = blockPool.Get().([]byte)[:0]
+	g.wrote = true
+	g.pending <- block
+	go block.compress()
+}
+
+func (b *gzipBlock) compress() {
+	defer close(b.ready)
+	zw := gzipPool.Get().(*gzip.Writer)
+	defer gzipPool.Put(zw)
+	zw.Reset(&b.out)
+	if _, err := zw.Write(b.data); err != nil {
+		b.err = err
+		return
+	}
+	b.err = zw.Close()
+	blockPool.Put(b.data[:0])
+	b.data = nil
+}
+
+// drain writes the members in the order they were submitted.
+func (g *gzipWriter) drain() {
+	defer close(g.done)
+	for block := range g.pending {
+		<-block.ready
+		err := block.err
+		if err == nil && g.failed() == nil {
+			_, err = g.out.Write(block.out.Bytes())
+		}
+		if err != nil {
+			g.mu.Lock()
+			if g.err == nil {
+				g.err = err
+			}
+			g.mu.Unlock()
+		}
+	}
+}
+
+func (g *gzipWriter) failed() error {
+	g.mu.Lock()
+	defer g.mu.Unlock()
+	return g.err
+}
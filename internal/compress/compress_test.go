@@ -0,0 +1,115 @@
+package compress
+
+import (
+	"bytes"
+	"compress/gzip"
+	"io"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+func gunzip(t *testing.T, data []byte) []byte {
+	t.Helper()
+	zr, err := gzip.NewReader(bytes.NewReader(data))
+	if err != nil {
+		t.Fatalf("Output is not gzip: %v", err)
+	}
+	content, err := io.ReadAll(zr)
+	if err != nil {
+		t.Fatalf("Failed to decompress: %v", err)
+	}
+	return content
+}
+
+func TestGzipWriter(t *testing.T) {
+	var input bytes.Buffer
+	for i := 0; input.Len() < 3*BlockSize+BlockSize/2; i++ {
+		input.WriteString(strings.Repeat("line ", i%17) + "\n")
+	}
+
+	for _, jobs := range []int{1, 4} {
+		var out bytes.Buffer
+		w := NewGzipWriter(&out, jobs)
+		for data := input.Bytes(); len(data) > 0; {
+			n := min(len(data), 7919)
+			if _, err := w.Write(data[:n]); err != nil {
+				t.Fatalf("Failed to write: %v", err)
+			}
+			data = data[n:]
+		}
+		if err := w.Close(); err != nil {
+			t.Fatalf("Failed to close: %v", err)
+		}
+		if got := gunzip(t, out.Bytes()); !bytes.Equal(got, input.Bytes()) {
+			t.Errorf("jobs %d: decompressed %d bytes, expected %d", jobs, len(got), input.Len())
+		}
+	}
+
+	var empty bytes.Buffer
+	w := NewGzipWriter(&empty, 2)
+	if err := w.Close(); err != nil || len(gunzip(t, empty.Bytes())) != 0 {
+		t.Errorf("Empty input should make an empty gzip stream, got %v", err)
+	}
+	if err := w.Close(); err != nil {
+		t.Errorf("Closing again should do nothing, got %v", err)
+	}
+}
+
+func TestCreate(t *testing.T) {
+	dir := t.TempDir()
+	for _, name := range []string{"out.txt", "out.json.gz"} {
+		path := filepath.Join(dir, name)
+		if err := WriteFile(path, []byte("content\n")); err != nil {
+			t.Fatalf("Failed to write %s: %v", name, err)
+		}
+		data, err := os.ReadFile(path)
+		if err != nil {
+			t.Fatalf("Failed to read %s: %v", name, err)
+		}
+		if filepath.Ext(name) == ".gz" {
+			data = gunzip(t, data)
+		}
+		if string(data) != "content\n" {
+			t.Errorf("%s: read back %q", name, data)
+		}
+	}
+
+	if _, err := Create(filepath.Join(dir, "out.txt.zst")); err == nil {
+		t.Error("zstd output should be refused")
+	}
+	if Trim("out.json.gz") != "out.json" || Trim("out.json") != "out.json" {
+		t.Error("Trim should only drop compression extensions")
+	}
+}
+
+func TestLazy(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "out.txt.gz")
+	unused := &Lazy{Path: path}
+	if err := unused.Close(); err != nil {
+		t.Fatalf("Failed to close unused file: %v", err)
+	}
+	if _, err := os.Stat(path); !os.IsNotExist(err) {
+		t.Fatal("An unused file should not be created")
+	}
+	if err := unused.Create(); err != nil || unused.Close() != nil {
+		t.Fatalf("Failed to create an empty file: %v", err)
+	}
+	if data, err := os.ReadFile(path); err != nil || len(gunzip(t, data)) != 0 {
+		t.Fatalf("Expected an empty gzip file, got %q (%v)", data, err)
+	}
+
+	file := &Lazy{Path: path}
+	file.Write([]byte("hello"))
+	if err := file.Close(); err != nil {
+		t.Fatalf("Failed to close file: %v", err)
+	}
+	if err := file.Close(); err != nil {
+		t.Errorf("Closing again should do nothing, got %v", err)
+	}
+	data, err := os.ReadFile(path)
+	if err != nil || string(gunzip(t, data)) != "hello" {
+		t.Errorf("Expected a gzipped hello, got %q (%v)", data, err)
+	}
+}
@@ -0,0 +1,227 @@
+package concatenate
+
+import (
+	"fmt"
+	"path/filepath"
+	"sort"
+	"sync"
+
+	"github.com/vitruves/gop/internal/registry"
+	"github.com/vitruves/gop/internal/walker"
+)
+
+// bytesPerToken estimates tokens from a file size before the file is read;
+// it is about what estimateTokens reports for source code.
+const bytesPerToken = 3
+
+// bytesPerLine estimates the line count of an unread file for the space
+// --add-line-numbers adds.
+const bytesPerLine = 32
+
+// budget caps the output at MaxTokens and MaxBytes. Chunks are admitted in
+// rank order across all shards, so a chunk that no longer fits is dropped
+// while smaller ones after it may still be written, and the same files are
+// dropped on every run.
+type budget struct {
+	mu        sync.Mutex
+	maxTokens int64
+	maxBytes  int64
+	tokens    int64
+	bytes     int64
+	written   int
+	dropped   int
+}
+
+// rankings are the accepted values of Config.Rank.
+var rankings = map[string]bool{"": true, "walk": true, "recent": true, "size": true, "central": true}
+
+// newBudget returns nil when the output is not capped.
+func newBudget(config Config) (*budget, error) {
+	if config.MaxTokens <= 0 && config.MaxBytes <= 0 {
+		return nil, nil
+	}
+	if !rankings[config.Rank] {
+		return nil, fmt.Errorf("unknown rank %q (walk, recent, size, central)", config.Rank)
+	}
+	return &budget{maxTokens: int64(config.MaxTokens), maxBytes: config.MaxBytes}, nil
+}
+
+func (b *budget) fits(tokens, bytes int64) bool {
+	return (b.maxTokens <= 0 || b.tokens+tokens <= b.maxTokens) &&
+		(b.maxBytes <= 0 || b.bytes+bytes <= b.maxBytes)
+}
+
+// take charges chunk against the budget if it fits and reports whether it
+// may be written.
+func (b *budget) take(chunk string) bool {
+	tokens, bytes := int64(estimateTokens(chunk)), int64(len(chunk))
+	b.mu.Lock()
+	defer b.mu.Unlock()
+	if !b.fits(tokens, bytes) {
+		b.dropped++
+		return false
+	}
+	b.tokens += tokens
+	b.bytes += bytes
+	b.written++
+	return true
+}
+
+// plan ranks files and keeps those whose estimated output fits the budget,
+// skipping any that would overflow it in favour of smaller ones further down.
+// Only the kept files are read.
+func (b *budget) plan(files []walker.File, config Config) ([]walker.File, error) {
+	if err := rankFiles(files, config); err != nil {
+		return nil, err
+	}
+
+	estimate := &budget{maxTokens: b.maxTokens, maxBytes: b.maxBytes}
+	var kept []walker.File
+	for _, file := range files {
+		bytes := estimateOutputBytes(file, config)
+		tokens := bytes / bytesPerToken
+		if estimate.fits(tokens, bytes) {
+			estimate.tokens += tokens
+			estimate.bytes += bytes
+			kept = append(kept, file)
+		}
+	}
+	return kept, nil
+}
+
+func (b *budget) String() string {
+	return fmt.Sprintf("wrote %d files (~%d tokens, %d bytes), dropped %d over budget", b.written, b.tokens, b.bytes, b.dropped)
+}
+
+// estimateOutputBytes predicts the size processFile produces for file from
+// its size alone. Removing comments or tests only makes the output smaller.
+func estimateOutputBytes(file walker.File, config Config) int64 {
+	bytes := file.Size
+	if config.AddHeaders {
+		bytes += int64(2*len(file.Path) + 24)
+	}
+	if config.AddLineNumbers {
+		bytes += 6 * (file.Size/bytesPerLine + 1)
+	}
+	return bytes
+}
+
+// estimateTokens approximates what a BPE tokenizer makes of code without
+// running one: a word costs a token per six bytes, a run of punctuation a
+// token per two bytes, and a run of whitespace one token unless it is a
+// single space merged into what follows.
+func estimateTokens(content string) int {
+	tokens := 0
+	for i := 0; i < len(content); {
+		c := content[i]
+		switch {
+		case isWordByte(c):
+			start := i
+			for i < len(content) && isWordByte(content[i]) {
+				i++
+			}
+			tokens += (i - start + 5) / 6
+		case c == ' ' || c == '\t' || c == '\n' || c == '\r':
+			start := i
+			for i < len(content) && (content[i] == ' ' || content[i] == '\t' || content[i] == '\n' || content[i] == '\r') {
+				i++
+			}
+			if i-start > 1 || c != ' ' {
+				tokens++
+			}
+		default:
+			start := i
+			for i < len(content) && !isWordByte(content[i]) && content[i] != ' ' && content[i] != '\t' && content[i] != '\n' && content[i] != '\r' {
+				i++
+			}
+			tokens += (i - start + 1) / 2
+		}
+	}
+	return tokens
+}
+
+// rankFiles orders files for a budgeted run: files matching an earlier
+// --priority glob come first, then config.Rank decides within each group.
+// The walk order breaks ties.
+func rankFiles(files []walker.File, config Config) error {
+	var key func(i int) int64
+	switch config.Rank {
+	case "", "walk":
+	case "recent":
+		key = func(i int) int64 { return -files[i].ModTime.UnixNano() }
+	case "size":
+		key = func(i int) int64 { return files[i].Size }
+	case "central":
+		// Only the files this run walked are parsed, so a run limited to
+		// changed files does not parse the whole tree to rank them.
+		paths := make([]string, len(files))
+		for i, file := range files {
+			paths[i] = file.Path
+		}
+		centrality, err := registry.FileCentrality(registry.Config{
+			Language:    config.Language,
+			Include:     config.Include,
+			Exclude:     config.Exclude,
+			Recursive:   config.Recursive,
+			Depth:       config.Depth,
+			NoGitignore: config.NoGitignore,
+			Jobs:        config.Jobs,
+			Verbose:     config.Verbose,
+			MaxMemory:   config.MaxMemory,
+			Files:       paths,
+		})
+		if err != nil {
+			return fmt.Errorf("failed to build call graph for ranking: %w", err)
+		}
+		key = func(i int) int64 { return -int64(centrality[files[i].Path]) }
+	}
+
+	type ranked struct {
+		file  walker.File
+		group int
+		key   int64
+	}
+	matchers := make([]*walker.Matcher, len(config.Priority))
+	for i, pattern := range config.Priority {
+		matchers[i] = walker.NewMatcher([]string{pattern})
+	}
+
+	order := make([]ranked, len(files))
+	for i, file := range files {
+		order[i] = ranked{file: file, group: len(matchers)}
+		for g, m := range matchers {
+			if matchesPath(m, file.Path) {
+				order[i].group = g
+				break
+			}
+		}
+		if key != nil {
+			order[i].key = key(i)
+		}
+	}
+
+	sort.SliceStable(order, func(i, j int) bool {
+		if order[i].group != order[j].group {
+			return order[i].group < order[j].group
+		}
+		return order[i].key < order[j].key
+	})
+	for i := range order {
+		files[i] = order[i].file
+	}
+	return nil
+}
+
+// matchesPath reports whether m matches path or one of its directories, so a
+// "docs/" pattern covers every file below docs.
+func matchesPath(m *walker.Matcher, path string) bool {
+	if m.Excluded(path, false) {
+		return true
+	}
+	for dir := filepath.Dir(path); dir != "." && dir != filepath.Dir(dir); dir = filepath.Dir(dir) {
+		if m.Excluded(dir, true) {
+			return true
+		}
+	}
+	return false
+}
@@ -8,6 +8,24 @@ import (
 
 type CProcessor struct{}
 
+var cPatterns = struct {
+	testFunction  *regexp.Regexp
+	testMain      *regexp.Regexp
+	assertInclude *regexp.Regexp
+	unityInclude  *regexp.Regexp
+	cunitInclude  *regexp.Regexp
+	assertMacro   *regexp.Regexp
+	testAssert    *regexp.Regexp
+}{
+	testFunction:  regexp.MustCompile(`(?s)(void|int)\s+test_\w+\s*\([^)]*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`),
+	testMain:      regexp.MustCompile(`(?s)int\s+main\s*\([^)]*\)\s*\{[^{}]*test[^{}]*\}`),
+	assertInclude: regexp.MustCompile(`(?m)^[ \t]*#include\s+<assert\.h>.*\n`),
+	unityInclude:  regexp.MustCompile(`(?m)^[ \t]*#include\s+"unity\.h".*\n`),
+	cunitInclude:  regexp.MustCompile(`(?m)^[ \t]*#include\s+<CUnit/.*\.h>.*\n`),
+	assertMacro:   regexp.MustCompile(`(?m)^[ \t]*assert\s*\(.*\)\s*;.*\n`),
+	testAssert:    regexp.MustCompile(`(?m)^[ \t]*TEST_ASSERT.*\(.*\)\s*;.*\n`),
+}
+
 func (c *CProcessor) GetExtensions() []string {
 	return []string{".c", ".h"}
 }
@@ -37,44 +55,17 @@ func (c *CProcessor) IsTestFile(path string) bool {
 }
 
 func (c *CProcessor) RemoveComments(content string) string {
-	singleLineRegex := regexp.MustCompile(`//.*$`)
-	lines := strings.Split(content, "\n")
-	var result []string
-	
-	for _, line := range lines {
-		processed := singleLineRegex.ReplaceAllString(line, "")
-		result = append(result, processed)
-	}
-	
-	content = strings.Join(result, "\n")
-	
-	multiLineRegex := regexp.MustCompile(`(?s)/\*.*?\*/`)
-	content = multiLineRegex.ReplaceAllString(content, "")
-	
-	return content
+	return stripComments(content, cSyntax)
 }
 
 func (c *CProcessor) RemoveTestCode(content string) string {
-	testFunctionRegex := regexp.MustCompile(`(?s)(void|int)\s+test_\w+\s*\([^)]*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = testFunctionRegex.ReplaceAllString(content, "")
-	
-	testMainRegex := regexp.MustCompile(`(?s)int\s+main\s*\([^)]*\)\s*\{[^{}]*test[^{}]*\}`)
-	content = testMainRegex.ReplaceAllString(content, "")
-	
-	assertIncludeRegex := regexp.MustCompile(`(?m)^[ \t]*#include\s+<assert\.h>.*\n`)
-	content = assertIncludeRegex.ReplaceAllString(content, "")
-	
-	unityIncludeRegex := regexp.MustCompile(`(?m)^[ \t]*#include\s+"unity\.h".*\n`)
-	content = unityIncludeRegex.ReplaceAllString(content, "")
-	
-	cunitIncludeRegex := regexp.MustCompile(`(?m)^[ \t]*#include\s+<CUnit/.*\.h>.*\n`)
-	content = cunitIncludeRegex.ReplaceAllString(content, "")
-	
-	assertMacroRegex := regexp.MustCompile(`(?m)^[ \t]*assert\s*\(.*\)\s*;.*\n`)
-	content = assertMacroRegex.ReplaceAllString(content, "")
-	
-	testAssertRegex := regexp.MustCompile(`(?m)^[ \t]*TEST_ASSERT.*\(.*\)\s*;.*\n`)
-	content = testAssertRegex.ReplaceAllString(content, "")
+	content = cPatterns.testFunction.ReplaceAllString(content, "")
+	content = cPatterns.testMain.ReplaceAllString(content, "")
+	content = cPatterns.assertInclude.ReplaceAllString(content, "")
+	content = cPatterns.unityInclude.ReplaceAllString(content, "")
+	content = cPatterns.cunitInclude.ReplaceAllString(content, "")
+	content = cPatterns.assertMacro.ReplaceAllString(content, "")
+	content = cPatterns.testAssert.ReplaceAllString(content, "")
 	
 	return content
 }
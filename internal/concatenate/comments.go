@@ -0,0 +1,218 @@
+package concatenate
+
+import (
+	"strings"
+	"unicode/utf8"
+)
+
+// commentSyntax describes the comment and literal forms of a C-style
+// language. Literals matter because comment markers inside them, as in
+// "http://example.com", are not comments.
+type commentSyntax struct {
+	// cppRawStrings enables R"delim(...)delim".
+	cppRawStrings bool
+	// rustRawStrings enables r"..." and r#"..."#, also with a b prefix.
+	rustRawStrings bool
+	// backquoteStrings enables Go raw strings.
+	backquoteStrings bool
+	// nestedBlocks makes /* /* */ */ a single comment, as in Rust.
+	nestedBlocks bool
+	// multilineStrings lets ordinary strings span lines, as in Rust.
+	multilineStrings bool
+}
+
+var (
+	cSyntax    = commentSyntax{}
+	cppSyntax  = commentSyntax{cppRawStrings: true}
+	goSyntax   = commentSyntax{backquoteStrings: true}
+	rustSyntax = commentSyntax{rustRawStrings: true, nestedBlocks: true, multilineStrings: true}
+	// genericSyntax covers other C-style languages, where backquotes are
+	// most likely JavaScript template strings.
+	genericSyntax = commentSyntax{backquoteStrings: true}
+)
+
+// stripComments removes // and /* */ comments in one forward pass, copying
+// the code between them into a buffer sized for the whole file. A line
+// comment leaves its newline; an unterminated block comment is kept.
+// Content without comments is returned as is.
+func stripComments(content string, syntax commentSyntax) string {
+	var out strings.Builder
+	last := 0
+
+	for i := 0; i < len(content); {
+		c := content[i]
+		switch {
+		case c == '/' && i+1 < len(content) && content[i+1] == '/':
+			end := strings.IndexByte(content[i:], '\n')
+			if end < 0 {
+				end = len(content)
+			} else {
+				end += i
+			}
+			last = cut(&out, content, last, i, end)
+			i = end
+		case c == '/' && i+1 < len(content) && content[i+1] == '*':
+			end := blockCommentEnd(content, i, syntax.nestedBlocks)
+			if end < 0 {
+				return finish(&out, content, last)
+			}
+			last = cut(&out, content, last, i, end)
+			i = end
+		default:
+			if end := literalEnd(content, i, syntax); end > i {
+				i = end
+			} else {
+				i++
+			}
+		}
+	}
+
+	return finish(&out, content, last)
+}
+
+// literalEnd returns the offset just past the string or character literal
+// starting at i, or i if none starts there.
+func literalEnd(content string, i int, syntax commentSyntax) int {
+	switch c := content[i]; {
+	case c == '"':
+		if syntax.cppRawStrings && hasPrefix(content, i, "R", "u8R", "uR", "UR", "LR") {
+			return cppRawStringEnd(content, i)
+		}
+		if syntax.rustRawStrings && hasPrefix(content, i, "r", "br") {
+			return rustRawStringEnd(content, i, 0)
+		}
+		return quotedEnd(content, i, '"', syntax.multilineStrings)
+	case c == '#' && syntax.rustRawStrings && hasPrefix(content, i, "r", "br"):
+		hashes := 0
+		for i+hashes < len(content) && content[i+hashes] == '#' {
+			hashes++
+		}
+		if i+hashes < len(content) && content[i+hashes] == '"' {
+			return rustRawStringEnd(content, i+hashes, hashes)
+		}
+	case c == '`' && syntax.backquoteStrings:
+		if end := strings.IndexByte(content[i+1:], '`'); end >= 0 {
+			return i + end + 2
+		}
+		return len(content)
+	case c == '\'':
+		return charLiteralEnd(content, i)
+	}
+	return i
+}
+
+// cut copies content[last:start] and skips the comment up to end.
+func cut(out *strings.Builder, content string, last, start, end int) int {
+	if out.Cap() == 0 {
+		out.Grow(len(content))
+	}
+	out.WriteString(content[last:start])
+	return end
+}
+
+func finish(out *strings.Builder, content string, last int) string {
+	if out.Cap() == 0 {
+		return content
+	}
+	out.WriteString(content[last:])
+	return out.String()
+}
+
+// blockCommentEnd returns the offset just past the comment opened at i, or
+// -1 if it is not closed.
+func blockCommentEnd(content string, i int, nested bool) int {
+	depth := 0
+	for j := i; j+1 < len(content); {
+		switch {
+		case content[j] == '/' && content[j+1] == '*':
+			depth++
+			j += 2
+		case content[j] == '*' && content[j+1] == '/':
+			depth--
+			j += 2
+			if depth == 0 || !nested {
+				return j
+			}
+		default:
+			j++
+		}
+		if !nested && depth > 1 {
+			depth = 1
+		}
+	}
+	return -1
+}
+
+// hasPrefix reports whether one of prefixes ends right before i and starts
+// a word, so that R"( opens a raw string but FOR"( does not.
+func hasPrefix(content string, i int, prefixes ...string) bool {
+	for _, prefix := range prefixes {
+		start := i - len(prefix)
+		if start < 0 || content[start:i] != prefix {
+			continue
+		}
+		if start == 0 || !isWordByte(content[start-1]) {
+			return true
+		}
+	}
+	return false
+}
+
+func isWordByte(c byte) bool {
+	return c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z' || c >= '0' && c <= '9' || c == '_' || c >= 0x80
+}
+
+// quotedEnd returns the offset just past the literal opened at i. Single
+// line literals end at an unescaped newline if they are not closed.
+func quotedEnd(content string, i int, quote byte, multiline bool) int {
+	for j := i + 1; j < len(content); j++ {
+		switch content[j] {
+		case '\\':
+			j++
+		case quote:
+			return j + 1
+		case '\n':
+			if !multiline {
+				return j
+			}
+		}
+	}
+	return len(content)
+}
+
+// charLiteralEnd skips a character literal. A quote that does not close
+// after one character is left alone: a Rust lifetime or a C++14 digit
+// separator.
+func charLiteralEnd(content string, i int) int {
+	if i+1 < len(content) && content[i+1] == '\\' {
+		return quotedEnd(content, i, '\'', false)
+	}
+	_, size := utf8.DecodeRuneInString(content[i+1:])
+	if j := i + 1 + size; size > 0 && j < len(content) && content[j] == '\'' {
+		return j + 1
+	}
+	return i + 1
+}
+
+// cppRawStringEnd skips R"delim( ... )delim" whose quote is at i.
+func cppRawStringEnd(content string, i int) int {
+	open := strings.IndexByte(content[i+1:], '(')
+	if open < 0 || open > 16 {
+		return quotedEnd(content, i, '"', false)
+	}
+	closing := ")" + content[i+1:i+1+open] + "\""
+	if end := strings.Index(content[i+2+open:], closing); end >= 0 {
+		return i + 2 + open + end + len(closing)
+	}
+	return len(content)
+}
+
+// rustRawStringEnd skips a raw string whose opening quote, after hashes
+// '#' characters, is at i.
+func rustRawStringEnd(content string, i int, hashes int) int {
+	closing := "\"" + strings.Repeat("#", hashes)
+	if end := strings.Index(content[i+1:], closing); end >= 0 {
+		return i + 1 + end + len(closing)
+	}
+	return len(content)
+}
@@ -2,17 +2,19 @@ package concatenate
 
 import (
 	"bufio"
-	"context"
 	"fmt"
-	"io/fs"
+	"io"
 	"os"
-	"path/filepath"
 	"strings"
-	"sync"
 	"time"
 
 	"github.com/schollz/progressbar/v3"
-	"golang.org/x/sync/semaphore"
+	"github.com/vitruves/gop/internal/compress"
+	"github.com/vitruves/gop/internal/memlimit"
+	"github.com/vitruves/gop/internal/pool"
+	"github.com/vitruves/gop/internal/source"
+	"github.com/vitruves/gop/internal/timings"
+	"github.com/vitruves/gop/internal/walker"
 )
 
 type Config struct {
@@ -21,6 +23,7 @@ type Config struct {
 	Exclude        []string
 	Recursive      bool
 	Depth          int
+	NoGitignore    bool
 	Jobs           int
 	Verbose        bool
 	RemoveTests    bool
@@ -28,6 +31,25 @@ type Config struct {
 	AddLineNumbers bool
 	AddHeaders     bool
 	OutputFile     string
+	// MaxTokens and MaxBytes cap the output; zero means no limit. Files are
+	// then ranked by Rank (walk, recent, size or central) after the groups
+	// formed by the Priority globs, and only those that fit are read.
+	MaxTokens int
+	MaxBytes  int64
+	Rank      string
+	Priority  []string
+	// Shards or ShardSize split the output into numbered files next to
+	// OutputFile that each end on a file boundary, plus a JSON manifest
+	// giving every file's shard and byte range.
+	Shards    int
+	ShardSize int64
+	// MaxMemory bounds, in bytes, the estimated output of the files read but
+	// not yet written; zero means no limit. The reorder window still caps
+	// their number.
+	MaxMemory int64
+	// Files, when not nil, replaces the directory walk with this candidate
+	// set, as from git.
+	Files []string
 }
 
 type FileProcessor interface {
@@ -47,81 +69,185 @@ func Run(config Config) error {
 		return fmt.Errorf("unsupported language: %s", config.Language)
 	}
 
-	files, err := collectFiles(config, processor)
+	budget, err := newBudget(config)
 	if err != nil {
-		logError(fmt.Sprintf("Failed to collect files: %v", err))
 		return err
 	}
 
-	if len(files) == 0 {
-		logWarning("No files found matching criteria")
-		return nil
+	sharded := config.Shards > 0 || config.ShardSize > 0
+	if sharded && config.OutputFile == "" {
+		return fmt.Errorf("sharded output needs an output file")
+	}
+	if config.Shards > 0 && config.ShardSize > 0 {
+		return fmt.Errorf("set either the number of shards or the shard size, not both")
 	}
 
-	logInfo(config.Verbose, fmt.Sprintf("Found %d files to process", len(files)))
+	// Ranking and sharding need every file before the first is read.
+	var planned []walker.File
+	files, walkErr := walker.Stream(walkerConfig(config, processor))
+	if budget != nil || sharded {
+		endPlan := timings.Phase("plan")
+		planned, err = plannedFiles(files, walkErr, config, budget)
+		endPlan()
+		if err != nil {
+			logError(fmt.Sprintf("Failed to collect files: %v", err))
+			return err
+		}
+		files, walkErr = fileStream(planned)
+	}
 
-	var output strings.Builder
-	
-	bar := progressbar.NewOptions(len(files),
+	window := config.Jobs * reorderWindowPerJob
+	barWriter := io.Writer(os.Stdout)
+	var out *output
+	// A single output file is replaced even when nothing is written to it;
+	// shards that get no content are left out instead.
+	var single *compress.Lazy
+	switch {
+	case sharded:
+		out = newShardedOutput(planned, config, window)
+	case config.OutputFile != "":
+		single = &compress.Lazy{Path: config.OutputFile}
+		out = newOutput(single, window)
+		out.files = []*compress.Lazy{single}
+	default:
+		out = newOutput(os.Stdout, window)
+		// Keep the progress bar out of the content stream.
+		barWriter = os.Stderr
+	}
+	defer out.close()
+	if budget != nil {
+		out.gate = newAdmitGate(budget.take, out.route)
+	}
+	if limit := memlimit.New(config.MaxMemory); limit != nil {
+		for _, w := range out.writers {
+			w.limit = limit
+		}
+	}
+
+	bar := progressbar.NewOptions(-1,
 		progressbar.OptionSetDescription("Processing files"),
+		progressbar.OptionSetWriter(barWriter),
 		progressbar.OptionShowCount(),
 		progressbar.OptionSetRenderBlankState(true),
 		progressbar.OptionClearOnFinish(),
 	)
 
-	sem := semaphore.NewWeighted(int64(config.Jobs))
-	var mu sync.Mutex
-	var wg sync.WaitGroup
-
-	results := make([]string, len(files))
-	
-	for i, file := range files {
-		wg.Add(1)
-		go func(idx int, filePath string) {
-			defer wg.Done()
-			sem.Acquire(context.Background(), 1)
-			defer sem.Release(1)
-
-			content, err := processFile(filePath, config, processor)
-			if err != nil {
-				logError(fmt.Sprintf("Error processing %s: %v", filePath, err))
-				return
-			}
-
-			mu.Lock()
-			results[idx] = content
-			bar.Add(1)
-			mu.Unlock()
-		}(i, file)
-	}
+	endProcess := timings.Phase("process")
+	progress := pool.NewProgress(func(n int) { bar.Add(n) })
+
+	// Window slots are taken in walk order, before a file reaches a worker.
+	admitted := make(chan walker.File)
+	go func() {
+		defer close(admitted)
+		idx := 0
+		for file := range files {
+			writer, _ := out.writer(idx)
+			writer.acquire(estimateOutputBytes(file, config))
+			admitted <- file
+			idx++
+		}
+	}()
+
+	count := pool.Each(config.Jobs, admitted, func(worker, idx int, file walker.File) {
+		start := timings.Now()
+		content, err := processFile(file.Path, config, processor)
+		if timings.Enabled() {
+			_, name := fileProcessor(processor, config.Language, file.Path)
+			timings.File(name, file.Size, start)
+		}
+		if err != nil {
+			logError(fmt.Sprintf("Error processing %s: %v", file.Path, err))
+		}
+		out.put(idx, content)
+		progress.Add(1)
+	})
 
-	wg.Wait()
+	progress.Stop()
 	bar.Finish()
+	endProcess()
 
-	for _, content := range results {
-		if content != "" {
-			output.WriteString(content)
+	if err := <-walkErr; err != nil {
+		logError(fmt.Sprintf("Failed to collect files: %v", err))
+		return err
+	}
+	if single != nil {
+		if err := single.Create(); err != nil {
+			logError(fmt.Sprintf("Failed to write output: %v", err))
+			return err
 		}
 	}
 
-	finalOutput := output.String()
-	
-	if config.OutputFile != "" {
-		err := os.WriteFile(config.OutputFile, []byte(finalOutput), 0644)
-		if err != nil {
-			logError(fmt.Sprintf("Failed to write output file: %v", err))
+	if count == 0 {
+		logWarning("No files found matching criteria")
+		return nil
+	}
+
+	logInfo(config.Verbose, fmt.Sprintf("Processed %d files", count))
+	if budget != nil {
+		logInfo(config.Verbose, fmt.Sprintf("Budget: %s", budget))
+	}
+
+	endOutput := timings.Phase("output")
+	defer endOutput()
+	if err := out.flush(); err != nil {
+		logError(fmt.Sprintf("Failed to write output: %v", err))
+		return err
+	}
+
+	if sharded {
+		path := manifestPath(config.OutputFile)
+		if err := out.writeManifest(path, planned); err != nil {
+			logError(fmt.Sprintf("Failed to write manifest: %v", err))
 			return err
 		}
+		logSuccess(fmt.Sprintf("Output written to %d shards indexed by %s", len(out.writers), path))
+	} else if config.OutputFile != "" {
 		logSuccess(fmt.Sprintf("Output written to %s", config.OutputFile))
-	} else {
-		fmt.Print(finalOutput)
+	}
+
+	if err := out.close(); err != nil {
+		logError(fmt.Sprintf("Failed to write output: %v", err))
+		return err
 	}
 
 	logSuccess("Code concatenation completed")
 	return nil
 }
 
+// plannedFiles drains a walk and, under a budget, ranks the files and keeps
+// those that fit.
+func plannedFiles(files <-chan walker.File, walkErr <-chan error, config Config, budget *budget) ([]walker.File, error) {
+	var all []walker.File
+	for file := range files {
+		all = append(all, file)
+	}
+	if err := <-walkErr; err != nil || budget == nil {
+		return all, err
+	}
+
+	planned, err := budget.plan(all, config)
+	logInfo(config.Verbose, fmt.Sprintf("Budget admits %d of %d files", len(planned), len(all)))
+	return planned, err
+}
+
+// fileStream yields files with the same channels as walker.Stream.
+func fileStream(files []walker.File) (<-chan walker.File, <-chan error) {
+	out := make(chan walker.File)
+	errc := make(chan error, 1)
+	go func() {
+		defer close(out)
+		for _, file := range files {
+			out <- file
+		}
+		errc <- nil
+	}()
+	return out, errc
+}
+
 func getProcessor(language string) FileProcessor {
+	if isMultiLanguage(language) {
+		return newMultiProcessor(language)
+	}
 	switch language {
 	case "python":
 		return &PythonProcessor{}
@@ -138,114 +264,47 @@ func getProcessor(language string) FileProcessor {
 	}
 }
 
-func collectFiles(config Config, processor FileProcessor) ([]string, error) {
-	var files []string
-	extensions := processor.GetExtensions()
-	specialFiles := processor.SupportsSpecialFiles()
-
-	startDir := "."
-	if len(config.Include) > 0 {
-		for _, path := range config.Include {
-			matches, err := filepath.Glob(path)
-			if err != nil {
-				return nil, err
-			}
-			for _, match := range matches {
-				if isValidFile(match, extensions) || isSpecialFile(match, specialFiles) {
-					files = append(files, match)
-				}
-			}
-		}
-		return files, nil
-	}
-
-	err := filepath.WalkDir(startDir, func(path string, d fs.DirEntry, err error) error {
-		if err != nil {
-			return err
-		}
-
-		if d.IsDir() {
-			if shouldExcludeDir(path, config.Exclude) {
-				return filepath.SkipDir
-			}
-			if !config.Recursive && path != startDir {
-				return filepath.SkipDir
-			}
-			if config.Depth > 0 {
-				relPath, _ := filepath.Rel(startDir, path)
-				if strings.Count(relPath, string(filepath.Separator)) >= config.Depth {
-					return filepath.SkipDir
-				}
-			}
-			return nil
-		}
-
-		if (isValidFile(path, extensions) || isSpecialFile(path, specialFiles)) && !shouldExcludeFile(path, config, processor) {
-			files = append(files, path)
-		}
-
-		return nil
-	})
-
-	return files, err
-}
-
-func isValidFile(path string, extensions []string) bool {
-	ext := filepath.Ext(path)
-	for _, validExt := range extensions {
-		if ext == validExt {
-			return true
-		}
+func walkerConfig(config Config, processor FileProcessor) walker.Config {
+	return walker.Config{
+		Include:      config.Include,
+		Exclude:      config.Exclude,
+		Recursive:    config.Recursive,
+		Depth:        config.Depth,
+		Jobs:         config.Jobs,
+		NoGitignore:  config.NoGitignore,
+		Files:        config.Files,
+		Extensions:   processor.GetExtensions(),
+		SpecialFiles: processor.SupportsSpecialFiles(),
+		Filter: func(path string) bool {
+			return !(config.RemoveTests && processor.IsTestFile(path))
+		},
 	}
-	return false
-}
-
-func isSpecialFile(path string, specialFiles map[string]bool) bool {
-	filename := filepath.Base(path)
-	return specialFiles[filename]
-}
-
-func shouldExcludeDir(path string, exclude []string) bool {
-	excludeDirs := []string{".git", "node_modules", "__pycache__", ".pytest_cache", "target", "build", "dist", "vendor"}
-	
-	for _, excludePattern := range exclude {
-		if matched, _ := filepath.Match(excludePattern, path); matched {
-			return true
-		}
-	}
-	
-	for _, excludeDir := range excludeDirs {
-		if strings.Contains(path, excludeDir) {
-			return true
-		}
-	}
-	
-	return false
-}
-
-func shouldExcludeFile(path string, config Config, processor FileProcessor) bool {
-	if config.RemoveTests && processor.IsTestFile(path) {
-		return true
-	}
-	
-	for _, excludePattern := range config.Exclude {
-		if matched, _ := filepath.Match(excludePattern, path); matched {
-			return true
-		}
-	}
-	
-	return false
 }
 
 func processFile(filePath string, config Config, processor FileProcessor) (string, error) {
 	logDebug(config.Verbose, fmt.Sprintf("Processing file: %s", filePath))
+	processor, _ = fileProcessor(processor, config.Language, filePath)
 	
-	content, err := os.ReadFile(filePath)
+	src, err := source.Open(filePath)
 	if err != nil {
 		return "", err
 	}
+	defer src.Close()
+
+	// A mapped file that shrinks while it is read gives an error, not a
+	// crash.
+	var result string
+	if err := source.Protect(func() { result = formatFile(filePath, src.String(), config, processor) }); err != nil {
+		return "", err
+	}
+	return result, nil
+}
 
-	contentStr := string(content)
+// formatFile applies the transforms config asks for to contentStr, the
+// content of filePath, and returns a copy.
+func formatFile(filePath, contentStr string, config Config, processor FileProcessor) string {
+	// contentStr points into the source until a transform copies it; the
+	// result is always copied into the builder below.
 	
 	if config.RemoveComments {
 		contentStr = processor.RemoveComments(contentStr)
@@ -256,6 +315,7 @@ func processFile(filePath string, config Config, processor FileProcessor) (strin
 	}
 
 	var result strings.Builder
+	result.Grow(len(contentStr) + 2*len(filePath) + 32)
 	
 	if config.AddHeaders {
 		result.WriteString(fmt.Sprintf("// === %s ===\n", filePath))
@@ -277,7 +337,7 @@ func processFile(filePath string, config Config, processor FileProcessor) (strin
 		result.WriteString("\n\n")
 	}
 
-	return result.String(), nil
+	return result.String()
 }
 
 func logInfo(verbose bool, msg string) {
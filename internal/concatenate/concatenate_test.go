@@ -1,10 +1,19 @@
 package concatenate
 
 import (
+	"bytes"
+	"compress/gzip"
+	"encoding/json"
+	"fmt"
+	"io"
 	"os"
 	"path/filepath"
 	"strings"
 	"testing"
+
+	"github.com/vitruves/gop/internal/corpus"
+	"github.com/vitruves/gop/internal/memlimit"
+	"github.com/vitruves/gop/internal/walker"
 )
 
 func TestPythonProcessor(t *testing.T) {
@@ -21,6 +30,11 @@ func TestPythonProcessor(t *testing.T) {
 	if processor.IsTestFile("example.py") != false {
 		t.Error("Should not identify example.py as test file")
 	}
+
+	cleaned := processor.RemoveTestCode("def run():\n    return 1\n\ndef test_run():\n    assert run() == 1\n")
+	if strings.Contains(cleaned, "test_run") || !strings.Contains(cleaned, "def run") {
+		t.Error("Should remove test functions and keep the rest")
+	}
 }
 
 func TestRustProcessor(t *testing.T) {
@@ -111,7 +125,7 @@ def test_hello():
 	}
 	
 	processor := &PythonProcessor{}
-	files, err := collectFiles(config, processor)
+	files, err := walker.Collect(walkerConfig(config, processor))
 	if err != nil {
 		t.Fatalf("Failed to collect files: %v", err)
 	}
@@ -121,6 +135,304 @@ def test_hello():
 	}
 }
 
+func TestBudget(t *testing.T) {
+	tempDir := t.TempDir()
+
+	sizes := map[string]int{"big.go": 4000, "mid.go": 900, "small.go": 300, "core/api.go": 1200}
+	var include []string
+	for name, size := range sizes {
+		path := filepath.Join(tempDir, name)
+		os.MkdirAll(filepath.Dir(path), 0755)
+		if err := os.WriteFile(path, []byte(strings.Repeat("x := 1\n", size/7)), 0644); err != nil {
+			t.Fatalf("Failed to create test file: %v", err)
+		}
+		include = append(include, path)
+	}
+
+	output := filepath.Join(tempDir, "out.txt")
+	config := Config{
+		Language:   "go",
+		Include:    include,
+		Jobs:       2,
+		MaxBytes:   3000,
+		Rank:       "size",
+		Priority:   []string{"core/"},
+		AddHeaders: true,
+		OutputFile: output,
+	}
+	if err := Run(config); err != nil {
+		t.Fatalf("Run failed: %v", err)
+	}
+
+	data, err := os.ReadFile(output)
+	if err != nil {
+		t.Fatalf("Failed to read output: %v", err)
+	}
+	got := string(data)
+	if len(got) > 3000 {
+		t.Errorf("Expected at most 3000 bytes, got %d", len(got))
+	}
+	// core/ comes first, then the smallest files while they fit.
+	api, small := strings.Index(got, "core/api.go"), strings.Index(got, "small.go")
+	if api < 0 || small < api || !strings.Contains(got, "mid.go") || strings.Contains(got, "big.go") {
+		t.Errorf("Unexpected selection:\n%s", got)
+	}
+
+	if err := Run(Config{Language: "go", MaxTokens: 10, Rank: "random"}); err == nil {
+		t.Error("Expected an error for an unknown rank")
+	}
+}
+
+func TestMultiLanguage(t *testing.T) {
+	tempDir := t.TempDir()
+	files := map[string]string{
+		"main.go":        "package main\n\n// go comment\nfunc main() {}\n",
+		"tool.py":        "# python comment\ndef run():\n    return 1\n",
+		"lib.rs":         "// rust comment\nfn lib() {}\n",
+		"notes.txt":      "not source\n",
+		"CMakeLists.txt": "project(demo)\n",
+	}
+	for name, content := range files {
+		if err := os.WriteFile(filepath.Join(tempDir, name), []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to create test file: %v", err)
+		}
+	}
+
+	output := filepath.Join(tempDir, "out.txt")
+	config := Config{Language: "go,python", Include: []string{tempDir}, Jobs: 2, RemoveComments: true, OutputFile: output}
+	if err := Run(config); err != nil {
+		t.Fatalf("Run failed: %v", err)
+	}
+	data, err := os.ReadFile(output)
+	if err != nil {
+		t.Fatalf("Failed to read output: %v", err)
+	}
+	got := string(data)
+	if !strings.Contains(got, "func main") || !strings.Contains(got, "def run") {
+		t.Errorf("Both languages should be concatenated:\n%s", got)
+	}
+	if strings.Contains(got, "comment") {
+		t.Errorf("Each file's comments should be removed by its own processor:\n%s", got)
+	}
+	if strings.Contains(got, "fn lib") || strings.Contains(got, "not source") {
+		t.Errorf("Files of unlisted languages should be left out:\n%s", got)
+	}
+
+	config.Language = "auto"
+	if err := Run(config); err != nil {
+		t.Fatalf("Run failed: %v", err)
+	}
+	if data, _ := os.ReadFile(output); !strings.Contains(string(data), "fn lib") || !strings.Contains(string(data), "project(demo)") {
+		t.Errorf("auto should cover every language and their build files:\n%s", data)
+	}
+
+	// A run with nothing to write still replaces the earlier output.
+	config.Include = []string{t.TempDir()}
+	if err := Run(config); err != nil {
+		t.Fatalf("Run failed: %v", err)
+	}
+	if data, err := os.ReadFile(output); err != nil || len(data) != 0 {
+		t.Errorf("Expected an empty output, got %q (%v)", data, err)
+	}
+
+	if err := Run(Config{Language: "go,java"}); err == nil {
+		t.Error("Expected an error for an unsupported language in a list")
+	}
+}
+
+func TestShards(t *testing.T) {
+	tempDir := t.TempDir()
+
+	var include []string
+	for i := 0; i < 6; i++ {
+		path := filepath.Join(tempDir, fmt.Sprintf("file%d.go", i))
+		if err := os.WriteFile(path, []byte(strings.Repeat(fmt.Sprintf("var v%d = 1\n", i), 50)), 0644); err != nil {
+			t.Fatalf("Failed to create test file: %v", err)
+		}
+		include = append(include, path)
+	}
+
+	// Manifest offsets are into the shards as written, before compression.
+	for _, name := range []string{"bundle.txt", "bundle.txt.gz"} {
+		output := filepath.Join(tempDir, name)
+		config := Config{Language: "go", Include: include, Jobs: 3, Shards: 3, AddHeaders: true, OutputFile: output}
+		if err := Run(config); err != nil {
+			t.Fatalf("Run failed: %v", err)
+		}
+
+		data, err := os.ReadFile(filepath.Join(tempDir, "bundle.manifest.json"))
+		if err != nil {
+			t.Fatalf("Failed to read manifest: %v", err)
+		}
+		var index manifest
+		if err := json.Unmarshal(data, &index); err != nil {
+			t.Fatalf("Failed to parse manifest: %v", err)
+		}
+		if len(index.Shards) != 3 || len(index.Files) != 6 {
+			t.Fatalf("Expected 3 shards and 6 files, got %+v", index)
+		}
+		if first := filepath.Base(index.Shards[0].Path); first != strings.Replace(name, ".txt", "-0001.txt", 1) {
+			t.Errorf("Shard of %s named %s", name, first)
+		}
+
+		for i, entry := range index.Files {
+			shard, err := os.ReadFile(filepath.Join(tempDir, index.Shards[entry.Shard].Path))
+			if err != nil {
+				t.Fatalf("Failed to read shard: %v", err)
+			}
+			if strings.HasSuffix(name, ".gz") {
+				zr, err := gzip.NewReader(bytes.NewReader(shard))
+				if err != nil {
+					t.Fatalf("Shard is not gzip: %v", err)
+				}
+				if shard, err = io.ReadAll(zr); err != nil {
+					t.Fatalf("Failed to decompress shard: %v", err)
+				}
+			}
+			chunk := string(shard[entry.Offset : entry.Offset+entry.Length])
+			if entry.Path != include[i] || !strings.HasPrefix(chunk, "// === "+include[i]) || !strings.Contains(chunk, fmt.Sprintf("var v%d", i)) {
+				t.Errorf("Manifest entry %d does not point at its file: %+v", i, entry)
+			}
+		}
+	}
+
+	if err := Run(Config{Language: "go", Include: include, ShardSize: 100}); err == nil {
+		t.Error("Expected an error for shards without an output file")
+	}
+}
+
+func TestEstimateTokens(t *testing.T) {
+	if got := estimateTokens("return a + b;\n"); got != 6 {
+		t.Errorf("Expected 6 tokens, got %d", got)
+	}
+	if got := estimateTokens(strings.Repeat("x", 16)); got != 3 {
+		t.Errorf("Expected 3 tokens, got %d", got)
+	}
+}
+
+func TestOrderedWriter(t *testing.T) {
+	var buf bytes.Buffer
+	writer := newOrderedWriter(&buf, 4)
+	writer.limit = memlimit.New(100)
+	
+	for i := 0; i < 4; i++ {
+		writer.acquire(10)
+	}
+	
+	writer.put(2, "c")
+	writer.put(1, "b")
+	if buf.Len() != 0 {
+		t.Error("Should not write before the first chunk is ready")
+	}
+	writer.put(3, "")
+	writer.put(0, "a")
+	
+	if err := writer.flush(); err != nil {
+		t.Fatalf("Failed to flush writer: %v", err)
+	}
+	
+	if buf.String() != "abc" {
+		t.Errorf("Expected ordered output %q, got %q", "abc", buf.String())
+	}
+	if got := writer.limit.String(); !strings.HasPrefix(got, "0 of 100 bytes in flight") {
+		t.Errorf("Expected written chunks to release their memory, got %s", got)
+	}
+}
+
+func TestAdmitGate(t *testing.T) {
+	// A budget of 4 bytes admits what fits in index order, however the
+	// chunks arrive.
+	for _, order := range [][]int{{0, 1, 2, 3}, {3, 2, 1, 0}, {2, 0, 3, 1}} {
+		b := &budget{maxBytes: 4}
+		var routed []string
+		gate := newAdmitGate(b.take, func(idx int, chunk string) {
+			if idx != len(routed) {
+				t.Errorf("Chunk %d routed out of order", idx)
+			}
+			routed = append(routed, chunk)
+		})
+		chunks := []string{"aa", "bbb", "c", "dd"}
+		for _, idx := range order {
+			gate.put(idx, chunks[idx])
+		}
+		if got := strings.Join(routed, ","); got != "aa,,c," {
+			t.Errorf("Order %v: expected aa,,c, got %q", order, got)
+		}
+	}
+}
+
+func TestStripComments(t *testing.T) {
+	tests := []struct {
+		name     string
+		syntax   commentSyntax
+		input    string
+		expected string
+	}{
+		{"line and block", cSyntax, "int a; // note\n/* block\n */int b;\n", "int a; \nint b;\n"},
+		{"url in string", cSyntax, "url = \"http://x/*y*/\"; // c\n", "url = \"http://x/*y*/\"; \n"},
+		{"escaped quote", cSyntax, "s = \"a\\\"//b\"; c = '\"'; // x", "s = \"a\\\"//b\"; c = '\"'; "},
+		{"unterminated block", cSyntax, "a /* open", "a /* open"},
+		{"cpp raw string", cppSyntax, "auto s = R\"x(// )\" /* )x\"; // c", "auto s = R\"x(// )\" /* )x\"; "},
+		{"digit separator", cppSyntax, "int n = 1'000; // c", "int n = 1'000; "},
+		{"go raw string", goSyntax, "s := `// not\n/* a */` // c", "s := `// not\n/* a */` "},
+		{"rust raw string", rustSyntax, "let s = r#\"a \"// b\"#; // c", "let s = r#\"a \"// b\"#; "},
+		{"rust lifetime", rustSyntax, "fn f<'a>(x: &'a str) {} // c", "fn f<'a>(x: &'a str) {} "},
+		{"rust nested block", rustSyntax, "a /* x /* y */ z */ b", "a  b"},
+		{"c nested block", cSyntax, "a /* x /* y */ z */ b", "a  z */ b"},
+	}
+
+	for _, test := range tests {
+		if got := stripComments(test.input, test.syntax); got != test.expected {
+			t.Errorf("%s: expected %q, got %q", test.name, test.expected, got)
+		}
+	}
+}
+
+func TestRemoveTestCode(t *testing.T) {
+	cpp := "#include <gtest/gtest.h>\n#include \"shape.h\"\n\n" +
+		"int area(int w) { return w * w; }\n\n" +
+		"TEST(Area, Square) {\n  auto f = [](int x) { return x; };\n  for (int i = 0; i < 3; i++) { EXPECT_EQ(area(i), i * i); }\n  const char* s = \"}\";\n}\n\n" +
+		"class AreaTest : public ::testing::Test {\n protected:\n  void SetUp() override {}\n};\n\n" +
+		"TEST_F(AreaTest, Zero) { ASSERT_EQ(area(0), 0); }\n" +
+		"const char* url = \"http://x/TEST(a, b) {\";\n" +
+		"int main(int argc, char** argv) {\n  ::testing::InitGoogleTest(&argc, argv);\n  return RUN_ALL_TESTS();\n}\n"
+	rust := "fn add(a: i32) -> i32 { a }\n\n#[cfg(test)]\nmod tests {\n    use super::*;\n\n    #[test]\n    fn adds() {\n        let v = vec![1];\n        if v.len() > 0 { assert_eq!(add(1), 1); }\n    }\n}\n\n" +
+		"#[test]\n#[should_panic]\nfn fails<T>() where T: Copy { let s = \"}\"; panic!(\"{}\", s); }\n\nfn main() {}\n"
+	python := "import pytest\nimport os\n\ndef run():\n    return \"\"\"\ndef test_doc():\n\"\"\"\n\n" +
+		"@pytest.mark.parametrize(\n    \"x\",\n    [1, 2],\n)\ndef test_run(x):\n    s = \"\"\"\nmultiline\n\"\"\"\n    assert run()\n\n" +
+		"class TestRun:\n    def test_a(self):\n        pass\n\n@property\ndef kept():\n    return 1\n"
+
+	tests := []struct {
+		name    string
+		got     string
+		removed []string
+		kept    []string
+	}{
+		{"cpp", (&CppProcessor{}).RemoveTestCode(cpp),
+			[]string{"gtest", "TEST(Area", "EXPECT_EQ", "AreaTest", "SetUp", "InitGoogleTest", "RUN_ALL_TESTS"},
+			[]string{"#include \"shape.h\"", "int area(int w) { return w * w; }", "\"http://x/TEST(a, b) {\""}},
+		{"rust", (&RustProcessor{}).RemoveTestCode(rust),
+			[]string{"cfg(test)", "mod tests", "assert_eq", "should_panic", "fails", "panic!"},
+			[]string{"fn add(a: i32) -> i32 { a }", "fn main() {}"}},
+		{"python", (&PythonProcessor{}).RemoveTestCode(python),
+			[]string{"pytest", "test_run", "multiline", "assert run", "TestRun", "test_a"},
+			[]string{"import os", "def run():", "def test_doc():", "@property\ndef kept():"}},
+	}
+
+	for _, test := range tests {
+		for _, text := range test.removed {
+			if strings.Contains(test.got, text) {
+				t.Errorf("%s: expected %q to be removed from %q", test.name, text, test.got)
+			}
+		}
+		for _, text := range test.kept {
+			if !strings.Contains(test.got, text) {
+				t.Errorf("%s: expected %q to be kept in %q", test.name, text, test.got)
+			}
+		}
+	}
+}
+
 func contains(slice []string, item string) bool {
 	for _, s := range slice {
 		if s == item {
@@ -128,4 +440,60 @@ func contains(slice []string, item string) bool {
 		}
 	}
 	return false
-}
\ No newline at end of file
+}
+func BenchmarkCppRemoveComments(b *testing.B) {
+	content := strings.Repeat("// comment\nint add(int a, int b) { /* sum */ return a + b; }\n", 500)
+	processor := &CppProcessor{}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		processor.RemoveComments(content)
+	}
+}
+
+func BenchmarkCppRemoveTestCode(b *testing.B) {
+	content := strings.Repeat("int add(int a, int b) { return a + b; }\n\nTEST(Add, Works) {\n  EXPECT_EQ(add(1, 2), 3);\n}\n", 500)
+	processor := &CppProcessor{}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		processor.RemoveTestCode(content)
+	}
+}
+
+func BenchmarkPythonRemoveTestCode(b *testing.B) {
+	content := strings.Repeat("def run():\n    return 1\n\ndef test_run():\n    assert run() == 1\n", 500)
+	processor := &PythonProcessor{}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		processor.RemoveTestCode(content)
+	}
+}
+
+func BenchmarkRemoveComments(b *testing.B) {
+	corpus.EachSource(b, func(b *testing.B, language, path, source string) {
+		processor := getProcessor(language)
+		for i := 0; i < b.N; i++ {
+			processor.RemoveComments(source)
+		}
+	})
+}
+
+func BenchmarkRemoveTestCode(b *testing.B) {
+	corpus.EachSource(b, func(b *testing.B, language, path, source string) {
+		processor := getProcessor(language)
+		for i := 0; i < b.N; i++ {
+			processor.RemoveTestCode(source)
+		}
+	})
+}
+
+func BenchmarkProcessFile(b *testing.B) {
+	corpus.EachSource(b, func(b *testing.B, language, path, source string) {
+		config := Config{Language: language, RemoveComments: true, RemoveTests: true, AddHeaders: true}
+		processor := getProcessor(language)
+		for i := 0; i < b.N; i++ {
+			if _, err := processFile(path, config, processor); err != nil {
+				b.Fatalf("Failed to process file: %v", err)
+			}
+		}
+	})
+}
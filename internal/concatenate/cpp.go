@@ -2,12 +2,14 @@ package concatenate
 
 import (
 	"path/filepath"
-	"regexp"
 	"strings"
 )
 
 type CppProcessor struct{}
 
+// cppTestIncludes are the test framework headers dropped with test code.
+var cppTestIncludes = []string{"<gtest/gtest.h>", "<catch.hpp>", "<catch2/catch.hpp>", "<boost/test/"}
+
 func (cpp *CppProcessor) GetExtensions() []string {
 	return []string{".cpp", ".cxx", ".cc", ".hpp", ".hxx", ".hh", ".h++", ".c++"}
 }
@@ -41,58 +43,83 @@ func (cpp *CppProcessor) IsTestFile(path string) bool {
 }
 
 func (cpp *CppProcessor) RemoveComments(content string) string {
-	singleLineRegex := regexp.MustCompile(`//.*$`)
-	lines := strings.Split(content, "\n")
-	var result []string
-	
-	for _, line := range lines {
-		processed := singleLineRegex.ReplaceAllString(line, "")
-		result = append(result, processed)
-	}
-	
-	content = strings.Join(result, "\n")
-	
-	multiLineRegex := regexp.MustCompile(`(?s)/\*.*?\*/`)
-	content = multiLineRegex.ReplaceAllString(content, "")
-	
-	return content
+	return stripComments(content, cppSyntax)
 }
 
 func (cpp *CppProcessor) RemoveTestCode(content string) string {
-	gtestTestRegex := regexp.MustCompile(`(?s)TEST\s*\([^)]*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = gtestTestRegex.ReplaceAllString(content, "")
-	
-	gtestTestFRegex := regexp.MustCompile(`(?s)TEST_F\s*\([^)]*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = gtestTestFRegex.ReplaceAllString(content, "")
-	
-	gtestTestPRegex := regexp.MustCompile(`(?s)TEST_P\s*\([^)]*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = gtestTestPRegex.ReplaceAllString(content, "")
-	
-	catchTestRegex := regexp.MustCompile(`(?s)TEST_CASE\s*\([^)]*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = catchTestRegex.ReplaceAllString(content, "")
-	
-	testFixtureRegex := regexp.MustCompile(`(?s)class\s+\w+\s*:\s*public\s+::testing::Test\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = testFixtureRegex.ReplaceAllString(content, "")
-	
-	gtestIncludeRegex := regexp.MustCompile(`(?m)^[ \t]*#include\s+<gtest/gtest\.h>.*\n`)
-	content = gtestIncludeRegex.ReplaceAllString(content, "")
-	
-	catchIncludeRegex := regexp.MustCompile(`(?m)^[ \t]*#include\s+<catch2?/catch\.hpp>.*\n`)
-	content = catchIncludeRegex.ReplaceAllString(content, "")
-	
-	boostTestIncludeRegex := regexp.MustCompile(`(?m)^[ \t]*#include\s+<boost/test/.*\.hpp>.*\n`)
-	content = boostTestIncludeRegex.ReplaceAllString(content, "")
-	
-	testMainRegex := regexp.MustCompile(`(?s)int\s+main\s*\([^)]*\)\s*\{[^{}]*testing::InitGoogleTest[^{}]*\}`)
-	content = testMainRegex.ReplaceAllString(content, "")
-	
-	expectAssertRegex := regexp.MustCompile(`(?m)^[ \t]*(EXPECT_|ASSERT_)\w+\s*\(.*\)\s*;.*\n`)
-	content = expectAssertRegex.ReplaceAllString(content, "")
-	
-	requireRegex := regexp.MustCompile(`(?m)^[ \t]*REQUIRE\s*\(.*\)\s*;.*\n`)
-	content = requireRegex.ReplaceAllString(content, "")
-	
-	return content
+	return removeTestBlocks(content, cppSyntax, matchCppTest)
+}
+
+// matchCppTest matches GoogleTest and Catch test cases, ::testing::Test
+// fixtures, a main that runs InitGoogleTest, test framework includes and
+// EXPECT_/ASSERT_/REQUIRE statement lines.
+func matchCppTest(s codeScanner, i, line int) (int, int) {
+	if s.content[i] == '#' {
+		if line < 0 {
+			return -1, -1
+		}
+		end := s.lineEnd(i)
+		directive := s.content[i:end]
+		if rest := strings.TrimLeft(directive[1:], " \t"); strings.HasPrefix(rest, "include") {
+			for _, header := range cppTestIncludes {
+				if strings.Contains(rest, header) {
+					return line, end
+				}
+			}
+		}
+		return -1, -1
+	}
+
+	word := s.word(i)
+	switch word {
+	case "TEST", "TEST_F", "TEST_P", "TEST_CASE":
+		return s.lineRange(i, line, s.macroBlock(i+len(word)))
+	case "class", "struct":
+		return s.lineRange(i, line, cppFixtureEnd(s, i+len(word)))
+	case "int":
+		if next := s.skipSpace(i + len(word)); s.word(next) == "main" {
+			end := s.macroBlock(next + len("main"))
+			if end > 0 && strings.Contains(s.content[next:end], "InitGoogleTest") {
+				return s.lineRange(i, line, end)
+			}
+		}
+		return -1, -1
+	}
+
+	if line >= 0 && (strings.HasPrefix(word, "EXPECT_") || strings.HasPrefix(word, "ASSERT_") || word == "REQUIRE") {
+		return line, s.statementLine(i + len(word))
+	}
+	return -1, -1
+}
+
+// cppFixtureEnd matches "Name : public ::testing::Test { ... };" after the
+// class keyword ending at i.
+func cppFixtureEnd(s codeScanner, i int) int {
+	i = s.skipSpace(i)
+	name := s.word(i)
+	if name == "" {
+		return -1
+	}
+	i = s.skipSpace(i + len(name))
+	if i >= len(s.content) || s.content[i] != ':' {
+		return -1
+	}
+	open := strings.IndexByte(s.content[i:], '{')
+	if open < 0 {
+		return -1
+	}
+	bases := strings.Join(strings.Fields(s.content[i+1:i+open]), " ")
+	if bases != "public ::testing::Test" && bases != "public testing::Test" {
+		return -1
+	}
+	end := s.body(i + open)
+	if end < 0 {
+		return -1
+	}
+	if next := s.skipSpace(end); next < len(s.content) && s.content[next] == ';' {
+		end = next + 1
+	}
+	return end
 }
 
 func (cpp *CppProcessor) SupportsSpecialFiles() map[string]bool {
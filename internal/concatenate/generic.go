@@ -8,6 +8,14 @@ import (
 
 type GenericProcessor struct{}
 
+var genericPatterns = struct {
+	testFunction *regexp.Regexp
+	testClass    *regexp.Regexp
+}{
+	testFunction: regexp.MustCompile(`(?s)(def|func|void|int)\s+(test_|Test)\w*.*?\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`),
+	testClass:    regexp.MustCompile(`(?s)class\s+(Test|.*Test)\w*.*?\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`),
+}
+
 func (g *GenericProcessor) GetExtensions() []string {
 	return []string{".py", ".rs", ".go", ".c", ".cpp", ".cxx", ".cc", ".h", ".hpp", ".hxx", ".hh", ".h++", ".c++"}
 }
@@ -50,11 +58,8 @@ func (g *GenericProcessor) RemoveComments(content string) string {
 }
 
 func (g *GenericProcessor) RemoveTestCode(content string) string {
-	testFunctionRegex := regexp.MustCompile(`(?s)(def|func|void|int)\s+(test_|Test)\w*.*?\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = testFunctionRegex.ReplaceAllString(content, "")
-	
-	testClassRegex := regexp.MustCompile(`(?s)class\s+(Test|.*Test)\w*.*?\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = testClassRegex.ReplaceAllString(content, "")
+	content = genericPatterns.testFunction.ReplaceAllString(content, "")
+	content = genericPatterns.testClass.ReplaceAllString(content, "")
 	
 	return content
 }
@@ -131,19 +136,5 @@ func (g *GenericProcessor) removePythonComments(content string) string {
 }
 
 func (g *GenericProcessor) removeCStyleComments(content string) string {
-	singleLineRegex := regexp.MustCompile(`//.*$`)
-	lines := strings.Split(content, "\n")
-	var result []string
-	
-	for _, line := range lines {
-		processed := singleLineRegex.ReplaceAllString(line, "")
-		result = append(result, processed)
-	}
-	
-	content = strings.Join(result, "\n")
-	
-	multiLineRegex := regexp.MustCompile(`(?s)/\*.*?\*/`)
-	content = multiLineRegex.ReplaceAllString(content, "")
-	
-	return content
+	return stripComments(content, genericSyntax)
 }
\ No newline at end of file
@@ -3,11 +3,24 @@ package concatenate
 import (
 	"path/filepath"
 	"regexp"
-	"strings"
 )
 
 type GoProcessor struct{}
 
+var goPatterns = struct {
+	testFunction      *regexp.Regexp
+	benchmarkFunction *regexp.Regexp
+	exampleFunction   *regexp.Regexp
+	testingImport     *regexp.Regexp
+	testifyImport     *regexp.Regexp
+}{
+	testFunction:      regexp.MustCompile(`(?s)func\s+Test\w*\(\s*t\s+\*testing\.T\s*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`),
+	benchmarkFunction: regexp.MustCompile(`(?s)func\s+Benchmark\w*\(\s*b\s+\*testing\.B\s*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`),
+	exampleFunction:   regexp.MustCompile(`(?s)func\s+Example\w*\(\s*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`),
+	testingImport:     regexp.MustCompile(`(?m)^[ \t]*"testing"\n`),
+	testifyImport:     regexp.MustCompile(`(?m)^[ \t]*".*testify.*"\n`),
+}
+
 func (g *GoProcessor) GetExtensions() []string {
 	return []string{".go"}
 }
@@ -29,38 +42,15 @@ func (g *GoProcessor) IsTestFile(path string) bool {
 }
 
 func (g *GoProcessor) RemoveComments(content string) string {
-	singleLineRegex := regexp.MustCompile(`//.*$`)
-	lines := strings.Split(content, "\n")
-	var result []string
-	
-	for _, line := range lines {
-		processed := singleLineRegex.ReplaceAllString(line, "")
-		result = append(result, processed)
-	}
-	
-	content = strings.Join(result, "\n")
-	
-	multiLineRegex := regexp.MustCompile(`(?s)/\*.*?\*/`)
-	content = multiLineRegex.ReplaceAllString(content, "")
-	
-	return content
+	return stripComments(content, goSyntax)
 }
 
 func (g *GoProcessor) RemoveTestCode(content string) string {
-	testFunctionRegex := regexp.MustCompile(`(?s)func\s+Test\w*\(\s*t\s+\*testing\.T\s*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = testFunctionRegex.ReplaceAllString(content, "")
-	
-	benchmarkFunctionRegex := regexp.MustCompile(`(?s)func\s+Benchmark\w*\(\s*b\s+\*testing\.B\s*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = benchmarkFunctionRegex.ReplaceAllString(content, "")
-	
-	exampleFunctionRegex := regexp.MustCompile(`(?s)func\s+Example\w*\(\s*\)\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = exampleFunctionRegex.ReplaceAllString(content, "")
-	
-	testingImportRegex := regexp.MustCompile(`(?m)^[ \t]*"testing"\n`)
-	content = testingImportRegex.ReplaceAllString(content, "")
-	
-	testifyImportRegex := regexp.MustCompile(`(?m)^[ \t]*".*testify.*"\n`)
-	content = testifyImportRegex.ReplaceAllString(content, "")
+	content = goPatterns.testFunction.ReplaceAllString(content, "")
+	content = goPatterns.benchmarkFunction.ReplaceAllString(content, "")
+	content = goPatterns.exampleFunction.ReplaceAllString(content, "")
+	content = goPatterns.testingImport.ReplaceAllString(content, "")
+	content = goPatterns.testifyImport.ReplaceAllString(content, "")
 	
 	return content
 }
@@ -0,0 +1,118 @@
+package concatenate
+
+import (
+	"path/filepath"
+	"strings"
+)
+
+// autoLanguages are what --language auto concatenates, in the order they
+// claim extensions.
+var autoLanguages = []string{"python", "rust", "go", "c", "cpp"}
+
+// isMultiLanguage reports whether language is "auto" or a comma-separated
+// list, which one run concatenates together.
+func isMultiLanguage(language string) bool {
+	return language == "auto" || strings.Contains(language, ",")
+}
+
+func splitLanguages(language string) []string {
+	if language == "auto" {
+		return autoLanguages
+	}
+	var languages []string
+	for _, name := range strings.Split(language, ",") {
+		if name = strings.TrimSpace(name); name != "" {
+			languages = append(languages, name)
+		}
+	}
+	return languages
+}
+
+// multiProcessor hands every file to the processor of the first of its
+// languages that claims the file's extension or, for build files, its
+// name, so one walk covers them all.
+type multiProcessor struct {
+	languages  []string
+	processors []FileProcessor
+	byExt      map[string]int
+	byName     map[string]int
+	extensions []string
+	special    map[string]bool
+}
+
+// newMultiProcessor returns nil when a listed language has no processor of
+// its own.
+func newMultiProcessor(language string) FileProcessor {
+	m := &multiProcessor{byExt: make(map[string]int), byName: make(map[string]int), special: make(map[string]bool)}
+	for _, name := range splitLanguages(language) {
+		if _, ok := getProcessor(name).(*GenericProcessor); ok || isMultiLanguage(name) {
+			return nil
+		}
+		i := len(m.processors)
+		m.languages = append(m.languages, name)
+		m.processors = append(m.processors, getProcessor(name))
+		for _, ext := range m.processors[i].GetExtensions() {
+			if _, taken := m.byExt[ext]; !taken {
+				m.byExt[ext] = i
+				m.extensions = append(m.extensions, ext)
+			}
+		}
+		for file := range m.processors[i].SupportsSpecialFiles() {
+			if _, taken := m.byName[file]; !taken {
+				m.byName[file] = i
+				m.special[file] = true
+			}
+		}
+	}
+	if len(m.processors) == 0 {
+		return nil
+	}
+	return m
+}
+
+// processorFor returns the processor of path and its language.
+func (m *multiProcessor) processorFor(path string) (FileProcessor, string) {
+	i, ok := m.byName[filepath.Base(path)]
+	if !ok {
+		i = m.byExt[filepath.Ext(path)]
+	}
+	return m.processors[i], m.languages[i]
+}
+
+func (m *multiProcessor) GetExtensions() []string {
+	return m.extensions
+}
+
+func (m *multiProcessor) SupportsSpecialFiles() map[string]bool {
+	return m.special
+}
+
+func (m *multiProcessor) IsTestFile(path string) bool {
+	processor, _ := m.processorFor(path)
+	return processor.IsTestFile(path)
+}
+
+func (m *multiProcessor) IsHeaderFile(path string) bool {
+	processor, _ := m.processorFor(path)
+	return processor.IsHeaderFile(path)
+}
+
+// RemoveComments and RemoveTestCode need the file's language, which
+// content alone does not tell; processFile asks the file's own processor
+// through fileProcessor instead.
+func (m *multiProcessor) RemoveComments(content string) string {
+	return content
+}
+
+func (m *multiProcessor) RemoveTestCode(content string) string {
+	return content
+}
+
+// fileProcessor returns the processor that handles path and the language
+// its work is reported under.
+func fileProcessor(processor FileProcessor, language, path string) (FileProcessor, string) {
+	if m, ok := processor.(*multiProcessor); ok {
+		return m.processorFor(path)
+	}
+	return processor, language
+}
@@ -2,12 +2,17 @@ package concatenate
 
 import (
 	"path/filepath"
-	"regexp"
 	"strings"
 )
 
 type PythonProcessor struct{}
 
+// pythonTestHeaders start the blocks dropped by RemoveTestCode.
+var pythonTestHeaders = []string{"def test_", "async def test_", "class Test"}
+
+// pythonTestImports start the import lines dropped by RemoveTestCode.
+var pythonTestImports = []string{"import unittest", "import pytest"}
+
 func (p *PythonProcessor) GetExtensions() []string {
 	return []string{".py"}
 }
@@ -94,19 +99,7 @@ func (p *PythonProcessor) RemoveComments(content string) string {
 }
 
 func (p *PythonProcessor) RemoveTestCode(content string) string {
-	testFunctionRegex := regexp.MustCompile(`(?m)^[ \t]*def test_.*?(?=^[ \t]*def|\n[ \t]*class|\n[ \t]*if|\n[ \t]*$|\z)`)
-	content = testFunctionRegex.ReplaceAllString(content, "")
-	
-	testClassRegex := regexp.MustCompile(`(?s)^[ \t]*class Test.*?(?=^[ \t]*class|\n[ \t]*def|\n[ \t]*if|\n[ \t]*$|\z)`)
-	content = testClassRegex.ReplaceAllString(content, "")
-	
-	unittestImportRegex := regexp.MustCompile(`(?m)^[ \t]*import unittest.*\n`)
-	content = unittestImportRegex.ReplaceAllString(content, "")
-	
-	pytestImportRegex := regexp.MustCompile(`(?m)^[ \t]*import pytest.*\n`)
-	content = pytestImportRegex.ReplaceAllString(content, "")
-	
-	return content
+	return removePythonTests(content)
 }
 
 func (p *PythonProcessor) SupportsSpecialFiles() map[string]bool {
@@ -167,4 +160,125 @@ func isInsideString(code string) bool {
 	}
 	
 	return inSingle || inDouble || inTripleSingle || inTripleDouble
-}
\ No newline at end of file
+}
+
+// removePythonTests drops test functions and classes with the decorators
+// above them, and test framework imports, in one pass over the lines. A
+// block ends at the first line indented no deeper than its header that is
+// not blank and not inside a string or bracket left open by the lines
+// before it.
+func removePythonTests(content string) string {
+	var out strings.Builder
+	last := 0
+
+	var state pythonLineState
+	block, blockIndent := -1, 0
+	decorator, decoratorIndent := -1, 0
+
+	for start := 0; start < len(content); {
+		end := len(content)
+		if n := strings.IndexByte(content[start:], '\n'); n >= 0 {
+			end = start + n + 1
+		}
+		line := content[start:end]
+		continued := state.open()
+		state.scan(line)
+
+		trimmed := strings.TrimLeft(line, " \t")
+		indent := len(line) - len(trimmed)
+		blank := strings.TrimSpace(trimmed) == ""
+
+		if continued || blank {
+			start = end
+			continue
+		}
+		if block >= 0 {
+			if indent > blockIndent {
+				start = end
+				continue
+			}
+			last = cut(&out, content, last, block, start)
+			block = -1
+		}
+
+		switch {
+		case trimmed[0] == '@':
+			if decorator < 0 {
+				decorator, decoratorIndent = start, indent
+			}
+			start = end
+			continue
+		case hasAnyPrefix(trimmed, pythonTestHeaders):
+			block, blockIndent = start, indent
+			if decorator >= 0 && decoratorIndent == indent {
+				block = decorator
+			}
+		case hasAnyPrefix(trimmed, pythonTestImports):
+			last = cut(&out, content, last, start, end)
+		}
+		decorator = -1
+		start = end
+	}
+
+	if block >= 0 {
+		last = cut(&out, content, last, block, len(content))
+	}
+	return finish(&out, content, last)
+}
+
+func hasAnyPrefix(s string, prefixes []string) bool {
+	for _, prefix := range prefixes {
+		if strings.HasPrefix(s, prefix) {
+			return true
+		}
+	}
+	return false
+}
+
+// pythonLineState carries what a line leaves open into the next one: a
+// triple-quoted string or unclosed brackets.
+type pythonLineState struct {
+	quote string
+	depth int
+}
+
+func (st *pythonLineState) open() bool {
+	return st.quote != "" || st.depth > 0
+}
+
+func (st *pythonLineState) scan(line string) {
+	for i := 0; i < len(line); i++ {
+		if st.quote != "" {
+			switch {
+			case line[i] == '\\':
+				i++
+			case strings.HasPrefix(line[i:], st.quote):
+				i += len(st.quote) - 1
+				st.quote = ""
+			}
+			continue
+		}
+
+		switch c := line[i]; c {
+		case '#':
+			return
+		case '"', '\'':
+			if triple := line[i:min(i+3, len(line))]; triple == strings.Repeat(string(c), 3) {
+				st.quote = triple
+				i += 2
+				continue
+			}
+			for i++; i < len(line) && line[i] != c && line[i] != '\n'; i++ {
+				if line[i] == '\\' {
+					i++
+				}
+			}
+		case '(', '[', '{':
+			st.depth++
+		case ')', ']', '}':
+			if st.depth > 0 {
+				st.depth--
+			}
+		}
+	}
+}
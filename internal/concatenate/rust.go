@@ -2,7 +2,6 @@ package concatenate
 
 import (
 	"path/filepath"
-	"regexp"
 	"strings"
 )
 
@@ -36,43 +35,65 @@ func (r *RustProcessor) IsTestFile(path string) bool {
 }
 
 func (r *RustProcessor) RemoveComments(content string) string {
-	singleLineRegex := regexp.MustCompile(`//.*$`)
-	lines := strings.Split(content, "\n")
-	var result []string
-	
-	for _, line := range lines {
-		processed := singleLineRegex.ReplaceAllString(line, "")
-		result = append(result, processed)
-	}
-	
-	content = strings.Join(result, "\n")
-	
-	multiLineRegex := regexp.MustCompile(`(?s)/\*.*?\*/`)
-	content = multiLineRegex.ReplaceAllString(content, "")
-	
-	docCommentRegex := regexp.MustCompile(`(?m)^[ \t]*///.*\n`)
-	content = docCommentRegex.ReplaceAllString(content, "")
-	
-	return content
+	return stripComments(content, rustSyntax)
 }
 
 func (r *RustProcessor) RemoveTestCode(content string) string {
-	testModuleRegex := regexp.MustCompile(`(?s)#\[cfg\(test\)\].*?mod\s+\w+\s*\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = testModuleRegex.ReplaceAllString(content, "")
-	
-	testFunctionRegex := regexp.MustCompile(`(?s)#\[test\].*?fn\s+\w+\(\)\s*(?:->\s*\w+\s*)?\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = testFunctionRegex.ReplaceAllString(content, "")
-	
-	benchmarkFunctionRegex := regexp.MustCompile(`(?s)#\[bench\].*?fn\s+\w+\(.*?\)\s*(?:->\s*\w+\s*)?\{(?:[^{}]*\{[^{}]*\})*[^{}]*\}`)
-	content = benchmarkFunctionRegex.ReplaceAllString(content, "")
-	
-	testImportRegex := regexp.MustCompile(`(?m)^[ \t]*use\s+.*test.*;\n`)
-	content = testImportRegex.ReplaceAllString(content, "")
-	
-	assertMacroRegex := regexp.MustCompile(`(?m)^[ \t]*assert.*!.*;\n`)
-	content = assertMacroRegex.ReplaceAllString(content, "")
-	
-	return content
+	return removeTestBlocks(content, rustSyntax, matchRustTest)
+}
+
+// matchRustTest matches items under #[cfg(test)], #[test] or #[bench]
+// together with their other attributes, and lines holding a use of a test
+// crate or an assert macro.
+func matchRustTest(s codeScanner, i, line int) (int, int) {
+	if s.content[i] == '#' {
+		if !isRustTestAttribute(s, i) {
+			return -1, -1
+		}
+		j := i
+		for j < len(s.content) && s.content[j] == '#' {
+			if j+1 >= len(s.content) || s.content[j+1] != '[' {
+				return -1, -1
+			}
+			if j = s.balanced(j + 1); j < 0 {
+				return -1, -1
+			}
+			j = s.skipSpace(j)
+		}
+		return s.lineRange(i, line, s.item(j))
+	}
+
+	if line < 0 {
+		return -1, -1
+	}
+	word := s.word(i)
+	switch {
+	case word == "use":
+		if end := s.item(i); end > 0 && s.content[end-1] == ';' && strings.Contains(s.content[i:end], "test") {
+			return s.lineRange(i, line, end)
+		}
+	case strings.HasPrefix(word, "assert"):
+		if j := i + len(word); j < len(s.content) && s.content[j] == '!' {
+			return s.lineRange(i, line, s.item(j))
+		}
+	}
+	return -1, -1
+}
+
+// isRustTestAttribute reports whether the attribute at i marks test code.
+func isRustTestAttribute(s codeScanner, i int) bool {
+	if i+1 >= len(s.content) || s.content[i+1] != '[' {
+		return false
+	}
+	end := s.balanced(i + 1)
+	if end < 0 {
+		return false
+	}
+	switch strings.Join(strings.Fields(s.content[i+2:end-1]), "") {
+	case "test", "bench", "cfg(test)", "tokio::test":
+		return true
+	}
+	return false
 }
 
 func (r *RustProcessor) SupportsSpecialFiles() map[string]bool {
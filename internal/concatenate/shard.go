@@ -0,0 +1,191 @@
+package concatenate
+
+import (
+	"encoding/json"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+
+	"github.com/vitruves/gop/internal/compress"
+	"github.com/vitruves/gop/internal/walker"
+)
+
+// output routes processed chunks, numbered in walk order, either to a single
+// ordered writer or to the writer of the shard that holds each file. Every
+// shard is a contiguous run of files with its own reorder window, so shards
+// fill concurrently.
+type output struct {
+	writers []*orderedWriter
+	first   []int
+	paths   []string
+	files   []*compress.Lazy
+	// gate, when set, admits chunks against a budget before they are routed.
+	gate *admitGate
+}
+
+func newOutput(w io.Writer, window int) *output {
+	return &output{writers: []*orderedWriter{newOrderedWriter(w, window)}, first: []int{0}}
+}
+
+// newShardedOutput splits files into shards named after config.OutputFile,
+// either config.Shards of them or as many as it takes to keep each near
+// config.ShardSize bytes. Shards end on file boundaries.
+func newShardedOutput(files []walker.File, config Config, window int) *output {
+	o := &output{}
+	for _, first := range shardStarts(files, config) {
+		file := &compress.Lazy{Path: shardPath(config.OutputFile, len(o.paths)+1)}
+		writer := newOrderedWriter(file, window)
+		writer.spans = []chunkSpan{}
+
+		o.writers = append(o.writers, writer)
+		o.first = append(o.first, first)
+		o.paths = append(o.paths, file.Path)
+		o.files = append(o.files, file)
+	}
+	return o
+}
+
+// shardStarts returns the index of the first file of every shard, cutting by
+// the estimated output size of each file.
+func shardStarts(files []walker.File, config Config) []int {
+	if len(files) == 0 {
+		return []int{0}
+	}
+
+	sizes := make([]int64, len(files))
+	var total int64
+	for i, file := range files {
+		sizes[i] = estimateOutputBytes(file, config)
+		total += sizes[i]
+	}
+
+	starts := []int{0}
+	var size, done int64
+	for i := range files {
+		var full bool
+		if config.ShardSize > 0 {
+			full = size > 0 && size+sizes[i] > config.ShardSize
+		} else {
+			// Cut once the files so far fill the shards so far.
+			full = size > 0 && len(starts) < config.Shards && done*int64(config.Shards) >= total*int64(len(starts))
+		}
+		if full {
+			starts = append(starts, i)
+			size = 0
+		}
+		size += sizes[i]
+		done += sizes[i]
+	}
+	return starts
+}
+
+// shardPath names shard n after output: out.txt becomes out-0001.txt, and
+// out.txt.gz out-0001.txt.gz.
+func shardPath(output string, n int) string {
+	base := compress.Trim(output)
+	ext := filepath.Ext(base) + output[len(base):]
+	return fmt.Sprintf("%s-%04d%s", strings.TrimSuffix(output, ext), n, ext)
+}
+
+// manifestPath names the index written next to the shards of output. Its
+// offsets are into the uncompressed shards.
+func manifestPath(output string) string {
+	base := compress.Trim(output)
+	return strings.TrimSuffix(base, filepath.Ext(base)) + ".manifest.json"
+}
+
+// writer returns the writer for the chunk at walk index idx and the index
+// of the chunk within it.
+func (o *output) writer(idx int) (*orderedWriter, int) {
+	if len(o.writers) == 1 {
+		return o.writers[0], idx
+	}
+	k := sort.SearchInts(o.first, idx+1) - 1
+	return o.writers[k], idx - o.first[k]
+}
+
+// put hands over the chunk for walk index idx.
+func (o *output) put(idx int, chunk string) {
+	if o.gate != nil {
+		o.gate.put(idx, chunk)
+		return
+	}
+	o.route(idx, chunk)
+}
+
+func (o *output) route(idx int, chunk string) {
+	writer, local := o.writer(idx)
+	writer.put(local, chunk)
+}
+
+func (o *output) flush() error {
+	for _, w := range o.writers {
+		if err := w.flush(); err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+// close closes the output files once; later calls do nothing.
+func (o *output) close() error {
+	var first error
+	for _, file := range o.files {
+		if err := file.Close(); err != nil && first == nil {
+			first = err
+		}
+	}
+	o.files = nil
+	return first
+}
+
+// manifest maps every written source file to its shard and byte range, so a
+// consumer can seek straight to one file.
+type manifest struct {
+	Shards []manifestShard `json:"shards"`
+	Files  []manifestFile  `json:"files"`
+}
+
+type manifestShard struct {
+	Path  string `json:"path"`
+	Files int    `json:"files"`
+	Bytes int64  `json:"bytes"`
+}
+
+type manifestFile struct {
+	Path   string `json:"path"`
+	Shard  int    `json:"shard"`
+	Offset int64  `json:"offset"`
+	Length int64  `json:"length"`
+}
+
+// writeManifest records where each of files ended up. Files that produced no
+// output are left out.
+func (o *output) writeManifest(path string, files []walker.File) error {
+	m := manifest{Shards: make([]manifestShard, len(o.writers)), Files: []manifestFile{}}
+	for k, w := range o.writers {
+		m.Shards[k].Path = filepath.Base(o.paths[k])
+		for local, span := range w.spans {
+			if span.length == 0 {
+				continue
+			}
+			m.Files = append(m.Files, manifestFile{
+				Path:   files[o.first[k]+local].Path,
+				Shard:  k,
+				Offset: span.offset,
+				Length: span.length,
+			})
+			m.Shards[k].Files++
+			m.Shards[k].Bytes += span.length
+		}
+	}
+
+	data, err := json.MarshalIndent(m, "", "  ")
+	if err != nil {
+		return err
+	}
+	return os.WriteFile(path, data, 0644)
+}
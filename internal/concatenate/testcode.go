@@ -0,0 +1,251 @@
+package concatenate
+
+import "strings"
+
+// codeScanner gives test-code matchers literal- and comment-aware access to
+// one file.
+type codeScanner struct {
+	content string
+	syntax  commentSyntax
+}
+
+// testMatcher decides whether test code starts at offset i, a word start or
+// a '#'. line is the start of the current line when only indentation
+// precedes i, and -1 otherwise. It returns the range to delete, or -1s.
+type testMatcher func(s codeScanner, i, line int) (start, end int)
+
+// removeTestBlocks deletes every range match reports in a single pass over
+// content, stepping over comments and literals so that neither can start a
+// match. Kept code is copied once into a buffer sized for the file.
+func removeTestBlocks(content string, syntax commentSyntax, match testMatcher) string {
+	s := codeScanner{content: content, syntax: syntax}
+	var out strings.Builder
+	last := 0
+	line := 0
+
+	for i := 0; i < len(content); {
+		c := content[i]
+		switch {
+		case c == '\n':
+			i++
+			line = i
+			continue
+		case c == ' ' || c == '\t' || c == '\r':
+			i++
+			continue
+		}
+
+		if end := s.skipComment(i); end > i {
+			i = end
+			line = -1
+			continue
+		}
+		if end := literalEnd(content, i, syntax); end > i {
+			i = end
+			line = -1
+			continue
+		}
+
+		if c == '#' || isWordByte(c) && (i == 0 || !isWordByte(content[i-1])) {
+			if start, end := match(s, i, line); end > start && start >= last {
+				last = cut(&out, content, last, start, end)
+				i = end
+				line = -1
+				if end > 0 && content[end-1] == '\n' {
+					line = end
+				}
+				continue
+			}
+		}
+
+		i++
+		line = -1
+	}
+
+	return finish(&out, content, last)
+}
+
+// skipComment returns the offset after a comment starting at i, or i.
+func (s codeScanner) skipComment(i int) int {
+	content := s.content
+	if content[i] != '/' || i+1 >= len(content) {
+		return i
+	}
+	switch content[i+1] {
+	case '/':
+		if end := strings.IndexByte(content[i:], '\n'); end >= 0 {
+			return i + end
+		}
+		return len(content)
+	case '*':
+		if end := blockCommentEnd(content, i, s.syntax.nestedBlocks); end >= 0 {
+			return end
+		}
+		return len(content)
+	}
+	return i
+}
+
+// skipSpace returns the first offset from i that is neither whitespace nor
+// part of a comment.
+func (s codeScanner) skipSpace(i int) int {
+	for i < len(s.content) {
+		switch s.content[i] {
+		case ' ', '\t', '\r', '\n':
+			i++
+			continue
+		}
+		if end := s.skipComment(i); end > i {
+			i = end
+			continue
+		}
+		break
+	}
+	return i
+}
+
+// word returns the identifier starting at i.
+func (s codeScanner) word(i int) string {
+	end := i
+	for end < len(s.content) && isWordByte(s.content[end]) {
+		end++
+	}
+	return s.content[i:end]
+}
+
+// balanced returns the offset after the bracket matching the one at i,
+// or -1 when it is never closed.
+func (s codeScanner) balanced(i int) int {
+	open := s.content[i]
+	var close byte
+	switch open {
+	case '(':
+		close = ')'
+	case '{':
+		close = '}'
+	case '[':
+		close = ']'
+	default:
+		return -1
+	}
+
+	depth := 0
+	for j := i; j < len(s.content); {
+		if end := s.skipComment(j); end > j {
+			j = end
+			continue
+		}
+		if end := literalEnd(s.content, j, s.syntax); end > j {
+			j = end
+			continue
+		}
+		switch s.content[j] {
+		case open:
+			depth++
+		case close:
+			if depth--; depth == 0 {
+				return j + 1
+			}
+		}
+		j++
+	}
+	return -1
+}
+
+// lineEnd returns the offset after the newline ending the line at i.
+func (s codeScanner) lineEnd(i int) int {
+	if end := strings.IndexByte(s.content[i:], '\n'); end >= 0 {
+		return i + end + 1
+	}
+	return len(s.content)
+}
+
+// macroBlock matches NAME(...) { ... } where the name ends at i and returns
+// the offset after the closing brace.
+func (s codeScanner) macroBlock(i int) int {
+	i = s.skipSpace(i)
+	if i >= len(s.content) || s.content[i] != '(' {
+		return -1
+	}
+	if i = s.balanced(i); i < 0 {
+		return -1
+	}
+	return s.body(i)
+}
+
+// body returns the offset after the brace-balanced block opening at the
+// first non-space offset from i.
+func (s codeScanner) body(i int) int {
+	i = s.skipSpace(i)
+	if i >= len(s.content) || s.content[i] != '{' {
+		return -1
+	}
+	return s.balanced(i)
+}
+
+// statementLine matches NAME(...); ending at i and returns the offset after
+// the rest of its line.
+func (s codeScanner) statementLine(i int) int {
+	i = s.skipSpace(i)
+	if i >= len(s.content) || s.content[i] != '(' {
+		return -1
+	}
+	if i = s.balanced(i); i < 0 {
+		return -1
+	}
+	i = s.skipSpace(i)
+	if i >= len(s.content) || s.content[i] != ';' {
+		return -1
+	}
+	return s.lineEnd(i)
+}
+
+// item returns the offset after the item starting at i: up to a ';' or
+// through a brace-balanced body, whichever comes first outside brackets.
+func (s codeScanner) item(i int) int {
+	for i < len(s.content) {
+		if end := s.skipComment(i); end > i {
+			i = end
+			continue
+		}
+		if end := literalEnd(s.content, i, s.syntax); end > i {
+			i = end
+			continue
+		}
+		switch s.content[i] {
+		case ';':
+			return i + 1
+		case '{':
+			return s.balanced(i)
+		case '(', '[':
+			if i = s.balanced(i); i < 0 {
+				return -1
+			}
+			continue
+		}
+		i++
+	}
+	return -1
+}
+
+// lineRange widens a match starting at i to its indentation when it starts
+// the line, and to the line break that follows when nothing else does.
+func (s codeScanner) lineRange(i, line, end int) (int, int) {
+	if end < 0 {
+		return -1, -1
+	}
+	if line < 0 {
+		return i, end
+	}
+	rest := end
+	for rest < len(s.content) && (s.content[rest] == ' ' || s.content[rest] == '\t' || s.content[rest] == '\r') {
+		rest++
+	}
+	if rest == len(s.content) {
+		return line, rest
+	}
+	if s.content[rest] == '\n' {
+		return line, rest + 1
+	}
+	return line, end
+}
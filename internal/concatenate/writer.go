@@ -0,0 +1,139 @@
+package concatenate
+
+import (
+	"bufio"
+	"io"
+	"sync"
+
+	"github.com/vitruves/gop/internal/memlimit"
+)
+
+// reorderWindowPerJob bounds how many processed files may wait in memory for
+// their turn to be written, relative to the number of workers.
+const reorderWindowPerJob = 4
+
+// orderedWriter receives processed chunks out of order from the workers and
+// writes them to the underlying writer strictly in index order.
+type orderedWriter struct {
+	out     *bufio.Writer
+	mu      sync.Mutex
+	next    int
+	pending map[int]string
+	slots   chan struct{}
+	err     error
+	// limit, when set, bounds the bytes of chunks between acquire and the
+	// write; weights holds what each of them took, in index order.
+	limit   *memlimit.Limit
+	weights []int64
+	// spans, when not nil, records where each chunk landed, by index.
+	spans  []chunkSpan
+	offset int64
+}
+
+// chunkSpan is the byte range of one chunk in the output; length is zero for
+// chunks that were empty or not admitted.
+type chunkSpan struct {
+	offset int64
+	length int64
+}
+
+func newOrderedWriter(w io.Writer, window int) *orderedWriter {
+	if window < 1 {
+		window = 1
+	}
+	return &orderedWriter{
+		out:     bufio.NewWriterSize(w, 256*1024),
+		pending: make(map[int]string),
+		slots:   make(chan struct{}, window),
+	}
+}
+
+// acquire blocks until the reorder window has room for one more chunk and
+// the memory limit for weight more bytes. It must be called in index order,
+// before the chunk is processed.
+func (w *orderedWriter) acquire(weight int64) {
+	w.slots <- struct{}{}
+	if w.limit == nil {
+		return
+	}
+	w.limit.Acquire(weight)
+	w.mu.Lock()
+	w.weights = append(w.weights, weight)
+	w.mu.Unlock()
+}
+
+// put hands over the chunk for index idx. An empty chunk still advances the
+// sequence, so failed files do not stall the writer.
+func (w *orderedWriter) put(idx int, chunk string) {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	w.pending[idx] = chunk
+	for {
+		content, ok := w.pending[w.next]
+		if !ok {
+			return
+		}
+		delete(w.pending, w.next)
+		span := chunkSpan{offset: w.offset}
+		if w.err == nil && content != "" {
+			_, w.err = w.out.WriteString(content)
+			span.length = int64(len(content))
+			w.offset += span.length
+		}
+		if w.spans != nil {
+			w.spans = append(w.spans, span)
+		}
+		w.next++
+		<-w.slots
+		if w.limit != nil {
+			w.limit.Release(w.weights[0])
+			w.weights = w.weights[1:]
+		}
+	}
+}
+
+// admitGate decides on chunks in walk index order before they are routed
+// to their writer, so a budget shared by several shards sees them in one
+// order however the shards interleave. Dropped chunks are passed on empty.
+type admitGate struct {
+	mu      sync.Mutex
+	next    int
+	pending map[int]string
+	admit   func(chunk string) bool
+	route   func(idx int, chunk string)
+}
+
+func newAdmitGate(admit func(chunk string) bool, route func(idx int, chunk string)) *admitGate {
+	return &admitGate{pending: make(map[int]string), admit: admit, route: route}
+}
+
+func (g *admitGate) put(idx int, chunk string) {
+	g.mu.Lock()
+	defer g.mu.Unlock()
+
+	g.pending[idx] = chunk
+	for {
+		content, ok := g.pending[g.next]
+		if !ok {
+			return
+		}
+		delete(g.pending, g.next)
+		if content != "" && !g.admit(content) {
+			content = ""
+		}
+		g.route(g.next, content)
+		g.next++
+	}
+}
+
+// flush writes any buffered output and returns the first write error.
+func (w *orderedWriter) flush() error {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	if w.err != nil {
+		return w.err
+	}
+	return w.out.Flush()
+}
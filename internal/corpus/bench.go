@@ -0,0 +1,56 @@
+package corpus
+
+import (
+	"fmt"
+	"os"
+	"path/filepath"
+	"testing"
+)
+
+// EachSource runs fn as a sub-benchmark named language/size for every
+// language and size. The source is generated once up front and also written
+// to path, for code that reads files; throughput is reported in MB/s.
+func EachSource(b *testing.B, fn func(b *testing.B, language, path, source string)) {
+	sizes := Sizes
+	if Full() {
+		sizes = FullSizes
+	}
+	dir := b.TempDir()
+	for _, language := range Languages {
+		for _, size := range sizes {
+			source := Source(language, size, 1)
+			path := filepath.Join(dir, language+"-"+SizeName(size)+Extension(language))
+			if err := os.WriteFile(path, []byte(source), 0644); err != nil {
+				b.Fatalf("Failed to write corpus: %v", err)
+			}
+			b.Run(language+"/"+SizeName(size), func(b *testing.B) {
+				b.SetBytes(int64(len(source)))
+				b.ReportAllocs()
+				b.ResetTimer()
+				fn(b, language, path, source)
+			})
+		}
+	}
+}
+
+// EachTree runs fn as a sub-benchmark named files=N for every file count,
+// on a tree of language files of about size bytes each generated once
+// below b.TempDir(), and reports throughput in files/s.
+func EachTree(b *testing.B, language string, size int, fn func(b *testing.B, dir string, files int)) {
+	counts := FileCounts
+	if Full() {
+		counts = FullFileCounts
+	}
+	for _, files := range counts {
+		dir := b.TempDir()
+		if _, err := Tree(dir, language, files, size, 1); err != nil {
+			b.Fatalf("Failed to generate corpus: %v", err)
+		}
+		b.Run(fmt.Sprintf("files=%d", files), func(b *testing.B) {
+			b.ReportAllocs()
+			b.ResetTimer()
+			fn(b, dir, files)
+			b.ReportMetric(float64(files)*float64(b.N)/b.Elapsed().Seconds(), "files/s")
+		})
+	}
+}
@@ -0,0 +1,312 @@
+// Package corpus generates deterministic synthetic source code for
+// benchmarks. The same language, size and seed always give the same bytes,
+// so throughput can be compared across releases.
+package corpus
+
+import (
+	"fmt"
+	"math/rand"
+	"os"
+	"path/filepath"
+	"strings"
+)
+
+// Languages are the languages Source can generate.
+var Languages = []string{"go", "python", "rust", "c", "cpp"}
+
+// Sizes are the file sizes benchmarks sweep by default; FullSizes adds the
+// ones that take minutes, for when GOP_BENCH_FULL is set.
+var (
+	Sizes     = []int{1 << 10, 64 << 10, 1 << 20}
+	FullSizes = []int{1 << 10, 64 << 10, 1 << 20, 16 << 20, 100 << 20}
+)
+
+// FileCounts are the tree sizes benchmarks sweep by default, and
+// FullFileCounts those for GOP_BENCH_FULL.
+var (
+	FileCounts     = []int{10, 1000}
+	FullFileCounts = []int{10, 1000, 100000, 1000000}
+)
+
+// Full reports whether benchmarks should sweep the full ranges.
+func Full() bool {
+	return os.Getenv("GOP_BENCH_FULL") != ""
+}
+
+// Extension returns the file extension used for language.
+func Extension(language string) string {
+	switch language {
+	case "python":
+		return ".py"
+	case "rust":
+		return ".rs"
+	case "c":
+		return ".c"
+	case "cpp":
+		return ".cpp"
+	default:
+		return ".go"
+	}
+}
+
+// SizeName formats a byte count for a benchmark name, as 1KB, 64KB or 1MB.
+func SizeName(size int) string {
+	if size >= 1<<20 && size%(1<<20) == 0 {
+		return fmt.Sprintf("%dMB", size>>20)
+	}
+	return fmt.Sprintf("%dKB", size>>10)
+}
+
+// Source returns at least size bytes of source code in language, made of
+// whole functions with comments, test code, string literals that look like
+// comments and the odd TODO, in the proportions of real code.
+func Source(language string, size int, seed int64) string {
+	g := &generator{rand: rand.New(rand.NewSource(seed))}
+	g.out.Grow(size + 1024)
+
+	unit := unitFor(language)
+	g.header(language)
+	for k := 0; g.out.Len() < size; k++ {
+		unit(g, k)
+	}
+	if language == "cpp" {
+		g.printf("}  // namespace bench\n")
+	}
+	return g.out.String()
+}
+
+// Tree writes files source files of about size bytes each below dir, at most
+// 100 per directory, and returns their paths in walk order. File i is
+// generated from seed+i, so a tree's prefix does not depend on its length.
+func Tree(dir, language string, files, size int, seed int64) ([]string, error) {
+	paths := make([]string, 0, files)
+	ext := Extension(language)
+	for i := 0; i < files; i++ {
+		path := filepath.Join(dir, fmt.Sprintf("p%03d", i/10000), fmt.Sprintf("q%02d", i/100%100), fmt.Sprintf("f%02d%s", i%100, ext))
+		if i%100 == 0 {
+			if err := os.MkdirAll(filepath.Dir(path), 0755); err != nil {
+				return nil, err
+			}
+		}
+		if err := os.WriteFile(path, []byte(Source(language, size, seed+int64(i))), 0644); err != nil {
+			return nil, err
+		}
+		paths = append(paths, path)
+	}
+	return paths, nil
+}
+
+type generator struct {
+	rand *rand.Rand
+	out  strings.Builder
+}
+
+var words = []string{
+	"parse", "value", "buffer", "node", "index", "token", "state", "entry",
+	"cache", "frame", "chunk", "range", "count", "depth", "scope", "store",
+	"merge", "split", "write", "read", "load", "scan", "walk", "emit",
+}
+
+func (g *generator) printf(format string, args ...interface{}) {
+	fmt.Fprintf(&g.out, format, args...)
+}
+
+// name returns the identifier of unit k, built as lowerCamel, UpperCamel or
+// snake_case from two words.
+func (g *generator) name(k int, style byte) string {
+	a, b := words[(k*7)%len(words)], words[(k*13+5)%len(words)]
+	switch style {
+	case 'U':
+		return fmt.Sprintf("%s%s%d", title(a), title(b), k)
+	case 's':
+		return fmt.Sprintf("%s_%s_%d", a, b, k)
+	default:
+		return fmt.Sprintf("%s%s%d", a, title(b), k)
+	}
+}
+
+func title(word string) string {
+	return strings.ToUpper(word[:1]) + word[1:]
+}
+
+func (g *generator) chance(n int) bool {
+	return g.rand.Intn(n) == 0
+}
+
+func (g *generator) header(language string) {
+	switch language {
+	case "go":
+		g.printf("// Package bench is generated.\npackage bench\n\nimport (\n\t\"fmt\"\n\t\"testing\"\n)\n\n")
+	case "python":
+		g.printf("\"\"\"Generated module.\"\"\"\n\nimport os\nimport unittest\n\n")
+	case "rust":
+		g.printf("//! Generated crate.\n\nuse std::collections::HashMap;\n\n")
+	case "c":
+		g.printf("/* Generated translation unit. */\n#include <stdio.h>\n#include <string.h>\n\n")
+	case "cpp":
+		g.printf("// Generated translation unit.\n#include <string>\n#include <vector>\n#include <gtest/gtest.h>\n\nnamespace bench {\n\n")
+	}
+}
+
+func unitFor(language string) func(*generator, int) {
+	switch language {
+	case "python":
+		return (*generator).pythonUnit
+	case "rust":
+		return (*generator).rustUnit
+	case "c":
+		return (*generator).cUnit
+	case "cpp":
+		return (*generator).cppUnit
+	default:
+		return (*generator).goUnit
+	}
+}
+
+func (g *generator) goUnit(k int) {
+	name := g.goName(k)
+	g.printf("// %s %ss the %s.\n", name, words[k%len(words)], words[(k+3)%len(words)])
+	if g.chance(10) {
+		g.printf("// TODO: handle the empty case.\n")
+	}
+	g.printf("func %s(items []string, limit int) (int, error) {\n", name)
+	g.printf("\ttotal := 0\n\tfor i, item := range items {\n")
+	g.printf("\t\tif i >= limit {\n\t\t\tbreak\n\t\t}\n")
+	g.printf("\t\ttotal += len(item) /* inline */ + %d\n\t}\n", g.rand.Intn(100))
+	if g.chance(3) {
+		g.printf("\tmsg := \"// not a comment /* nor this */\"\n\t_ = msg\n")
+	}
+	if k > 0 && g.chance(2) {
+		g.printf("\tif n, err := %s(items, limit-1); err == nil {\n\t\ttotal += n\n\t}\n", g.goName(g.rand.Intn(k)))
+	}
+	if g.chance(8) {
+		g.printf("\tfmt.Println(\"debug:\", total)\n")
+	}
+	g.printf("\treturn total, nil\n}\n\n")
+
+	if g.chance(6) {
+		g.printf("func Test%s(t *testing.T) {\n\tif _, err := %s(nil, 1); err != nil {\n\t\tt.Fatal(err)\n\t}\n}\n\n", g.name(k, 'U'), name)
+	}
+}
+
+// goName names Go unit k, which is exported for odd k.
+func (g *generator) goName(k int) string {
+	if k%2 == 1 {
+		return g.name(k, 'U')
+	}
+	return g.name(k, 'l')
+}
+
+func (g *generator) pythonUnit(k int) {
+	name := g.name(k, 's')
+	if g.chance(4) {
+		g.printf("@staticmethod\n")
+	}
+	g.printf("def %s(items, limit=10):\n", name)
+	g.printf("    \"\"\"%s the %s.\n\n    # not a comment inside a docstring\n    \"\"\"\n", title(words[k%len(words)]), words[(k+3)%len(words)])
+	if g.chance(10) {
+		g.printf("    # TODO: handle the empty case\n")
+	}
+	g.printf("    total = 0\n    for i, item in enumerate(items):  # walk\n")
+	g.printf("        if i >= limit:\n            break\n")
+	g.printf("        total += len(item) + %d\n", g.rand.Intn(100))
+	if g.chance(3) {
+		g.printf("    msg = \"# not a comment\"\n")
+	}
+	if k > 0 && g.chance(2) {
+		g.printf("    total += %s(items, limit - 1)\n", g.name(g.rand.Intn(k), 's'))
+	}
+	if g.chance(8) {
+		g.printf("    print(\"debug:\", total)\n")
+	}
+	g.printf("    return total\n\n\n")
+
+	if g.chance(6) {
+		g.printf("def test_%s():\n    assert %s([], 1) == 0\n\n\n", name, name)
+	}
+	if g.chance(12) {
+		g.printf("class Test%s(unittest.TestCase):\n    def test_limit(self):\n        self.assertEqual(%s([\"a\"], 0), 0)\n\n\n", g.name(k, 'U'), name)
+	}
+}
+
+func (g *generator) rustUnit(k int) {
+	name := g.name(k, 's')
+	g.printf("/// %s the %s.\n", title(words[k%len(words)]), words[(k+3)%len(words)])
+	if g.chance(10) {
+		g.printf("// TODO: handle the empty case.\n")
+	}
+	if g.chance(2) {
+		g.printf("pub ")
+	}
+	g.printf("fn %s(items: &[String], limit: usize) -> usize {\n", name)
+	g.printf("    let mut total = 0;\n    for (i, item) in items.iter().enumerate() {\n")
+	g.printf("        if i >= limit {\n            break;\n        }\n")
+	g.printf("        total += item.len() /* inline */ + %d;\n    }\n", g.rand.Intn(100))
+	if g.chance(3) {
+		g.printf("    let _msg = \"// not a comment /* nor this */\";\n")
+	}
+	if k > 0 && g.chance(2) {
+		g.printf("    total += %s(items, limit.saturating_sub(1));\n", g.name(g.rand.Intn(k), 's'))
+	}
+	if g.chance(8) {
+		g.printf("    println!(\"debug: {}\", total);\n")
+	}
+	g.printf("    total\n}\n\n")
+
+	if g.chance(6) {
+		g.printf("#[cfg(test)]\nmod tests_%d {\n    use super::*;\n\n    #[test]\n    fn empty() {\n        assert_eq!(%s(&[], 1), 0);\n    }\n}\n\n", k, name)
+	}
+}
+
+func (g *generator) cUnit(k int) {
+	name := g.name(k, 's')
+	g.printf("/*\n * %s the %s.\n */\n", title(words[k%len(words)]), words[(k+3)%len(words)])
+	if g.chance(10) {
+		g.printf("// TODO: handle the empty case.\n")
+	}
+	if g.chance(3) {
+		g.printf("static ")
+	}
+	g.printf("int %s(const char **items, int count, int limit) {\n", name)
+	g.printf("    int total = 0;\n    for (int i = 0; i < count && i < limit; i++) {\n")
+	g.printf("        total += (int)strlen(items[i]) /* inline */ + %d;\n    }\n", g.rand.Intn(100))
+	if g.chance(3) {
+		g.printf("    const char *msg = \"// not a comment /* nor this */\";\n    (void)msg;\n")
+	}
+	if k > 0 && g.chance(2) {
+		g.printf("    total += %s(items, count, limit - 1);\n", g.name(g.rand.Intn(k), 's'))
+	}
+	if g.chance(8) {
+		g.printf("    printf(\"debug: %%d\\n\", total);\n")
+	}
+	g.printf("    return total;\n}\n\n")
+}
+
+func (g *generator) cppUnit(k int) {
+	name := g.name(k, 'l')
+	g.printf("// %s the %s.\n", title(words[k%len(words)]), words[(k+3)%len(words)])
+	if g.chance(10) {
+		g.printf("// TODO: handle the empty case.\n")
+	}
+	if k%4 == 3 {
+		g.printf("class %s {\npublic:\n    int %s(const std::vector<std::string>& items) const {\n        return static_cast<int>(items.size()) + %d;\n    }\n\nprivate:\n    int limit_ = %d;\n};\n\n",
+			g.name(k, 'U'), name, g.rand.Intn(100), g.rand.Intn(100))
+		return
+	}
+
+	g.printf("int %s(const std::vector<std::string>& items, int limit) {\n", name)
+	g.printf("    int total = 0;\n    for (const auto& item : items) {\n")
+	g.printf("        if (limit-- <= 0) {\n            break;\n        }\n")
+	g.printf("        total += static_cast<int>(item.size()) /* inline */ + %d;\n    }\n", g.rand.Intn(100))
+	if g.chance(3) {
+		g.printf("    std::string msg = \"// not a comment /* nor this */\";\n")
+	}
+	if k > 0 && g.chance(2) {
+		g.printf("    total += %s(items, limit - 1);\n", g.name(g.rand.Intn(k)/4*4, 'l'))
+	}
+	g.printf("    return total;\n}\n\n")
+
+	if g.chance(6) {
+		g.printf("TEST(%s, Empty) {\n    EXPECT_EQ(%s({}, 1), 0);\n}\n\n", g.name(k, 'U'), name)
+	}
+}
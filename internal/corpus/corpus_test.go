@@ -0,0 +1,56 @@
+package corpus
+
+import (
+	"go/parser"
+	"go/token"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+func TestSourceIsDeterministic(t *testing.T) {
+	for _, language := range Languages {
+		a := Source(language, 8<<10, 7)
+		if a != Source(language, 8<<10, 7) {
+			t.Errorf("%s: same seed should give the same source", language)
+		}
+		if a == Source(language, 8<<10, 8) {
+			t.Errorf("%s: different seeds should give different sources", language)
+		}
+		if len(a) < 8<<10 || len(a) > 9<<10 {
+			t.Errorf("%s: expected about 8KB, got %d bytes", language, len(a))
+		}
+		if !strings.Contains(a, "TODO") {
+			t.Errorf("%s: source should contain placeholders", language)
+		}
+	}
+}
+
+func TestGoSourceParses(t *testing.T) {
+	src := Source("go", 64<<10, 1)
+	if _, err := parser.ParseFile(token.NewFileSet(), "bench.go", src, parser.ParseComments); err != nil {
+		t.Errorf("Generated Go should parse: %v", err)
+	}
+}
+
+func TestTree(t *testing.T) {
+	dir := t.TempDir()
+	paths, err := Tree(dir, "rust", 150, 1<<10, 1)
+	if err != nil {
+		t.Fatalf("Tree failed: %v", err)
+	}
+	if len(paths) != 150 {
+		t.Fatalf("Expected 150 files, got %d", len(paths))
+	}
+	if want := filepath.Join(dir, "p000", "q01", "f49.rs"); paths[149] != want {
+		t.Errorf("Expected last file %s, got %s", want, paths[149])
+	}
+	data, err := os.ReadFile(paths[3])
+	if err != nil {
+		t.Fatalf("Failed to read file: %v", err)
+	}
+	if string(data) != Source("rust", 1<<10, 4) {
+		t.Error("File i should be generated from seed+i")
+	}
+}
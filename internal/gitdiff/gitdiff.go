@@ -0,0 +1,60 @@
+// Package gitdiff asks git which files changed, so commands can process just
+// those instead of walking the whole tree.
+package gitdiff
+
+import (
+	"bytes"
+	"fmt"
+	"os/exec"
+	"strings"
+)
+
+// ChangedFiles returns the files below the working directory that differ
+// from rev, committed or not, plus untracked files git does not ignore.
+// Unless rev is HEAD it is first reduced to its merge base with HEAD, so
+// "main" means the changes made since branching off main. Deleted files are
+// left out and paths are relative to the working directory. The result is
+// never nil.
+func ChangedFiles(rev string) ([]string, error) {
+	base := rev
+	if rev != "HEAD" {
+		if out, err := git("merge-base", rev, "HEAD"); err == nil {
+			base = strings.TrimSpace(string(out))
+		}
+	}
+
+	diff, err := git("diff", "--name-only", "--relative", "--diff-filter=d", "-z", base, "--")
+	if err != nil {
+		return nil, err
+	}
+	untracked, err := git("ls-files", "--others", "--exclude-standard", "-z")
+	if err != nil {
+		return nil, err
+	}
+
+	files := []string{}
+	seen := make(map[string]bool)
+	for _, list := range [][]byte{diff, untracked} {
+		for _, name := range bytes.Split(list, []byte{0}) {
+			if len(name) > 0 && !seen[string(name)] {
+				seen[string(name)] = true
+				files = append(files, string(name))
+			}
+		}
+	}
+	return files, nil
+}
+
+func git(args ...string) ([]byte, error) {
+	cmd := exec.Command("git", args...)
+	var stderr bytes.Buffer
+	cmd.Stderr = &stderr
+	out, err := cmd.Output()
+	if err != nil {
+		if msg := strings.TrimSpace(stderr.String()); msg != "" {
+			return nil, fmt.Errorf("git %s: %s", args[0], msg)
+		}
+		return nil, fmt.Errorf("git %s: %w", args[0], err)
+	}
+	return out, nil
+}
@@ -0,0 +1,73 @@
+package gitdiff
+
+import (
+	"os"
+	"os/exec"
+	"path/filepath"
+	"sort"
+	"strings"
+	"testing"
+)
+
+func run(t *testing.T, dir string, args ...string) {
+	t.Helper()
+	cmd := exec.Command("git", args...)
+	cmd.Dir = dir
+	cmd.Env = append(os.Environ(), "GIT_AUTHOR_NAME=t", "GIT_AUTHOR_EMAIL=t@t", "GIT_COMMITTER_NAME=t", "GIT_COMMITTER_EMAIL=t@t")
+	if out, err := cmd.CombinedOutput(); err != nil {
+		t.Fatalf("git %v: %v\n%s", args, err, out)
+	}
+}
+
+func write(t *testing.T, dir, name, content string) {
+	t.Helper()
+	path := filepath.Join(dir, name)
+	os.MkdirAll(filepath.Dir(path), 0755)
+	if err := os.WriteFile(path, []byte(content), 0644); err != nil {
+		t.Fatalf("Failed to write %s: %v", name, err)
+	}
+}
+
+func TestChangedFiles(t *testing.T) {
+	if _, err := exec.LookPath("git"); err != nil {
+		t.Skip("git not installed")
+	}
+
+	dir := t.TempDir()
+	run(t, dir, "init", "-q", "-b", "main")
+	write(t, dir, "a.go", "package a\n")
+	write(t, dir, "src/b.go", "package b\n")
+	write(t, dir, "src/c.go", "package c\n")
+	write(t, dir, ".gitignore", "*.log\n")
+	run(t, dir, "add", ".")
+	run(t, dir, "commit", "-q", "-m", "base")
+
+	run(t, dir, "checkout", "-q", "-b", "feature")
+	write(t, dir, "src/b.go", "package b // committed\n")
+	run(t, dir, "commit", "-q", "-am", "change b")
+	write(t, dir, "src/c.go", "package c // uncommitted\n")
+	write(t, dir, "src/new.go", "package c\n")
+	write(t, dir, "src/debug.log", "ignored\n")
+	run(t, dir, "rm", "-q", "a.go")
+
+	wd, _ := os.Getwd()
+	defer os.Chdir(wd)
+	os.Chdir(filepath.Join(dir, "src"))
+
+	check := func(rev string, expected ...string) {
+		files, err := ChangedFiles(rev)
+		if err != nil {
+			t.Fatalf("ChangedFiles(%s) failed: %v", rev, err)
+		}
+		sort.Strings(files)
+		if strings.Join(files, ",") != strings.Join(expected, ",") {
+			t.Errorf("ChangedFiles(%s): expected %v, got %v", rev, expected, files)
+		}
+	}
+	check("main", "b.go", "c.go", "new.go")
+	check("HEAD", "c.go", "new.go")
+
+	if _, err := ChangedFiles("no-such-rev"); err == nil {
+		t.Error("Expected an error for an unknown revision")
+	}
+}
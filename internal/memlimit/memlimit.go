@@ -0,0 +1,176 @@
+// Package memlimit bounds the memory a run holds at once. Files are admitted
+// by their size through a weighted semaphore, so a few huge files hold back
+// the walk as much as many small ones, and results kept until the end of the
+// run are counted against the same limit so their owner knows when to move
+// them to disk. A nil *Limit has no bound, so callers do not need to
+// special-case a run without --max-memory.
+package memlimit
+
+import (
+	"fmt"
+	"os"
+	"sync"
+)
+
+// Limit is a byte budget shared by the files in flight and the results a
+// run retains.
+type Limit struct {
+	max int64
+
+	mu       sync.Mutex
+	cond     *sync.Cond
+	inFlight int64
+	retained int64
+}
+
+// New returns a limit of max bytes, or nil when max is not positive.
+func New(max int64) *Limit {
+	if max <= 0 {
+		return nil
+	}
+	l := &Limit{max: max}
+	l.cond = sync.NewCond(&l.mu)
+	return l
+}
+
+// Acquire blocks until n more bytes fit in the limit next to what is in
+// flight and retained. When nothing is in flight the request is granted
+// whatever its size, so a file larger than the limit, or a limit already
+// filled by retained results, makes the run slower rather than stuck.
+func (l *Limit) Acquire(n int64) {
+	if l == nil {
+		return
+	}
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	for l.inFlight > 0 && l.inFlight+l.retained+n > l.max {
+		l.cond.Wait()
+	}
+	l.inFlight += n
+}
+
+// Release returns n bytes taken by Acquire.
+func (l *Limit) Release(n int64) {
+	if l == nil {
+		return
+	}
+	l.mu.Lock()
+	l.inFlight -= n
+	l.mu.Unlock()
+	l.cond.Broadcast()
+}
+
+// Retain counts n bytes of results kept in memory and reports whether
+// retained results now take more than half of the limit, the point at which
+// their owner should spill them.
+func (l *Limit) Retain(n int64) bool {
+	if l == nil {
+		return false
+	}
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	l.retained += n
+	return l.retained > l.max/2
+}
+
+// Free uncounts n retained bytes, as after they were spilled.
+func (l *Limit) Free(n int64) {
+	if l == nil {
+		return
+	}
+	l.mu.Lock()
+	l.retained -= n
+	l.mu.Unlock()
+	l.cond.Broadcast()
+}
+
+// Admit forwards items once their size is acquired, so at most the limit's
+// worth of them is between Admit and the Release the caller makes when an
+// item is done. Without a limit items is returned as is.
+func Admit[T any](l *Limit, items <-chan T, size func(T) int64) <-chan T {
+	if l == nil {
+		return items
+	}
+	admitted := make(chan T)
+	go func() {
+		defer close(admitted)
+		for item := range items {
+			l.Acquire(size(item))
+			admitted <- item
+		}
+	}()
+	return admitted
+}
+
+func (l *Limit) String() string {
+	if l == nil {
+		return "no limit"
+	}
+	l.mu.Lock()
+	defer l.mu.Unlock()
+	return fmt.Sprintf("%d of %d bytes in flight, %d retained", l.inFlight, l.max, l.retained)
+}
+
+// Spill is a temporary file that results are appended to once they no
+// longer fit in memory, and read back from by offset.
+type Spill struct {
+	file *os.File
+	size int64
+}
+
+// NewSpill creates an empty spill file in the system temporary directory.
+func NewSpill() (*Spill, error) {
+	file, err := os.CreateTemp("", "gop-spill-*")
+	if err != nil {
+		return nil, err
+	}
+	return &Spill{file: file}, nil
+}
+
+// Append writes p at the end of the file and returns its offset.
+func (s *Spill) Append(p []byte) (int64, error) {
+	offset := s.size
+	n, err := s.file.WriteAt(p, offset)
+	s.size += int64(n)
+	return offset, err
+}
+
+// Write appends p, so that a stream can be copied into the spill.
+func (s *Spill) Write(p []byte) (int, error) {
+	n, err := s.file.WriteAt(p, s.size)
+	s.size += int64(n)
+	return n, err
+}
+
+// ReadAt reads len(p) bytes at off, as io.ReaderAt. It is safe to call
+// from several goroutines once nothing is appended any more.
+func (s *Spill) ReadAt(p []byte, off int64) (int, error) {
+	return s.file.ReadAt(p, off)
+}
+
+// Read returns the length bytes at offset.
+func (s *Spill) Read(offset, length int64) ([]byte, error) {
+	buf := make([]byte, length)
+	_, err := s.file.ReadAt(buf, offset)
+	return buf, err
+}
+
+// Size is how many bytes were spilled.
+func (s *Spill) Size() int64 {
+	if s == nil {
+		return 0
+	}
+	return s.size
+}
+
+// Close closes and deletes the file. A nil *Spill is closed already.
+func (s *Spill) Close() error {
+	if s == nil {
+		return nil
+	}
+	err := s.file.Close()
+	if rerr := os.Remove(s.file.Name()); err == nil {
+		err = rerr
+	}
+	return err
+}
@@ -0,0 +1,105 @@
+package memlimit
+
+import (
+	"os"
+	"sync"
+	"sync/atomic"
+	"testing"
+)
+
+func TestLimitBoundsInFlight(t *testing.T) {
+	limit := New(100)
+	items := make(chan int64)
+	go func() {
+		defer close(items)
+		for i := 0; i < 200; i++ {
+			// One item is larger than the whole limit and must still pass.
+			if i == 50 {
+				items <- 500
+				continue
+			}
+			items <- int64(10 + i%30)
+		}
+	}()
+
+	var inFlight, peak atomic.Int64
+	var wg sync.WaitGroup
+	count := 0
+	for size := range Admit(limit, items, func(n int64) int64 { return n }) {
+		count++
+		wg.Add(1)
+		go func(size int64) {
+			defer wg.Done()
+			now := inFlight.Add(size)
+			for {
+				old := peak.Load()
+				if now <= old || peak.CompareAndSwap(old, now) {
+					break
+				}
+			}
+			inFlight.Add(-size)
+			limit.Release(size)
+		}(size)
+	}
+	wg.Wait()
+
+	if count != 200 {
+		t.Fatalf("Expected 200 items, got %d", count)
+	}
+	if peak.Load() > 500 {
+		t.Errorf("Expected at most 500 bytes in flight, peaked at %d", peak.Load())
+	}
+}
+
+func TestLimitRetain(t *testing.T) {
+	limit := New(100)
+	if limit.Retain(40) {
+		t.Error("Expected 40 of 100 bytes not to ask for a spill")
+	}
+	if !limit.Retain(20) {
+		t.Error("Expected 60 of 100 bytes to ask for a spill")
+	}
+	limit.Free(60)
+	if limit.Retain(10) {
+		t.Error("Expected freed bytes to stop counting")
+	}
+
+	var none *Limit
+	none.Acquire(1 << 40)
+	none.Release(1 << 40)
+	if none.Retain(1 << 40) {
+		t.Error("Expected no limit never to ask for a spill")
+	}
+}
+
+func TestSpill(t *testing.T) {
+	spill, err := NewSpill()
+	if err != nil {
+		t.Fatalf("Failed to create spill: %v", err)
+	}
+	name := spill.file.Name()
+
+	first, _ := spill.Append([]byte("hello "))
+	second, err := spill.Append([]byte("world"))
+	if err != nil || first != 0 || second != 6 || spill.Size() != 11 {
+		t.Fatalf("Unexpected offsets %d, %d and size %d (%v)", first, second, spill.Size(), err)
+	}
+	data, err := spill.Read(second, 5)
+	if err != nil || string(data) != "world" {
+		t.Errorf("Expected world at %d, got %q (%v)", second, data, err)
+	}
+	if n, err := spill.Write([]byte("!")); n != 1 || err != nil || spill.Size() != 12 {
+		t.Errorf("Expected Write to append, got %d, %v and size %d", n, err, spill.Size())
+	}
+	buf := make([]byte, 6)
+	if _, err := spill.ReadAt(buf, 6); err != nil || string(buf) != "world!" {
+		t.Errorf("Expected world! at 6, got %q (%v)", buf, err)
+	}
+
+	if err := spill.Close(); err != nil {
+		t.Errorf("Failed to close spill: %v", err)
+	}
+	if _, err := os.Stat(name); !os.IsNotExist(err) {
+		t.Errorf("Expected %s to be removed", name)
+	}
+}
@@ -0,0 +1,140 @@
+package pool
+
+import (
+	"sync"
+	"sync/atomic"
+	"time"
+)
+
+// progressInterval is how often batched progress is handed to the reporter.
+const progressInterval = 100 * time.Millisecond
+
+type task[T any] struct {
+	index int
+	item  T
+}
+
+// Each runs fn for every item received from items on jobs workers and returns
+// the number of items once items is closed and all of them are done. Items
+// are numbered in the order they are received. The worker argument is in
+// [0, jobs), so callers can keep per-worker results without locking.
+func Each[T any](jobs int, items <-chan T, fn func(worker, index int, item T)) int {
+	if jobs < 1 {
+		jobs = 1
+	}
+
+	tasks := make(chan task[T], jobs)
+	var wg sync.WaitGroup
+	for w := 0; w < jobs; w++ {
+		wg.Add(1)
+		go func(worker int) {
+			defer wg.Done()
+			for t := range tasks {
+				fn(worker, t.index, t.item)
+			}
+		}(w)
+	}
+
+	count := 0
+	for item := range items {
+		tasks <- task[T]{index: count, item: item}
+		count++
+	}
+	close(tasks)
+	wg.Wait()
+
+	return count
+}
+
+// Progress collects completions from many workers with an atomic counter and
+// forwards them to report in batches from a single goroutine, so workers
+// never contend on the progress bar.
+type Progress struct {
+	done   atomic.Int64
+	report func(n int)
+	stop   chan struct{}
+	wg     sync.WaitGroup
+}
+
+func NewProgress(report func(n int)) *Progress {
+	p := &Progress{
+		report: report,
+		stop:   make(chan struct{}),
+	}
+
+	p.wg.Add(1)
+	go func() {
+		defer p.wg.Done()
+		ticker := time.NewTicker(progressInterval)
+		defer ticker.Stop()
+
+		var reported int64
+		flush := func() {
+			if done := p.done.Load(); done > reported {
+				p.report(int(done - reported))
+				reported = done
+			}
+		}
+		for {
+			select {
+			case <-ticker.C:
+				flush()
+			case <-p.stop:
+				flush()
+				return
+			}
+		}
+	}()
+
+	return p
+}
+
+// Add records n completed items.
+func (p *Progress) Add(n int) {
+	p.done.Add(int64(n))
+}
+
+// Stop reports whatever is still pending and ends the reporter.
+func (p *Progress) Stop() {
+	close(p.stop)
+	p.wg.Wait()
+}
+
+// Results gathers one value per item into per-worker buffers, so workers
+// never share a slice, and hands them back in item order.
+type Results[R any] struct {
+	buckets [][]result[R]
+}
+
+type result[R any] struct {
+	index int
+	value R
+}
+
+func NewResults[R any](jobs int) *Results[R] {
+	if jobs < 1 {
+		jobs = 1
+	}
+	return &Results[R]{buckets: make([][]result[R], jobs)}
+}
+
+// Set records the value for item index. It must only be called from the
+// worker it names.
+func (r *Results[R]) Set(worker, index int, value R) {
+	r.buckets[worker] = append(r.buckets[worker], result[R]{index: index, value: value})
+}
+
+// Ordered returns the values for items [0, count). Items without a value are
+// left at the zero value. Each worker's bucket is a run in item order, since
+// items are handed out in order; placing every value at its index merges the
+// runs in one pass, and the result does not depend on which worker finished
+// first.
+func (r *Results[R]) Ordered(count int) []R {
+	values := make([]R, count)
+	for _, bucket := range r.buckets {
+		for _, res := range bucket {
+			values[res.index] = res.value
+		}
+	}
+	return values
+}
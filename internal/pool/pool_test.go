@@ -0,0 +1,43 @@
+package pool
+
+import (
+	"sync/atomic"
+	"testing"
+)
+
+func TestEachKeepsItemOrder(t *testing.T) {
+	const jobs = 4
+
+	items := make(chan int)
+	go func() {
+		defer close(items)
+		for i := 0; i < 1000; i++ {
+			items <- i * 2
+		}
+	}()
+
+	var reported atomic.Int64
+	progress := NewProgress(func(n int) { reported.Add(int64(n)) })
+	results := NewResults[int](jobs)
+
+	count := Each(jobs, items, func(worker, index, item int) {
+		if worker < 0 || worker >= jobs {
+			t.Errorf("Worker %d out of range", worker)
+		}
+		results.Set(worker, index, item)
+		progress.Add(1)
+	})
+	progress.Stop()
+
+	if count != 1000 {
+		t.Fatalf("Expected 1000 items, got %d", count)
+	}
+	for i, value := range results.Ordered(count) {
+		if value != i*2 {
+			t.Errorf("Expected %d at %d, got %d", i*2, i, value)
+		}
+	}
+	if reported.Load() != 1000 {
+		t.Errorf("Expected 1000 reported completions, got %d", reported.Load())
+	}
+}
@@ -0,0 +1,57 @@
+package registry
+
+import "strings"
+
+// braceSpans finds where function bodies end in one pass over a file. A
+// body opened on line i ends on the first later line after which as many
+// braces have closed as opened since the start of line i, or on the last
+// line of the file. Each line is counted once, however long or deeply
+// nested the functions around it are.
+type braceSpans struct {
+	depth   int // braces opened minus braces closed so far
+	before  int // depth at the start of the last line
+	lines   int // lines counted so far
+	pending map[int][]openSpan
+	closed  func(id, start, end int)
+}
+
+// openSpan is a body waiting for the depth its line started at.
+type openSpan struct {
+	id    int
+	start int
+}
+
+// newBraceSpans calls closed with the first and last line of each body
+// once they are known.
+func newBraceSpans(closed func(id, start, end int)) *braceSpans {
+	return &braceSpans{pending: make(map[int][]openSpan), closed: closed}
+}
+
+// next counts the braces of the next line and closes the bodies that end
+// on it.
+func (s *braceSpans) next(line string) {
+	s.before = s.depth
+	s.depth += strings.Count(line, "{") - strings.Count(line, "}")
+	s.lines++
+	if waiting := s.pending[s.depth]; len(waiting) > 0 {
+		delete(s.pending, s.depth)
+		for _, span := range waiting {
+			s.closed(span.id, span.start, s.lines-1)
+		}
+	}
+}
+
+// open starts body id on the line last passed to next.
+func (s *braceSpans) open(id int) {
+	s.pending[s.before] = append(s.pending[s.before], openSpan{id: id, start: s.lines - 1})
+}
+
+// finish closes the bodies still open at the end of the file.
+func (s *braceSpans) finish() {
+	for depth, waiting := range s.pending {
+		for _, span := range waiting {
+			s.closed(span.id, span.start, s.lines-1)
+		}
+		delete(s.pending, depth)
+	}
+}
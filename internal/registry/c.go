@@ -1,14 +1,27 @@
 package registry
 
 import (
-	"os"
 	"path/filepath"
 	"regexp"
 	"strings"
+
+	"github.com/vitruves/gop/internal/source"
 )
 
 type CParser struct{}
 
+var cPatterns = struct {
+	fn           *regexp.Regexp
+	structDef    *regexp.Regexp
+	preprocessor *regexp.Regexp
+	call         *regexp.Regexp
+}{
+	fn:           regexp.MustCompile(`^\s*(static\s+)?(extern\s+)?(inline\s+)?(\w+(?:\s*\*)*)\s+(\w+)\s*\((.*?)\)\s*[{;]`),
+	structDef:    regexp.MustCompile(`^\s*struct\s+(\w+)`),
+	preprocessor: regexp.MustCompile(`^\s*#(\w+)`),
+	call:         regexp.MustCompile(`(\w+)\s*\(`),
+}
+
 func (c *CParser) GetExtensions() []string {
 	return []string{".c", ".h"}
 }
@@ -18,37 +31,38 @@ func (c *CParser) IsHeaderFile(filePath string) bool {
 }
 
 func (c *CParser) ParseFile(filePath string) ([]Function, error) {
-	content, err := os.ReadFile(filePath)
-	if err != nil {
-		return nil, err
-	}
+	return parseFile(c, filePath)
+}
 
+func (c *CParser) ParseSource(filePath string, src *source.File) ([]Function, error) {
 	var functions []Function
-	lines := strings.Split(string(content), "\n")
-	
-	// More comprehensive C function regex
-	fnRegex := regexp.MustCompile(`^\s*(static\s+)?(extern\s+)?(inline\s+)?(\w+(?:\s*\*)*)\s+(\w+)\s*\((.*?)\)\s*[{;]`)
-	structRegex := regexp.MustCompile(`^\s*struct\s+(\w+)`)
-	preprocessorRegex := regexp.MustCompile(`^\s*#(\w+)`)
 	
 	var currentStruct string
-	
-	for i, line := range lines {
+
+	// Definitions are sized as their bodies close; declarations span one
+	// line.
+	spans := newBraceSpans(func(id, start, end int) {
+		functions[id].Size = end - start + 1
+	})
+
+	for i := 0; i < src.NumLines(); i++ {
+		line := src.Line(i)
 		trimmed := strings.TrimSpace(line)
+		spans.next(line)
 		
 		// Skip preprocessor directives
-		if preprocessorRegex.MatchString(line) {
+		if cPatterns.preprocessor.MatchString(line) {
 			continue
 		}
 		
 		// Track struct context
-		if structMatch := structRegex.FindStringSubmatch(line); structMatch != nil {
+		if structMatch := cPatterns.structDef.FindStringSubmatch(line); structMatch != nil {
 			currentStruct = structMatch[1]
 			continue
 		}
 		
 		// Parse function definitions and declarations
-		if fnMatch := fnRegex.FindStringSubmatch(line); fnMatch != nil {
+		if fnMatch := cPatterns.fn.FindStringSubmatch(line); fnMatch != nil {
 			staticMod := strings.TrimSpace(fnMatch[1])
 			externMod := strings.TrimSpace(fnMatch[2])
 			inlineMod := strings.TrimSpace(fnMatch[3])
@@ -71,21 +85,21 @@ func (c *CParser) ParseFile(filePath string) ([]Function, error) {
 			isDefinition := strings.Contains(line, "{")
 			
 			paramList := parseCParameters(params)
-			comments := extractCComments(lines, i)
+			comments := extractCComments(src, i)
 			
 			fn := Function{
-				Name:       name,
+				Name:       strings.Clone(name),
 				File:       filePath,
 				Line:       i + 1,
 				Visibility: visibility,
-				ReturnType: returnType,
-				Parameters: paramList,
+				ReturnType: strings.Clone(returnType),
+				Parameters: cloneStrings(paramList),
 				Language:   "c",
-				Signature:  strings.TrimSpace(line),
+				Signature:  strings.Clone(strings.TrimSpace(line)),
 				IsTest:     isCTestFunction(name),
 				IsMain:     name == "main",
-				Size:       calculateCFunctionSize(lines, i, isDefinition),
-				Comments:   comments,
+				Size:       1,
+				Comments:   strings.Clone(comments),
 			}
 			
 			// Set metadata
@@ -103,10 +117,13 @@ func (c *CParser) ParseFile(filePath string) ([]Function, error) {
 				fn.Metadata["definition"] = "true"
 			}
 			if currentStruct != "" {
-				fn.Metadata["struct_context"] = currentStruct
+				fn.Metadata["struct_context"] = strings.Clone(currentStruct)
 			}
 			
 			functions = append(functions, fn)
+			if isDefinition {
+				spans.open(len(functions) - 1)
+			}
 		}
 		
 		// Reset struct context on closing brace
@@ -114,26 +131,23 @@ func (c *CParser) ParseFile(filePath string) ([]Function, error) {
 			currentStruct = ""
 		}
 	}
-	
+	spans.finish()
+
 	return functions, nil
 }
 
-func (c *CParser) FindFunctionCalls(content string) []string {
-	callRegex := regexp.MustCompile(`(\w+)\s*\(`)
-	matches := callRegex.FindAllStringSubmatch(content, -1)
+func (c *CParser) FindCallSites(content string) []CallSite {
+	var sites []CallSite
+	lines := newLineCounter(content)
 	
-	var calls []string
-	seen := make(map[string]bool)
-	
-	for _, match := range matches {
-		call := match[1]
-		if !seen[call] && !isCBuiltin(call) && !isCKeyword(call) {
-			calls = append(calls, call)
-			seen[call] = true
+	for _, match := range cPatterns.call.FindAllStringSubmatchIndex(content, -1) {
+		call := content[match[2]:match[3]]
+		if !isCBuiltin(call) && !isCKeyword(call) {
+			sites = append(sites, CallSite{Name: call, Line: lines.lineAt(match[2])})
 		}
 	}
 	
-	return calls
+	return sites
 }
 
 func parseCParameters(params string) []string {
@@ -181,12 +195,12 @@ func parseCParameters(params string) []string {
 	return result
 }
 
-func extractCComments(lines []string, fnLine int) string {
+func extractCComments(lines *source.File, fnLine int) string {
 	var comments []string
 	
 	// Look for comments above the function
 	for i := fnLine - 1; i >= 0; i-- {
-		line := strings.TrimSpace(lines[i])
+		line := strings.TrimSpace(lines.Line(i))
 		if line == "" {
 			continue
 		}
@@ -201,8 +215,8 @@ func extractCComments(lines []string, fnLine int) string {
 			comments = append([]string{strings.TrimSpace(comment)}, comments...)
 			
 			// Continue reading until */
-			for j := i + 1; j < len(lines); j++ {
-				commentLine := lines[j]
+			for j := i + 1; j < lines.NumLines(); j++ {
+				commentLine := lines.Line(j)
 				if strings.Contains(commentLine, "*/") {
 					finalPart := strings.Split(commentLine, "*/")[0]
 					if strings.TrimSpace(finalPart) != "" {
@@ -231,30 +245,6 @@ func extractCComments(lines []string, fnLine int) string {
 	return strings.Join(comments, " ")
 }
 
-func calculateCFunctionSize(lines []string, startLine int, isDefinition bool) int {
-	if !isDefinition || startLine >= len(lines) {
-		return 1
-	}
-	
-	braceCount := 0
-	size := 1
-	
-	// Count opening braces in the first line
-	braceCount += strings.Count(lines[startLine], "{") - strings.Count(lines[startLine], "}")
-	
-	for i := startLine + 1; i < len(lines); i++ {
-		line := lines[i]
-		braceCount += strings.Count(line, "{") - strings.Count(line, "}")
-		size++
-		
-		if braceCount == 0 {
-			break
-		}
-	}
-	
-	return size
-}
-
 func isCTestFunction(name string) bool {
 	return strings.HasPrefix(name, "test_") || 
 	       strings.HasSuffix(name, "_test") ||
@@ -0,0 +1,81 @@
+package registry
+
+import (
+	"fmt"
+	"path/filepath"
+
+	"github.com/vitruves/gop/internal/memlimit"
+	"github.com/vitruves/gop/internal/source"
+)
+
+// Collector builds the registry of files that another pipeline reads, as
+// gop analyze does, and writes the report Run would have written for them.
+type Collector struct {
+	config     Config
+	parser     LanguageParser
+	extensions map[string]bool
+	withCalls  bool
+	emitter    *fileEmitter
+	build      *registryBuild
+	files      int
+}
+
+// NewCollector returns a collector for config. Files, CacheDir and the walk
+// settings are not used: the caller decides which files are read.
+func NewCollector(config Config) (*Collector, error) {
+	parser := newParser(config)
+	if parser == nil {
+		return nil, fmt.Errorf("unsupported language: %s", config.Language)
+	}
+	c := &Collector{
+		config:     config,
+		parser:     parser,
+		extensions: parserExtensions(config, parser),
+		withCalls:  config.AddRelations || config.OnlyDeadCode || config.CallGraphFile != "",
+		build:      newRegistryBuild(memlimit.New(config.MaxMemory)),
+	}
+	c.emitter = newFileEmitter(func(file parsedFile) {
+		if file.path != "" {
+			c.build.add(file)
+			c.files++
+		}
+	})
+	return c, nil
+}
+
+// Accepts reports whether the registry covers files like path.
+func (c *Collector) Accepts(path string) bool {
+	return c.extensions[filepath.Ext(path)]
+}
+
+// Add parses src, the content of the file at position idx of the walk.
+// Every position must be added, with a nil src for files the registry does
+// not cover, or later files are held back. Add is safe for concurrent use
+// and src may be closed once it returns.
+func (c *Collector) Add(idx int, path string, src *source.File) {
+	if src == nil {
+		c.emitter.put(idx, parsedFile{})
+		return
+	}
+	cached, err := analyzeOpened(c.parser, path, src, c.withCalls)
+	if err != nil {
+		logError(fmt.Sprintf("Error parsing %s: %v", path, err))
+	}
+	c.emitter.put(idx, parsedFile{path: path, functions: cached.Functions, sites: cached.Calls})
+}
+
+// Limit returns the memory limit the registry's functions count against,
+// so the caller can admit the files it reads through the same budget.
+func (c *Collector) Limit() *memlimit.Limit {
+	return c.build.store.limit
+}
+
+// Files returns how many files the registry covers.
+func (c *Collector) Files() int {
+	return c.files
+}
+
+// Finish resolves calls if config needs them and writes the report.
+func (c *Collector) Finish() error {
+	return writeRegistry(c.config, c.build, c.files, c.withCalls, nil)
+}
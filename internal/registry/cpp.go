@@ -1,10 +1,10 @@
 package registry
 
 import (
-	"os"
 	"path/filepath"
-	"regexp"
 	"strings"
+
+	"github.com/vitruves/gop/internal/source"
 )
 
 type CppParser struct{}
@@ -25,418 +25,874 @@ func (cpp *CppParser) IsHeaderFile(filePath string) bool {
 }
 
 func (cpp *CppParser) ParseFile(filePath string) ([]Function, error) {
-	content, err := os.ReadFile(filePath)
-	if err != nil {
-		return nil, err
-	}
-
-	var functions []Function
-	lines := strings.Split(string(content), "\n")
-	
-	// Comprehensive C++ function regex patterns
-	fnRegex := regexp.MustCompile(`^\s*(template\s*<[^>]*>\s*)?(public|private|protected)?\s*:\s*$|^\s*(virtual\s+)?(static\s+)?(inline\s+)?(explicit\s+)?(\w+(?:\s*::\s*\w+)*(?:\s*<[^>]*>)?(?:\s*\*)*)\s+(\w+(?:::\w+)*)\s*\((.*?)\)\s*(const)?\s*(override)?\s*(final)?\s*[{;]`)
-	classRegex := regexp.MustCompile(`^\s*(template\s*<[^>]*>\s*)?(class|struct)\s+(\w+)`)
-	namespaceRegex := regexp.MustCompile(`^\s*namespace\s+(\w+)`)
-	accessRegex := regexp.MustCompile(`^\s*(public|private|protected)\s*:`)
-	
-	var currentClass string
-	var currentNamespace string
-	var currentAccess string = "private" // Default for class
-	var templateContext string
-	
-	for i, line := range lines {
-		trimmed := strings.TrimSpace(line)
-		
-		// Track template context
-		if strings.HasPrefix(trimmed, "template") && strings.Contains(trimmed, "<") {
-			templateContext = trimmed
-			continue
+	return parseFile(cpp, filePath)
+}
+
+func (cpp *CppParser) ParseSource(filePath string, src *source.File) ([]Function, error) {
+	s := newCppScanner(src.String(), filePath, true, false)
+	s.run()
+	return s.functions, nil
+}
+
+func (cpp *CppParser) FindCallSites(content string) []CallSite {
+	s := newCppScanner(content, "", false, true)
+	s.run()
+	return s.sites
+}
+
+// AnalyzeSource extracts functions and call sites from one token stream.
+func (cpp *CppParser) AnalyzeSource(filePath string, src *source.File) ([]Function, []CallSite, error) {
+	s := newCppScanner(src.String(), filePath, true, true)
+	s.run()
+	return s.functions, s.sites, nil
+}
+
+// cppScopeKind tells what an open brace belongs to.
+type cppScopeKind uint8
+
+const (
+	cppScopeNamespace cppScopeKind = iota // the file, a namespace or extern "C"
+	cppScopeClass
+	cppScopeFunction
+	cppScopeBlock // statements inside functions, enum bodies and macro blocks
+	cppScopeInit  // a braced initializer inside a declaration
+)
+
+type cppScope struct {
+	kind cppScopeKind
+	// prefix is the qualified name of the innermost namespace or class.
+	prefix string
+	class  string
+	access string
+	fn     int
+}
+
+// cppScanner walks the token stream of one file with a scope stack. At
+// namespace and class level it buffers each declaration until its '{' or
+// ';' and then decides what it declares; everywhere it records calls.
+type cppScanner struct {
+	lex           *cppLexer
+	filePath      string
+	wantFunctions bool
+	wantCalls     bool
+
+	functions []Function
+	sites     []CallSite
+
+	scopes  []cppScope
+	stmt    []cppToken
+	docs    []cppToken
+	pending []cppToken
+	// depth counts open parentheses and brackets in stmt; assigned is set
+	// after a top-level '=' in it.
+	depth    int
+	assigned bool
+
+	// prev and prev2 are the last two tokens, chain is the first token of
+	// the qualified name ending at prev and before the two tokens ahead of it.
+	prev, prev2     cppToken
+	chain           cppToken
+	before, before2 cppToken
+}
+
+func newCppScanner(src, filePath string, wantFunctions, wantCalls bool) *cppScanner {
+	return &cppScanner{
+		lex:           newCppLexer(src),
+		filePath:      filePath,
+		wantFunctions: wantFunctions,
+		wantCalls:     wantCalls,
+		scopes:        []cppScope{{kind: cppScopeNamespace, fn: -1}},
+	}
+}
+
+func (s *cppScanner) run() {
+	for {
+		tok := s.lex.next()
+		if tok.kind == cppEOF {
+			break
 		}
-		
-		// Track namespace
-		if nsMatch := namespaceRegex.FindStringSubmatch(line); nsMatch != nil {
-			currentNamespace = nsMatch[1]
-			templateContext = ""
+		if tok.kind == cppComment {
+			s.comment(tok)
 			continue
 		}
-		
-		// Track class/struct context
-		if classMatch := classRegex.FindStringSubmatch(line); classMatch != nil {
-			currentClass = classMatch[3]
-			currentAccess = "private"
-			if classMatch[2] == "struct" {
-				currentAccess = "public"
-			}
-			templateContext = ""
-			continue
+		s.token(tok)
+	}
+
+	// Bodies left open by unbalanced input end with the file.
+	for i := len(s.scopes) - 1; i > 0; i-- {
+		if fn := s.scopes[i].fn; fn >= 0 {
+			s.functions[fn].Size = s.lex.line - s.functions[fn].Line + 1
 		}
-		
-		// Track access specifiers
-		if accessMatch := accessRegex.FindStringSubmatch(line); accessMatch != nil {
-			currentAccess = accessMatch[1]
-			templateContext = ""
-			continue
+	}
+}
+
+func (s *cppScanner) text(tok cppToken) string {
+	return s.lex.src[tok.start:tok.end]
+}
+
+// is reports whether tok is the punctuation or word text.
+func (s *cppScanner) is(tok cppToken, text string) bool {
+	return tok.end-tok.start == len(text) && (tok.kind == cppPunct || tok.kind == cppIdent) && s.lex.src[tok.start:tok.end] == text
+}
+
+func (s *cppScanner) top() *cppScope {
+	return &s.scopes[len(s.scopes)-1]
+}
+
+// comment keeps the comments that may document the next declaration: those
+// on lines of their own, back to the previous token or plain block comment.
+func (s *cppScanner) comment(tok cppToken) {
+	if !s.wantFunctions {
+		return
+	}
+	text := s.text(tok)
+	if !tok.first || strings.HasPrefix(text, "/*") && !strings.HasPrefix(text, "/**") {
+		s.pending = s.pending[:0]
+		return
+	}
+	s.pending = append(s.pending, tok)
+}
+
+func (s *cppScanner) token(tok cppToken) {
+	s.track(tok)
+
+	switch s.top().kind {
+	case cppScopeFunction, cppScopeBlock:
+		s.call(tok, true)
+		if s.is(tok, "{") {
+			s.push(cppScope{kind: cppScopeBlock, fn: -1})
+		} else if s.is(tok, "}") {
+			s.pop(tok)
 		}
-		
-		// Parse function definitions
-		if fnMatch := fnRegex.FindStringSubmatch(line); fnMatch != nil {
-			// Skip access specifier lines
-			if fnMatch[2] != "" && fnMatch[7] == "" {
-				currentAccess = fnMatch[2]
-				continue
-			}
-			
-			virtualMod := strings.TrimSpace(fnMatch[3])
-			staticMod := strings.TrimSpace(fnMatch[4])
-			inlineMod := strings.TrimSpace(fnMatch[5])
-			explicitMod := strings.TrimSpace(fnMatch[6])
-			returnType := strings.TrimSpace(fnMatch[7])
-			name := strings.TrimSpace(fnMatch[8])
-			params := fnMatch[9]
-			constMod := strings.TrimSpace(fnMatch[10])
-			overrideMod := strings.TrimSpace(fnMatch[11])
-			finalMod := strings.TrimSpace(fnMatch[12])
-			
-			// Skip obvious non-functions
-			if returnType == "" || name == "" {
-				continue
-			}
-			
-			// Handle constructors and destructors
-			if name == currentClass || name == "~"+currentClass {
-				returnType = ""
+	case cppScopeInit:
+		s.call(tok, true)
+		s.stmt = append(s.stmt, tok)
+		if s.is(tok, "{") {
+			s.push(cppScope{kind: cppScopeInit, fn: -1})
+		} else if s.is(tok, "}") {
+			s.pop(tok)
+		}
+	default:
+		s.declarationToken(tok)
+	}
+
+	s.pending = s.pending[:0]
+	s.prev2, s.prev = s.prev, tok
+}
+
+// track follows qualified names, so a call knows where its name started.
+func (s *cppScanner) track(tok cppToken) {
+	switch {
+	case tok.kind == cppIdent && s.is(s.prev, "::"):
+	case tok.kind == cppIdent || s.is(tok, "::") && s.prev.kind != cppIdent:
+		s.chain, s.before, s.before2 = tok, s.prev, s.prev2
+	}
+}
+
+// call records a call site when tok opens the argument list of a name.
+// Outside function bodies, names directly before '(' are mostly being
+// declared, so only those in initializers, nested parentheses and
+// statement-leading macros count.
+func (s *cppScanner) call(tok cppToken, inBody bool) {
+	if !s.wantCalls || s.prev.kind != cppIdent || !s.is(tok, "(") {
+		return
+	}
+	if !inBody && s.depth == 0 && !s.assigned && (len(s.stmt) == 0 || s.chain.start != s.stmt[0].start || s.chain.start != s.prev.start) {
+		return
+	}
+
+	name := s.lex.src[s.chain.start:s.prev.end]
+	if strings.ContainsAny(name, " \t\r\n") {
+		name = strings.Join(strings.Fields(name), "")
+	}
+	qualifier, call := splitQualifier(strings.TrimPrefix(name, "::"))
+	if isCppBuiltin(call) || isCppKeyword(call) {
+		return
+	}
+
+	site := CallSite{Name: call, Qualifier: qualifier, Line: s.prev.line}
+	if s.is(s.before, ".") || s.is(s.before, "->") {
+		site.Member = true
+		if qualifier == "" && s.before2.kind == cppIdent {
+			site.Qualifier = s.text(s.before2)
+		}
+	}
+	s.sites = append(s.sites, site)
+}
+
+func (s *cppScanner) declarationToken(tok cppToken) {
+	if len(s.stmt) == 0 {
+		s.docs = append(s.docs[:0], s.pending...)
+	}
+	s.call(tok, false)
+
+	if tok.kind == cppPunct {
+		switch s.text(tok) {
+		case "(", "[":
+			s.depth++
+		case ")", "]":
+			if s.depth > 0 {
+				s.depth--
 			}
-			
-			fullName := name
-			if currentClass != "" {
-				fullName = currentClass + "::" + name
+		case "=":
+			if s.depth == 0 && !s.is(s.prev, "operator") && !strings.Contains("=!<>", s.text(s.prev)) {
+				s.assigned = true
 			}
-			if currentNamespace != "" {
-				if currentClass != "" {
-					fullName = currentNamespace + "::" + currentClass + "::" + name
-				} else {
-					fullName = currentNamespace + "::" + name
+		case ";":
+			if s.depth == 0 {
+				if s.wantFunctions {
+					s.function(false)
 				}
+				s.reset()
+				return
 			}
-			
-			visibility := currentAccess
-			if currentClass == "" {
-				visibility = "public" // Free functions are public
-			}
-			
-			// Determine if it's a declaration or definition
-			isDeclaration := strings.HasSuffix(trimmed, ";")
-			isDefinition := strings.Contains(line, "{")
-			
-			paramList := parseCppParameters(params)
-			comments := extractCppComments(lines, i)
-			
-			fn := Function{
-				Name:       fullName,
-				File:       filePath,
-				Line:       i + 1,
-				Visibility: visibility,
-				ReturnType: returnType,
-				Parameters: paramList,
-				Language:   "cpp",
-				Signature:  strings.TrimSpace(line),
-				IsTest:     isCppTestFunction(name, fullName),
-				IsMain:     name == "main",
-				Size:       calculateCppFunctionSize(lines, i, isDefinition),
-				Comments:   comments,
-			}
-			
-			// Set metadata
-			fn.Metadata = make(map[string]string)
-			if virtualMod != "" {
-				fn.Metadata["virtual"] = "true"
+		case ":":
+			if s.depth == 0 && s.top().kind == cppScopeClass && s.accessSpecifier() {
+				s.reset()
+				return
 			}
-			if staticMod != "" {
-				fn.Metadata["static"] = "true"
-			}
-			if inlineMod != "" {
-				fn.Metadata["inline"] = "true"
+		case "{":
+			s.openBrace(tok)
+			return
+		case "}":
+			s.pop(tok)
+			s.reset()
+			return
+		}
+	}
+
+	s.stmt = append(s.stmt, tok)
+}
+
+func (s *cppScanner) reset() {
+	s.stmt = s.stmt[:0]
+	s.depth = 0
+	s.assigned = false
+}
+
+func (s *cppScanner) push(scope cppScope) {
+	s.scopes = append(s.scopes, scope)
+}
+
+func (s *cppScanner) pop(tok cppToken) {
+	if len(s.scopes) == 1 {
+		// A stray '}' (unbalanced input) never closes the file.
+		return
+	}
+	if fn := s.top().fn; fn >= 0 {
+		s.functions[fn].Size = tok.line - s.functions[fn].Line + 1
+	}
+	s.scopes = s.scopes[:len(s.scopes)-1]
+}
+
+// accessSpecifier handles "public:" and friends, including Qt's
+// "public slots:", ending the statement.
+func (s *cppScanner) accessSpecifier() bool {
+	n := len(s.stmt)
+	for i := n - 1; i >= 0 && i >= n-2; i-- {
+		switch s.text(s.stmt[i]) {
+		case "public":
+			s.top().access = "public"
+			return true
+		case "protected":
+			s.top().access = "protected"
+			return true
+		case "private":
+			s.top().access = "private"
+			return true
+		}
+	}
+	return false
+}
+
+// openBrace decides what a '{' at namespace or class level opens.
+func (s *cppScanner) openBrace(tok cppToken) {
+	parent := s.top()
+	if s.depth > 0 {
+		s.push(cppScope{kind: cppScopeInit, fn: -1})
+		s.stmt = append(s.stmt, tok)
+		return
+	}
+
+	toks := s.stmt
+	i := s.skipTemplate(toks, 0)
+	if i < len(toks) && s.is(toks[i], "typedef") {
+		i++
+	}
+	if i < len(toks) && s.is(toks[i], "inline") {
+		i++
+	}
+
+	switch {
+	case i < len(toks) && s.is(toks[i], "namespace"):
+		var name strings.Builder
+		for _, t := range toks[i+1:] {
+			if t.kind == cppIdent || s.is(t, "::") {
+				name.WriteString(s.text(t))
 			}
-			if explicitMod != "" {
-				fn.Metadata["explicit"] = "true"
+		}
+		s.push(cppScope{kind: cppScopeNamespace, prefix: qualify(parent.prefix, name.String()), fn: -1})
+	case len(toks) == 2 && s.is(toks[0], "extern") && toks[1].kind == cppString:
+		s.push(cppScope{kind: cppScopeNamespace, prefix: parent.prefix, fn: -1})
+	case i < len(toks) && s.is(toks[i], "enum"):
+		s.push(cppScope{kind: cppScopeBlock, fn: -1})
+	default:
+		if name, access, ok := s.classHead(toks, i); ok {
+			prefix := qualify(parent.prefix, name)
+			s.push(cppScope{kind: cppScopeClass, prefix: prefix, class: prefix[len(prefix)-len(name):], access: access, fn: -1})
+			break
+		}
+		if !s.wantFunctions {
+			s.push(cppScope{kind: cppScopeBlock, fn: -1})
+			break
+		}
+		if fn := s.function(true); fn >= 0 {
+			s.push(cppScope{kind: cppScopeFunction, fn: fn})
+			break
+		}
+		if s.is(s.prev, ")") {
+			// The body of a macro such as TEST(Suite, Name).
+			s.push(cppScope{kind: cppScopeBlock, fn: -1})
+			break
+		}
+		s.push(cppScope{kind: cppScopeInit, fn: -1})
+		s.stmt = append(s.stmt, tok)
+		return
+	}
+
+	s.reset()
+}
+
+// qualify appends name to a scope prefix, copying it out of the source.
+func qualify(prefix, name string) string {
+	if name == "" {
+		return prefix
+	}
+	if prefix == "" {
+		return strings.Clone(name)
+	}
+	return prefix + "::" + name
+}
+
+// skipTemplate returns the index after any template<...> prefixes at i.
+func (s *cppScanner) skipTemplate(toks []cppToken, i int) int {
+	for i < len(toks) && s.is(toks[i], "template") {
+		i++
+		if i < len(toks) && s.is(toks[i], "<") {
+			i = s.skipGroup(toks, i)
+		}
+	}
+	return i
+}
+
+// skipGroup returns the index after the bracket group opened at toks[i].
+// Angle brackets only nest with each other, so "a > b" inside parentheses
+// does not end a template argument list.
+func (s *cppScanner) skipGroup(toks []cppToken, i int) int {
+	open := s.text(toks[i])
+	depth := 0
+	for ; i < len(toks); i++ {
+		switch s.text(toks[i]) {
+		case "(", "[", "{":
+			if open != "<" || depth == 0 {
+				depth++
+			} else {
+				i = s.skipGroup(toks, i) - 1
 			}
-			if constMod != "" {
-				fn.Metadata["const"] = "true"
+		case ")", "]", "}":
+			depth--
+		case "<":
+			if open == "<" {
+				depth++
 			}
-			if overrideMod != "" {
-				fn.Metadata["override"] = "true"
+		case ">":
+			if open == "<" {
+				depth--
 			}
-			if finalMod != "" {
-				fn.Metadata["final"] = "true"
+		}
+		if depth == 0 {
+			return i + 1
+		}
+	}
+	return len(toks)
+}
+
+// classHead recognizes "class Name : bases" and returns the name, empty for
+// anonymous types, and the default access.
+func (s *cppScanner) classHead(toks []cppToken, i int) (string, string, bool) {
+	if i >= len(toks) {
+		return "", "", false
+	}
+	access := "public"
+	switch s.text(toks[i]) {
+	case "class":
+		access = "private"
+	case "struct", "union":
+	default:
+		return "", "", false
+	}
+
+	name := ""
+	for i++; i < len(toks); i++ {
+		t := toks[i]
+		switch {
+		case t.kind == cppIdent:
+			if text := s.text(t); text != "final" {
+				name = text
 			}
-			if templateContext != "" {
-				fn.Metadata["template"] = "true"
+		case s.is(t, "::"):
+		case s.is(t, "<"), s.is(t, "["):
+			i = s.skipGroup(toks, i) - 1
+		case s.is(t, "(") && isCppAttributeName(name):
+			i = s.skipGroup(toks, i) - 1
+		case s.is(t, ":"):
+			return name, access, true
+		default:
+			return "", "", false
+		}
+	}
+	return name, access, true
+}
+
+func isCppAttributeName(name string) bool {
+	return name == "alignas" || name == "__declspec" || name == "__attribute__"
+}
+
+// cppDeclarator locates the parts of a function declaration in stmt.
+type cppDeclarator struct {
+	retStart  int // first token after specifiers
+	nameStart int
+	open      int // '(' of the parameter list
+	close     int // ')' of the parameter list
+	sigEnd    int // end of the signature, before '=', ':' or the body
+	operator  bool
+}
+
+// function records the declaration buffered in stmt if it declares a
+// function, returning its index or -1.
+func (s *cppScanner) function(definition bool) int {
+	toks := s.stmt
+	sigStart := s.skipTemplate(toks, 0)
+	if sigStart >= len(toks) {
+		return -1
+	}
+	switch s.text(toks[sigStart]) {
+	case "using", "typedef", "static_assert", "namespace", "return", "enum":
+		return -1
+	}
+
+	d, ok := s.declarator(toks, sigStart, definition)
+	if !ok {
+		return -1
+	}
+
+	scope := s.top()
+	name := s.joinTokens(toks[d.nameStart:d.open])
+	qualifier, short := splitQualifier(name)
+	owner := scope.class
+	if qualifier != "" {
+		_, owner = splitQualifier(qualifier)
+	}
+	isConstructor := owner != "" && short == owner
+	isDestructor := owner != "" && short == "~"+owner
+
+	if d.retStart == d.nameStart && !isConstructor && !isDestructor && !d.operator {
+		return -1
+	}
+
+	metadata := make(map[string]string)
+	for _, t := range toks[sigStart:d.retStart] {
+		if key := cppModifier(s.text(t)); key != "" {
+			metadata[key] = "true"
+		}
+	}
+	for _, t := range toks[d.close+1 : d.sigEnd] {
+		if key := cppModifier(s.text(t)); key == "const" || key == "override" || key == "final" {
+			metadata[key] = "true"
+		}
+	}
+	if sigStart > 0 {
+		metadata["template"] = "true"
+	}
+	if definition {
+		metadata["definition"] = "true"
+	} else {
+		metadata["declaration"] = "true"
+	}
+	if isConstructor {
+		metadata["constructor"] = "true"
+	}
+	if isDestructor {
+		metadata["destructor"] = "true"
+	}
+
+	returnType := ""
+	if !isConstructor && !isDestructor {
+		returnType = s.joinTokens(toks[d.retStart:d.nameStart])
+	}
+	fullName := name
+	if scope.prefix != "" {
+		fullName = scope.prefix + "::" + name
+	}
+	visibility := "public" // Free functions are public
+	if scope.kind == cppScopeClass {
+		visibility = scope.access
+	}
+
+	s.functions = append(s.functions, Function{
+		Name:       fullName,
+		File:       s.filePath,
+		Line:       toks[d.open-1].line,
+		Visibility: visibility,
+		ReturnType: returnType,
+		Parameters: s.parameters(toks[d.open+1 : d.close]),
+		Language:   "cpp",
+		Signature:  s.signature(toks[sigStart:d.sigEnd]),
+		IsTest:     isCppTestFunction(short, fullName),
+		IsMain:     short == "main" && scope.kind != cppScopeClass,
+		Size:       1,
+		Comments:   s.comments(),
+		Metadata:   metadata,
+	})
+	return len(s.functions) - 1
+}
+
+// cppModifier returns the metadata key for a specifier or qualifier. The
+// keys are constants, so maps built from them never point into the source.
+func cppModifier(text string) string {
+	switch text {
+	case "virtual":
+		return "virtual"
+	case "static":
+		return "static"
+	case "inline":
+		return "inline"
+	case "explicit":
+		return "explicit"
+	case "constexpr":
+		return "constexpr"
+	case "const":
+		return "const"
+	case "override":
+		return "override"
+	case "final":
+		return "final"
+	}
+	return ""
+}
+
+// declarator finds the name and parameter list of a function declared by
+// toks: the first top-level '(' that follows a name and is followed only by
+// qualifiers, a pure/default/delete marker or a constructor initializer.
+func (s *cppScanner) declarator(toks []cppToken, sigStart int, definition bool) (cppDeclarator, bool) {
+	depth := 0
+	for j := sigStart; j < len(toks); j++ {
+		t := toks[j]
+		switch {
+		case s.is(t, "operator") && depth == 0:
+			open := j + 1
+			if open+2 < len(toks) && s.is(toks[open], "(") && s.is(toks[open+1], ")") {
+				open += 2
 			}
-			if isDeclaration {
-				fn.Metadata["declaration"] = "true"
+			for open < len(toks) && !s.is(toks[open], "(") {
+				open++
 			}
-			if isDefinition {
-				fn.Metadata["definition"] = "true"
+			if open >= len(toks) {
+				return cppDeclarator{}, false
 			}
-			if name == currentClass {
-				fn.Metadata["constructor"] = "true"
+			return s.parameterList(toks, sigStart, j, open, true, definition)
+		case s.is(t, "(") && depth == 0 && j > sigStart && toks[j-1].kind == cppIdent:
+			name := s.text(toks[j-1])
+			if !isCppKeyword(name) && !isCppAttributeName(name) {
+				nameStart := j - 1
+				if nameStart > sigStart && s.is(toks[nameStart-1], "~") {
+					nameStart--
+				}
+				if d, ok := s.parameterList(toks, sigStart, nameStart, j, false, definition); ok {
+					return d, true
+				}
 			}
-			if name == "~"+currentClass {
-				fn.Metadata["destructor"] = "true"
+			depth++
+		case s.is(t, "("), s.is(t, "["), s.is(t, "{"):
+			depth++
+		case s.is(t, ")"), s.is(t, "]"), s.is(t, "}"):
+			depth--
+		case s.is(t, "=") && depth == 0:
+			// A variable initializer, unless part of a comparison.
+			if j+1 < len(toks) && s.is(toks[j+1], "=") || j > 0 && strings.Contains("=!<>", s.text(toks[j-1])) {
+				continue
 			}
-			
-			functions = append(functions, fn)
-			templateContext = ""
-		} else if trimmed != "" && !strings.HasPrefix(trimmed, "//") && !strings.HasPrefix(trimmed, "/*") {
-			// Reset template context on non-template lines
-			if !strings.Contains(trimmed, "template") {
-				templateContext = ""
+			return cppDeclarator{}, false
+		}
+	}
+	return cppDeclarator{}, false
+}
+
+func (s *cppScanner) parameterList(toks []cppToken, sigStart, nameStart, open int, operator, definition bool) (cppDeclarator, bool) {
+	d := cppDeclarator{nameStart: nameStart, open: open, operator: operator}
+
+	// Qualified names: ns::Class::name and Class<T>::name.
+	for d.nameStart-1 > sigStart && s.is(toks[d.nameStart-1], "::") {
+		k := d.nameStart - 2
+		if s.is(toks[k], ">") {
+			for depth := 0; k > sigStart; k-- {
+				if s.is(toks[k], ">") {
+					depth++
+				} else if s.is(toks[k], "<") {
+					if depth--; depth == 0 {
+						break
+					}
+				}
 			}
+			k--
 		}
-		
-		// Reset class context on closing brace
-		if strings.Contains(line, "}") && !strings.Contains(line, "{") {
-			// This is a simplified check - proper parsing would need brace counting
-			currentClass = ""
-			currentAccess = "private"
-		}
-	}
-	
-	return functions, nil
-}
-
-func (cpp *CppParser) FindFunctionCalls(content string) []string {
-	callRegex := regexp.MustCompile(`(\w+(?:::\w+)*)\s*\(`)
-	methodRegex := regexp.MustCompile(`\.(\w+)\s*\(|->(\w+)\s*\(`)
-	
-	var calls []string
-	seen := make(map[string]bool)
-	
-	// Function calls
-	matches := callRegex.FindAllStringSubmatch(content, -1)
-	for _, match := range matches {
-		call := match[1]
-		// Remove namespace qualifiers for simplicity
-		if idx := strings.LastIndex(call, "::"); idx != -1 {
-			call = call[idx+2:]
-		}
-		
-		if !seen[call] && !isCppBuiltin(call) && !isCppKeyword(call) {
-			calls = append(calls, call)
-			seen[call] = true
-		}
-	}
-	
-	// Method calls
-	methodMatches := methodRegex.FindAllStringSubmatch(content, -1)
-	for _, match := range methodMatches {
-		var call string
-		if match[1] != "" {
-			call = match[1]
-		} else if match[2] != "" {
-			call = match[2]
-		}
-		
-		if call != "" && !seen[call] && !isCppBuiltin(call) {
-			calls = append(calls, call)
-			seen[call] = true
-		}
-	}
-	
-	return calls
-}
-
-func parseCppParameters(params string) []string {
-	if strings.TrimSpace(params) == "" || strings.TrimSpace(params) == "void" {
-		return []string{}
-	}
-	
-	var result []string
-	parts := strings.Split(params, ",")
-	
-	for _, part := range parts {
-		part = strings.TrimSpace(part)
-		if part == "" || part == "void" {
-			continue
+		if k < sigStart || toks[k].kind != cppIdent {
+			break
 		}
-		
-		// Handle default parameters: type name = default
-		if equalIndex := strings.Index(part, "="); equalIndex != -1 {
-			part = strings.TrimSpace(part[:equalIndex])
-		}
-		
-		// Handle function pointers and complex types
-		if strings.Contains(part, "(") && strings.Contains(part, ")") {
-			// Function pointer parameter - extract name after the closing paren
-			if idx := strings.LastIndex(part, ")"); idx != -1 {
-				remaining := part[idx+1:]
-				words := strings.Fields(remaining)
-				if len(words) > 0 {
-					result = append(result, words[0])
-				}
+		d.nameStart = k
+	}
+	if d.nameStart-1 >= sigStart && s.is(toks[d.nameStart-1], "::") {
+		d.nameStart--
+	}
+
+	// Specifiers and what they leave for the return type.
+	d.retStart = sigStart
+	for d.retStart < d.nameStart {
+		t := toks[d.retStart]
+		text := s.text(t)
+		switch {
+		case text == "virtual" || text == "static" || text == "inline" || text == "explicit" ||
+			text == "constexpr" || text == "consteval" || text == "friend" || text == "extern" ||
+			t.kind == cppString:
+			d.retStart++
+			continue
+		case text == "[" || isCppAttributeName(text) && d.retStart+1 < d.nameStart && s.is(toks[d.retStart+1], "("):
+			if text != "[" {
+				d.retStart++
 			}
+			d.retStart = s.skipGroup(toks, d.retStart)
 			continue
 		}
-		
-		// Regular parameter: type name, const type& name, type* name, etc.
-		words := strings.Fields(part)
-		if len(words) > 0 {
-			// Take the last word as the parameter name
-			paramName := words[len(words)-1]
-			// Remove reference and pointer symbols
-			paramName = strings.TrimLeft(paramName, "*&")
-			// Remove array brackets
-			if bracketIdx := strings.Index(paramName, "["); bracketIdx != -1 {
-				paramName = paramName[:bracketIdx]
+		break
+	}
+	for _, t := range toks[d.retStart:d.nameStart] {
+		switch s.text(t) {
+		case ".", "->", "return", "new", "delete", "throw", "case", "goto", "sizeof":
+			return d, false
+		}
+	}
+
+	d.close = s.skipGroup(toks, open) - 1
+	if d.close >= len(toks) || !s.is(toks[d.close], ")") {
+		return d, false
+	}
+	for k := open + 1; k < d.close; k++ {
+		// Arguments rather than parameters, as in std::string name("x").
+		if (toks[k].kind == cppString || toks[k].kind == cppNumber) && (s.is(toks[k-1], "(") || s.is(toks[k-1], ",")) {
+			return d, false
+		}
+	}
+
+	// What may follow the parameters.
+	d.sigEnd = len(toks)
+	for k := d.close + 1; k < len(toks); k++ {
+		t := toks[k]
+		switch text := s.text(t); {
+		case text == ":" && definition:
+			last := toks[len(toks)-1]
+			if !s.is(last, ")") && !s.is(last, "}") {
+				// "x_{": a braced member initializer, not the body.
+				return d, false
 			}
-			if paramName != "" {
-				result = append(result, paramName)
+			d.sigEnd = k
+			return d, true
+		case text == "=" && !definition:
+			d.sigEnd = k
+			return d, true
+		case text == "(" || text == "[":
+			k = s.skipGroup(toks, k) - 1
+		case text == "," || text == "=" || text == ":" || t.kind == cppString || t.kind == cppNumber:
+			return d, false
+		}
+	}
+	return d, true
+}
+
+// joinTokens renders tokens compactly: "const std::string&", "operator==".
+func (s *cppScanner) joinTokens(toks []cppToken) string {
+	var b strings.Builder
+	for i, t := range toks {
+		if i > 0 {
+			prev := toks[i-1]
+			if prev.kind != cppPunct && t.kind != cppPunct || s.is(prev, ",") {
+				b.WriteByte(' ')
 			}
 		}
+		b.WriteString(s.text(t))
 	}
-	
-	return result
+	return b.String()
 }
 
-func extractCppComments(lines []string, fnLine int) string {
-	var comments []string
-	
-	// Look for comments above the function
-	for i := fnLine - 1; i >= 0; i-- {
-		line := strings.TrimSpace(lines[i])
-		if line == "" {
-			continue
+// signature is the declaration as written, on one line.
+func (s *cppScanner) signature(toks []cppToken) string {
+	text := s.lex.src[toks[0].start:toks[len(toks)-1].end]
+	if strings.ContainsAny(text, "\n\t\r") || strings.Contains(text, "  ") {
+		text = strings.Join(strings.Fields(text), " ")
+	}
+	return strings.Clone(text)
+}
+
+// parameters returns the parameter names of a parameter list.
+func (s *cppScanner) parameters(toks []cppToken) []string {
+	params := []string{}
+	start, depth := 0, 0
+	for i := 0; i <= len(toks); i++ {
+		if i < len(toks) {
+			switch s.text(toks[i]) {
+			case "(", "[", "{", "<":
+				depth++
+			case ")", "]", "}", ">":
+				depth--
+			}
+			if depth != 0 || !s.is(toks[i], ",") {
+				continue
+			}
 		}
-		
-		if strings.HasPrefix(line, "///") {
-			// Doxygen comment
-			comment := strings.TrimPrefix(line, "///")
-			comments = append([]string{strings.TrimSpace(comment)}, comments...)
-		} else if strings.HasPrefix(line, "/**") && strings.HasSuffix(line, "*/") {
-			// Single line Doxygen block comment
-			comment := strings.TrimSuffix(strings.TrimPrefix(line, "/**"), "*/")
-			comments = append([]string{strings.TrimSpace(comment)}, comments...)
-		} else if strings.HasPrefix(line, "/**") {
-			// Multi-line Doxygen block comment
-			comment := strings.TrimPrefix(line, "/**")
-			comments = append([]string{strings.TrimSpace(comment)}, comments...)
-			
-			// Continue reading until */
-			for j := i + 1; j < len(lines); j++ {
-				commentLine := lines[j]
-				if strings.Contains(commentLine, "*/") {
-					finalPart := strings.Split(commentLine, "*/")[0]
-					cleanPart := strings.TrimSpace(finalPart)
-					cleanPart = strings.TrimPrefix(cleanPart, "*")
-					cleanPart = strings.TrimSpace(cleanPart)
-					if cleanPart != "" {
-						comments = append(comments, cleanPart)
-					}
-					break
-				} else {
-					cleanLine := strings.TrimSpace(commentLine)
-					cleanLine = strings.TrimPrefix(cleanLine, "*")
-					cleanLine = strings.TrimSpace(cleanLine)
-					if cleanLine != "" {
-						comments = append(comments, cleanLine)
-					}
-				}
+		if name := s.parameterName(toks[start:i]); name != "" {
+			params = append(params, name)
+		}
+		start = i + 1
+	}
+	return params
+}
+
+func (s *cppScanner) parameterName(group []cppToken) string {
+	// Drop default arguments.
+	depth := 0
+	for i, t := range group {
+		switch s.text(t) {
+		case "(", "[", "{", "<":
+			depth++
+		case ")", "]", "}", ">":
+			depth--
+		case "=":
+			if depth == 0 {
+				group = group[:i]
 			}
-			break
-		} else if strings.HasPrefix(line, "//") {
-			// Single line comment
-			comment := strings.TrimPrefix(line, "//")
-			comments = append([]string{strings.TrimSpace(comment)}, comments...)
-		} else {
+		}
+		if len(group) == i {
 			break
 		}
 	}
-	
-	return strings.Join(comments, " ")
-}
+	if len(group) == 0 || len(group) == 1 && s.is(group[0], "void") {
+		return ""
+	}
 
-func calculateCppFunctionSize(lines []string, startLine int, isDefinition bool) int {
-	if !isDefinition || startLine >= len(lines) {
-		return 1
+	// Function pointers and references: the name follows the '*' or '&'
+	// inside the first parentheses.
+	for i := 0; i+2 < len(group); i++ {
+		if s.is(group[i], "(") && (s.is(group[i+1], "*") || s.is(group[i+1], "&")) && group[i+2].kind == cppIdent {
+			return strings.Clone(s.text(group[i+2]))
+		}
 	}
-	
-	braceCount := 0
-	size := 1
-	
-	// Count opening braces in the first line
-	braceCount += strings.Count(lines[startLine], "{") - strings.Count(lines[startLine], "}")
-	
-	for i := startLine + 1; i < len(lines); i++ {
-		line := lines[i]
-		braceCount += strings.Count(line, "{") - strings.Count(line, "}")
-		size++
-		
-		if braceCount == 0 {
-			break
+
+	// Otherwise the last word, skipping array bounds.
+	for i := len(group) - 1; i >= 0; i-- {
+		if s.is(group[i], "]") {
+			for i > 0 && !s.is(group[i], "[") {
+				i--
+			}
+			continue
+		}
+		if group[i].kind == cppIdent {
+			return strings.Clone(s.text(group[i]))
+		}
+		if s.is(group[i], ".") {
+			return "..."
 		}
 	}
-	
-	return size
+	return ""
+}
+
+// comments renders the documentation comments of the current declaration.
+func (s *cppScanner) comments() string {
+	var parts []string
+	for _, tok := range s.docs {
+		text := s.text(tok)
+		if strings.HasPrefix(text, "//") {
+			if part := strings.TrimSpace(strings.TrimLeft(text, "/")); part != "" {
+				parts = append(parts, part)
+			}
+			continue
+		}
+		text = strings.TrimSuffix(strings.TrimPrefix(text, "/**"), "*/")
+		for _, line := range strings.Split(text, "\n") {
+			line = strings.TrimSpace(strings.TrimPrefix(strings.TrimSpace(line), "*"))
+			if line != "" {
+				parts = append(parts, line)
+			}
+		}
+	}
+	if len(parts) == 0 {
+		return ""
+	}
+	return strings.Clone(strings.Join(parts, " "))
 }
 
 func isCppTestFunction(name, fullName string) bool {
 	testPatterns := []string{"test", "Test", "TEST"}
-	
+
 	for _, pattern := range testPatterns {
 		if strings.Contains(name, pattern) || strings.Contains(fullName, pattern) {
 			return true
 		}
 	}
-	
+
 	return false
 }
 
-func isCppBuiltin(name string) bool {
-	builtins := []string{
-		// C++ standard library
-		"cout", "cin", "cerr", "clog", "endl", "flush",
-		"string", "vector", "list", "map", "set", "unordered_map", "unordered_set",
-		"shared_ptr", "unique_ptr", "weak_ptr", "make_shared", "make_unique",
-		"thread", "mutex", "lock_guard", "unique_lock",
-		"begin", "end", "size", "empty", "clear", "push_back", "pop_back",
-		"insert", "erase", "find", "count", "at", "front", "back",
-		// C standard library (inherited)
-		"printf", "scanf", "malloc", "free", "strlen", "strcpy", "strcmp",
-		"memcpy", "memset", "assert",
-	}
-	
-	for _, builtin := range builtins {
-		if name == builtin {
-			return true
-		}
+// cppBuiltins are standard library names never reported as calls.
+var cppBuiltins = wordSet(
+	// C++ standard library
+	"cout", "cin", "cerr", "clog", "endl", "flush",
+	"string", "vector", "list", "map", "set", "unordered_map", "unordered_set",
+	"shared_ptr", "unique_ptr", "weak_ptr", "make_shared", "make_unique",
+	"thread", "mutex", "lock_guard", "unique_lock",
+	"begin", "end", "size", "empty", "clear", "push_back", "pop_back",
+	"insert", "erase", "find", "count", "at", "front", "back",
+	// C standard library (inherited)
+	"printf", "scanf", "malloc", "free", "strlen", "strcpy", "strcmp",
+	"memcpy", "memset", "assert",
+)
+
+var cppKeywords = wordSet(
+	"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor",
+	"bool", "break", "case", "catch", "char", "char16_t", "char32_t", "class",
+	"compl", "concept", "const", "constexpr", "const_cast", "continue",
+	"decltype", "default", "delete", "do", "double", "dynamic_cast",
+	"else", "enum", "explicit", "export", "extern", "false", "float",
+	"for", "friend", "goto", "if", "inline", "int", "long", "mutable",
+	"namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator",
+	"or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
+	"requires", "return", "short", "signed", "sizeof", "static", "static_assert",
+	"static_cast", "struct", "switch", "template", "this", "thread_local",
+	"throw", "true", "try", "typedef", "typeid", "typename", "union",
+	"unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while",
+	"xor", "xor_eq", "override", "final",
+)
+
+func wordSet(words ...string) map[string]bool {
+	set := make(map[string]bool, len(words))
+	for _, word := range words {
+		set[word] = true
 	}
-	
-	return false
+	return set
+}
+
+func isCppBuiltin(name string) bool {
+	return cppBuiltins[name]
 }
 
 func isCppKeyword(name string) bool {
-	keywords := []string{
-		// C++ keywords
-		"alignas", "alignof", "and", "and_eq", "asm", "auto", "bitand", "bitor",
-		"bool", "break", "case", "catch", "char", "char16_t", "char32_t", "class",
-		"compl", "concept", "const", "constexpr", "const_cast", "continue",
-		"decltype", "default", "delete", "do", "double", "dynamic_cast",
-		"else", "enum", "explicit", "export", "extern", "false", "float",
-		"for", "friend", "goto", "if", "inline", "int", "long", "mutable",
-		"namespace", "new", "noexcept", "not", "not_eq", "nullptr", "operator",
-		"or", "or_eq", "private", "protected", "public", "register", "reinterpret_cast",
-		"requires", "return", "short", "signed", "sizeof", "static", "static_assert",
-		"static_cast", "struct", "switch", "template", "this", "thread_local",
-		"throw", "true", "try", "typedef", "typeid", "typename", "union",
-		"unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while",
-		"xor", "xor_eq", "override", "final",
-	}
-	
-	for _, keyword := range keywords {
-		if name == keyword {
-			return true
-		}
-	}
-	
-	return false
-}
\ No newline at end of file
+	return cppKeywords[name]
+}
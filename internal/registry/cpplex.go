@@ -0,0 +1,293 @@
+package registry
+
+// cppTokenKind classifies the tokens produced by cppLexer.
+type cppTokenKind uint8
+
+const (
+	cppEOF cppTokenKind = iota
+	cppIdent
+	cppNumber
+	cppString
+	cppPunct
+	cppComment
+)
+
+// cppToken is a span of the lexed source; its text is never copied.
+type cppToken struct {
+	kind  cppTokenKind
+	start int
+	end   int
+	line  int
+	// first is set when only whitespace precedes the token on its line.
+	first bool
+}
+
+// cppLexer splits C and C++ source into tokens. Preprocessor directives are
+// consumed and never returned; of each #if chain only the first branch not
+// disabled by "#if 0" produces tokens, so alternative branches cannot
+// unbalance the braces.
+type cppLexer struct {
+	src   string
+	pos   int
+	line  int
+	first bool
+	conds []cppCondition
+}
+
+type cppCondition struct {
+	taken    bool
+	skipping bool
+	outer    bool
+}
+
+func newCppLexer(src string) *cppLexer {
+	return &cppLexer{src: src, line: 1, first: true}
+}
+
+func (l *cppLexer) text(tok cppToken) string {
+	return l.src[tok.start:tok.end]
+}
+
+func (l *cppLexer) skipping() bool {
+	return len(l.conds) > 0 && l.conds[len(l.conds)-1].skipping
+}
+
+// next returns the next token, or one of kind cppEOF at the end.
+func (l *cppLexer) next() cppToken {
+	for {
+		tok := l.scan()
+		if tok.kind == cppEOF || !l.skipping() {
+			return tok
+		}
+	}
+}
+
+func (l *cppLexer) scan() cppToken {
+	src := l.src
+	for l.pos < len(src) {
+		c := src[l.pos]
+		if c == '\n' {
+			l.line++
+			l.first = true
+			l.pos++
+		} else if c == ' ' || c == '\t' || c == '\r' || c == '\f' || c == '\v' {
+			l.pos++
+		} else if c == '\\' && l.pos+1 < len(src) && (src[l.pos+1] == '\n' || src[l.pos+1] == '\r') {
+			l.pos++
+		} else if c == '#' && l.first {
+			l.directive()
+		} else {
+			break
+		}
+	}
+	if l.pos >= len(src) {
+		return cppToken{kind: cppEOF, start: len(src), end: len(src), line: l.line}
+	}
+
+	tok := cppToken{start: l.pos, line: l.line, first: l.first}
+	l.first = false
+
+	c := src[l.pos]
+	switch {
+	case isCppIdentByte(c) && !isDigit(c):
+		l.pos++
+		for l.pos < len(src) && isCppIdentByte(src[l.pos]) {
+			l.pos++
+		}
+		tok.kind = cppIdent
+		if l.pos < len(src) && (src[l.pos] == '"' || src[l.pos] == '\'') {
+			switch prefix := src[tok.start:l.pos]; prefix {
+			case "R", "u8R", "uR", "UR", "LR":
+				if src[l.pos] == '"' {
+					tok.kind = cppString
+					l.rawString()
+				}
+			case "u8", "u", "U", "L":
+				tok.kind = cppString
+				l.quoted(src[l.pos])
+			}
+		}
+	case isDigit(c) || c == '.' && l.pos+1 < len(src) && isDigit(src[l.pos+1]):
+		tok.kind = cppNumber
+		l.number()
+	case c == '"' || c == '\'':
+		tok.kind = cppString
+		l.quoted(c)
+	case c == '/' && l.pos+1 < len(src) && src[l.pos+1] == '/':
+		tok.kind = cppComment
+		l.lineComment()
+	case c == '/' && l.pos+1 < len(src) && src[l.pos+1] == '*':
+		tok.kind = cppComment
+		l.blockComment()
+	case c == ':' && l.pos+1 < len(src) && src[l.pos+1] == ':',
+		c == '-' && l.pos+1 < len(src) && src[l.pos+1] == '>':
+		tok.kind = cppPunct
+		l.pos += 2
+	default:
+		tok.kind = cppPunct
+		l.pos++
+	}
+
+	tok.end = l.pos
+	return tok
+}
+
+func (l *cppLexer) number() {
+	src := l.src
+	for l.pos < len(src) {
+		c := src[l.pos]
+		switch {
+		case isCppIdentByte(c) || c == '.':
+			l.pos++
+		case (c == '+' || c == '-') && l.pos > 0 && (src[l.pos-1]|0x20 == 'e' || src[l.pos-1]|0x20 == 'p'):
+			l.pos++
+		case c == '\'' && l.pos+1 < len(src) && isCppIdentByte(src[l.pos+1]):
+			// Digit separator, as in 1'000'000.
+			l.pos++
+		default:
+			return
+		}
+	}
+}
+
+// quoted consumes a string or character literal opened by quote.
+func (l *cppLexer) quoted(quote byte) {
+	src := l.src
+	l.pos++
+	for l.pos < len(src) {
+		c := src[l.pos]
+		if c == '\\' && l.pos+1 < len(src) {
+			if src[l.pos+1] == '\n' {
+				l.line++
+			}
+			l.pos += 2
+			continue
+		}
+		if c == '\n' {
+			// Unterminated; stop at the end of the line.
+			return
+		}
+		l.pos++
+		if c == quote {
+			return
+		}
+	}
+}
+
+// rawString consumes R"delim( ... )delim".
+func (l *cppLexer) rawString() {
+	src := l.src
+	open := l.pos + 1
+	paren := open
+	for paren < len(src) && src[paren] != '(' && paren-open <= 16 {
+		paren++
+	}
+	if paren >= len(src) || src[paren] != '(' {
+		l.quoted('"')
+		return
+	}
+
+	closing := ")" + src[open:paren] + "\""
+	l.pos = paren + 1
+	for l.pos < len(src) {
+		if src[l.pos] == '\n' {
+			l.line++
+		} else if src[l.pos] == ')' && len(src)-l.pos >= len(closing) && src[l.pos:l.pos+len(closing)] == closing {
+			l.pos += len(closing)
+			return
+		}
+		l.pos++
+	}
+}
+
+func (l *cppLexer) lineComment() {
+	src := l.src
+	for l.pos < len(src) && src[l.pos] != '\n' {
+		l.pos++
+	}
+}
+
+func (l *cppLexer) blockComment() {
+	src := l.src
+	l.pos += 2
+	for l.pos < len(src) {
+		if src[l.pos] == '\n' {
+			l.line++
+		} else if src[l.pos] == '*' && l.pos+1 < len(src) && src[l.pos+1] == '/' {
+			l.pos += 2
+			return
+		}
+		l.pos++
+	}
+}
+
+// directive consumes a preprocessor line, including continuation lines and
+// comments, and tracks conditional branches.
+func (l *cppLexer) directive() {
+	src := l.src
+	l.pos++
+	for l.pos < len(src) && (src[l.pos] == ' ' || src[l.pos] == '\t') {
+		l.pos++
+	}
+	nameStart := l.pos
+	for l.pos < len(src) && isCppIdentByte(src[l.pos]) {
+		l.pos++
+	}
+	name := src[nameStart:l.pos]
+
+	argStart := l.pos
+	for l.pos < len(src) && src[l.pos] != '\n' {
+		switch {
+		case src[l.pos] == '\\' && l.pos+1 < len(src) && src[l.pos+1] == '\n':
+			l.line++
+			l.pos += 2
+		case src[l.pos] == '/' && l.pos+1 < len(src) && src[l.pos+1] == '*':
+			l.blockComment()
+		case src[l.pos] == '/' && l.pos+1 < len(src) && src[l.pos+1] == '/':
+			l.lineComment()
+		default:
+			l.pos++
+		}
+	}
+	arg := trimCppSpace(src[argStart:l.pos])
+
+	skipping := l.skipping()
+	switch name {
+	case "if", "ifdef", "ifndef":
+		disabled := name == "if" && arg == "0"
+		l.conds = append(l.conds, cppCondition{taken: !disabled, skipping: skipping || disabled, outer: skipping})
+	case "elif", "else", "elifdef", "elifndef":
+		if n := len(l.conds); n > 0 {
+			cond := &l.conds[n-1]
+			if cond.taken {
+				cond.skipping = true
+			} else {
+				cond.taken = !(name == "elif" && arg == "0")
+				cond.skipping = cond.outer || !cond.taken
+			}
+		}
+	case "endif":
+		if n := len(l.conds); n > 0 {
+			l.conds = l.conds[:n-1]
+		}
+	}
+}
+
+func trimCppSpace(s string) string {
+	start, end := 0, len(s)
+	for start < end && (s[start] == ' ' || s[start] == '\t' || s[start] == '\r') {
+		start++
+	}
+	for end > start && (s[end-1] == ' ' || s[end-1] == '\t' || s[end-1] == '\r') {
+		end--
+	}
+	return s[start:end]
+}
+
+func isCppIdentByte(c byte) bool {
+	return c >= 'a' && c <= 'z' || c >= 'A' && c <= 'Z' || c >= '0' && c <= '9' || c == '_' || c == '$' || c >= 0x80
+}
+
+func isDigit(c byte) bool {
+	return c >= '0' && c <= '9'
+}
@@ -1,14 +1,34 @@
 package registry
 
 import (
-	"os"
 	"path/filepath"
 	"regexp"
 	"strings"
+
+	"github.com/vitruves/gop/internal/source"
 )
 
 type GenericParser struct{}
 
+type genericDefinition struct {
+	regex    *regexp.Regexp
+	language string
+}
+
+// Generic patterns for different languages
+var genericPatterns = struct {
+	definitions []genericDefinition
+	call        *regexp.Regexp
+}{
+	definitions: []genericDefinition{
+		{regexp.MustCompile(`^\s*(def|async def)\s+(\w+)\s*\(`), "python"},
+		{regexp.MustCompile(`^\s*(pub\s+)?fn\s+(\w+)\s*\(`), "rust"},
+		{regexp.MustCompile(`^\s*func\s+(\w+)\s*\(`), "go"},
+		{regexp.MustCompile(`^\s*(\w+)\s+(\w+)\s*\(.*\)\s*[{;]`), "c/cpp"},
+	},
+	call: regexp.MustCompile(`(\w+)\s*\(`),
+}
+
 func (g *GenericParser) GetExtensions() []string {
 	return []string{".py", ".rs", ".go", ".c", ".cpp", ".cxx", ".cc", ".h", ".hpp", ".hxx", ".hh"}
 }
@@ -25,30 +45,18 @@ func (g *GenericParser) IsHeaderFile(filePath string) bool {
 }
 
 func (g *GenericParser) ParseFile(filePath string) ([]Function, error) {
-	content, err := os.ReadFile(filePath)
-	if err != nil {
-		return nil, err
-	}
+	return parseFile(g, filePath)
+}
 
+func (g *GenericParser) ParseSource(filePath string, src *source.File) ([]Function, error) {
 	var functions []Function
-	lines := strings.Split(string(content), "\n")
-	
-	// Generic patterns for different languages
-	patterns := []struct {
-		regex    *regexp.Regexp
-		language string
-	}{
-		{regexp.MustCompile(`^\s*(def|async def)\s+(\w+)\s*\(`), "python"},
-		{regexp.MustCompile(`^\s*(pub\s+)?fn\s+(\w+)\s*\(`), "rust"},
-		{regexp.MustCompile(`^\s*func\s+(\w+)\s*\(`), "go"},
-		{regexp.MustCompile(`^\s*(\w+)\s+(\w+)\s*\(.*\)\s*[{;]`), "c/cpp"},
-	}
+	lines := strings.Split(src.Owned(), "\n")
 	
 	ext := filepath.Ext(filePath)
 	detectedLang := detectLanguageFromExtension(ext)
 	
 	for i, line := range lines {
-		for _, pattern := range patterns {
+		for _, pattern := range genericPatterns.definitions {
 			if matches := pattern.regex.FindStringSubmatch(line); matches != nil {
 				var name string
 				
@@ -99,23 +107,19 @@ func (g *GenericParser) ParseFile(filePath string) ([]Function, error) {
 	return functions, nil
 }
 
-func (g *GenericParser) FindFunctionCalls(content string) []string {
+func (g *GenericParser) FindCallSites(content string) []CallSite {
 	// Generic function call patterns
-	callRegex := regexp.MustCompile(`(\w+)\s*\(`)
-	matches := callRegex.FindAllStringSubmatch(content, -1)
-	
-	var calls []string
-	seen := make(map[string]bool)
+	var sites []CallSite
+	lines := newLineCounter(content)
 	
-	for _, match := range matches {
-		call := match[1]
-		if !seen[call] && !isGenericBuiltin(call) && !isGenericKeyword(call) {
-			calls = append(calls, call)
-			seen[call] = true
+	for _, match := range genericPatterns.call.FindAllStringSubmatchIndex(content, -1) {
+		call := content[match[2]:match[3]]
+		if !isGenericBuiltin(call) && !isGenericKeyword(call) {
+			sites = append(sites, CallSite{Name: call, Line: lines.lineAt(match[2])})
 		}
 	}
 	
-	return calls
+	return sites
 }
 
 func detectLanguageFromExtension(ext string) string {
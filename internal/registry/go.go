@@ -5,9 +5,15 @@ import (
 	"go/parser"
 	"go/token"
 	"strings"
+
+	"github.com/vitruves/gop/internal/source"
 )
 
-type GoParser struct{}
+// GoParser parses Go with go/parser. SkipDocs leaves comments unparsed,
+// so functions carry no doc comments.
+type GoParser struct {
+	SkipDocs bool
+}
 
 func (g *GoParser) GetExtensions() []string {
 	return []string{".go"}
@@ -18,17 +24,53 @@ func (g *GoParser) IsHeaderFile(filePath string) bool {
 }
 
 func (g *GoParser) ParseFile(filePath string) ([]Function, error) {
+	return parseFile(g, filePath)
+}
+
+func (g *GoParser) ParseSource(filePath string, src *source.File) ([]Function, error) {
+	functions, _, err := g.parse(filePath, src.Bytes(), false)
+	return functions, err
+}
+
+// AnalyzeSource parses the file once and collects its call sites from the
+// same walk of the AST that finds its functions.
+func (g *GoParser) AnalyzeSource(filePath string, src *source.File) ([]Function, []CallSite, error) {
+	functions, sites, err := g.parse(filePath, src.Bytes(), true)
+	if err != nil {
+		return nil, g.findCallSitesWithRegex(src.String()), err
+	}
+	return functions, sites, nil
+}
+
+func (g *GoParser) FindCallSites(content string) []CallSite {
+	_, sites, err := g.parse("", []byte(content), true)
+	if err != nil {
+		// Fallback to regex if AST parsing fails
+		return g.findCallSitesWithRegex(content)
+	}
+	return sites
+}
+
+// parse walks the AST of content once for its functions and, when calls is
+// set, its call sites. Identifiers are never resolved to objects, and
+// comments are only parsed when doc comments are kept.
+func (g *GoParser) parse(filePath string, content []byte, calls bool) ([]Function, []CallSite, error) {
+	mode := parser.SkipObjectResolution
+	if !g.SkipDocs {
+		mode |= parser.ParseComments
+	}
 	fset := token.NewFileSet()
-	node, err := parser.ParseFile(fset, filePath, nil, parser.ParseComments)
+	node, err := parser.ParseFile(fset, filePath, content, mode)
 	if err != nil {
-		return nil, err
+		return nil, nil, err
 	}
 
 	var functions []Function
-	
+	var sites []CallSite
+
 	// Extract function documentation from comments
 	funcDocs := make(map[string]string)
-	
+
 	for _, decl := range node.Decls {
 		if fn, ok := decl.(*ast.FuncDecl); ok && fn.Name != nil {
 			if fn.Doc != nil {
@@ -41,131 +83,148 @@ func (g *GoParser) ParseFile(filePath string) ([]Function, error) {
 		switch x := n.(type) {
 		case *ast.FuncDecl:
 			if x.Name != nil {
-				pos := fset.Position(x.Pos())
-				end := fset.Position(x.End())
-				
-				visibility := "private"
-				if x.Name.IsExported() {
-					visibility = "public"
-				}
-				
-				var params []string
-				if x.Type.Params != nil {
-					for _, param := range x.Type.Params.List {
-						for _, name := range param.Names {
-							params = append(params, name.Name)
-						}
-					}
-				}
-				
-				returnType := parseGoReturnType(x.Type.Results)
-				
-				isTest := strings.HasPrefix(x.Name.Name, "Test") || 
-				         strings.HasPrefix(x.Name.Name, "Benchmark") || 
-				         strings.HasPrefix(x.Name.Name, "Example")
-				isMain := x.Name.Name == "main"
-				
-				// Determine if it's a method
-				var fullName string
-				var receiverType string
-				if x.Recv != nil && len(x.Recv.List) > 0 {
-					receiverType = extractReceiverType(x.Recv.List[0])
-					fullName = receiverType + "." + x.Name.Name
-				} else {
-					fullName = x.Name.Name
-				}
-				
-				fn := Function{
-					Name:       fullName,
-					File:       filePath,
-					Line:       pos.Line,
-					Visibility: visibility,
-					ReturnType: returnType,
-					Parameters: params,
-					Language:   "go",
-					Signature:  extractGoSignature(x, fset),
-					IsTest:     isTest,
-					IsMain:     isMain,
-					Size:       end.Line - pos.Line + 1,
-					Comments:   funcDocs[x.Name.Name],
-					Complexity: calculateGoComplexity(x),
-				}
-				
-				// Add metadata
-				fn.Metadata = make(map[string]string)
-				if receiverType != "" {
-					fn.Metadata["receiver"] = receiverType
-					fn.Metadata["method"] = "true"
-				}
-				if isGenericFunction(x) {
-					fn.Metadata["generic"] = "true"
-				}
-				
-				functions = append(functions, fn)
+				functions = append(functions, goFunction(x, filePath, fset, funcDocs[x.Name.Name]))
+			}
+		case *ast.CallExpr:
+			if calls {
+				sites = appendCall(sites, fset, x)
+			}
+		case *ast.KeyValueExpr:
+			// Functions handed over as values, such as RunE: runCommand.
+			if calls {
+				sites = appendFuncValue(sites, fset, x.Value)
 			}
 		}
 		return true
 	})
 
-	return functions, nil
+	return functions, sites, nil
 }
 
-func (g *GoParser) FindFunctionCalls(content string) []string {
-	fset := token.NewFileSet()
-	node, err := parser.ParseFile(fset, "", content, 0)
-	if err != nil {
-		// Fallback to regex if AST parsing fails
-		return g.findCallsWithRegex(content)
+func goFunction(x *ast.FuncDecl, filePath string, fset *token.FileSet, doc string) Function {
+	pos := fset.Position(x.Pos())
+	end := fset.Position(x.End())
+
+	visibility := "private"
+	if x.Name.IsExported() {
+		visibility = "public"
 	}
 
-	var calls []string
-	seen := make(map[string]bool)
+	var params []string
+	if x.Type.Params != nil {
+		for _, param := range x.Type.Params.List {
+			for _, name := range param.Names {
+				params = append(params, name.Name)
+			}
+		}
+	}
 
-	ast.Inspect(node, func(n ast.Node) bool {
-		switch x := n.(type) {
-		case *ast.CallExpr:
-			switch fun := x.Fun.(type) {
-			case *ast.Ident:
-				if !seen[fun.Name] && !isGoBuiltin(fun.Name) {
-					calls = append(calls, fun.Name)
-					seen[fun.Name] = true
-				}
-			case *ast.SelectorExpr:
-				if sel := fun.Sel; sel != nil {
-					if !seen[sel.Name] && !isGoBuiltin(sel.Name) {
-						calls = append(calls, sel.Name)
-						seen[sel.Name] = true
-					}
-				}
+	returnType := parseGoReturnType(x.Type.Results)
+
+	isTest := strings.HasPrefix(x.Name.Name, "Test") ||
+		strings.HasPrefix(x.Name.Name, "Benchmark") ||
+		strings.HasPrefix(x.Name.Name, "Example")
+	isMain := x.Name.Name == "main"
+
+	// Determine if it's a method
+	var fullName string
+	var receiverType string
+	if x.Recv != nil && len(x.Recv.List) > 0 {
+		receiverType = extractReceiverType(x.Recv.List[0])
+		fullName = receiverType + "." + x.Name.Name
+	} else {
+		fullName = x.Name.Name
+	}
+
+	fn := Function{
+		Name:       fullName,
+		File:       filePath,
+		Line:       pos.Line,
+		Visibility: visibility,
+		ReturnType: returnType,
+		Parameters: params,
+		Language:   "go",
+		Signature:  extractGoSignature(x, fset),
+		IsTest:     isTest,
+		IsMain:     isMain,
+		Size:       end.Line - pos.Line + 1,
+		Comments:   doc,
+		Complexity: calculateGoComplexity(x),
+	}
+
+	// Add metadata
+	fn.Metadata = make(map[string]string)
+	if receiverType != "" {
+		fn.Metadata["receiver"] = receiverType
+		fn.Metadata["method"] = "true"
+	}
+	if isGenericFunction(x) {
+		fn.Metadata["generic"] = "true"
+	}
+	return fn
+}
+
+// appendCall records the function or method x calls, and the functions it
+// passes as arguments.
+func appendCall(sites []CallSite, fset *token.FileSet, x *ast.CallExpr) []CallSite {
+	fun := x.Fun
+	// Explicit instantiations, as in NewResults[T](n).
+	switch index := fun.(type) {
+	case *ast.IndexExpr:
+		fun = index.X
+	case *ast.IndexListExpr:
+		fun = index.X
+	}
+	switch fun := fun.(type) {
+	case *ast.Ident:
+		if !isGoBuiltin(fun.Name) {
+			sites = append(sites, CallSite{Name: fun.Name, Line: fset.Position(fun.Pos()).Line})
+		}
+	case *ast.SelectorExpr:
+		if sel := fun.Sel; sel != nil {
+			// pkg.Func or value.Method; the resolver tells them apart.
+			site := CallSite{Name: sel.Name, Member: true, Line: fset.Position(sel.Pos()).Line}
+			if ident, ok := fun.X.(*ast.Ident); ok {
+				site.Qualifier = ident.Name
 			}
+			sites = append(sites, site)
 		}
-		return true
-	})
+	}
+	for _, arg := range x.Args {
+		sites = appendFuncValue(sites, fset, arg)
+	}
+	return sites
+}
 
-	return calls
+// appendFuncValue records expr as a call site when it is a bare identifier
+// that may name a function passed as a value, so callbacks are not reported
+// as dead code.
+func appendFuncValue(sites []CallSite, fset *token.FileSet, expr ast.Expr) []CallSite {
+	if ident, ok := expr.(*ast.Ident); ok && !isGoBuiltin(ident.Name) && ident.Name != "nil" && ident.Name != "true" && ident.Name != "false" {
+		sites = append(sites, CallSite{Name: ident.Name, Line: fset.Position(ident.Pos()).Line})
+	}
+	return sites
 }
 
-func (g *GoParser) findCallsWithRegex(content string) []string {
+func (g *GoParser) findCallSitesWithRegex(content string) []CallSite {
 	// This is a simplified fallback - the AST method above is preferred
 	lines := strings.Split(content, "\n")
-	var calls []string
-	seen := make(map[string]bool)
+	var sites []CallSite
 	
-	for _, line := range lines {
+	for lineNum, line := range lines {
 		// Simple regex approach for fallback
 		words := strings.Fields(line)
 		for i, word := range words {
 			if strings.HasSuffix(word, "(") && i > 0 {
 				funcName := strings.TrimSuffix(word, "(")
-				if !seen[funcName] && !isGoBuiltin(funcName) {
-					calls = append(calls, funcName)
-					seen[funcName] = true
+				if !isGoBuiltin(funcName) {
+					sites = append(sites, CallSite{Name: funcName, Line: lineNum + 1})
 				}
 			}
 		}
 	}
 	
-	return calls
+	return sites
 }
 
 func parseGoReturnType(results *ast.FieldList) string {
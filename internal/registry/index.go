@@ -0,0 +1,127 @@
+package registry
+
+import (
+	"fmt"
+	"path/filepath"
+	"sort"
+	"sync"
+
+	"github.com/vitruves/gop/internal/source"
+)
+
+// Index keeps the functions of every file in memory and replaces them one
+// file at a time, for gop serve. Calls are not resolved, so CallCount,
+// CalledBy and Calls stay empty.
+type Index struct {
+	parser     LanguageParser
+	extensions map[string]bool
+
+	mu    sync.RWMutex
+	files map[string][]Function
+}
+
+// NewIndex returns an empty index for config.Language, honouring
+// config.OnlyHeaderFiles.
+func NewIndex(config Config) (*Index, error) {
+	parser := newParser(config)
+	if parser == nil {
+		return nil, fmt.Errorf("unsupported language: %s", config.Language)
+	}
+	index := &Index{
+		parser:     parser,
+		extensions: parserExtensions(config, parser),
+		files:      make(map[string][]Function),
+	}
+	return index, nil
+}
+
+// parserExtensions is the set of extensions a run of config parses.
+func parserExtensions(config Config, parser LanguageParser) map[string]bool {
+	extensions := make(map[string]bool)
+	for _, ext := range walkerConfig(config, parser).Extensions {
+		extensions[ext] = true
+	}
+	return extensions
+}
+
+// Accepts reports whether the index parses files like path.
+func (ix *Index) Accepts(path string) bool {
+	return ix.extensions[filepath.Ext(path)]
+}
+
+// Update parses path and replaces what the index knows about it. A file
+// that fails to parse is dropped.
+func (ix *Index) Update(path string) error {
+	src, err := source.Open(path)
+	if err != nil {
+		ix.Remove(path)
+		return err
+	}
+	defer src.Close()
+	return ix.UpdateSource(path, src)
+}
+
+// UpdateSource is Update for src, the content of path the caller already
+// read. src may be closed once it returns.
+func (ix *Index) UpdateSource(path string, src *source.File) error {
+	functions, err := parseOpened(ix.parser, path, src)
+	ix.mu.Lock()
+	defer ix.mu.Unlock()
+	if err != nil {
+		delete(ix.files, path)
+		return err
+	}
+	ix.files[path] = functions
+	return nil
+}
+
+// Remove forgets path.
+func (ix *Index) Remove(path string) {
+	ix.mu.Lock()
+	defer ix.mu.Unlock()
+	delete(ix.files, path)
+}
+
+// Files returns how many files the index holds.
+func (ix *Index) Files() int {
+	ix.mu.RLock()
+	defer ix.mu.RUnlock()
+	return len(ix.files)
+}
+
+// Functions returns, ordered by file and line, the functions called name in
+// file. An empty name or file matches every one.
+func (ix *Index) Functions(name, file string) []Function {
+	ix.mu.RLock()
+	var matches []Function
+	for path, functions := range ix.files {
+		if file != "" && path != file {
+			continue
+		}
+		for _, fn := range functions {
+			if name == "" || fn.Name == name {
+				matches = append(matches, fn)
+			}
+		}
+	}
+	ix.mu.RUnlock()
+
+	sort.SliceStable(matches, func(i, j int) bool {
+		if matches[i].File != matches[j].File {
+			return matches[i].File < matches[j].File
+		}
+		return matches[i].Line < matches[j].Line
+	})
+	return matches
+}
+
+// Summary summarizes every function in the index.
+func (ix *Index) Summary() Summary {
+	ix.mu.RLock()
+	defer ix.mu.RUnlock()
+	var summary Summary
+	for _, functions := range ix.files {
+		summary.add(generateSummary(functions, 1))
+	}
+	return summary
+}
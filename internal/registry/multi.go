@@ -0,0 +1,123 @@
+package registry
+
+import (
+	"path/filepath"
+	"strings"
+
+	"github.com/vitruves/gop/internal/source"
+)
+
+// autoLanguages are what --language auto parses, in the order they claim
+// extensions.
+var autoLanguages = []string{"python", "rust", "go", "c", "cpp"}
+
+// isMultiLanguage reports whether language is "auto" or a comma-separated
+// list, which one run parses together.
+func isMultiLanguage(language string) bool {
+	return language == "auto" || strings.Contains(language, ",")
+}
+
+func splitLanguages(language string) []string {
+	if language == "auto" {
+		return autoLanguages
+	}
+	var languages []string
+	for _, name := range strings.Split(language, ",") {
+		if name = strings.TrimSpace(name); name != "" {
+			languages = append(languages, name)
+		}
+	}
+	return languages
+}
+
+// multiParser hands every file to the parser of the first of its languages
+// whose extensions include the file's, so one walk and one worker pool
+// cover them all.
+type multiParser struct {
+	languages  []string
+	parsers    []LanguageParser
+	byExt      map[string]int
+	extensions []string
+}
+
+// newMultiParser returns nil when a listed language has no parser of its
+// own.
+func newMultiParser(language string) LanguageParser {
+	m := &multiParser{byExt: make(map[string]int)}
+	for _, name := range splitLanguages(language) {
+		if parserName(name) != name {
+			return nil
+		}
+		m.languages = append(m.languages, name)
+		m.parsers = append(m.parsers, getParser(name))
+		for _, ext := range m.parsers[len(m.parsers)-1].GetExtensions() {
+			if _, taken := m.byExt[ext]; !taken {
+				m.byExt[ext] = len(m.parsers) - 1
+				m.extensions = append(m.extensions, ext)
+			}
+		}
+	}
+	if len(m.parsers) == 0 {
+		return nil
+	}
+	return m
+}
+
+// parserFor returns the parser of filePath and its language.
+func (m *multiParser) parserFor(filePath string) (LanguageParser, string) {
+	i, ok := m.byExt[filepath.Ext(filePath)]
+	if !ok {
+		i = 0
+	}
+	return m.parsers[i], m.languages[i]
+}
+
+func (m *multiParser) GetExtensions() []string {
+	return m.extensions
+}
+
+func (m *multiParser) ParseFile(filePath string) ([]Function, error) {
+	return parseFile(m, filePath)
+}
+
+func (m *multiParser) ParseSource(filePath string, src *source.File) ([]Function, error) {
+	parser, _ := m.parserFor(filePath)
+	return parser.ParseSource(filePath, src)
+}
+
+func (m *multiParser) IsHeaderFile(filePath string) bool {
+	parser, _ := m.parserFor(filePath)
+	return parser.IsHeaderFile(filePath)
+}
+
+// FindCallSites cannot tell the language from content alone; analyzeSource
+// asks the file's own parser through fileParser instead.
+func (m *multiParser) FindCallSites(content string) []CallSite {
+	return nil
+}
+
+// fileParser returns the parser that handles filePath and the language its
+// work is reported under.
+func fileParser(parser LanguageParser, language, filePath string) (LanguageParser, string) {
+	if m, ok := parser.(*multiParser); ok {
+		return m.parserFor(filePath)
+	}
+	return parser, parserName(language)
+}
+
+// callFamily numbers the groups of languages whose functions can call each
+// other, by file extension; 0 is unknown and matches any.
+func callFamily(filePath string) int8 {
+	switch filepath.Ext(filePath) {
+	case ".py":
+		return 1
+	case ".rs":
+		return 2
+	case ".go":
+		return 3
+	case ".c", ".h", ".cpp", ".cxx", ".cc", ".hpp", ".hxx", ".hh", ".h++", ".c++":
+		return 4
+	default:
+		return 0
+	}
+}
@@ -0,0 +1,425 @@
+package registry
+
+import (
+	"bufio"
+	"encoding/csv"
+	"encoding/json"
+	"fmt"
+	"io"
+	"os"
+	"path/filepath"
+	"sort"
+	"strconv"
+	"strings"
+	"sync"
+
+	"github.com/vitruves/gop/internal/compress"
+	"gopkg.in/yaml.v3"
+)
+
+// outputFormat maps an output file name to the format written to it; a
+// compression extension after it, as in .json.gz, does not count.
+func outputFormat(path string) string {
+	switch filepath.Ext(compress.Trim(path)) {
+	case ".yaml", ".yml":
+		return "yaml"
+	case ".json":
+		return "json"
+	case ".ndjson", ".jsonl":
+		return "ndjson"
+	case ".csv":
+		return "csv"
+	default:
+		return "text"
+	}
+}
+
+// isRecordFormat reports whether format writes one record per function with
+// nothing before them that depends on the whole registry, so functions can
+// be written as soon as they are final.
+func isRecordFormat(format string) bool {
+	return format == "ndjson" || format == "csv"
+}
+
+// output is the buffered destination of a run: stdout, or the output file,
+// which is only created on the first write so a run without results leaves
+// none behind.
+type output struct {
+	*bufio.Writer
+	file *compress.Lazy
+}
+
+func newOutput(path string) *output {
+	if path == "" {
+		return &output{Writer: bufio.NewWriterSize(os.Stdout, 256*1024)}
+	}
+	file := &compress.Lazy{Path: path}
+	return &output{Writer: bufio.NewWriterSize(file, 256*1024), file: file}
+}
+
+func (o *output) close() error {
+	err := o.Flush()
+	if o.file != nil {
+		if cerr := o.file.Close(); err == nil {
+			err = cerr
+		}
+	}
+	return err
+}
+
+// recordWriter writes functions one at a time as NDJSON lines or CSV rows.
+type recordWriter struct {
+	out  *output
+	json *json.Encoder
+	csv  *csv.Writer
+	err  error
+}
+
+var csvHeader = []string{
+	"Name", "File", "Line", "Visibility", "ReturnType", "Parameters",
+	"Language", "CallCount", "Size", "IsTest", "IsMain", "Comments", "Signature",
+}
+
+func newRecordWriter(out *output, format string) *recordWriter {
+	w := &recordWriter{out: out}
+	if format == "csv" {
+		w.csv = csv.NewWriter(out.Writer)
+	} else {
+		w.json = json.NewEncoder(out.Writer)
+		w.json.SetEscapeHTML(false)
+	}
+	return w
+}
+
+func (w *recordWriter) write(fn *Function) {
+	if w.err != nil {
+		return
+	}
+	if w.json != nil {
+		w.err = w.json.Encode(fn)
+		return
+	}
+	w.err = w.csv.Write(csvRecord(fn))
+}
+
+// writeFile writes the functions of one file in line order.
+func (w *recordWriter) writeFile(functions []Function) {
+	sortByLine(functions)
+	for i := range functions {
+		w.write(&functions[i])
+	}
+}
+
+func (w *recordWriter) flush() error {
+	if w.csv != nil {
+		w.csv.Flush()
+		if err := w.csv.Error(); err != nil && w.err == nil {
+			w.err = err
+		}
+	}
+	return w.err
+}
+
+func csvRecord(fn *Function) []string {
+	return []string{
+		fn.Name,
+		fn.File,
+		strconv.Itoa(fn.Line),
+		fn.Visibility,
+		fn.ReturnType,
+		strings.Join(fn.Parameters, ";"), // Use semicolon to separate parameters
+		fn.Language,
+		strconv.Itoa(fn.CallCount),
+		strconv.Itoa(fn.Size),
+		strconv.FormatBool(fn.IsTest),
+		strconv.FormatBool(fn.IsMain),
+		strings.ReplaceAll(fn.Comments, "\n", " "),  // Replace newlines with spaces
+		strings.ReplaceAll(fn.Signature, "\n", " "), // Replace newlines with spaces
+	}
+}
+
+// fileEmitter hands parsed files to emit in walk order as soon as every file
+// before them is done, so nothing has to be kept for the end of the run.
+type fileEmitter struct {
+	mu      sync.Mutex
+	next    int
+	pending map[int]parsedFile
+	emit    func(parsedFile)
+}
+
+func newFileEmitter(emit func(parsedFile)) *fileEmitter {
+	return &fileEmitter{pending: make(map[int]parsedFile), emit: emit}
+}
+
+func (e *fileEmitter) put(idx int, file parsedFile) {
+	e.mu.Lock()
+	defer e.mu.Unlock()
+
+	e.pending[idx] = file
+	for {
+		file, ok := e.pending[e.next]
+		if !ok {
+			return
+		}
+		delete(e.pending, e.next)
+		e.emit(file)
+		e.next++
+	}
+}
+
+// registryView is what a run reports: the kept functions of the store, by
+// index, and the call graph when one was built.
+type registryView struct {
+	store     *functionStore
+	kept      []int32
+	cg        *callGraph
+	relations bool
+}
+
+// function rebuilds function i, with its calls when relations are shown.
+func (v *registryView) function(i int) Function {
+	fn := v.store.function(i)
+	if v.relations {
+		applyRelations(&fn, v.cg, i)
+	}
+	return fn
+}
+
+// dead reports whether function i is unreachable from any entry point.
+// Without a call graph nothing is known to call it, so it counts as dead.
+func (v *registryView) dead(i int) bool {
+	return v.cg == nil || !v.cg.reachable[i]
+}
+
+func (v *registryView) summary(totalFiles int) Summary {
+	summary := Summary{TotalFunctions: len(v.kept), TotalFiles: totalFiles}
+	for _, k := range v.kept {
+		i := int(k)
+		if v.store.public(i) {
+			summary.PublicFunctions++
+		} else {
+			summary.PrivateFunctions++
+		}
+		if v.dead(i) {
+			summary.DeadFunctions++
+		}
+		if v.store.isTest(i) {
+			summary.TestFunctions++
+		}
+	}
+	return summary
+}
+
+// writeOutput writes the finished registry. Every format but YAML rebuilds
+// one function at a time straight into the buffered output; YAML documents
+// are marshalled as a whole.
+func writeOutput(view *registryView, summary Summary, config Config) error {
+	out := newOutput(config.OutputFile)
+	format := outputFormat(config.OutputFile)
+
+	var err error
+	switch {
+	case isRecordFormat(format):
+		view.store.sortByFile(view.kept)
+		w := newRecordWriter(out, format)
+		if w.csv != nil {
+			w.err = w.csv.Write(csvHeader)
+		}
+		for _, i := range view.kept {
+			fn := view.function(int(i))
+			w.write(&fn)
+		}
+		err = w.flush()
+	case format == "text":
+		view.store.sortByFile(view.kept)
+		writeText(out, view, summary, config)
+	case format == "json":
+		err = writeJSON(out, view, summary, config)
+	default:
+		err = writeYAML(out, view, summary, config)
+	}
+
+	if cerr := out.close(); err == nil {
+		err = cerr
+	}
+	return err
+}
+
+// writeJSON writes what json.MarshalIndent makes of the Registry, one
+// function at a time, so the registry is never built in full.
+func writeJSON(out io.Writer, view *registryView, summary Summary, config Config) error {
+	w := &jsonWriter{out: out}
+	w.raw("{\n  \"functions\": ")
+	w.functions(view, view.kept, "  ")
+
+	if config.ByScript && len(view.kept) > 0 {
+		byFile := append([]int32(nil), view.kept...)
+		sort.SliceStable(byFile, func(a, b int) bool {
+			return view.store.file(int(byFile[a])) < view.store.file(int(byFile[b]))
+		})
+
+		w.raw(",\n  \"scripts\": {")
+		for start := 0; start < len(byFile); {
+			file := view.store.files[byFile[start]]
+			end := start + 1
+			for end < len(byFile) && view.store.files[byFile[end]] == file {
+				end++
+			}
+			if start > 0 {
+				w.raw(",")
+			}
+			w.raw("\n    ")
+			w.value(view.store.file(int(byFile[start])), "    ")
+			w.raw(": ")
+			w.functions(view, byFile[start:end], "    ")
+			start = end
+		}
+		w.raw("\n  }")
+	}
+
+	w.raw(",\n  \"summary\": ")
+	w.value(summary, "  ")
+	w.raw("\n}")
+	return w.err
+}
+
+// jsonWriter writes indented JSON piecewise. The first error sticks.
+type jsonWriter struct {
+	out io.Writer
+	err error
+}
+
+func (w *jsonWriter) raw(s string) {
+	if w.err == nil {
+		_, w.err = io.WriteString(w.out, s)
+	}
+}
+
+// value writes v as it would appear nested at indent.
+func (w *jsonWriter) value(v interface{}, indent string) {
+	if w.err != nil {
+		return
+	}
+	data, err := json.MarshalIndent(v, indent, "  ")
+	if err != nil {
+		w.err = err
+		return
+	}
+	_, w.err = w.out.Write(data)
+}
+
+func (w *jsonWriter) functions(view *registryView, indices []int32, indent string) {
+	if len(indices) == 0 {
+		w.raw("[]")
+		return
+	}
+	w.raw("[")
+	for k, i := range indices {
+		if k > 0 {
+			w.raw(",")
+		}
+		w.raw("\n" + indent + "  ")
+		fn := view.function(int(i))
+		w.value(&fn, indent+"  ")
+	}
+	w.raw("\n" + indent + "]")
+}
+
+// writeYAML marshals the Registry as a whole.
+func writeYAML(out io.Writer, view *registryView, summary Summary, config Config) error {
+	registry := &Registry{Functions: make([]Function, len(view.kept)), Scripts: map[string][]Function{}, Summary: summary}
+	for k, i := range view.kept {
+		registry.Functions[k] = view.function(int(i))
+	}
+	if config.ByScript {
+		for _, fn := range registry.Functions {
+			registry.Scripts[fn.File] = append(registry.Scripts[fn.File], fn)
+		}
+	}
+
+	data, err := yaml.Marshal(registry)
+	if err != nil {
+		return err
+	}
+	_, err = out.Write(data)
+	return err
+}
+
+// writeText writes the Markdown report. The kept functions must be sorted by
+// file, so --by-script sections are consecutive runs of them. Write errors
+// stick to the buffered output and surface when it is closed.
+func writeText(out io.Writer, view *registryView, summary Summary, config Config) {
+	fmt.Fprintf(out, "# Function Registry\n\n")
+
+	fmt.Fprintf(out, "## Summary\n")
+	fmt.Fprintf(out, "- Total Functions: %d\n", summary.TotalFunctions)
+	fmt.Fprintf(out, "- Total Files: %d\n", summary.TotalFiles)
+	fmt.Fprintf(out, "- Public Functions: %d\n", summary.PublicFunctions)
+	fmt.Fprintf(out, "- Private Functions: %d\n", summary.PrivateFunctions)
+	fmt.Fprintf(out, "- Dead Functions: %d\n", summary.DeadFunctions)
+	fmt.Fprintf(out, "- Test Functions: %d\n", summary.TestFunctions)
+	fmt.Fprintf(out, "\n")
+
+	if !config.ByScript {
+		fmt.Fprintf(out, "## Functions\n\n")
+	}
+	files := view.store.files
+	for k, i := range view.kept {
+		if config.ByScript && (k == 0 || files[i] != files[view.kept[k-1]]) {
+			if k > 0 {
+				fmt.Fprintf(out, "\n")
+			}
+			fmt.Fprintf(out, "## %s\n\n", view.store.file(int(i)))
+		}
+		fn := view.function(int(i))
+		writeFunction(out, &fn)
+	}
+	if config.ByScript && len(view.kept) > 0 {
+		fmt.Fprintf(out, "\n")
+	}
+}
+
+func writeFunction(out io.Writer, fn *Function) {
+	fmt.Fprintf(out, "### %s\n", fn.Name)
+	fmt.Fprintf(out, "- **File**: %s:%d\n", fn.File, fn.Line)
+	fmt.Fprintf(out, "- **Visibility**: %s\n", fn.Visibility)
+	fmt.Fprintf(out, "- **Return Type**: %s\n", fn.ReturnType)
+	fmt.Fprintf(out, "- **Parameters**: %s\n", strings.Join(fn.Parameters, ", "))
+	fmt.Fprintf(out, "- **Language**: %s\n", fn.Language)
+	fmt.Fprintf(out, "- **Call Count**: %d\n", fn.CallCount)
+	fmt.Fprintf(out, "- **Size**: %d lines\n", fn.Size)
+
+	if fn.IsTest {
+		fmt.Fprintf(out, "- **Type**: Test Function\n")
+	}
+
+	if fn.IsMain {
+		fmt.Fprintf(out, "- **Type**: Main Function\n")
+	}
+
+	if fn.Complexity > 0 {
+		fmt.Fprintf(out, "- **Complexity**: %d\n", fn.Complexity)
+	}
+
+	if len(fn.CalledBy) > 0 {
+		fmt.Fprintf(out, "- **Called By**: %s\n", strings.Join(fn.CalledBy, ", "))
+	}
+
+	if len(fn.Calls) > 0 {
+		fmt.Fprintf(out, "- **Calls**: %s\n", strings.Join(fn.Calls, ", "))
+	}
+
+	if fn.Comments != "" {
+		fmt.Fprintf(out, "- **Comments**: %s\n", fn.Comments)
+	}
+
+	fmt.Fprintf(out, "- **Signature**: `%s`\n", fn.Signature)
+	fmt.Fprintf(out, "\n")
+}
+
+// sortByLine keeps functions on the same line in the order they were found.
+func sortByLine(functions []Function) {
+	sort.SliceStable(functions, func(i, j int) bool {
+		return functions[i].Line < functions[j].Line
+	})
+}
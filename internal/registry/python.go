@@ -1,13 +1,26 @@
 package registry
 
 import (
-	"os"
 	"regexp"
 	"strings"
+
+	"github.com/vitruves/gop/internal/source"
 )
 
 type PythonParser struct{}
 
+var pythonPatterns = struct {
+	def       *regexp.Regexp
+	class     *regexp.Regexp
+	decorator *regexp.Regexp
+	call      *regexp.Regexp
+}{
+	def:       regexp.MustCompile(`^\s*(def|async def)\s+(\w+)\s*\((.*?)\)(?:\s*->\s*([^:]+))?\s*:`),
+	class:     regexp.MustCompile(`^\s*class\s+(\w+)(?:\s*\([^)]*\))?\s*:`),
+	decorator: regexp.MustCompile(`^\s*@(\w+)`),
+	call:      regexp.MustCompile(`(?:(\w+)\.)?(\w+)\s*\(`),
+}
+
 func (p *PythonParser) GetExtensions() []string {
 	return []string{".py"}
 }
@@ -17,127 +30,182 @@ func (p *PythonParser) IsHeaderFile(filePath string) bool {
 }
 
 func (p *PythonParser) ParseFile(filePath string) ([]Function, error) {
-	content, err := os.ReadFile(filePath)
-	if err != nil {
-		return nil, err
-	}
+	return parseFile(p, filePath)
+}
 
-	var functions []Function
-	lines := strings.Split(string(content), "\n")
+// pythonScope is a def or class whose body has not ended yet.
+type pythonScope struct {
+	indent   int
+	start    int
+	function int    // index in functions, or -1 for a class
+	class    string // class name, for a class
+}
 
-	defRegex := regexp.MustCompile(`^\s*(def|async def)\s+(\w+)\s*\((.*?)\)(?:\s*->\s*([^:]+))?\s*:`)
-	classRegex := regexp.MustCompile(`^\s*class\s+(\w+)(?:\s*\([^)]*\))?\s*:`)
-	decoratorRegex := regexp.MustCompile(`^\s*@(\w+)`)
+// ParseSource reads the file one logical line at a time, keeping the defs
+// and classes that are open in a stack by indentation. A scope closes when
+// a statement at or left of its indentation starts, which is when its size
+// is known; docstrings are the first statement inside a def. Each line is
+// looked at once, so nesting and file size do not make parsing quadratic.
+func (p *PythonParser) ParseSource(filePath string, src *source.File) ([]Function, error) {
+	var functions []Function
+	lines := strings.Split(src.Owned(), "\n")
 
-	var currentClass string
+	var scopes []pythonScope
 	var currentDecorators []string
+	var scanner pythonScanner
+	docFor := -1
+
+	// closeScopes ends the scopes a statement on line at indent closes.
+	closeScopes := func(indent, line int) {
+		for len(scopes) > 0 && scopes[len(scopes)-1].indent >= indent {
+			scope := scopes[len(scopes)-1]
+			if scope.function >= 0 {
+				functions[scope.function].Size = line - scope.start
+			}
+			scopes = scopes[:len(scopes)-1]
+		}
+	}
 
-	for i, line := range lines {
+	for i := 0; i < len(lines); {
+		line := lines[i]
 		trimmed := strings.TrimSpace(line)
+		if trimmed == "" || trimmed[0] == '#' {
+			i++
+			continue
+		}
+
+		// A statement runs on while strings, brackets or a backslash
+		// carry it over to the next line.
+		start := i
+		for scanner.continues(lines[i]) && i+1 < len(lines) {
+			i++
+		}
+		i++
+		statement := line
+		if i-start > 1 && startsPythonHeader(trimmed) {
+			parts := make([]string, 0, i-start)
+			for _, part := range lines[start:i] {
+				parts = append(parts, strings.TrimSpace(part))
+			}
+			statement = strings.Join(parts, " ")
+		}
+
+		indent := pythonIndent(line)
+		closeScopes(indent, start)
+
+		var parent *pythonScope
+		if len(scopes) > 0 {
+			parent = &scopes[len(scopes)-1]
+		}
+
+		// The first statement of a def is its docstring if it is a string.
+		if docFor >= 0 {
+			if parent != nil && parent.function == docFor && (strings.HasPrefix(trimmed, `"""`) || strings.HasPrefix(trimmed, `'''`)) {
+				functions[docFor].Comments = extractPythonDocstring(lines, start)
+			}
+			docFor = -1
+		}
 
 		// Track decorators
-		if decoratorMatch := decoratorRegex.FindStringSubmatch(line); decoratorMatch != nil {
+		if decoratorMatch := pythonPatterns.decorator.FindStringSubmatch(line); decoratorMatch != nil {
 			currentDecorators = append(currentDecorators, decoratorMatch[1])
 			continue
 		}
 
 		// Track class context
-		if classMatch := classRegex.FindStringSubmatch(line); classMatch != nil {
-			currentClass = classMatch[1]
+		if classMatch := pythonPatterns.class.FindStringSubmatch(statement); classMatch != nil {
+			scopes = append(scopes, pythonScope{indent: indent, start: start, function: -1, class: classMatch[1]})
 			currentDecorators = nil
 			continue
 		}
 
-		// Check if we're at the top level (no indentation for def/class)
-		if (strings.HasPrefix(line, "def ") || strings.HasPrefix(line, "async def ") || strings.HasPrefix(line, "class ")) && !strings.HasPrefix(line, " ") && !strings.HasPrefix(line, "\t") {
-			if strings.HasPrefix(line, "class ") {
-				// We're starting a new class, handled above
-			} else {
-				// We're at a top-level function, reset class context
-				currentClass = ""
-			}
+		defMatch := pythonPatterns.def.FindStringSubmatch(statement)
+		if defMatch == nil {
+			currentDecorators = nil
+			continue
 		}
 
-		// Parse function definitions
-		if defMatch := defRegex.FindStringSubmatch(line); defMatch != nil {
-			fnType := defMatch[1]
-			name := defMatch[2]
-			params := defMatch[3]
-			returnType := defMatch[4]
+		fnType := defMatch[1]
+		name := defMatch[2]
+		params := defMatch[3]
+		returnType := defMatch[4]
 
-			if returnType == "" {
-				returnType = "None"
-			}
+		if returnType == "" {
+			returnType = "None"
+		}
 
-			fullName := name
-			if currentClass != "" {
-				fullName = currentClass + "." + name
-			}
+		// Methods are named after the class they are defined in directly.
+		var currentClass string
+		if parent != nil && parent.function < 0 {
+			currentClass = parent.class
+		}
+		fullName := name
+		if currentClass != "" {
+			fullName = currentClass + "." + name
+		}
 
-			visibility := "public"
-			if strings.HasPrefix(name, "_") {
-				if strings.HasPrefix(name, "__") && strings.HasSuffix(name, "__") {
-					visibility = "magic"
-				} else {
-					visibility = "private"
-				}
+		visibility := "public"
+		if strings.HasPrefix(name, "_") {
+			if strings.HasPrefix(name, "__") && strings.HasSuffix(name, "__") {
+				visibility = "magic"
+			} else {
+				visibility = "private"
 			}
+		}
 
-			paramList := parsePythonParameters(params)
-			comments := extractPythonDocstring(lines, i+1)
-
-			fn := Function{
-				Name:       fullName,
-				File:       filePath,
-				Line:       i + 1,
-				Visibility: visibility,
-				ReturnType: returnType,
-				Parameters: paramList,
-				Language:   "python",
-				Signature:  strings.TrimSpace(line),
-				IsTest:     isTestFunction(name, currentDecorators),
-				IsMain:     name == "__main__" || (currentClass == "" && name == "main"),
-				Size:       calculatePythonFunctionSize(lines, i),
-				Comments:   comments,
-			}
+		fn := Function{
+			Name:       fullName,
+			File:       filePath,
+			Line:       start + 1,
+			Visibility: visibility,
+			ReturnType: returnType,
+			Parameters: parsePythonParameters(params),
+			Language:   "python",
+			Signature:  strings.TrimSpace(statement),
+			IsTest:     isTestFunction(name, currentDecorators),
+			IsMain:     name == "__main__" || (currentClass == "" && name == "main"),
+		}
 
-			if fnType == "async def" {
-				fn.Metadata = map[string]string{"async": "true"}
-			}
+		if fnType == "async def" {
+			fn.Metadata = map[string]string{"async": "true"}
+		}
 
-			if len(currentDecorators) > 0 {
-				if fn.Metadata == nil {
-					fn.Metadata = make(map[string]string)
-				}
-				fn.Metadata["decorators"] = strings.Join(currentDecorators, ",")
+		if len(currentDecorators) > 0 {
+			if fn.Metadata == nil {
+				fn.Metadata = make(map[string]string)
 			}
-
-			functions = append(functions, fn)
-			currentDecorators = nil
-		} else if trimmed != "" && !strings.HasPrefix(trimmed, "#") {
-			currentDecorators = nil
+			fn.Metadata["decorators"] = strings.Join(currentDecorators, ",")
 		}
+
+		functions = append(functions, fn)
+		scopes = append(scopes, pythonScope{indent: indent, start: start, function: len(functions) - 1})
+		docFor = len(functions) - 1
+		currentDecorators = nil
 	}
+	closeScopes(-1, len(lines))
 
 	return functions, nil
 }
 
-func (p *PythonParser) FindFunctionCalls(content string) []string {
-	callRegex := regexp.MustCompile(`(\w+)\s*\(`)
-	matches := callRegex.FindAllStringSubmatch(content, -1)
+func (p *PythonParser) FindCallSites(content string) []CallSite {
+	var sites []CallSite
+	lines := newLineCounter(content)
 
-	seen := make(map[string]bool)
-	var calls []string
+	for _, match := range pythonPatterns.call.FindAllStringSubmatchIndex(content, -1) {
+		call := content[match[4]:match[5]]
+		if isPythonBuiltin(call) {
+			continue
+		}
 
-	for _, match := range matches {
-		call := match[1]
-		if !seen[call] && !isPythonBuiltin(call) {
-			calls = append(calls, call)
-			seen[call] = true
+		site := CallSite{Name: call, Line: lines.lineAt(match[4])}
+		if match[2] >= 0 {
+			site.Qualifier = content[match[2]:match[3]]
+			site.Member = true
 		}
+		sites = append(sites, site)
 	}
 
-	return calls
+	return sites
 }
 
 func parsePythonParameters(params string) []string {
@@ -220,38 +288,9 @@ func extractPythonDocstring(lines []string, startLine int) string {
 	return ""
 }
 
-func calculatePythonFunctionSize(lines []string, startLine int) int {
-	if startLine >= len(lines) {
-		return 1
-	}
-
-	baseIndent := getIndentLevel(lines[startLine])
-	size := 1
-
-	for i := startLine + 1; i < len(lines); i++ {
-		line := lines[i]
-		trimmed := strings.TrimSpace(line)
-
-		// Empty lines don't count for indentation
-		if trimmed == "" {
-			size++
-			continue
-		}
-
-		currentIndent := getIndentLevel(line)
-
-		// If we're back to the same or less indentation, function is done
-		if currentIndent <= baseIndent {
-			break
-		}
-
-		size++
-	}
-
-	return size
-}
-
-func getIndentLevel(line string) int {
+// pythonIndent is the width of the leading white space of line, counting
+// a tab as four spaces.
+func pythonIndent(line string) int {
 	count := 0
 	for _, char := range line {
 		switch char {
@@ -260,12 +299,71 @@ func getIndentLevel(line string) int {
 		case '\t':
 			count += 4
 		default:
-			break
+			return count
 		}
 	}
 	return count
 }
 
+// startsPythonHeader reports whether a statement starting with trimmed may
+// be a def, class or decorator, whose header can span several lines.
+func startsPythonHeader(trimmed string) bool {
+	return strings.HasPrefix(trimmed, "def") || strings.HasPrefix(trimmed, "async") ||
+		strings.HasPrefix(trimmed, "class") || strings.HasPrefix(trimmed, "@")
+}
+
+// pythonScanner follows strings and brackets across the lines of a file so
+// a statement is known to end only where Python ends it.
+type pythonScanner struct {
+	quote string // the delimiter of an open triple-quoted string
+	depth int    // brackets open outside strings
+}
+
+// continues scans line and reports whether the statement it is part of goes
+// on to the next line.
+func (s *pythonScanner) continues(line string) bool {
+	escaped := false
+	for i := 0; i < len(line); i++ {
+		c := line[i]
+		if s.quote != "" {
+			if c == '\\' {
+				i++
+			} else if strings.HasPrefix(line[i:], s.quote) {
+				i += len(s.quote) - 1
+				s.quote = ""
+			}
+			continue
+		}
+
+		switch c {
+		case '#':
+			return s.depth > 0
+		case '(', '[', '{':
+			s.depth++
+		case ')', ']', '}':
+			if s.depth > 0 {
+				s.depth--
+			}
+		case '"', '\'':
+			s.quote = line[i : i+1]
+			if triple := line[i:min(i+3, len(line))]; triple == `"""` || triple == `'''` {
+				s.quote = triple
+				i += 2
+			}
+		case '\\':
+			escaped = strings.TrimRight(line[i+1:], "\r") == ""
+		}
+	}
+	// Other strings only go on past a backslash at the end of the line.
+	if len(s.quote) == 1 {
+		if !strings.HasSuffix(strings.TrimRight(line, "\r"), "\\") {
+			s.quote = ""
+		}
+		escaped = s.quote != ""
+	}
+	return s.quote != "" || s.depth > 0 || escaped
+}
+
 func isTestFunction(name string, decorators []string) bool {
 	// Check function name patterns
 	if strings.HasPrefix(name, "test_") || strings.HasSuffix(name, "_test") {
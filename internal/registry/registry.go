@@ -1,22 +1,19 @@
 package registry
 
 import (
-	"context"
-	"encoding/csv"
-	"encoding/json"
+	"crypto/sha256"
 	"fmt"
-	"io/fs"
 	"os"
-	"path/filepath"
-	"sort"
-	"strconv"
 	"strings"
-	"sync"
 	"time"
 
 	"github.com/schollz/progressbar/v3"
-	"golang.org/x/sync/semaphore"
-	"gopkg.in/yaml.v3"
+	"github.com/vitruves/gop/internal/cache"
+	"github.com/vitruves/gop/internal/memlimit"
+	"github.com/vitruves/gop/internal/pool"
+	"github.com/vitruves/gop/internal/source"
+	"github.com/vitruves/gop/internal/timings"
+	"github.com/vitruves/gop/internal/walker"
 )
 
 type Config struct {
@@ -25,6 +22,7 @@ type Config struct {
 	Exclude         []string
 	Recursive       bool
 	Depth           int
+	NoGitignore     bool
 	Jobs            int
 	Verbose         bool
 	OutputFile      string
@@ -32,8 +30,44 @@ type Config struct {
 	OnlyHeaderFiles bool
 	AddRelations    bool
 	OnlyDeadCode    bool
+	CallGraphFile   string
+	CacheDir        string
+	// NoDocs leaves doc comments out, so the Go parser never parses
+	// comments.
+	NoDocs bool
+	// MaxMemory bounds, in bytes, the files being parsed at once by their
+	// size together with the functions kept for the report; past half of it
+	// signatures and comments are spilled to a temporary file. Zero means no
+	// limit.
+	MaxMemory int64
+	// Files, when not nil, replaces the directory walk with this candidate
+	// set, as from git. Only these files are parsed and reported; with a
+	// cache, the cached results of every other file still take part in the
+	// call graph.
+	Files []string
 }
 
+// parsedFile is one worker result: the functions found in path, or nil when
+// the file could not be parsed, and the calls it makes.
+type parsedFile struct {
+	path      string
+	functions []Function
+	sites     []CallSite
+}
+
+// cachedFile is what the cache keeps per file. Call sites are only collected
+// when the call graph is needed; HasCalls tells such a run whether the entry
+// can be reused.
+type cachedFile struct {
+	Functions []Function
+	Calls     []CallSite
+	HasCalls  bool
+}
+
+// cacheVersion must change whenever Function, cachedFile or a parser's
+// output changes.
+const cacheVersion = "registry-5"
+
 type Function struct {
 	Name       string            `json:"name" yaml:"name"`
 	File       string            `json:"file" yaml:"file"`
@@ -69,105 +103,172 @@ type Summary struct {
 	TestFunctions    int `json:"test_functions" yaml:"test_functions"`
 }
 
+// LanguageParser extracts functions and call sites for one language.
+// ParseSource must copy every string it keeps out of src, which is closed
+// once the file has been processed.
 type LanguageParser interface {
 	GetExtensions() []string
 	ParseFile(filePath string) ([]Function, error)
+	ParseSource(filePath string, src *source.File) ([]Function, error)
 	IsHeaderFile(filePath string) bool
-	FindFunctionCalls(content string) []string
+	FindCallSites(content string) []CallSite
+}
+
+// sourceAnalyzer is implemented by parsers that find functions and call
+// sites in a single pass over the source.
+type sourceAnalyzer interface {
+	AnalyzeSource(filePath string, src *source.File) ([]Function, []CallSite, error)
 }
 
 func Run(config Config) error {
 	logInfo(config.Verbose, "Starting function registry generation")
 
-	parser := getParser(config.Language)
+	parser := newParser(config)
 	if parser == nil {
 		return fmt.Errorf("unsupported language: %s", config.Language)
 	}
 
-	files, err := collectFiles(config, parser)
-	if err != nil {
-		logError(fmt.Sprintf("Failed to collect files: %v", err))
-		return err
-	}
-
-	if len(files) == 0 {
-		logWarning("No files found matching criteria")
-		return nil
+	if config.Jobs < 1 {
+		config.Jobs = 1
 	}
 
-	logInfo(config.Verbose, fmt.Sprintf("Found %d files to analyze", len(files)))
-
-	registry := &Registry{
-		Functions: []Function{},
-		Scripts:   make(map[string][]Function),
-	}
-
-	bar := progressbar.NewOptions(len(files),
+	bar := progressbar.NewOptions(-1,
 		progressbar.OptionSetDescription("Analyzing functions"),
 		progressbar.OptionShowCount(),
 		progressbar.OptionSetRenderBlankState(true),
 		progressbar.OptionClearOnFinish(),
 	)
 
-	sem := semaphore.NewWeighted(int64(config.Jobs))
-	var mu sync.Mutex
-	var wg sync.WaitGroup
-
-	allFunctions := make([][]Function, len(files))
+	var fileCache *cache.Cache
+	if config.CacheDir != "" {
+		fileCache = cache.Open(config.CacheDir, cacheName(config), cacheVersion)
+	}
 
-	for i, file := range files {
-		wg.Add(1)
-		go func(idx int, filePath string) {
-			defer wg.Done()
-			sem.Acquire(context.Background(), 1)
-			defer sem.Release(1)
+	withCalls := config.AddRelations || config.OnlyDeadCode || config.CallGraphFile != ""
 
-			functions, err := parser.ParseFile(filePath)
-			if err != nil {
-				logError(fmt.Sprintf("Error parsing %s: %v", filePath, err))
-				return
+	// Without a call graph every function is final once its file is parsed,
+	// so record formats are written while the other files are still parsed.
+	var stream *recordWriter
+	var streamed Summary
+	if format := outputFormat(config.OutputFile); !withCalls && isRecordFormat(format) {
+		stream = newRecordWriter(newOutput(config.OutputFile), format)
+	}
+	limit := memlimit.New(config.MaxMemory)
+	build := newRegistryBuild(limit)
+	defer build.store.close()
+	emit := build.add
+	if stream != nil {
+		emit = func(file parsedFile) {
+			if streamed.TotalFiles == 0 && stream.csv != nil {
+				stream.err = stream.csv.Write(csvHeader)
 			}
-
-			mu.Lock()
-			allFunctions[idx] = functions
-			bar.Add(1)
-			mu.Unlock()
-		}(i, file)
+			streamed.add(generateSummary(file.functions, 1))
+			stream.writeFile(file.functions)
+		}
 	}
 
-	wg.Wait()
+	endAnalyze := timings.Phase("analyze")
+	progress := pool.NewProgress(func(n int) { bar.Add(n) })
+	count, err := analyzeFiles(config, parser, fileCache, withCalls, limit, progress, emit)
+	progress.Stop()
 	bar.Finish()
+	endAnalyze()
 
-	functionMap := make(map[string]*Function)
+	if err != nil {
+		logError(fmt.Sprintf("Failed to collect files: %v", err))
+		return err
+	}
 
-	for i, functions := range allFunctions {
-		if functions == nil {
-			continue
+	if count == 0 {
+		logWarning("No files found matching criteria")
+		return nil
+	}
+
+	if stream != nil {
+		err := stream.flush()
+		if cerr := stream.out.close(); err == nil {
+			err = cerr
 		}
+		if err != nil {
+			logError(fmt.Sprintf("Failed to write output: %v", err))
+			return err
+		}
+		logInfo(config.Verbose, fmt.Sprintf("Streamed %d functions from %d files", streamed.TotalFunctions, count))
+		saveRegistryCache(fileCache, config)
+		logSuccess("Function registry generated successfully")
+		return nil
+	}
 
-		fileName := files[i]
+	logInfo(config.Verbose, fmt.Sprintf("Analyzed %d files", count))
+	saveRegistryCache(fileCache, config)
+	return writeRegistry(config, build, count, withCalls, fileCache)
+}
 
-		for _, fn := range functions {
-			if config.OnlyDeadCode && fn.CallCount > 0 {
-				continue
-			}
+// registryBuild collects the functions and call sites of a run's files.
+type registryBuild struct {
+	store *functionStore
+	sites []fileSites
+}
 
-			registry.Functions = append(registry.Functions, fn)
-			functionMap[fn.Name] = &fn
+// newRegistryBuild returns an empty build whose functions count against
+// limit.
+func newRegistryBuild(limit *memlimit.Limit) *registryBuild {
+	store := newFunctionStore()
+	store.limit = limit
+	return &registryBuild{store: store}
+}
 
-			if config.ByScript {
-				registry.Scripts[fileName] = append(registry.Scripts[fileName], fn)
-			}
+func (b *registryBuild) add(file parsedFile) {
+	b.sites = append(b.sites, fileSites{path: file.path, first: b.store.add(file.functions), count: len(file.functions), sites: file.sites})
+}
+
+// writeRegistry resolves the calls of build when config needs them and
+// writes the report of count files.
+func writeRegistry(config Config, build *registryBuild, count int, withCalls bool, fileCache *cache.Cache) error {
+	// Functions past reported only provide call graph context.
+	store := build.store
+	defer store.close()
+	reported := store.len()
+	if withCalls && config.Files != nil {
+		context := cachedContext(fileCache)
+		logInfo(config.Verbose, fmt.Sprintf("Resolving calls against %d unchanged files from cache", len(context)))
+		for _, file := range context {
+			build.add(file)
 		}
 	}
 
-	if config.AddRelations {
-		addCallRelations(registry, files, parser, config)
+	view := &registryView{store: store}
+	if withCalls {
+		logInfo(config.Verbose, "Analyzing function call relationships")
+		endGraph := timings.Phase("call graph")
+		cg := buildCallGraph(store, build.sites)
+		endGraph()
+		logInfo(config.Verbose, fmt.Sprintf("Resolved %d call edges", cg.graph.Edges()))
+		view.cg = cg
+		view.relations = config.AddRelations
+
+		if config.CallGraphFile != "" {
+			if err := writeCallGraph(cg, config.CallGraphFile); err != nil {
+				logError(fmt.Sprintf("Failed to write call graph: %v", err))
+				return err
+			}
+			logInfo(config.Verbose, fmt.Sprintf("Call graph written to %s", config.CallGraphFile))
+		}
 	}
 
-	registry.Summary = generateSummary(registry.Functions, len(files))
+	view.kept = make([]int32, 0, reported)
+	for i := 0; i < reported; i++ {
+		if !config.OnlyDeadCode || view.dead(i) {
+			view.kept = append(view.kept, int32(i))
+		}
+	}
 
-	err = writeOutput(registry, config)
+	endOutput := timings.Phase("output")
+	err := writeOutput(view, view.summary(count), config)
+	if serr := store.close(); err == nil {
+		err = serr
+	}
+	endOutput()
 	if err != nil {
 		logError(fmt.Sprintf("Failed to write output: %v", err))
 		return err
@@ -177,7 +278,41 @@ func Run(config Config) error {
 	return nil
 }
 
+// newParser returns the parser for config.Language, set up for what the run
+// keeps.
+func newParser(config Config) LanguageParser {
+	parser := getParser(config.Language)
+	if config.NoDocs {
+		skipDocs(parser)
+	}
+	return parser
+}
+
+func skipDocs(parser LanguageParser) {
+	switch p := parser.(type) {
+	case *GoParser:
+		p.SkipDocs = true
+	case *multiParser:
+		for _, member := range p.parsers {
+			skipDocs(member)
+		}
+	}
+}
+
+// cacheName names the cache file of config's runs, which differ by parser
+// and by whether doc comments are kept.
+func cacheName(config Config) string {
+	name := "registry-" + parserName(config.Language)
+	if config.NoDocs {
+		name += "-nodocs"
+	}
+	return name
+}
+
 func getParser(language string) LanguageParser {
+	if isMultiLanguage(language) {
+		return newMultiParser(language)
+	}
 	switch language {
 	case "python":
 		return &PythonParser{}
@@ -194,124 +329,225 @@ func getParser(language string) LanguageParser {
 	}
 }
 
-func collectFiles(config Config, parser LanguageParser) ([]string, error) {
-	var files []string
-	extensions := parser.GetExtensions()
+// parserName names the parser getParser picks, so each parser keeps its own
+// cache file.
+func parserName(language string) string {
+	if isMultiLanguage(language) {
+		return strings.Join(splitLanguages(language), "+")
+	}
+	switch language {
+	case "python", "rust", "go", "c", "cpp":
+		return language
+	default:
+		return "generic"
+	}
+}
 
-	startDir := "."
-	if len(config.Include) > 0 {
-		for _, path := range config.Include {
-			matches, err := filepath.Glob(path)
-			if err != nil {
-				return nil, err
-			}
-			for _, match := range matches {
-				if isValidFile(match, extensions, config, parser) {
-					files = append(files, match)
-				}
+func walkerConfig(config Config, parser LanguageParser) walker.Config {
+	extensions := parser.GetExtensions()
+	if config.OnlyHeaderFiles {
+		var headerExts []string
+		for _, ext := range extensions {
+			if parser.IsHeaderFile("header" + ext) {
+				headerExts = append(headerExts, ext)
 			}
 		}
-		return files, nil
+		extensions = headerExts
 	}
 
-	err := filepath.WalkDir(startDir, func(path string, d fs.DirEntry, err error) error {
-		if err != nil {
-			return err
-		}
+	return walker.Config{
+		Include:     config.Include,
+		Exclude:     config.Exclude,
+		Recursive:   config.Recursive,
+		Depth:       config.Depth,
+		Jobs:        config.Jobs,
+		NoGitignore: config.NoGitignore,
+		Extensions:  extensions,
+		Files:       config.Files,
+	}
+}
 
-		if d.IsDir() {
-			if shouldExcludeDir(path, config.Exclude) {
-				return filepath.SkipDir
+// analyzeFiles parses every file the walk yields on config.Jobs workers,
+// serving unchanged files from fileCache, and hands them to emit in walk
+// order. Files wait for their size in limit before they are read. It
+// returns the number of files.
+func analyzeFiles(config Config, parser LanguageParser, fileCache *cache.Cache, withCalls bool, limit *memlimit.Limit, progress *pool.Progress, emit func(parsedFile)) (int, error) {
+	emitter := newFileEmitter(emit)
+	stream, walkErr := walker.Stream(walkerConfig(config, parser))
+	admitted := memlimit.Admit(limit, stream, func(file walker.File) int64 { return file.Size })
+
+	count := pool.Each(config.Jobs, admitted, func(_, idx int, file walker.File) {
+		defer progress.Add(1)
+		defer limit.Release(file.Size)
+
+		var cached cachedFile
+		if !fileCache.Get(file.Path, file.Size, file.ModTime, &cached) || (withCalls && !cached.HasCalls) {
+			var err error
+			start := timings.Now()
+			var hash [sha256.Size]byte
+			hashed := &hash
+			if fileCache == nil {
+				hashed = nil
 			}
-			if !config.Recursive && path != startDir {
-				return filepath.SkipDir
+			cached, err = analyzeSource(parser, file.Path, withCalls, hashed)
+			if timings.Enabled() {
+				_, name := fileParser(parser, config.Language, file.Path)
+				timings.File(name, file.Size, start)
 			}
-			if config.Depth > 0 {
-				relPath, _ := filepath.Rel(startDir, path)
-				if strings.Count(relPath, string(filepath.Separator)) >= config.Depth {
-					return filepath.SkipDir
-				}
+			if err != nil {
+				logError(fmt.Sprintf("Error parsing %s: %v", file.Path, err))
+			} else {
+				fileCache.Put(file.Path, file.Size, file.ModTime, hash, cached)
 			}
-			return nil
 		}
 
-		if isValidFile(path, extensions, config, parser) {
-			files = append(files, path)
-		}
-
-		return nil
+		emitter.put(idx, parsedFile{path: file.Path, functions: cached.Functions, sites: cached.Calls})
 	})
 
-	return files, err
+	return count, <-walkErr
 }
 
-func isValidFile(path string, extensions []string, config Config, parser LanguageParser) bool {
-	ext := filepath.Ext(path)
+func saveRegistryCache(fileCache *cache.Cache, config Config) {
+	if fileCache == nil {
+		return
+	}
+	logInfo(config.Verbose, fmt.Sprintf("Served %d files from cache", fileCache.Hits()))
+	if err := fileCache.Save(); err != nil {
+		logWarning(fmt.Sprintf("Failed to save cache: %v", err))
+	}
+}
 
-	for _, validExt := range extensions {
-		if ext == validExt {
-			if config.OnlyHeaderFiles && !parser.IsHeaderFile(path) {
-				return false
-			}
-			return !shouldExcludeFile(path, config.Exclude)
+// cachedContext returns the still valid cached functions and call sites of
+// the files a run limited to changed files did not parse. Checking an entry
+// costs a stat, so no directory is read.
+func cachedContext(fileCache *cache.Cache) []parsedFile {
+	var context []parsedFile
+	for _, path := range fileCache.Unseen() {
+		info, err := os.Stat(path)
+		if err != nil {
+			continue
+		}
+		var cached cachedFile
+		if fileCache.Get(path, info.Size(), info.ModTime(), &cached) && cached.HasCalls {
+			context = append(context, parsedFile{path: path, functions: cached.Functions, sites: cached.Calls})
 		}
 	}
+	return context
+}
 
-	return false
+// analyzeSource reads filePath once and extracts both its functions and, if
+// withCalls is set, its call sites. Calls are still collected when parsing
+// fails, so a file with syntax errors keeps counting towards its callees.
+// When hash is not nil it is set to the cache hash of the bytes parsed.
+func analyzeSource(parser LanguageParser, filePath string, withCalls bool, hash *[sha256.Size]byte) (cachedFile, error) {
+	src, err := source.Open(filePath)
+	if err != nil {
+		return cachedFile{}, err
+	}
+	defer src.Close()
+	result, err := analyzeOpened(parser, filePath, src, withCalls)
+	if hash != nil && err == nil {
+		err = source.Protect(func() { *hash = cache.Hash(src.Bytes()) })
+	}
+	return result, err
 }
 
-func shouldExcludeDir(path string, exclude []string) bool {
-	excludeDirs := []string{".git", "node_modules", "__pycache__", ".pytest_cache", "target", "build", "dist", "vendor"}
+// analyzeOpened is analyzeSource for a file that is already open. A mapped
+// file that shrinks while it is parsed gives an error, not a crash.
+func analyzeOpened(parser LanguageParser, filePath string, src *source.File, withCalls bool) (result cachedFile, err error) {
+	if ferr := source.Protect(func() { result, err = analyzeContent(parser, filePath, src, withCalls) }); ferr != nil {
+		return cachedFile{}, ferr
+	}
+	return result, err
+}
 
-	for _, excludePattern := range exclude {
-		if matched, _ := filepath.Match(excludePattern, path); matched {
-			return true
+func analyzeContent(parser LanguageParser, filePath string, src *source.File, withCalls bool) (cachedFile, error) {
+	parser, _ = fileParser(parser, "", filePath)
+	var result cachedFile
+	var err error
+	if analyzer, ok := parser.(sourceAnalyzer); ok && withCalls {
+		var sites []CallSite
+		result.Functions, sites, err = analyzer.AnalyzeSource(filePath, src)
+		result.Calls = cloneCallSites(sites)
+		result.HasCalls = true
+		if err != nil {
+			result.Functions = nil
 		}
+		return result, err
 	}
 
-	for _, excludeDir := range excludeDirs {
-		if strings.Contains(path, excludeDir) {
-			return true
-		}
+	if withCalls {
+		result.Calls = cloneCallSites(parser.FindCallSites(src.String()))
+		result.HasCalls = true
 	}
 
-	return false
+	result.Functions, err = parser.ParseSource(filePath, src)
+	if err != nil {
+		result.Functions = nil
+	}
+	return result, err
 }
 
-func shouldExcludeFile(path string, exclude []string) bool {
-	for _, excludePattern := range exclude {
-		if matched, _ := filepath.Match(excludePattern, path); matched {
-			return true
-		}
+// parseFile backs every parser's ParseFile.
+func parseFile(parser LanguageParser, filePath string) ([]Function, error) {
+	src, err := source.Open(filePath)
+	if err != nil {
+		return nil, err
 	}
-
-	return false
+	defer src.Close()
+	return parseOpened(parser, filePath, src)
 }
 
-func addCallRelations(registry *Registry, files []string, parser LanguageParser, config Config) {
-	logInfo(config.Verbose, "Analyzing function call relationships")
+// parseOpened is parseFile for a file that is already open.
+func parseOpened(parser LanguageParser, filePath string, src *source.File) (functions []Function, err error) {
+	if ferr := source.Protect(func() { functions, err = parser.ParseSource(filePath, src) }); ferr != nil {
+		return nil, ferr
+	}
+	return functions, err
+}
 
-	functionMap := make(map[string]*Function)
-	for i := range registry.Functions {
-		functionMap[registry.Functions[i].Name] = &registry.Functions[i]
+// cloneStrings copies values out of a source.File so they stay valid after
+// it is closed.
+func cloneStrings(values []string) []string {
+	cloned := make([]string, len(values))
+	for i, value := range values {
+		cloned[i] = strings.Clone(value)
 	}
+	return cloned
+}
 
-	for _, file := range files {
-		content, err := os.ReadFile(file)
-		if err != nil {
-			continue
+// cloneCallSites copies call sites out of a source.File, sharing one copy of
+// each distinct name.
+func cloneCallSites(sites []CallSite) []CallSite {
+	names := make(map[string]string)
+	clone := func(s string) string {
+		if c, ok := names[s]; ok {
+			return c
 		}
+		c := strings.Clone(s)
+		names[c] = c
+		return c
+	}
 
-		calls := parser.FindFunctionCalls(string(content))
-
-		for _, call := range calls {
-			if fn, exists := functionMap[call]; exists {
-				fn.CallCount++
-			}
-		}
+	for i := range sites {
+		sites[i].Name = clone(sites[i].Name)
+		sites[i].Qualifier = clone(sites[i].Qualifier)
 	}
+	return sites
+}
+
+// add accumulates the counts of another summary.
+func (s *Summary) add(other Summary) {
+	s.TotalFunctions += other.TotalFunctions
+	s.TotalFiles += other.TotalFiles
+	s.PublicFunctions += other.PublicFunctions
+	s.PrivateFunctions += other.PrivateFunctions
+	s.DeadFunctions += other.DeadFunctions
+	s.TestFunctions += other.TestFunctions
 }
 
+// generateSummary counts the functions of a run without a call graph, where
+// a function nothing is known to call counts as dead.
 func generateSummary(functions []Function, totalFiles int) Summary {
 	summary := Summary{
 		TotalFunctions: len(functions),
@@ -337,173 +573,6 @@ func generateSummary(functions []Function, totalFiles int) Summary {
 	return summary
 }
 
-func writeOutput(registry *Registry, config Config) error {
-	var output []byte
-	var err error
-
-	ext := filepath.Ext(config.OutputFile)
-
-	switch ext {
-	case ".yaml", ".yml":
-		output, err = yaml.Marshal(registry)
-	case ".json":
-		output, err = json.MarshalIndent(registry, "", "  ")
-	case ".csv":
-		output, err = formatCSV(registry)
-	default:
-		output = []byte(formatText(registry, config))
-	}
-
-	if err != nil {
-		return err
-	}
-
-	if config.OutputFile != "" {
-		return os.WriteFile(config.OutputFile, output, 0644)
-	} else {
-		fmt.Print(string(output))
-		return nil
-	}
-}
-
-func formatText(registry *Registry, config Config) string {
-	var sb strings.Builder
-
-	sb.WriteString("# Function Registry\n\n")
-
-	sb.WriteString("## Summary\n")
-	sb.WriteString(fmt.Sprintf("- Total Functions: %d\n", registry.Summary.TotalFunctions))
-	sb.WriteString(fmt.Sprintf("- Total Files: %d\n", registry.Summary.TotalFiles))
-	sb.WriteString(fmt.Sprintf("- Public Functions: %d\n", registry.Summary.PublicFunctions))
-	sb.WriteString(fmt.Sprintf("- Private Functions: %d\n", registry.Summary.PrivateFunctions))
-	sb.WriteString(fmt.Sprintf("- Dead Functions: %d\n", registry.Summary.DeadFunctions))
-	sb.WriteString(fmt.Sprintf("- Test Functions: %d\n", registry.Summary.TestFunctions))
-	sb.WriteString("\n")
-
-	if config.ByScript {
-		for file, functions := range registry.Scripts {
-			sb.WriteString(fmt.Sprintf("## %s\n\n", file))
-
-			sort.Slice(functions, func(i, j int) bool {
-				return functions[i].Line < functions[j].Line
-			})
-
-			for _, fn := range functions {
-				sb.WriteString(formatFunction(fn))
-			}
-			sb.WriteString("\n")
-		}
-	} else {
-		sort.Slice(registry.Functions, func(i, j int) bool {
-			if registry.Functions[i].File == registry.Functions[j].File {
-				return registry.Functions[i].Line < registry.Functions[j].Line
-			}
-			return registry.Functions[i].File < registry.Functions[j].File
-		})
-
-		sb.WriteString("## Functions\n\n")
-		for _, fn := range registry.Functions {
-			sb.WriteString(formatFunction(fn))
-		}
-	}
-
-	return sb.String()
-}
-
-func formatFunction(fn Function) string {
-	var sb strings.Builder
-
-	sb.WriteString(fmt.Sprintf("### %s\n", fn.Name))
-	sb.WriteString(fmt.Sprintf("- **File**: %s:%d\n", fn.File, fn.Line))
-	sb.WriteString(fmt.Sprintf("- **Visibility**: %s\n", fn.Visibility))
-	sb.WriteString(fmt.Sprintf("- **Return Type**: %s\n", fn.ReturnType))
-	sb.WriteString(fmt.Sprintf("- **Parameters**: %s\n", strings.Join(fn.Parameters, ", ")))
-	sb.WriteString(fmt.Sprintf("- **Language**: %s\n", fn.Language))
-	sb.WriteString(fmt.Sprintf("- **Call Count**: %d\n", fn.CallCount))
-	sb.WriteString(fmt.Sprintf("- **Size**: %d lines\n", fn.Size))
-
-	if fn.IsTest {
-		sb.WriteString("- **Type**: Test Function\n")
-	}
-
-	if fn.IsMain {
-		sb.WriteString("- **Type**: Main Function\n")
-	}
-
-	if fn.Complexity > 0 {
-		sb.WriteString(fmt.Sprintf("- **Complexity**: %d\n", fn.Complexity))
-	}
-
-	if len(fn.CalledBy) > 0 {
-		sb.WriteString(fmt.Sprintf("- **Called By**: %s\n", strings.Join(fn.CalledBy, ", ")))
-	}
-
-	if len(fn.Calls) > 0 {
-		sb.WriteString(fmt.Sprintf("- **Calls**: %s\n", strings.Join(fn.Calls, ", ")))
-	}
-
-	if fn.Comments != "" {
-		sb.WriteString(fmt.Sprintf("- **Comments**: %s\n", fn.Comments))
-	}
-
-	sb.WriteString(fmt.Sprintf("- **Signature**: `%s`\n", fn.Signature))
-	sb.WriteString("\n")
-
-	return sb.String()
-}
-
-func formatCSV(registry *Registry) ([]byte, error) {
-	var buf strings.Builder
-	writer := csv.NewWriter(&buf)
-	
-	// Write header
-	header := []string{
-		"Name", "File", "Line", "Visibility", "ReturnType", "Parameters",
-		"Language", "CallCount", "Size", "IsTest", "IsMain", "Comments", "Signature",
-	}
-	if err := writer.Write(header); err != nil {
-		return nil, err
-	}
-	
-	// Sort functions for consistent output
-	sort.Slice(registry.Functions, func(i, j int) bool {
-		if registry.Functions[i].File == registry.Functions[j].File {
-			return registry.Functions[i].Line < registry.Functions[j].Line
-		}
-		return registry.Functions[i].File < registry.Functions[j].File
-	})
-	
-	// Write function data
-	for _, fn := range registry.Functions {
-		record := []string{
-			fn.Name,
-			fn.File,
-			strconv.Itoa(fn.Line),
-			fn.Visibility,
-			fn.ReturnType,
-			strings.Join(fn.Parameters, ";"), // Use semicolon to separate parameters
-			fn.Language,
-			strconv.Itoa(fn.CallCount),
-			strconv.Itoa(fn.Size),
-			strconv.FormatBool(fn.IsTest),
-			strconv.FormatBool(fn.IsMain),
-			strings.ReplaceAll(fn.Comments, "\n", " "), // Replace newlines with spaces
-			strings.ReplaceAll(fn.Signature, "\n", " "), // Replace newlines with spaces
-		}
-		
-		if err := writer.Write(record); err != nil {
-			return nil, err
-		}
-	}
-	
-	writer.Flush()
-	if err := writer.Error(); err != nil {
-		return nil, err
-	}
-	
-	return []byte(buf.String()), nil
-}
-
 func logInfo(verbose bool, msg string) {
 	if verbose {
 		fmt.Printf("\033[34m%s - INFO: %s\033[0m\n", getCurrentTime(), msg)
@@ -1,9 +1,20 @@
 package registry
 
 import (
+	"compress/gzip"
+	"encoding/json"
+	"fmt"
 	"os"
 	"path/filepath"
+	"reflect"
+	"runtime"
+	"strings"
 	"testing"
+
+	"github.com/vitruves/gop/internal/corpus"
+	"github.com/vitruves/gop/internal/memlimit"
+	"github.com/vitruves/gop/internal/pool"
+	"github.com/vitruves/gop/internal/source"
 )
 
 func TestPythonParser(t *testing.T) {
@@ -120,6 +131,105 @@ func TestSomething(t *testing.T) {
 	}
 }
 
+func TestPythonParserScopes(t *testing.T) {
+	testFile := filepath.Join(t.TempDir(), "scopes.py")
+	content := `class Shape:
+    def area(self,
+             scale=1):
+        """Area of the shape.
+
+        def not_a_function():
+        """
+        def helper():
+            return 1
+        return helper() * scale
+
+# A comment at the left margin does not end the class.
+    def name(self):
+        return 'shape \\
+def not_a_function_either():'
+
+def main():
+    pass
+`
+	if err := os.WriteFile(testFile, []byte(content), 0644); err != nil {
+		t.Fatalf("Failed to create test file: %v", err)
+	}
+
+	functions, err := (&PythonParser{}).ParseFile(testFile)
+	if err != nil {
+		t.Fatalf("Failed to parse file: %v", err)
+	}
+
+	expected := []struct {
+		name       string
+		line, size int
+	}{
+		{"Shape.area", 2, 11},
+		{"helper", 8, 2},
+		{"Shape.name", 13, 4},
+		{"main", 17, 3},
+	}
+	if len(functions) != len(expected) {
+		t.Fatalf("Expected %d functions, got %+v", len(expected), functions)
+	}
+	for i, want := range expected {
+		fn := functions[i]
+		if fn.Name != want.name || fn.Line != want.line || fn.Size != want.size {
+			t.Errorf("Expected %+v, got %s at %d size %d", want, fn.Name, fn.Line, fn.Size)
+		}
+	}
+	if area := functions[0]; len(area.Parameters) != 2 || !strings.HasPrefix(area.Comments, "Area of the shape.") {
+		t.Errorf("Multi-line def parsed as %+v", area)
+	}
+	if !functions[3].IsMain {
+		t.Error("main should be identified as main")
+	}
+}
+
+func TestGoAnalyzeSource(t *testing.T) {
+	testFile := filepath.Join(t.TempDir(), "run.go")
+	content := `package main
+
+// run starts the work.
+func run() error {
+	return helper(cmd.Execute)
+}
+
+func helper(f func() error) error { return f() }
+`
+	if err := os.WriteFile(testFile, []byte(content), 0644); err != nil {
+		t.Fatalf("Failed to create test file: %v", err)
+	}
+
+	for _, skipDocs := range []bool{false, true} {
+		parser := &GoParser{SkipDocs: skipDocs}
+		src, err := source.Open(testFile)
+		if err != nil {
+			t.Fatalf("Failed to open file: %v", err)
+		}
+		functions, sites, err := parser.AnalyzeSource(testFile, src)
+		src.Close()
+		if err != nil {
+			t.Fatalf("Failed to analyze file: %v", err)
+		}
+
+		if len(functions) != 2 || functions[0].Name != "run" || functions[1].Name != "helper" {
+			t.Fatalf("Expected run and helper, got %+v", functions)
+		}
+		wantDoc := "run starts the work.\n"
+		if skipDocs {
+			wantDoc = ""
+		}
+		if functions[0].Comments != wantDoc {
+			t.Errorf("SkipDocs %v: expected comments %q, got %q", skipDocs, wantDoc, functions[0].Comments)
+		}
+		if !reflect.DeepEqual(sites, parser.FindCallSites(content)) {
+			t.Errorf("AnalyzeSource sites %+v differ from FindCallSites %+v", sites, parser.FindCallSites(content))
+		}
+	}
+}
+
 func TestRustParser(t *testing.T) {
 	parser := &RustParser{}
 	
@@ -168,6 +278,9 @@ async fn async_function() {
 		if fn.Name == "test_function" && !fn.IsTest {
 			t.Error("test_function should be identified as test")
 		}
+		if fn.Name == "public_function" && (fn.Size != 3 || fn.Complexity != 1) {
+			t.Errorf("public_function should span 3 lines with complexity 1, got %d and %d", fn.Size, fn.Complexity)
+		}
 	}
 }
 
@@ -193,4 +306,513 @@ func contains(slice []string, item string) bool {
 		}
 	}
 	return false
-}
\ No newline at end of file
+}
+
+const benchmarkCppSource = `
+#include <vector>
+
+namespace geometry {
+
+class Shape {
+public:
+    virtual double area() const = 0;
+};
+
+// Computes the sum of all areas.
+double totalArea(const std::vector<Shape*>& shapes) {
+    double total = 0;
+    for (auto* shape : shapes) {
+        total += shape->area();
+    }
+    return total;
+}
+
+}
+`
+
+func TestCppParser(t *testing.T) {
+	parser := &CppParser{}
+
+	testFile := filepath.Join(t.TempDir(), "shapes.hpp")
+	content := `namespace geometry {
+class Shape {
+public:
+    explicit Shape(int id) : id_(id), name_{"shape"} {}
+    /// Computes the area.
+    template <typename T>
+    std::map<int, std::vector<T>> compute(const T& value,
+                                          int count = 3) const;
+private:
+    int id_;
+};
+
+int helper(int v) {
+    const char* text = "}";
+    return v + '}';
+}
+
+#if 0
+void disabled() {
+#else
+void enabled() {
+#endif
+    helper(1);
+}
+}
+`
+	if err := os.WriteFile(testFile, []byte(content), 0644); err != nil {
+		t.Fatalf("Failed to create test file: %v", err)
+	}
+
+	functions, err := parser.ParseFile(testFile)
+	if err != nil {
+		t.Fatalf("Failed to parse file: %v", err)
+	}
+
+	expected := []struct {
+		name       string
+		line, size int
+		visibility string
+	}{
+		{"geometry::Shape::Shape", 4, 1, "public"},
+		{"geometry::Shape::compute", 7, 1, "public"},
+		{"geometry::helper", 13, 4, "public"},
+		{"geometry::enabled", 21, 4, "public"},
+	}
+	if len(functions) != len(expected) {
+		t.Fatalf("Expected %d functions, got %+v", len(expected), functions)
+	}
+	for i, want := range expected {
+		fn := functions[i]
+		if fn.Name != want.name || fn.Line != want.line || fn.Size != want.size || fn.Visibility != want.visibility {
+			t.Errorf("Expected %+v, got %s at %d size %d %s", want, fn.Name, fn.Line, fn.Size, fn.Visibility)
+		}
+	}
+
+	compute := functions[1]
+	if compute.Comments != "Computes the area." || compute.Metadata["template"] != "true" || len(compute.Parameters) != 2 {
+		t.Errorf("Multi-line template declaration parsed as %+v", compute)
+	}
+	if functions[0].Metadata["constructor"] != "true" || functions[0].ReturnType != "" {
+		t.Errorf("Shape should be a constructor, got %+v", functions[0])
+	}
+
+	sites := parser.FindCallSites(content)
+	if len(sites) != 1 || sites[0].Name != "helper" || sites[0].Line != 23 {
+		t.Errorf("Expected one call to helper at line 23, got %+v", sites)
+	}
+}
+
+func TestCppParserLargeFile(t *testing.T) {
+	testFile := filepath.Join(t.TempDir(), "generated.hpp")
+	unit := benchmarkCppSource + "class Point {\npublic:\n    int x() const { return x_; }\n};\n"
+	content := strings.Repeat(unit, source.MmapThreshold/len(unit)+1)
+	if err := os.WriteFile(testFile, []byte(content), 0644); err != nil {
+		t.Fatalf("Failed to create test file: %v", err)
+	}
+
+	parser := &CppParser{}
+	functions, err := parser.ParseFile(testFile)
+	if err != nil {
+		t.Fatalf("Failed to parse file: %v", err)
+	}
+
+	// The file is unmapped by now, so every field must have been copied out.
+	if _, err := json.Marshal(functions); err != nil {
+		t.Fatalf("Failed to encode functions: %v", err)
+	}
+	for _, fn := range functions {
+		if fn.Visibility != "public" && fn.Visibility != "private" && fn.Visibility != "protected" {
+			t.Fatalf("Unexpected visibility %q for %s", fn.Visibility, fn.Name)
+		}
+		if !strings.Contains(fn.Signature, "(") || !strings.HasSuffix(fn.File, "generated.hpp") {
+			t.Fatalf("Incomplete function: %+v", fn)
+		}
+	}
+	if len(functions) < 2 || functions[0].Name != "geometry::Shape::area" || functions[1].Name != "geometry::totalArea" {
+		t.Errorf("Expected geometry::Shape::area and geometry::totalArea first, got %d functions", len(functions))
+	}
+}
+
+func BenchmarkCppParseFile(b *testing.B) {
+	testFile := filepath.Join(b.TempDir(), "bench.cpp")
+	if err := os.WriteFile(testFile, []byte(strings.Repeat(benchmarkCppSource, 50)), 0644); err != nil {
+		b.Fatalf("Failed to create test file: %v", err)
+	}
+
+	parser := &CppParser{}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		if _, err := parser.ParseFile(testFile); err != nil {
+			b.Fatalf("Failed to parse file: %v", err)
+		}
+	}
+}
+
+func BenchmarkCppFindCallSites(b *testing.B) {
+	content := strings.Repeat(benchmarkCppSource, 50)
+	parser := &CppParser{}
+	b.ResetTimer()
+	for i := 0; i < b.N; i++ {
+		parser.FindCallSites(content)
+	}
+}
+
+func TestCallGraphResolution(t *testing.T) {
+	tempDir := t.TempDir()
+	files := map[string]string{
+		"main.go": `package main
+
+import "demo/alpha"
+
+type Server struct{}
+
+func (s *Server) Start() {
+	s.listen()
+}
+
+func (s *Server) listen() {}
+
+func main() {
+	alpha.Helper()
+	srv := &Server{}
+	srv.Start()
+}
+
+func orphan() {
+	orphanChild()
+}
+
+func orphanChild() {}
+`,
+		"alpha/alpha.go": `package alpha
+
+func Helper() {}
+`,
+		"beta/beta.go": `package beta
+
+func Helper() {}
+`,
+	}
+
+	parser := &GoParser{}
+	store := newFunctionStore()
+	var sites []fileSites
+	for name, content := range files {
+		path := filepath.Join(tempDir, name)
+		os.MkdirAll(filepath.Dir(path), 0755)
+		if err := os.WriteFile(path, []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to create test file: %v", err)
+		}
+		result, err := analyzeSource(parser, path, true, nil)
+		if err != nil {
+			t.Fatalf("Failed to parse %s: %v", name, err)
+		}
+		sites = append(sites, fileSites{path: path, first: store.add(result.Functions), count: len(result.Functions), sites: result.Calls})
+	}
+
+	cg := buildCallGraph(store, sites)
+	view := &registryView{store: store, cg: cg, relations: true}
+	functions := make([]Function, store.len())
+	for i := range functions {
+		functions[i] = view.function(i)
+	}
+
+	byFile := func(name, dir string) (int, *Function) {
+		for i := range functions {
+			if functions[i].Name == name && filepath.Base(filepath.Dir(functions[i].File)) == dir {
+				return i, &functions[i]
+			}
+		}
+		t.Fatalf("Function %s in %s not found", name, dir)
+		return -1, nil
+	}
+
+	_, alphaHelper := byFile("Helper", "alpha")
+	_, betaHelper := byFile("Helper", "beta")
+	if alphaHelper.CallCount != 1 || !contains(alphaHelper.CalledBy, "main") {
+		t.Errorf("alpha.Helper should be called once by main, got %d %v", alphaHelper.CallCount, alphaHelper.CalledBy)
+	}
+	if betaHelper.CallCount != 0 {
+		t.Errorf("beta.Helper should not be called, got %v", betaHelper.CalledBy)
+	}
+
+	base := filepath.Base(tempDir)
+	_, start := byFile("*Server.Start", base)
+	if !contains(start.Calls, "*Server.listen") {
+		t.Errorf("Start should call listen, got %v", start.Calls)
+	}
+
+	for _, name := range []string{"orphan", "orphanChild"} {
+		if i, _ := byFile(name, base); cg.reachable[i] {
+			t.Errorf("%s should be unreachable", name)
+		}
+	}
+	for _, name := range []string{"main", "*Server.Start", "*Server.listen"} {
+		if i, _ := byFile(name, base); !cg.reachable[i] {
+			t.Errorf("%s should be reachable", name)
+		}
+	}
+	if i, _ := byFile("Helper", "beta"); cg.reachable[i] {
+		t.Error("beta.Helper should be unreachable")
+	}
+
+	graphFile := filepath.Join(tempDir, "cg.json.gz")
+	if err := writeCallGraph(cg, graphFile); err != nil {
+		t.Fatalf("Failed to write call graph: %v", err)
+	}
+	file, err := os.Open(graphFile)
+	if err != nil {
+		t.Fatalf("Failed to open call graph: %v", err)
+	}
+	defer file.Close()
+	zr, err := gzip.NewReader(file)
+	if err != nil {
+		t.Fatalf("Call graph is not gzipped: %v", err)
+	}
+	var graph any
+	if err := json.NewDecoder(zr).Decode(&graph); err != nil {
+		t.Errorf("Call graph is not JSON: %v", err)
+	}
+}
+
+func TestStreamedOutput(t *testing.T) {
+	tempDir := t.TempDir()
+	for _, name := range []string{"a.go", "b.go", "c.go"} {
+		content := "package demo\n\nfunc First() {}\n\nfunc Second() {}\n"
+		if err := os.WriteFile(filepath.Join(tempDir, name), []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to create test file: %v", err)
+		}
+	}
+
+	ndjson := filepath.Join(tempDir, "out.ndjson")
+	if err := Run(Config{Language: "go", Include: []string{tempDir}, Jobs: 2, OutputFile: ndjson}); err != nil {
+		t.Fatalf("Run failed: %v", err)
+	}
+	data, err := os.ReadFile(ndjson)
+	if err != nil {
+		t.Fatalf("Failed to read output: %v", err)
+	}
+	lines := strings.Split(strings.TrimSpace(string(data)), "\n")
+	if len(lines) != 6 {
+		t.Fatalf("Expected 6 NDJSON lines, got %d", len(lines))
+	}
+	var previous Function
+	for i, line := range lines {
+		var fn Function
+		if err := json.Unmarshal([]byte(line), &fn); err != nil {
+			t.Fatalf("Line %d is not a JSON object: %v", i+1, err)
+		}
+		if i > 0 && (fn.File < previous.File || fn.File == previous.File && fn.Line < previous.Line) {
+			t.Errorf("Line %d out of order: %s:%d after %s:%d", i+1, fn.File, fn.Line, previous.File, previous.Line)
+		}
+		previous = fn
+	}
+
+	csvFile := filepath.Join(tempDir, "out.csv")
+	if err := Run(Config{Language: "go", Include: []string{tempDir}, Jobs: 2, OutputFile: csvFile}); err != nil {
+		t.Fatalf("Run failed: %v", err)
+	}
+	data, err = os.ReadFile(csvFile)
+	if err != nil {
+		t.Fatalf("Failed to read output: %v", err)
+	}
+	rows := strings.Split(strings.TrimSpace(string(data)), "\n")
+	if len(rows) != 7 || !strings.HasPrefix(rows[0], "Name,File,Line") {
+		t.Errorf("Expected a header and 6 rows, got %d lines starting %q", len(rows), rows[0])
+	}
+}
+
+func TestFunctionStore(t *testing.T) {
+	functions := []Function{
+		{Name: "parse", File: "a.go", Line: 3, Visibility: "private", Parameters: []string{"s string"}, Language: "go", Size: 4, Signature: "func parse(s string)", Metadata: map[string]string{"generic": "true"}},
+		{Name: "Parse", File: "a.go", Line: 9, Visibility: "public", Parameters: []string{}, Language: "go", Complexity: 2, IsTest: true},
+		{Name: "main", File: "b.go", Line: 1, Visibility: "private", Language: "go", IsMain: true, Comments: "entry"},
+	}
+
+	store := newFunctionStore()
+	if first := store.add(functions[:1]); first != 0 {
+		t.Errorf("First batch should start at 0, got %d", first)
+	}
+	if first := store.add(functions[1:]); first != 1 {
+		t.Errorf("Second batch should start at 1, got %d", first)
+	}
+
+	for i, want := range functions {
+		got := store.function(i)
+		gotJSON, _ := json.Marshal(got)
+		wantJSON, _ := json.Marshal(want)
+		if string(gotJSON) != string(wantJSON) {
+			t.Errorf("Function %d round trip:\n got %s\nwant %s", i, gotJSON, wantJSON)
+		}
+	}
+
+	if store.files[0] != store.files[1] || store.files[0] == store.files[2] {
+		t.Error("File paths should be interned")
+	}
+}
+
+func TestFunctionStoreSpill(t *testing.T) {
+	store := newRegistryBuild(memlimit.New(1 << 20)).store
+	var functions []Function
+	for batch := 0; batch < 8; batch++ {
+		var file []Function
+		for i := 0; i < 400; i++ {
+			file = append(file, Function{
+				Name:      fmt.Sprintf("f%d_%d", batch, i),
+				Line:      i + 1,
+				Signature: fmt.Sprintf("func f%d_%d()", batch, i),
+				Comments:  strings.Repeat("doc ", i%700),
+			})
+		}
+		store.add(file)
+		functions = append(functions, file...)
+	}
+
+	if store.spill.Size() == 0 {
+		t.Fatal("Expected the store to spill past half of its limit")
+	}
+	if want := fmt.Sprintf(", %d retained", store.text); !strings.HasSuffix(store.limit.String(), want) {
+		t.Errorf("Expected only the text still in memory to be retained, got %s", store.limit)
+	}
+	for i, want := range functions {
+		got := store.function(i)
+		if got.Signature != want.Signature || got.Comments != want.Comments {
+			t.Fatalf("Function %d came back as %q, %d bytes of comments", i, got.Signature, len(got.Comments))
+		}
+	}
+	if err := store.close(); err != nil {
+		t.Errorf("Failed to close store: %v", err)
+	}
+}
+
+func BenchmarkParseFile(b *testing.B) {
+	corpus.EachSource(b, func(b *testing.B, language, path, source string) {
+		parser := getParser(language)
+		for i := 0; i < b.N; i++ {
+			if _, err := parser.ParseFile(path); err != nil {
+				b.Fatalf("Failed to parse file: %v", err)
+			}
+		}
+	})
+}
+
+func BenchmarkAnalyzeSource(b *testing.B) {
+	corpus.EachSource(b, func(b *testing.B, language, path, source string) {
+		parser := getParser(language)
+		for i := 0; i < b.N; i++ {
+			if _, err := analyzeSource(parser, path, true, nil); err != nil {
+				b.Fatalf("Failed to analyze file: %v", err)
+			}
+		}
+	})
+}
+
+func BenchmarkAnalyzeFiles(b *testing.B) {
+	corpus.EachTree(b, "go", 8<<10, func(b *testing.B, dir string, files int) {
+		config := Config{Language: "go", Include: []string{dir}, Recursive: true, Jobs: runtime.NumCPU()}
+		for i := 0; i < b.N; i++ {
+			progress := pool.NewProgress(func(int) {})
+			count, err := analyzeFiles(config, getParser("go"), nil, true, nil, progress, func(parsedFile) {})
+			progress.Stop()
+			if err != nil || count != files {
+				b.Fatalf("Expected %d files, got %d (%v)", files, count, err)
+			}
+		}
+	})
+}
+
+func TestIndex(t *testing.T) {
+	tempDir := t.TempDir()
+	path := filepath.Join(tempDir, "a.go")
+	write := func(content string) {
+		if err := os.WriteFile(path, []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to create test file: %v", err)
+		}
+	}
+
+	index, err := NewIndex(Config{Language: "go"})
+	if err != nil {
+		t.Fatalf("NewIndex failed: %v", err)
+	}
+	if !index.Accepts(path) || index.Accepts(filepath.Join(tempDir, "a.py")) {
+		t.Error("A Go index should only accept Go files")
+	}
+
+	write("package demo\n\nfunc First() {}\n\nfunc second() {}\n")
+	if err := index.Update(path); err != nil {
+		t.Fatalf("Update failed: %v", err)
+	}
+	if got := index.Functions("", ""); len(got) != 2 || got[0].Name != "First" || got[1].Name != "second" {
+		t.Errorf("Expected First and second in line order, got %+v", got)
+	}
+
+	write("package demo\n\nfunc Third() {}\n")
+	if err := index.Update(path); err != nil {
+		t.Fatalf("Update failed: %v", err)
+	}
+	if got := index.Functions("First", ""); len(got) != 0 {
+		t.Error("Update should replace the file's functions")
+	}
+	if got := index.Functions("Third", path); len(got) != 1 {
+		t.Errorf("Expected Third, got %+v", got)
+	}
+	if summary := index.Summary(); summary.TotalFunctions != 1 || summary.PublicFunctions != 1 || summary.TotalFiles != 1 {
+		t.Errorf("Unexpected summary %+v", summary)
+	}
+
+	index.Remove(path)
+	if index.Files() != 0 {
+		t.Error("Remove should forget the file")
+	}
+}
+
+func TestMultiLanguageRegistry(t *testing.T) {
+	tempDir := t.TempDir()
+	files := map[string]string{
+		"main.go": "package main\n\nfunc main() {\n\tlocal()\n}\n\nfunc local() {}\n\nfunc shared() {}\n",
+		"tool.py": "def run():\n    shared()\n\ndef shared():\n    pass\n",
+		"lib.rs":  "fn lib() {}\n",
+	}
+	for name, content := range files {
+		if err := os.WriteFile(filepath.Join(tempDir, name), []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to create test file: %v", err)
+		}
+	}
+
+	output := filepath.Join(tempDir, "out.json")
+	config := Config{Language: "go,python", Include: []string{tempDir}, Jobs: 2, AddRelations: true, OutputFile: output}
+	if err := Run(config); err != nil {
+		t.Fatalf("Run failed: %v", err)
+	}
+	data, err := os.ReadFile(output)
+	if err != nil {
+		t.Fatalf("Failed to read output: %v", err)
+	}
+	var registry Registry
+	if err := json.Unmarshal(data, &registry); err != nil {
+		t.Fatalf("Invalid JSON: %v", err)
+	}
+
+	calls := make(map[string]int)
+	for _, fn := range registry.Functions {
+		calls[fn.Language+":"+fn.Name] = fn.CallCount
+	}
+	if len(calls) != 5 || registry.Summary.TotalFiles != 2 {
+		t.Fatalf("Expected the 5 Go and Python functions of 2 files, got %v", calls)
+	}
+	if calls["go:local"] != 1 || calls["python:shared"] != 1 {
+		t.Errorf("Calls should resolve within each language, got %v", calls)
+	}
+	if calls["go:shared"] != 0 {
+		t.Errorf("A Python call should not reach a Go function, got %v", calls)
+	}
+
+	if getParser("go,java") != nil || getParser("auto,go") != nil {
+		t.Error("Lists with languages that have no parser should be rejected")
+	}
+	parser := getParser("auto")
+	if _, language := fileParser(parser, "auto", "x.rs"); language != "rust" {
+		t.Errorf("auto should route .rs files to rust, got %s", language)
+	}
+}
@@ -0,0 +1,389 @@
+package registry
+
+import (
+	"fmt"
+	"path/filepath"
+	"sort"
+	"strings"
+
+	"github.com/vitruves/gop/internal/cache"
+	"github.com/vitruves/gop/internal/callgraph"
+	"github.com/vitruves/gop/internal/compress"
+	"github.com/vitruves/gop/internal/memlimit"
+	"github.com/vitruves/gop/internal/pool"
+)
+
+// CallSite is one call found in a file. Qualifier is the path written before
+// the name (a C++ namespace or class, a Rust module or type) or, for Member
+// calls, the receiver expression when it is a plain identifier: a Go package
+// or variable, a Python module or self.
+type CallSite struct {
+	Name      string
+	Qualifier string
+	Member    bool
+	Line      int
+}
+
+// fileSites are the call sites of one file together with the range of
+// registry functions it defines.
+type fileSites struct {
+	path  string
+	first int
+	count int
+	sites []CallSite
+}
+
+// callGraph is the resolved call graph of a run. Nodes below store.len()
+// are the registry functions; each file adds one more node standing for its
+// top-level code, so calls outside any function still have a caller.
+type callGraph struct {
+	graph     *callgraph.Graph
+	nodes     []callgraph.Node
+	callCount []int
+	reachable []bool
+}
+
+// resolver matches call sites to function definitions by short name and
+// narrows the candidates with the call's qualifier and the caller's scope.
+// When the run covers several languages, calls only reach definitions of
+// the caller's language family.
+type resolver struct {
+	store    *functionStore
+	symbols  *callgraph.Symbols
+	byName   [][]int32
+	scopes   []string
+	shorts   []int32
+	families []int8
+	mixed    bool
+}
+
+func buildCallGraph(store *functionStore, files []fileSites) *callGraph {
+	count := store.len()
+	r := &resolver{
+		store:    store,
+		symbols:  callgraph.NewSymbols(),
+		scopes:   make([]string, count),
+		shorts:   make([]int32, count),
+		families: make([]int8, count),
+	}
+	for i := 0; i < count; i++ {
+		r.families[i] = callFamily(store.file(i))
+		r.mixed = r.mixed || r.families[i] != r.families[0]
+		scope, short := splitQualifier(store.name(i))
+		id := r.symbols.Intern(short)
+		if int(id) == len(r.byName) {
+			r.byName = append(r.byName, nil)
+		}
+		r.byName[id] = append(r.byName[id], int32(i))
+		r.scopes[i] = strings.TrimPrefix(scope, "*")
+		r.shorts[i] = id
+	}
+
+	builder := callgraph.NewBuilder(count + len(files))
+	callCount := make([]int, count)
+
+	for f, file := range files {
+		module := int32(count + f)
+		defs := newDefinitionIndex(store, file.first, file.count)
+		family := callFamily(file.path)
+
+		for _, site := range file.sites {
+			id, ok := r.symbols.Lookup(site.Name)
+			if !ok {
+				continue
+			}
+
+			caller, isDefinition := defs.enclosing(site.Line, id, r.shorts)
+			if isDefinition {
+				continue
+			}
+			from := module
+			if caller >= 0 {
+				from = caller
+			}
+
+			for _, callee := range r.resolve(site, id, caller, file.path, family) {
+				builder.AddEdge(from, callee)
+				callCount[callee]++
+			}
+		}
+	}
+
+	graph := builder.Build()
+
+	nodes := make([]callgraph.Node, 0, graph.Nodes())
+	var roots []int32
+	for i := 0; i < count; i++ {
+		nodes = append(nodes, callgraph.Node{Name: store.name(i), File: store.file(i), Line: store.line(i), Kind: "function"})
+		if isEntryPoint(store, i) {
+			roots = append(roots, int32(i))
+		}
+	}
+	for f, file := range files {
+		nodes = append(nodes, callgraph.Node{Name: file.path, File: file.path, Kind: "file"})
+		roots = append(roots, int32(count+f))
+	}
+
+	return &callGraph{
+		graph:     graph,
+		nodes:     nodes,
+		callCount: callCount,
+		reachable: graph.Reachable(roots),
+	}
+}
+
+// FileCentrality analyzes the files config selects and returns, per file,
+// how many call edges from other files reach the functions it defines.
+func FileCentrality(config Config) (map[string]int, error) {
+	parser := newParser(config)
+	if parser == nil {
+		return nil, fmt.Errorf("unsupported language: %s", config.Language)
+	}
+	if config.Jobs < 1 {
+		config.Jobs = 1
+	}
+
+	var fileCache *cache.Cache
+	if config.CacheDir != "" {
+		fileCache = cache.Open(config.CacheDir, cacheName(config), cacheVersion)
+	}
+
+	limit := memlimit.New(config.MaxMemory)
+	build := newRegistryBuild(limit)
+	defer build.store.close()
+	progress := pool.NewProgress(func(int) {})
+	_, err := analyzeFiles(config, parser, fileCache, true, limit, progress, build.add)
+	progress.Stop()
+	if err != nil {
+		return nil, err
+	}
+	if fileCache != nil {
+		if err := fileCache.Save(); err != nil {
+			logWarning(fmt.Sprintf("Failed to save cache: %v", err))
+		}
+	}
+
+	cg := buildCallGraph(build.store, build.sites)
+
+	centrality := make(map[string]int, len(build.sites))
+	for i := 0; i < build.store.len(); i++ {
+		file := build.store.file(i)
+		for _, caller := range cg.graph.Callers(int32(i)) {
+			if cg.nodes[caller].File != file {
+				centrality[file]++
+			}
+		}
+	}
+	return centrality, nil
+}
+
+// isEntryPoint reports whether function i may run without being called
+// from the analyzed code.
+func isEntryPoint(store *functionStore, i int) bool {
+	if store.isMain(i) || store.isTest(i) {
+		return true
+	}
+	_, short := splitQualifier(store.name(i))
+	return store.language(i) == "go" && short == "init"
+}
+
+func (r *resolver) resolve(site CallSite, id int32, caller int32, path string, family int8) []int32 {
+	candidates := r.byName[id]
+	if r.mixed && family != 0 {
+		candidates = r.filter(candidates, func(c int32) bool { return r.families[c] == family || r.families[c] == 0 })
+	}
+	callerScope := ""
+	if caller >= 0 {
+		callerScope = r.scopes[caller]
+	}
+
+	qualifier := site.Qualifier
+	if qualifier == "self" || qualifier == "Self" || qualifier == "this" {
+		qualifier = callerScope
+	}
+
+	if qualifier != "" {
+		if matches := r.filter(candidates, func(c int32) bool { return r.qualifies(c, qualifier) }); len(matches) > 0 {
+			return matches
+		}
+		if !site.Member {
+			// An explicit path to something outside the analyzed code.
+			return nil
+		}
+	}
+
+	if site.Member {
+		// value.method() can only reach methods.
+		return r.filter(candidates, func(c int32) bool { return r.scopes[c] != "" })
+	}
+
+	if callerScope != "" {
+		if matches := r.filter(candidates, func(c int32) bool { return r.scopes[c] == callerScope }); len(matches) > 0 {
+			return matches
+		}
+	}
+
+	free := r.filter(candidates, func(c int32) bool { return r.scopes[c] == "" })
+	if matches := r.filter(free, func(c int32) bool { return r.store.file(int(c)) == path }); len(matches) > 0 {
+		return matches
+	}
+	if len(free) > 0 && r.store.language(int(free[0])) == "go" {
+		// Unqualified Go calls stay inside the package.
+		dir := filepath.Dir(path)
+		return r.filter(free, func(c int32) bool { return filepath.Dir(r.store.file(int(c))) == dir })
+	}
+	return free
+}
+
+// qualifies reports whether qualifier names the scope of candidate c, either
+// as the trailing part of its class or namespace path or as the package or
+// module its file belongs to.
+func (r *resolver) qualifies(c int32, qualifier string) bool {
+	scope := r.scopes[c]
+	if scope != "" {
+		return scope == qualifier || strings.HasSuffix(scope, "::"+qualifier) || strings.HasSuffix(scope, "."+qualifier)
+	}
+
+	file := r.store.file(int(c))
+	if filepath.Base(filepath.Dir(file)) == qualifier {
+		return true
+	}
+	return strings.TrimSuffix(filepath.Base(file), filepath.Ext(file)) == qualifier
+}
+
+func (r *resolver) filter(candidates []int32, keep func(int32) bool) []int32 {
+	var kept []int32
+	for _, c := range candidates {
+		if keep(c) {
+			kept = append(kept, c)
+		}
+	}
+	return kept
+}
+
+// definitionIndex finds the innermost function of one file around a line.
+type definitionIndex struct {
+	store *functionStore
+	order []int32
+	reach []int
+}
+
+func newDefinitionIndex(store *functionStore, first, count int) *definitionIndex {
+	d := &definitionIndex{store: store, order: make([]int32, count), reach: make([]int, count)}
+	for i := range d.order {
+		d.order[i] = int32(first + i)
+	}
+	sort.SliceStable(d.order, func(i, j int) bool {
+		return store.lines[d.order[i]] < store.lines[d.order[j]]
+	})
+
+	// reach[k] is the last line covered by any of the first k+1 functions,
+	// which bounds how far back enclosing has to look.
+	last := 0
+	for k, i := range d.order {
+		if end := store.end(int(i)); end > last {
+			last = end
+		}
+		d.reach[k] = last
+	}
+	return d
+}
+
+// enclosing returns the innermost function containing line, or -1. It also
+// reports whether line is where a function named symbol is defined, in which
+// case the match is the definition itself rather than a call.
+func (d *definitionIndex) enclosing(line int, symbol int32, shorts []int32) (int32, bool) {
+	k := sort.Search(len(d.order), func(k int) bool { return d.store.line(int(d.order[k])) > line }) - 1
+
+	caller := int32(-1)
+	for ; k >= 0 && d.reach[k] >= line; k-- {
+		i := d.order[k]
+		start := d.store.line(int(i))
+		if start == line && shorts[i] == symbol {
+			return i, true
+		}
+		if start < line && caller >= 0 {
+			break
+		}
+		if caller < 0 && d.store.end(int(i)) >= line {
+			caller = i
+		}
+	}
+	return caller, false
+}
+
+// applyRelations fills CallCount, Calls and CalledBy of fn, graph node i.
+func applyRelations(fn *Function, cg *callGraph, i int) {
+	n := int32(i)
+	fn.CallCount = cg.callCount[i]
+	fn.Calls = nodeNames(cg, cg.graph.Callees(n))
+	fn.CalledBy = nodeNames(cg, cg.graph.Callers(n))
+}
+
+func nodeNames(cg *callGraph, ids []int32) []string {
+	if len(ids) == 0 {
+		return nil
+	}
+
+	names := make([]string, 0, len(ids))
+	seen := make(map[string]bool, len(ids))
+	for _, id := range ids {
+		name := cg.nodes[id].Name
+		if !seen[name] {
+			seen[name] = true
+			names = append(names, name)
+		}
+	}
+	return names
+}
+
+// writeCallGraph exports the graph as Graphviz for .dot files and as JSON
+// otherwise.
+func writeCallGraph(cg *callGraph, path string) error {
+	file, err := compress.Create(path)
+	if err != nil {
+		return err
+	}
+
+	if filepath.Ext(compress.Trim(path)) == ".dot" {
+		err = cg.graph.WriteDOT(file, cg.nodes)
+	} else {
+		err = cg.graph.WriteJSON(file, cg.nodes)
+	}
+	if cerr := file.Close(); err == nil {
+		err = cerr
+	}
+	return err
+}
+
+// splitQualifier splits "a::b::c" or "a.b.c" into "a::b" and "c".
+func splitQualifier(name string) (string, string) {
+	if i := strings.LastIndex(name, "::"); i >= 0 {
+		return name[:i], name[i+2:]
+	}
+	if i := strings.LastIndex(name, "."); i >= 0 {
+		return name[:i], name[i+1:]
+	}
+	return "", name
+}
+
+// lineCounter maps byte offsets of content to 1-based line numbers. Offsets
+// are expected in increasing order, which makes a whole pass linear.
+type lineCounter struct {
+	content string
+	offset  int
+	line    int
+}
+
+func newLineCounter(content string) *lineCounter {
+	return &lineCounter{content: content, line: 1}
+}
+
+func (lc *lineCounter) lineAt(offset int) int {
+	if offset < lc.offset {
+		lc.offset, lc.line = 0, 1
+	}
+	lc.line += strings.Count(lc.content[lc.offset:offset], "\n")
+	lc.offset = offset
+	return lc.line
+}
@@ -1,13 +1,30 @@
 package registry
 
 import (
-	"os"
 	"regexp"
 	"strings"
+
+	"github.com/vitruves/gop/internal/source"
 )
 
 type RustParser struct{}
 
+var rustPatterns = struct {
+	fn     *regexp.Regexp
+	impl   *regexp.Regexp
+	trait  *regexp.Regexp
+	attr   *regexp.Regexp
+	call   *regexp.Regexp
+	method *regexp.Regexp
+}{
+	fn:     regexp.MustCompile(`^\s*(pub\s+)?(unsafe\s+)?(extern\s+"[^"]+"\s+)?(async\s+)?fn\s+(\w+)\s*(<[^>]*>)?\s*\((.*?)\)(?:\s*->\s*([^{]+))?\s*\{`),
+	impl:   regexp.MustCompile(`^\s*impl\s*(<[^>]*>)?\s*(\w+)`),
+	trait:  regexp.MustCompile(`^\s*(pub\s+)?trait\s+(\w+)`),
+	attr:   regexp.MustCompile(`^\s*#\[([^\]]+)\]`),
+	call:   regexp.MustCompile(`(\w+)!\s*\(|(\w+(?:::\w+)*)\s*\(`),
+	method: regexp.MustCompile(`\.(\w+)\s*\(`),
+}
+
 func (r *RustParser) GetExtensions() []string {
 	return []string{".rs"}
 }
@@ -17,34 +34,41 @@ func (r *RustParser) IsHeaderFile(filePath string) bool {
 }
 
 func (r *RustParser) ParseFile(filePath string) ([]Function, error) {
-	content, err := os.ReadFile(filePath)
-	if err != nil {
-		return nil, err
-	}
+	return parseFile(r, filePath)
+}
 
+func (r *RustParser) ParseSource(filePath string, src *source.File) ([]Function, error) {
 	var functions []Function
-	lines := strings.Split(string(content), "\n")
-	
-	fnRegex := regexp.MustCompile(`^\s*(pub\s+)?(unsafe\s+)?(extern\s+"[^"]+"\s+)?(async\s+)?fn\s+(\w+)\s*(<[^>]*>)?\s*\((.*?)\)(?:\s*->\s*([^{]+))?\s*\{`)
-	implRegex := regexp.MustCompile(`^\s*impl\s*(<[^>]*>)?\s*(\w+)`)
-	traitRegex := regexp.MustCompile(`^\s*(pub\s+)?trait\s+(\w+)`)
-	attrRegex := regexp.MustCompile(`^\s*#\[([^\]]+)\]`)
+	lines := strings.Split(src.Owned(), "\n")
 	
 	var currentImpl string
 	var currentTrait string
 	var currentAttributes []string
-	
+
+	// Sizes and complexities are filled in as each body closes: the
+	// complexity of a function is 1 plus the constructs counted on its
+	// lines, a running total taken where it starts and where it ends.
+	var constructs int
+	var startConstructs []int
+	spans := newBraceSpans(func(id, start, end int) {
+		functions[id].Size = end - start + 1
+		functions[id].Complexity = 1 + constructs - startConstructs[id]
+	})
+
 	for i, line := range lines {
 		trimmed := strings.TrimSpace(line)
+		lineConstructs := countRustConstructs(line)
+		constructs += lineConstructs
+		spans.next(line)
 		
 		// Track attributes
-		if attrMatch := attrRegex.FindStringSubmatch(line); attrMatch != nil {
+		if attrMatch := rustPatterns.attr.FindStringSubmatch(line); attrMatch != nil {
 			currentAttributes = append(currentAttributes, attrMatch[1])
 			continue
 		}
 		
 		// Track impl blocks
-		if implMatch := implRegex.FindStringSubmatch(line); implMatch != nil {
+		if implMatch := rustPatterns.impl.FindStringSubmatch(line); implMatch != nil {
 			currentImpl = implMatch[2]
 			currentTrait = ""
 			currentAttributes = nil
@@ -52,7 +76,7 @@ func (r *RustParser) ParseFile(filePath string) ([]Function, error) {
 		}
 		
 		// Track trait definitions
-		if traitMatch := traitRegex.FindStringSubmatch(line); traitMatch != nil {
+		if traitMatch := rustPatterns.trait.FindStringSubmatch(line); traitMatch != nil {
 			currentTrait = traitMatch[2]
 			currentImpl = ""
 			currentAttributes = nil
@@ -60,7 +84,7 @@ func (r *RustParser) ParseFile(filePath string) ([]Function, error) {
 		}
 		
 		// Parse function definitions
-		if fnMatch := fnRegex.FindStringSubmatch(line); fnMatch != nil {
+		if fnMatch := rustPatterns.fn.FindStringSubmatch(line); fnMatch != nil {
 			pubMod := strings.TrimSpace(fnMatch[1])
 			unsafeMod := strings.TrimSpace(fnMatch[2])
 			externMod := strings.TrimSpace(fnMatch[3])
@@ -100,9 +124,7 @@ func (r *RustParser) ParseFile(filePath string) ([]Function, error) {
 				Signature:  strings.TrimSpace(line),
 				IsTest:     isRustTestFunction(currentAttributes),
 				IsMain:     name == "main",
-				Size:       calculateRustFunctionSize(lines, i),
 				Comments:   comments,
-				Complexity: calculateRustComplexity(lines, i),
 			}
 			
 			// Set metadata
@@ -124,6 +146,8 @@ func (r *RustParser) ParseFile(filePath string) ([]Function, error) {
 			}
 			
 			functions = append(functions, fn)
+			startConstructs = append(startConstructs, constructs-lineConstructs)
+			spans.open(len(functions) - 1)
 			currentAttributes = nil
 		} else if trimmed != "" && !strings.HasPrefix(trimmed, "//") && !strings.HasPrefix(trimmed, "#") {
 			if !strings.Contains(trimmed, "impl") && !strings.Contains(trimmed, "trait") {
@@ -131,44 +155,44 @@ func (r *RustParser) ParseFile(filePath string) ([]Function, error) {
 			}
 		}
 	}
-	
+	spans.finish()
+
 	return functions, nil
 }
 
-func (r *RustParser) FindFunctionCalls(content string) []string {
+func (r *RustParser) FindCallSites(content string) []CallSite {
 	// Rust function calls and macro invocations
-	callRegex := regexp.MustCompile(`(\w+)!\s*\(|(\w+)\s*\(`)
-	methodRegex := regexp.MustCompile(`\.(\w+)\s*\(`)
-	
-	var calls []string
-	seen := make(map[string]bool)
+	var sites []CallSite
 	
-	matches := callRegex.FindAllStringSubmatch(content, -1)
-	for _, match := range matches {
-		var call string
-		if match[1] != "" { // Macro call
-			call = match[1]
-		} else if match[2] != "" { // Function call
-			call = match[2]
-		}
-		
-		if call != "" && !seen[call] && !isRustBuiltin(call) {
-			calls = append(calls, call)
-			seen[call] = true
+	// Method calls; the plain call pattern also matches their names, so
+	// remember where they start.
+	members := make(map[int]bool)
+	lines := newLineCounter(content)
+	for _, match := range rustPatterns.method.FindAllStringSubmatchIndex(content, -1) {
+		call := content[match[2]:match[3]]
+		members[match[2]] = true
+		if !isRustBuiltin(call) {
+			sites = append(sites, CallSite{Name: call, Member: true, Line: lines.lineAt(match[2])})
 		}
 	}
 	
-	// Method calls
-	methodMatches := methodRegex.FindAllStringSubmatch(content, -1)
-	for _, match := range methodMatches {
-		call := match[1]
-		if !seen[call] && !isRustBuiltin(call) {
-			calls = append(calls, call)
-			seen[call] = true
+	lines = newLineCounter(content)
+	for _, match := range rustPatterns.call.FindAllStringSubmatchIndex(content, -1) {
+		var site CallSite
+		if match[2] >= 0 { // Macro call
+			site.Name = content[match[2]:match[3]]
+			site.Line = lines.lineAt(match[2])
+		} else if match[4] >= 0 && !members[match[4]] { // Function call
+			site.Qualifier, site.Name = splitQualifier(content[match[4]:match[5]])
+			site.Line = lines.lineAt(match[4])
+		}
+		
+		if site.Name != "" && !isRustBuiltin(site.Name) {
+			sites = append(sites, site)
 		}
 	}
 	
-	return calls
+	return sites
 }
 
 func parseRustParameters(params string) []string {
@@ -233,55 +257,16 @@ func extractRustComments(lines []string, fnLine int) string {
 	return strings.Join(comments, " ")
 }
 
-func calculateRustFunctionSize(lines []string, startLine int) int {
-	if startLine >= len(lines) {
-		return 1
-	}
-	
-	braceCount := 0
-	size := 1
-	
-	// Count opening braces in the first line
-	braceCount += strings.Count(lines[startLine], "{") - strings.Count(lines[startLine], "}")
-	
-	for i := startLine + 1; i < len(lines); i++ {
-		line := lines[i]
-		braceCount += strings.Count(line, "{") - strings.Count(line, "}")
-		size++
-		
-		if braceCount == 0 {
-			break
-		}
-	}
-	
-	return size
-}
-
-func calculateRustComplexity(lines []string, startLine int) int {
-	complexity := 1 // Base complexity
-	braceCount := 0
-	
-	braceCount += strings.Count(lines[startLine], "{") - strings.Count(lines[startLine], "}")
-	
-	for i := startLine; i < len(lines); i++ {
-		line := lines[i]
-		braceCount += strings.Count(line, "{") - strings.Count(line, "}")
-		
-		// Count complexity-increasing constructs
-		complexity += strings.Count(line, "if ")
-		complexity += strings.Count(line, "else if ")
-		complexity += strings.Count(line, "match ")
-		complexity += strings.Count(line, "for ")
-		complexity += strings.Count(line, "while ")
-		complexity += strings.Count(line, "loop ")
-		complexity += strings.Count(line, "?") // Error propagation
-		
-		if braceCount == 0 && i > startLine {
-			break
-		}
-	}
-	
-	return complexity
+// countRustConstructs counts the branches and error propagations on line
+// that add to a function's complexity.
+func countRustConstructs(line string) int {
+	return strings.Count(line, "if ") +
+		strings.Count(line, "else if ") +
+		strings.Count(line, "match ") +
+		strings.Count(line, "for ") +
+		strings.Count(line, "while ") +
+		strings.Count(line, "loop ") +
+		strings.Count(line, "?") // Error propagation
 }
 
 func isRustTestFunction(attributes []string) bool {
@@ -0,0 +1,272 @@
+package registry
+
+import (
+	"sort"
+
+	"github.com/vitruves/gop/internal/memlimit"
+)
+
+// functionStore holds the functions of a run in columns. Names, files,
+// languages, visibilities, return types, parameters and metadata are
+// interned to IDs, and parameters and metadata of all functions share one
+// arena each, so a function costs a few words plus whatever text is unique
+// to it. The store is filled file by file in walk order and converted back
+// to Function only for output. Under a memory limit, signatures and
+// comments, the text that is rarely shared, move to a temporary file once
+// the store holds more than the limit allows.
+type functionStore struct {
+	strs []string
+	ids  map[string]uint32
+
+	names       []uint32
+	files       []uint32
+	languages   []uint32
+	visibility  []uint32
+	returnTypes []uint32
+	lines       []int32
+	sizes       []int32
+	complexity  []int32
+	flags       []uint8
+	signatures  []string
+	comments    []string
+
+	// The parameters of function i are params[paramEnd[i-1]:paramEnd[i]];
+	// its metadata are the key and value pairs in meta[metaEnd[i-1]:metaEnd[i]].
+	params   []uint32
+	paramEnd []uint32
+	meta     []uint32
+	metaEnd  []uint32
+
+	// The signature and comments of function i < len(spillEnd)/2 were
+	// spilled and end at spillEnd[2i] and spillEnd[2i+1] in spill. text is
+	// how many bytes of them are still in memory.
+	limit    *memlimit.Limit
+	spill    *memlimit.Spill
+	spillEnd []int64
+	text     int64
+	err      error
+}
+
+// minSpill is the least text written to the spill file at once, so a limit
+// already filled by other results does not make the store spill on every
+// file. Only the text counts against the limit: the columns cannot be
+// spilled, and counting them would leave the limit full for good.
+const minSpill = 1 << 20
+
+const (
+	flagTest uint8 = 1 << iota
+	flagMain
+	// flagParams tells an empty parameter list from a nil one, which JSON
+	// writes differently.
+	flagParams
+)
+
+func newFunctionStore() *functionStore {
+	s := &functionStore{ids: make(map[string]uint32)}
+	s.intern("")
+	return s
+}
+
+func (s *functionStore) intern(str string) uint32 {
+	if id, ok := s.ids[str]; ok {
+		return id
+	}
+	id := uint32(len(s.strs))
+	s.strs = append(s.strs, str)
+	s.ids[str] = id
+	return id
+}
+
+func (s *functionStore) len() int {
+	return len(s.names)
+}
+
+// add appends functions and returns the index of the first of them.
+func (s *functionStore) add(functions []Function) int {
+	first := s.len()
+	for i := range functions {
+		fn := &functions[i]
+		var flags uint8
+		if fn.IsTest {
+			flags |= flagTest
+		}
+		if fn.IsMain {
+			flags |= flagMain
+		}
+		if fn.Parameters != nil {
+			flags |= flagParams
+		}
+
+		s.names = append(s.names, s.intern(fn.Name))
+		s.files = append(s.files, s.intern(fn.File))
+		s.languages = append(s.languages, s.intern(fn.Language))
+		s.visibility = append(s.visibility, s.intern(fn.Visibility))
+		s.returnTypes = append(s.returnTypes, s.intern(fn.ReturnType))
+		s.lines = append(s.lines, int32(fn.Line))
+		s.sizes = append(s.sizes, int32(fn.Size))
+		s.complexity = append(s.complexity, int32(fn.Complexity))
+		s.flags = append(s.flags, flags)
+		s.signatures = append(s.signatures, fn.Signature)
+		s.comments = append(s.comments, fn.Comments)
+
+		for _, param := range fn.Parameters {
+			s.params = append(s.params, s.intern(param))
+		}
+		s.paramEnd = append(s.paramEnd, uint32(len(s.params)))
+		for key, value := range fn.Metadata {
+			s.meta = append(s.meta, s.intern(key), s.intern(value))
+		}
+		s.metaEnd = append(s.metaEnd, uint32(len(s.meta)))
+	}
+
+	if s.limit != nil {
+		var text int64
+		for i := range functions {
+			text += int64(len(functions[i].Signature) + len(functions[i].Comments))
+		}
+		s.text += text
+		if s.limit.Retain(text) && s.text >= minSpill {
+			s.spillText()
+		}
+	}
+	return first
+}
+
+// spillText appends the signatures and comments still in memory to the
+// spill file. When the file cannot be written they stay where they are.
+func (s *functionStore) spillText() {
+	if s.err != nil {
+		return
+	}
+	if s.spill == nil {
+		if s.spill, s.err = memlimit.NewSpill(); s.err != nil {
+			return
+		}
+	}
+
+	from := len(s.spillEnd) / 2
+	buf := make([]byte, 0, s.text)
+	ends := make([]int64, 0, 2*(s.len()-from))
+	base := s.spill.Size()
+	for i := from; i < s.len(); i++ {
+		buf = append(buf, s.signatures[i]...)
+		ends = append(ends, base+int64(len(buf)))
+		buf = append(buf, s.comments[i]...)
+		ends = append(ends, base+int64(len(buf)))
+	}
+	if _, s.err = s.spill.Append(buf); s.err != nil {
+		return
+	}
+
+	for i := from; i < s.len(); i++ {
+		s.signatures[i] = ""
+		s.comments[i] = ""
+	}
+	s.spillEnd = append(s.spillEnd, ends...)
+	s.limit.Free(s.text)
+	s.text = 0
+}
+
+// docs returns the signature and comments of function i, reading them back
+// from the spill file if they were moved there.
+func (s *functionStore) docs(i int) (signature, comments string) {
+	if 2*i >= len(s.spillEnd) {
+		return s.signatures[i], s.comments[i]
+	}
+	start := int64(0)
+	if i > 0 {
+		start = s.spillEnd[2*i-1]
+	}
+	data, err := s.spill.Read(start, s.spillEnd[2*i+1]-start)
+	if err != nil {
+		if s.err == nil {
+			s.err = err
+		}
+		return "", ""
+	}
+	split := s.spillEnd[2*i] - start
+	return string(data[:split]), string(data[split:])
+}
+
+// close deletes the spill file and returns the first error spilling or
+// reading back met.
+func (s *functionStore) close() error {
+	err := s.err
+	if cerr := s.spill.Close(); err == nil {
+		err = cerr
+	}
+	s.spill = nil
+	return err
+}
+
+func (s *functionStore) name(i int) string     { return s.strs[s.names[i]] }
+func (s *functionStore) file(i int) string     { return s.strs[s.files[i]] }
+func (s *functionStore) language(i int) string { return s.strs[s.languages[i]] }
+func (s *functionStore) line(i int) int        { return int(s.lines[i]) }
+func (s *functionStore) size(i int) int        { return int(s.sizes[i]) }
+
+// end is the last line of function i.
+func (s *functionStore) end(i int) int {
+	return int(s.lines[i]+s.sizes[i]) - 1
+}
+
+func (s *functionStore) public(i int) bool {
+	return s.strs[s.visibility[i]] == "public"
+}
+
+func (s *functionStore) isTest(i int) bool { return s.flags[i]&flagTest != 0 }
+func (s *functionStore) isMain(i int) bool { return s.flags[i]&flagMain != 0 }
+
+// function rebuilds function i with its own parameters and metadata.
+func (s *functionStore) function(i int) Function {
+	signature, comments := s.docs(i)
+	fn := Function{
+		Name:       s.name(i),
+		File:       s.file(i),
+		Line:       s.line(i),
+		Visibility: s.strs[s.visibility[i]],
+		ReturnType: s.strs[s.returnTypes[i]],
+		Language:   s.language(i),
+		Comments:   comments,
+		Signature:  signature,
+		IsTest:     s.isTest(i),
+		IsMain:     s.isMain(i),
+		Complexity: int(s.complexity[i]),
+		Size:       s.size(i),
+	}
+
+	params := s.params[s.rangeStart(s.paramEnd, i):s.paramEnd[i]]
+	if s.flags[i]&flagParams != 0 {
+		fn.Parameters = make([]string, len(params))
+		for k, id := range params {
+			fn.Parameters[k] = s.strs[id]
+		}
+	}
+
+	if meta := s.meta[s.rangeStart(s.metaEnd, i):s.metaEnd[i]]; len(meta) > 0 {
+		fn.Metadata = make(map[string]string, len(meta)/2)
+		for k := 0; k < len(meta); k += 2 {
+			fn.Metadata[s.strs[meta[k]]] = s.strs[meta[k+1]]
+		}
+	}
+	return fn
+}
+
+func (s *functionStore) rangeStart(ends []uint32, i int) uint32 {
+	if i == 0 {
+		return 0
+	}
+	return ends[i-1]
+}
+
+// sortByFile orders function indices by file and then line, keeping walk
+// order for functions on the same line.
+func (s *functionStore) sortByFile(indices []int32) {
+	sort.SliceStable(indices, func(a, b int) bool {
+		i, j := int(indices[a]), int(indices[b])
+		if s.files[i] == s.files[j] {
+			return s.lines[i] < s.lines[j]
+		}
+		return s.file(i) < s.file(j)
+	})
+}
@@ -0,0 +1,119 @@
+// Package sniff tells binary and generated files apart from hand-written
+// source by looking only at their first HeadSize bytes.
+package sniff
+
+import (
+	"bytes"
+	"io"
+	"os"
+
+	"github.com/vitruves/gop/internal/archive"
+)
+
+// HeadSize is how much of a file File reads.
+const HeadSize = 8 << 10
+
+// Kind is what a file looks like from its head.
+type Kind int
+
+const (
+	Text Kind = iota
+	Binary
+	Generated
+)
+
+func (k Kind) String() string {
+	switch k {
+	case Binary:
+		return "binary"
+	case Generated:
+		return "generated"
+	default:
+		return "text"
+	}
+}
+
+var (
+	generatedMarker = []byte("@generated")
+	codeGenerated   = []byte("Code generated")
+	doNotEdit       = []byte("DO NOT EDIT")
+)
+
+// File reads the head of path, which may be an archive member, and
+// classifies it.
+func File(path string) (Kind, error) {
+	if data, ok, err := archive.Read(path); ok {
+		if err != nil {
+			return Text, err
+		}
+		if len(data) > HeadSize {
+			return Classify(data[:HeadSize], true), nil
+		}
+		return Classify(data, false), nil
+	}
+
+	file, err := os.Open(path)
+	if err != nil {
+		return Text, err
+	}
+	defer file.Close()
+
+	// One byte more than HeadSize tells whether the file goes on.
+	buf := make([]byte, HeadSize+1)
+	n, err := io.ReadFull(file, buf)
+	if err != nil && err != io.EOF && err != io.ErrUnexpectedEOF {
+		return Text, err
+	}
+	if n > HeadSize {
+		return Classify(buf[:HeadSize], true), nil
+	}
+	return Classify(buf[:n], false), nil
+}
+
+// Classify looks at head, the start of a file that goes on past it when
+// truncated is set. A NUL byte, or control bytes making up more than a
+// tenth of it, make it Binary; any text encoding, UTF-8 or not, passes. A
+// "Code generated ... DO NOT EDIT" line, an @generated marker, or no
+// newline at all in a truncated head, as in minified bundles, makes it
+// Generated.
+func Classify(head []byte, truncated bool) Kind {
+	if bytes.IndexByte(head, 0) >= 0 || 10*controlBytes(head) > len(head) {
+		return Binary
+	}
+
+	if bytes.Contains(head, generatedMarker) {
+		return Generated
+	}
+	for rest := head; ; {
+		i := bytes.Index(rest, codeGenerated)
+		if i < 0 {
+			break
+		}
+		rest = rest[i:]
+		line := rest
+		if end := bytes.IndexByte(rest, '\n'); end >= 0 {
+			line = rest[:end]
+		}
+		if bytes.Contains(line, doNotEdit) {
+			return Generated
+		}
+		rest = rest[len(codeGenerated):]
+	}
+	if truncated && bytes.IndexByte(head, '\n') < 0 {
+		return Generated
+	}
+	return Text
+}
+
+// controlBytes counts the bytes of head below space that text does not use:
+// everything but tabs, line and page breaks, and the escape of terminal
+// colours.
+func controlBytes(head []byte) int {
+	n := 0
+	for _, b := range head {
+		if b < ' ' && b != '\t' && b != '\n' && b != '\r' && b != '\f' && b != '\v' && b != 0x1b {
+			n++
+		}
+	}
+	return n
+}
@@ -0,0 +1,57 @@
+package sniff
+
+import (
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+func TestClassify(t *testing.T) {
+	tests := []struct {
+		name      string
+		head      string
+		truncated bool
+		want      Kind
+	}{
+		{"source", "package main\n\nfunc main() {}\n", false, Text},
+		{"unicode", "// héllo wörld ✓\n", false, Text},
+		{"nul", "ELF\x00\x01\x02", false, Binary},
+		{"latin1", "caf\xe9\n", false, Text},
+		{"cut rune", "x := 1\ny := \"\xe2\x9c", true, Text},
+		{"control bytes", "\x89PNG\r\n\x1a\n\x01\x02\x03\x04IHDR", false, Binary},
+		{"a few control bytes", "form\x0cfeed and a bell\x07 in a long line of text\n", false, Text},
+		{"go generated", "// Code generated by protoc-gen-go. DO NOT EDIT.\npackage pb\n", false, Generated},
+		{"marker", "/**\n * @generated\n */\n", false, Generated},
+		{"code generated prose", "// Code generated files are skipped.\n// DO NOT EDIT them by hand.\n", false, Text},
+		{"minified", strings.Repeat("var a=1;", 100), true, Generated},
+		{"one short line", strings.Repeat("var a=1;", 100), false, Text},
+	}
+
+	for _, tt := range tests {
+		if got := Classify([]byte(tt.head), tt.truncated); got != tt.want {
+			t.Errorf("%s: expected %s, got %s", tt.name, tt.want, got)
+		}
+	}
+}
+
+func TestFileReadsOnlyTheHead(t *testing.T) {
+	dir := t.TempDir()
+	path := filepath.Join(dir, "late.c")
+	content := strings.Repeat("int x;\n", HeadSize/7+1) + "\x00"
+	if err := os.WriteFile(path, []byte(content), 0644); err != nil {
+		t.Fatalf("Failed to write file: %v", err)
+	}
+
+	kind, err := File(path)
+	if err != nil {
+		t.Fatalf("File failed: %v", err)
+	}
+	if kind != Text {
+		t.Errorf("A NUL past the head should not be seen, got %s", kind)
+	}
+
+	if _, err := File(filepath.Join(dir, "missing.c")); err == nil {
+		t.Error("Expected an error for a missing file")
+	}
+}
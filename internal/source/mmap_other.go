@@ -0,0 +1,12 @@
+//go:build !unix
+
+package source
+
+import (
+	"errors"
+	"os"
+)
+
+func mmap(file *os.File, size int) ([]byte, func() error, error) {
+	return nil, nil, errors.New("mmap is not supported on this platform")
+}
@@ -0,0 +1,173 @@
+package source
+
+import (
+	"bytes"
+	"errors"
+	"fmt"
+	"os"
+	"runtime/debug"
+	"unsafe"
+
+	"github.com/vitruves/gop/internal/archive"
+)
+
+// MmapThreshold is the size from which Open maps a file instead of reading
+// it. Smaller files are cheaper to read than to map and unmap.
+const MmapThreshold = 1 << 20
+
+// File is the read-only content of a source file together with a lazily
+// built index of line start offsets. Large files are memory-mapped, so their
+// content never lives on the Go heap. Strings returned by String and Line
+// point into that content and are only valid until Close; anything kept
+// longer must be copied with strings.Clone.
+type File struct {
+	data    []byte
+	starts  []int
+	release func() error
+}
+
+// ErrFault is returned by Protect when mapped content could not be read,
+// as when the file was truncated while it was mapped.
+var ErrFault = errors.New("mapped file changed while it was read")
+
+// Open reads path, mapping it into memory when it is at least MmapThreshold
+// bytes long and the platform supports it. Members of a loaded archive are
+// read from the archive. Code that reads mapped content must run under
+// Protect.
+func Open(path string) (*File, error) {
+	return open(path, true)
+}
+
+// Read is Open without mapping, for files that are likely to change while
+// they are read, as those a watcher reports.
+func Read(path string) (*File, error) {
+	return open(path, false)
+}
+
+func open(path string, mapLarge bool) (*File, error) {
+	if data, ok, err := archive.Read(path); ok {
+		if err != nil {
+			return nil, err
+		}
+		return &File{data: data}, nil
+	}
+
+	file, err := os.Open(path)
+	if err != nil {
+		return nil, err
+	}
+	defer file.Close()
+
+	info, err := file.Stat()
+	if err != nil {
+		return nil, err
+	}
+
+	if size := info.Size(); mapLarge && size >= MmapThreshold && size == int64(int(size)) {
+		if data, release, err := mmap(file, int(size)); err == nil {
+			return &File{data: data, release: release}, nil
+		}
+	}
+
+	var buf bytes.Buffer
+	if size := info.Size(); size > 0 && size == int64(int(size)) {
+		buf.Grow(int(size) + bytes.MinRead)
+	}
+	if _, err := buf.ReadFrom(file); err != nil {
+		return nil, err
+	}
+	return &File{data: buf.Bytes()}, nil
+}
+
+// Protect runs fn, which reads the content of Files, and turns the fault
+// raised when a mapped file shrinks under it into ErrFault instead of a
+// crash. Anything fn was doing when the fault hit is abandoned, so fn must
+// not leave shared state half updated.
+func Protect(fn func()) (err error) {
+	defer debug.SetPanicOnFault(debug.SetPanicOnFault(true))
+	defer func() {
+		if r := recover(); r != nil {
+			fault, ok := r.(interface{ Addr() uintptr })
+			if !ok {
+				panic(r)
+			}
+			err = fmt.Errorf("%w (fault at %#x)", ErrFault, fault.Addr())
+		}
+	}()
+	fn()
+	return nil
+}
+
+// Bytes returns the whole content. It must not be modified.
+func (f *File) Bytes() []byte {
+	return f.data
+}
+
+// String returns the whole content without copying it.
+func (f *File) String() string {
+	if len(f.data) == 0 {
+		return ""
+	}
+	return unsafe.String(&f.data[0], len(f.data))
+}
+
+// Owned returns the whole content as a string that stays valid after Close.
+// It only copies when the content is mapped.
+func (f *File) Owned() string {
+	if f.Mapped() {
+		return string(f.data)
+	}
+	return f.String()
+}
+
+// Mapped reports whether the content is memory-mapped.
+func (f *File) Mapped() bool {
+	return f.release != nil
+}
+
+// NumLines returns the number of lines, counted like strings.Split(s, "\n"):
+// a trailing newline starts one final empty line.
+func (f *File) NumLines() int {
+	f.index()
+	return len(f.starts)
+}
+
+// Line returns line i without its newline, without copying it.
+func (f *File) Line(i int) string {
+	f.index()
+	start := f.starts[i]
+	end := len(f.data)
+	if i+1 < len(f.starts) {
+		end = f.starts[i+1] - 1
+	}
+	return f.String()[start:end]
+}
+
+func (f *File) index() {
+	if f.starts != nil {
+		return
+	}
+
+	f.starts = make([]int, 1, bytes.Count(f.data, []byte{'\n'})+1)
+	for offset := 0; ; {
+		i := bytes.IndexByte(f.data[offset:], '\n')
+		if i < 0 {
+			break
+		}
+		offset += i + 1
+		f.starts = append(f.starts, offset)
+	}
+}
+
+// Close releases the mapping. The content must not be used afterwards.
+func (f *File) Close() error {
+	f.starts = nil
+	if f.release == nil {
+		f.data = nil
+		return nil
+	}
+
+	release := f.release
+	f.data, f.release = nil, nil
+	return release()
+}
@@ -0,0 +1,74 @@
+package source
+
+import (
+	"errors"
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+)
+
+func TestOpenIndexesLines(t *testing.T) {
+	dir := t.TempDir()
+	small := "first\nsecond\r\n\nlast\n"
+	large := strings.Repeat("int value = 42;\n", MmapThreshold/16+1)
+
+	for _, content := range []string{small, large, ""} {
+		path := filepath.Join(dir, "file.h")
+		if err := os.WriteFile(path, []byte(content), 0644); err != nil {
+			t.Fatalf("Failed to create file: %v", err)
+		}
+
+		src, err := Open(path)
+		if err != nil {
+			t.Fatalf("Failed to open file: %v", err)
+		}
+
+		if src.String() != content {
+			t.Errorf("Content mismatch for %d byte file", len(content))
+		}
+
+		expected := strings.Split(content, "\n")
+		if src.NumLines() != len(expected) {
+			t.Fatalf("Expected %d lines, got %d", len(expected), src.NumLines())
+		}
+		for i, line := range expected {
+			if got := src.Line(i); got != line {
+				t.Errorf("Line %d: expected %q, got %q", i, line, got)
+			}
+		}
+
+		if err := src.Close(); err != nil {
+			t.Errorf("Failed to close file: %v", err)
+		}
+	}
+}
+
+func TestProtectTruncatedMapping(t *testing.T) {
+	path := filepath.Join(t.TempDir(), "big.c")
+	if err := os.WriteFile(path, []byte(strings.Repeat("x", 4*MmapThreshold)), 0644); err != nil {
+		t.Fatalf("Failed to create file: %v", err)
+	}
+	src, err := Open(path)
+	if err != nil {
+		t.Fatalf("Failed to open file: %v", err)
+	}
+	defer src.Close()
+	if !src.Mapped() {
+		t.Skip("Files are not mapped on this platform")
+	}
+
+	if err := os.Truncate(path, 0); err != nil {
+		t.Fatalf("Failed to truncate file: %v", err)
+	}
+	var last byte
+	err = Protect(func() { last = src.Bytes()[len(src.Bytes())-1] })
+	if !errors.Is(err, ErrFault) {
+		t.Errorf("Expected ErrFault reading a truncated mapping, got %v (read %q)", err, last)
+	}
+
+	unmapped, err := Read(path)
+	if err != nil || unmapped.Mapped() {
+		t.Errorf("Read should never map, got mapped=%v (%v)", unmapped != nil && unmapped.Mapped(), err)
+	}
+}
@@ -0,0 +1,164 @@
+// Package timings collects what --timings reports: wall time, CPU time and
+// allocations for each phase of a run, and files, bytes and worker time for
+// each language. Until Enable is called every function returns at once.
+package timings
+
+import (
+	"fmt"
+	"io"
+	"runtime"
+	"sync"
+	"sync/atomic"
+	"text/tabwriter"
+	"time"
+)
+
+var enabled atomic.Bool
+
+var (
+	mu     sync.Mutex
+	phases []phase
+	work   = map[string]*languageWork{}
+	order  []string
+)
+
+type phase struct {
+	name       string
+	wall       time.Duration
+	cpu        time.Duration
+	allocs     uint64
+	allocBytes uint64
+}
+
+type languageWork struct {
+	files int
+	bytes int64
+	busy  time.Duration
+}
+
+// Enable starts collecting.
+func Enable() {
+	enabled.Store(true)
+}
+
+// Enabled reports whether Enable was called.
+func Enabled() bool {
+	return enabled.Load()
+}
+
+// Reset forgets everything collected so far.
+func Reset() {
+	mu.Lock()
+	defer mu.Unlock()
+	phases, work, order = nil, map[string]*languageWork{}, nil
+}
+
+// Phase starts timing the named phase of the run; calling the returned
+// function ends it. Phases of a streaming pipeline cover all the stages
+// that overlap in it, such as walking, reading and parsing.
+func Phase(name string) func() {
+	if !enabled.Load() {
+		return func() {}
+	}
+
+	var before runtime.MemStats
+	runtime.ReadMemStats(&before)
+	start, cpu := time.Now(), cpuTime()
+	return func() {
+		p := phase{name: name, wall: time.Since(start), cpu: cpuTime() - cpu}
+		var after runtime.MemStats
+		runtime.ReadMemStats(&after)
+		p.allocs = after.Mallocs - before.Mallocs
+		p.allocBytes = after.TotalAlloc - before.TotalAlloc
+
+		mu.Lock()
+		phases = append(phases, p)
+		mu.Unlock()
+	}
+}
+
+// Now returns the start time to pass to File, or the zero time when
+// nothing is collected.
+func Now() time.Time {
+	if !enabled.Load() {
+		return time.Time{}
+	}
+	return time.Now()
+}
+
+// File records that a worker spent the time since start on a file of the
+// given size in language. Files served from a cache are not recorded.
+func File(language string, bytes int64, start time.Time) {
+	if !enabled.Load() {
+		return
+	}
+	busy := time.Since(start)
+
+	mu.Lock()
+	defer mu.Unlock()
+	w, ok := work[language]
+	if !ok {
+		w = &languageWork{}
+		work[language] = w
+		order = append(order, language)
+	}
+	w.files++
+	w.bytes += bytes
+	w.busy += busy
+}
+
+// Report writes the collected timings as two tables. Per-language
+// throughput is per worker: files and bytes over the worker time spent on
+// them.
+func Report(w io.Writer) error {
+	mu.Lock()
+	defer mu.Unlock()
+
+	tw := tabwriter.NewWriter(w, 0, 4, 2, ' ', 0)
+	fmt.Fprintf(tw, "phase\twall\tcpu\tallocs\talloc bytes\n")
+	for _, p := range phases {
+		fmt.Fprintf(tw, "%s\t%s\t%s\t%d\t%s\n", p.name, round(p.wall), round(p.cpu), p.allocs, formatBytes(int64(p.allocBytes)))
+	}
+
+	if len(order) > 0 {
+		fmt.Fprintf(tw, "\nlanguage\tfiles\tbytes read\tworker time\tfiles/s\tMB/s\n")
+		for _, language := range order {
+			lw := work[language]
+			name := language
+			if name == "" {
+				name = "(all)"
+			}
+			seconds := lw.busy.Seconds()
+			if seconds == 0 {
+				seconds = 1e-9
+			}
+			fmt.Fprintf(tw, "%s\t%d\t%s\t%s\t%.0f\t%.1f\n", name, lw.files, formatBytes(lw.bytes), round(lw.busy),
+				float64(lw.files)/seconds, float64(lw.bytes)/seconds/(1<<20))
+		}
+	}
+	return tw.Flush()
+}
+
+func round(d time.Duration) time.Duration {
+	switch {
+	case d >= time.Second:
+		return d.Round(time.Millisecond)
+	case d >= time.Millisecond:
+		return d.Round(time.Microsecond)
+	default:
+		return d
+	}
+}
+
+func formatBytes(n int64) string {
+	switch {
+	case n >= 1<<30:
+		return fmt.Sprintf("%.1f GB", float64(n)/(1<<30))
+	case n >= 1<<20:
+		return fmt.Sprintf("%.1f MB", float64(n)/(1<<20))
+	case n >= 1<<10:
+		return fmt.Sprintf("%.1f KB", float64(n)/(1<<10))
+	default:
+		return fmt.Sprintf("%d B", n)
+	}
+}
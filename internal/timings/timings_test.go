@@ -0,0 +1,56 @@
+package timings
+
+import (
+	"bytes"
+	"strings"
+	"testing"
+	"time"
+)
+
+func TestDisabledRecordsNothing(t *testing.T) {
+	Reset()
+	Phase("walk")()
+	File("go", 10, Now())
+
+	var out bytes.Buffer
+	if err := Report(&out); err != nil {
+		t.Fatalf("Report failed: %v", err)
+	}
+	if strings.Contains(out.String(), "walk") || strings.Contains(out.String(), "language") {
+		t.Errorf("Nothing should be recorded before Enable, got:\n%s", out.String())
+	}
+}
+
+func TestReport(t *testing.T) {
+	Reset()
+	Enable()
+	defer func() {
+		enabled.Store(false)
+		Reset()
+	}()
+
+	end := Phase("parse")
+	data := make([]byte, 1<<16)
+	_ = data
+	end()
+
+	start := Now()
+	time.Sleep(time.Millisecond)
+	File("go", 2<<20, start)
+	File("go", 1<<20, Now())
+	File("rust", 100, Now())
+
+	var out bytes.Buffer
+	if err := Report(&out); err != nil {
+		t.Fatalf("Report failed: %v", err)
+	}
+	report := out.String()
+	for _, want := range []string{"parse", "language", "3.0 MB", "100 B"} {
+		if !strings.Contains(report, want) {
+			t.Errorf("Report should contain %q, got:\n%s", want, report)
+		}
+	}
+	if lines := strings.Split(report, "\n"); !strings.Contains(lines[len(lines)-3], "go") || !strings.Contains(lines[len(lines)-3], " 2 ") {
+		t.Errorf("Languages should be listed in first-seen order with their file counts, got:\n%s", report)
+	}
+}
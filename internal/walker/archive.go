@@ -0,0 +1,59 @@
+package walker
+
+import (
+	"path/filepath"
+	"sort"
+	"strings"
+
+	"github.com/vitruves/gop/internal/archive"
+)
+
+// emitArchive sends the members of the archive at path that a walk of it
+// as a directory would yield, in walk order: files below its top level
+// only when recursive and within the depth, and only past the exclude,
+// extension and filter rules. .gitignore files inside archives are not
+// read.
+func (w *walker) emitArchive(path string) error {
+	members, err := archive.Load(path)
+	if err != nil {
+		return err
+	}
+	sort.Slice(members, func(i, j int) bool { return walkLess(members[i].Name, members[j].Name) })
+
+	skipped := make(map[string]bool)
+	for _, member := range members {
+		if w.skipArchiveDirs(path, member.Name, skipped) {
+			continue
+		}
+		memberPath := filepath.Join(path, filepath.FromSlash(member.Name))
+		if !w.acceptName(path, memberPath) || w.config.Filter != nil && !w.config.Filter(memberPath) {
+			continue
+		}
+		w.out <- File{Path: memberPath, Size: member.Size, ModTime: member.ModTime}
+	}
+	return nil
+}
+
+// skipArchiveDirs reports whether the walk would not enter one of the
+// directories of member, remembering the answer for each directory.
+func (w *walker) skipArchiveDirs(root, member string, skipped map[string]bool) bool {
+	dirs := strings.Split(member, "/")
+	dirs = dirs[:len(dirs)-1]
+	if len(dirs) > 0 && !w.config.Recursive || w.config.Depth > 0 && len(dirs) > w.config.Depth {
+		return true
+	}
+
+	dir := root
+	for _, name := range dirs {
+		dir = filepath.Join(dir, name)
+		skip, known := skipped[dir]
+		if !known {
+			skip = w.matcher.ExcludedDir(dir) || w.excludedBelow(root, dir, true)
+			skipped[dir] = skip
+		}
+		if skip {
+			return true
+		}
+	}
+	return false
+}
@@ -0,0 +1,142 @@
+package walker
+
+import (
+	"os"
+	"path/filepath"
+	"sort"
+	"strings"
+
+	"github.com/vitruves/gop/internal/archive"
+)
+
+// emitFiles yields the files of config.Files that a walk would have found,
+// without reading any directory: each must lie below an include root within
+// the recursion depth, pass the same exclude, .gitignore, extension and
+// filter rules, and still exist. Files come out in walk order.
+func (w *walker) emitFiles() error {
+	roots, err := w.includeRoots()
+	if err != nil {
+		return err
+	}
+
+	candidates := make([]string, 0, len(w.config.Files))
+	for _, path := range w.config.Files {
+		candidates = append(candidates, filepath.Clean(path))
+	}
+	sort.Slice(candidates, func(i, j int) bool { return walkLess(candidates[i], candidates[j]) })
+
+	scopes := make(map[string]*ignoreScope)
+	for i, path := range candidates {
+		if i > 0 && path == candidates[i-1] {
+			continue
+		}
+
+		var file File
+		if member, ok := archive.Stat(path); ok {
+			file = File{Path: path, Size: member.Size, ModTime: member.ModTime}
+		} else if info, err := os.Stat(path); err == nil && !info.IsDir() {
+			file = File{Path: path, Size: info.Size(), ModTime: info.ModTime()}
+		} else {
+			// Deleted since the list was made, or not a file.
+			continue
+		}
+
+		for _, root := range roots {
+			if w.acceptListed(root, path, scopes) {
+				w.out <- file
+				break
+			}
+		}
+	}
+	return nil
+}
+
+// listedRoot is a directory whose files are accepted as in a walk, or a file
+// named directly by an include pattern.
+type listedRoot struct {
+	path string
+	file bool
+}
+
+func (w *walker) includeRoots() ([]listedRoot, error) {
+	if len(w.config.Include) == 0 {
+		return []listedRoot{{path: "."}}, nil
+	}
+
+	var roots []listedRoot
+	for _, pattern := range w.config.Include {
+		matches, err := filepath.Glob(pattern)
+		if err != nil {
+			return nil, err
+		}
+		for _, match := range matches {
+			info, err := os.Stat(match)
+			if err != nil {
+				return nil, err
+			}
+			// An archive is walked like a directory, so its members are listed below it.
+			roots = append(roots, listedRoot{path: filepath.Clean(match), file: !info.IsDir() && !archive.IsArchive(match)})
+		}
+	}
+	return roots, nil
+}
+
+func (w *walker) acceptListed(root listedRoot, path string, scopes map[string]*ignoreScope) bool {
+	if root.file {
+		return path == root.path && w.acceptName(root.path, path)
+	}
+
+	rel, ok := relTo(root.path, path)
+	if !ok || root.path == "." && (filepath.IsAbs(path) || rel == ".." || strings.HasPrefix(rel, "../")) {
+		return false
+	}
+
+	dirs := strings.Split(filepath.ToSlash(filepath.Dir(rel)), "/")
+	if dirs[0] == "." {
+		dirs = nil
+	}
+	// Apply the directory rules from the root down, as a walk would.
+	parent := &dirNode{path: root.path, root: root.path, scope: w.listedScope(nil, root.path, scopes)}
+	dir := root.path
+	for _, name := range dirs {
+		dir = filepath.Join(dir, name)
+		if w.skipDir(parent, dir) {
+			return false
+		}
+		parent = &dirNode{path: dir, root: root.path, level: parent.level + 1, scope: w.listedScope(parent.scope, dir, scopes)}
+	}
+	return w.acceptFile(parent, path)
+}
+
+// listedScope loads the .gitignore scope of dir once per run.
+func (w *walker) listedScope(parent *ignoreScope, dir string, scopes map[string]*ignoreScope) *ignoreScope {
+	if w.config.NoGitignore {
+		return nil
+	}
+	scope, ok := scopes[dir]
+	if !ok {
+		scope = loadIgnoreScope(parent, dir)
+		scopes[dir] = scope
+	}
+	return scope
+}
+
+// walkLess orders paths as a depth-first walk over sorted directory entries
+// visits them, comparing one path element at a time.
+func walkLess(a, b string) bool {
+	a, b = filepath.ToSlash(a), filepath.ToSlash(b)
+	for {
+		ai, bi := strings.IndexByte(a, '/'), strings.IndexByte(b, '/')
+		ae, be := a, b
+		if ai >= 0 {
+			ae = a[:ai]
+		}
+		if bi >= 0 {
+			be = b[:bi]
+		}
+		if ae != be || ai < 0 || bi < 0 {
+			return ae < be || ae == be && ai < 0 && bi >= 0
+		}
+		a, b = a[ai+1:], b[bi+1:]
+	}
+}
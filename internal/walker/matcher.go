@@ -0,0 +1,245 @@
+package walker
+
+import (
+	"bufio"
+	"bytes"
+	"os"
+	"path"
+	"path/filepath"
+	"strings"
+)
+
+var defaultExcludeDirs = map[string]bool{
+	".git":          true,
+	".gop-cache":    true,
+	"node_modules":  true,
+	"__pycache__":   true,
+	".pytest_cache": true,
+	"target":        true,
+	"build":         true,
+	"dist":          true,
+	"vendor":        true,
+}
+
+// rule is one compiled gitignore-style pattern.
+type rule struct {
+	segments []string
+	negate   bool
+	dirOnly  bool
+	anchored bool
+}
+
+// Matcher holds the --exclude patterns compiled once per run. Literal names
+// and "*.ext" patterns are answered from hash sets; everything else falls
+// back to segment-wise glob matching.
+type Matcher struct {
+	names map[string]bool
+	exts  map[string]bool
+	rules []rule
+}
+
+// ignoreScope is the set of .gitignore rules that apply below dir. Each scope
+// keeps the chain of scopes from the walk root down to itself.
+type ignoreScope struct {
+	chain []*ignoreScope
+	dir   string
+	rules []rule
+}
+
+func NewMatcher(patterns []string) *Matcher {
+	m := &Matcher{
+		names: make(map[string]bool),
+		exts:  make(map[string]bool),
+	}
+
+	for _, pattern := range patterns {
+		r, ok := compileRule(pattern)
+		if !ok || r.negate {
+			continue
+		}
+		if !r.anchored && !r.dirOnly {
+			segment := r.segments[0]
+			if !hasMeta(segment) {
+				m.names[segment] = true
+				continue
+			}
+			if ext := segment[1:]; segment[0] == '*' && strings.Count(ext, ".") == 1 && strings.HasPrefix(ext, ".") && !hasMeta(ext) {
+				m.exts[ext] = true
+				continue
+			}
+		}
+		m.rules = append(m.rules, r)
+	}
+
+	return m
+}
+
+// Excluded reports whether an --exclude pattern matches p.
+func (m *Matcher) Excluded(p string, isDir bool) bool {
+	name := filepath.Base(p)
+	if m.names[name] || (!isDir && m.exts[filepath.Ext(name)]) {
+		return true
+	}
+	if len(m.rules) == 0 {
+		return false
+	}
+
+	rel := cleanRel(p)
+	for _, r := range m.rules {
+		if r.match(rel, name, isDir) {
+			return true
+		}
+	}
+	return false
+}
+
+// ExcludedDir also applies the built-in list of dependency and build output
+// directories, compared by exact directory name.
+func (m *Matcher) ExcludedDir(p string) bool {
+	return defaultExcludeDirs[filepath.Base(p)] || m.Excluded(p, true)
+}
+
+// ignored evaluates the .gitignore chain for p. Deeper files take precedence
+// over their parents and, within one file, the last matching rule wins.
+func (s *ignoreScope) ignored(p string, isDir bool) bool {
+	if s == nil {
+		return false
+	}
+
+	name := filepath.Base(p)
+	ignored := false
+	for _, scope := range s.chain {
+		rel, ok := relTo(scope.dir, p)
+		if !ok {
+			continue
+		}
+		for _, r := range scope.rules {
+			if r.match(rel, name, isDir) {
+				ignored = !r.negate
+			}
+		}
+	}
+
+	return ignored
+}
+
+// loadIgnoreScope returns the scope for dir, extended with dir/.gitignore
+// when that file exists.
+func loadIgnoreScope(parent *ignoreScope, dir string) *ignoreScope {
+	content, err := os.ReadFile(filepath.Join(dir, ".gitignore"))
+	if err != nil {
+		return parent
+	}
+
+	var rules []rule
+	scanner := bufio.NewScanner(bytes.NewReader(content))
+	for scanner.Scan() {
+		if r, ok := compileRule(scanner.Text()); ok {
+			rules = append(rules, r)
+		}
+	}
+
+	if len(rules) == 0 {
+		return parent
+	}
+
+	scope := &ignoreScope{dir: filepath.Clean(dir), rules: rules}
+	if parent != nil {
+		scope.chain = append(scope.chain, parent.chain...)
+	}
+	scope.chain = append(scope.chain, scope)
+	return scope
+}
+
+func compileRule(pattern string) (rule, bool) {
+	pattern = strings.TrimRight(pattern, " \t\r")
+	if pattern == "" || strings.HasPrefix(pattern, "#") {
+		return rule{}, false
+	}
+
+	var r rule
+	if strings.HasPrefix(pattern, "!") {
+		r.negate = true
+		pattern = pattern[1:]
+	} else if strings.HasPrefix(pattern, `\`) {
+		pattern = pattern[1:]
+	}
+
+	if strings.HasSuffix(pattern, "/") {
+		r.dirOnly = true
+		pattern = strings.TrimRight(pattern, "/")
+	}
+
+	pattern = strings.TrimPrefix(filepath.ToSlash(pattern), "./")
+	if strings.HasPrefix(pattern, "/") {
+		r.anchored = true
+		pattern = strings.TrimLeft(pattern, "/")
+	}
+	if strings.Contains(pattern, "/") {
+		r.anchored = true
+	}
+
+	if pattern == "" {
+		return rule{}, false
+	}
+
+	r.segments = strings.Split(pattern, "/")
+	return r, true
+}
+
+func (r rule) match(rel, name string, isDir bool) bool {
+	if r.dirOnly && !isDir {
+		return false
+	}
+	if !r.anchored {
+		matched, _ := path.Match(r.segments[0], name)
+		return matched
+	}
+	return matchSegments(r.segments, strings.Split(rel, "/"))
+}
+
+func matchSegments(pattern, parts []string) bool {
+	for len(pattern) > 0 {
+		if pattern[0] == "**" {
+			pattern = pattern[1:]
+			if len(pattern) == 0 {
+				return len(parts) > 0
+			}
+			for i := 0; i < len(parts); i++ {
+				if matchSegments(pattern, parts[i:]) {
+					return true
+				}
+			}
+			return false
+		}
+
+		if len(parts) == 0 {
+			return false
+		}
+		if matched, _ := path.Match(pattern[0], parts[0]); !matched {
+			return false
+		}
+		pattern, parts = pattern[1:], parts[1:]
+	}
+
+	return len(parts) == 0
+}
+
+func relTo(dir, p string) (string, bool) {
+	if dir == "." {
+		return cleanRel(p), true
+	}
+	prefix := dir + string(filepath.Separator)
+	if !strings.HasPrefix(p, prefix) {
+		return "", false
+	}
+	return filepath.ToSlash(p[len(prefix):]), true
+}
+
+func cleanRel(p string) string {
+	return strings.TrimPrefix(filepath.ToSlash(filepath.Clean(p)), "./")
+}
+
+func hasMeta(pattern string) bool {
+	return strings.ContainsAny(pattern, `*?[\`)
+}
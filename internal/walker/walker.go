@@ -0,0 +1,377 @@
+package walker
+
+import (
+	"io/fs"
+	"os"
+	"path/filepath"
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/vitruves/gop/internal/archive"
+)
+
+// maxReadAhead caps how many directories the workers may read before the
+// emitter has caught up with them, so memory stays bounded on huge trees.
+const maxReadAhead = 1024
+
+// Config describes which files a walk yields. Filter is applied to files found
+// while walking directories; files named directly by an Include pattern only
+// go through the extension and exclude rules. Exclude patterns use gitignore
+// syntax and, unless NoGitignore is set, .gitignore files found during the
+// walk are honoured as well. An Include pattern naming a .zip, .tar or
+// .tar.gz file walks the archive's members like a directory. When Files is
+// not nil, no directory is read: the walk yields those of Files that it
+// would have found.
+type Config struct {
+	Include      []string
+	Exclude      []string
+	Recursive    bool
+	Depth        int
+	Jobs         int
+	Extensions   []string
+	SpecialFiles map[string]bool
+	Filter       func(path string) bool
+	NoGitignore  bool
+	Files        []string
+}
+
+type File struct {
+	Path    string
+	Size    int64
+	ModTime time.Time
+}
+
+type dirNode struct {
+	path    string
+	root    string
+	level   int
+	scope   *ignoreScope
+	claimed atomic.Bool
+	slot    bool
+	ready   chan struct{}
+	items   []item
+	err     error
+}
+
+type item struct {
+	file File
+	dir  *dirNode
+}
+
+type walker struct {
+	config     Config
+	matcher    *Matcher
+	extensions map[string]bool
+	out        chan File
+
+	mu     sync.Mutex
+	cond   *sync.Cond
+	queue  []*dirNode
+	closed bool
+
+	ahead chan struct{}
+	done  chan struct{}
+}
+
+// Stream walks the configured roots on config.Jobs goroutines and sends every
+// matching file to the returned channel in the same lexical order as
+// filepath.WalkDir. Once the file channel is closed, the error channel yields
+// the first walk error, or nil.
+func Stream(config Config) (<-chan File, <-chan error) {
+	w := &walker{
+		config:     config,
+		matcher:    NewMatcher(config.Exclude),
+		extensions: make(map[string]bool, len(config.Extensions)),
+		out:        make(chan File, 256),
+		ahead:      make(chan struct{}, maxReadAhead),
+		done:       make(chan struct{}),
+	}
+	w.cond = sync.NewCond(&w.mu)
+	for _, ext := range config.Extensions {
+		w.extensions[ext] = true
+	}
+
+	errc := make(chan error, 1)
+
+	jobs := config.Jobs
+	if jobs < 1 {
+		jobs = 1
+	}
+
+	var wg sync.WaitGroup
+	for i := 0; i < jobs; i++ {
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			w.work()
+		}()
+	}
+
+	go func() {
+		err := w.run()
+		w.close()
+		wg.Wait()
+		close(w.out)
+		errc <- err
+	}()
+
+	return w.out, errc
+}
+
+// Collect drains Stream into a slice.
+func Collect(config Config) ([]File, error) {
+	files, errc := Stream(config)
+
+	var result []File
+	for file := range files {
+		result = append(result, file)
+	}
+
+	return result, <-errc
+}
+
+func (w *walker) run() error {
+	if w.config.Files != nil {
+		return w.emitFiles()
+	}
+	if len(w.config.Include) == 0 {
+		return w.emit(w.newRoot("."))
+	}
+
+	for _, pattern := range w.config.Include {
+		matches, err := filepath.Glob(pattern)
+		if err != nil {
+			return err
+		}
+		for _, match := range matches {
+			info, err := os.Stat(match)
+			if err != nil {
+				return err
+			}
+			if info.IsDir() {
+				if err := w.emit(w.newRoot(match)); err != nil {
+					return err
+				}
+				continue
+			}
+			if archive.IsArchive(match) {
+				if err := w.emitArchive(match); err != nil {
+					return err
+				}
+				continue
+			}
+			if w.acceptName(match, match) {
+				w.out <- File{Path: match, Size: info.Size(), ModTime: info.ModTime()}
+			}
+		}
+	}
+
+	return nil
+}
+
+func (w *walker) newRoot(path string) *dirNode {
+	return &dirNode{
+		path:  path,
+		root:  path,
+		ready: make(chan struct{}),
+	}
+}
+
+func (w *walker) newChild(parent *dirNode, path string) *dirNode {
+	return &dirNode{
+		path:  path,
+		root:  parent.root,
+		level: parent.level + 1,
+		scope: parent.scope,
+		ready: make(chan struct{}),
+	}
+}
+
+// emit sends the files below node depth-first. A node nobody has claimed yet
+// is read inline, so the emitter never waits on queued work.
+func (w *walker) emit(node *dirNode) error {
+	if node.claimed.CompareAndSwap(false, true) {
+		w.read(node)
+	}
+	<-node.ready
+
+	if node.err != nil {
+		return node.err
+	}
+
+	for _, it := range node.items {
+		if it.dir != nil {
+			if err := w.emit(it.dir); err != nil {
+				return err
+			}
+			continue
+		}
+		w.out <- it.file
+	}
+
+	node.items = nil
+	if node.slot {
+		<-w.ahead
+	}
+
+	return nil
+}
+
+func (w *walker) work() {
+	for {
+		select {
+		case w.ahead <- struct{}{}:
+		case <-w.done:
+			return
+		}
+
+		node, ok := w.pop()
+		if !ok {
+			<-w.ahead
+			return
+		}
+
+		if !node.claimed.CompareAndSwap(false, true) {
+			<-w.ahead
+			continue
+		}
+
+		node.slot = true
+		w.read(node)
+	}
+}
+
+func (w *walker) read(node *dirNode) {
+	defer close(node.ready)
+
+	entries, err := os.ReadDir(node.path)
+	if err != nil {
+		node.err = err
+		return
+	}
+
+	if !w.config.NoGitignore {
+		node.scope = loadIgnoreScope(node.scope, node.path)
+	}
+
+	var children []*dirNode
+	for _, entry := range entries {
+		path := filepath.Join(node.path, entry.Name())
+
+		if entry.IsDir() {
+			if w.skipDir(node, path) {
+				continue
+			}
+			child := w.newChild(node, path)
+			children = append(children, child)
+			node.items = append(node.items, item{dir: child})
+			continue
+		}
+
+		if !w.acceptFile(node, path) {
+			continue
+		}
+
+		info, err := fileInfo(path, entry)
+		if err != nil {
+			node.err = err
+			return
+		}
+		node.items = append(node.items, item{file: File{Path: path, Size: info.Size(), ModTime: info.ModTime()}})
+	}
+
+	w.push(children)
+}
+
+func (w *walker) skipDir(parent *dirNode, path string) bool {
+	if !w.config.Recursive {
+		return true
+	}
+	if w.config.Depth > 0 && parent.level >= w.config.Depth {
+		return true
+	}
+	if w.matcher.ExcludedDir(path) || w.excludedBelow(parent.root, path, true) {
+		return true
+	}
+	return parent.scope.ignored(path, true)
+}
+
+func (w *walker) acceptFile(parent *dirNode, path string) bool {
+	if !w.acceptName(parent.root, path) {
+		return false
+	}
+	if parent.scope.ignored(path, false) {
+		return false
+	}
+	if w.config.Filter != nil && !w.config.Filter(path) {
+		return false
+	}
+	return true
+}
+
+func (w *walker) acceptName(root, path string) bool {
+	if len(w.extensions) > 0 && !w.extensions[filepath.Ext(path)] && !w.config.SpecialFiles[filepath.Base(path)] {
+		return false
+	}
+	return !w.matcher.Excluded(path, false) && !w.excludedBelow(root, path, false)
+}
+
+// excludedBelow lets anchored exclude patterns match relative to an include
+// root as well as relative to the working directory.
+func (w *walker) excludedBelow(root, path string, isDir bool) bool {
+	if root == "." || root == path {
+		return false
+	}
+	rel, ok := relTo(filepath.Clean(root), path)
+	return ok && w.matcher.Excluded(rel, isDir)
+}
+
+// push queues children so the first one is handed out next, keeping the
+// read-ahead close to the emitter's depth-first position.
+func (w *walker) push(children []*dirNode) {
+	if len(children) == 0 {
+		return
+	}
+
+	w.mu.Lock()
+	for i := len(children) - 1; i >= 0; i-- {
+		w.queue = append(w.queue, children[i])
+	}
+	w.mu.Unlock()
+	w.cond.Broadcast()
+}
+
+func (w *walker) pop() (*dirNode, bool) {
+	w.mu.Lock()
+	defer w.mu.Unlock()
+
+	for len(w.queue) == 0 && !w.closed {
+		w.cond.Wait()
+	}
+	if w.closed {
+		return nil, false
+	}
+
+	node := w.queue[len(w.queue)-1]
+	w.queue = w.queue[:len(w.queue)-1]
+	return node, true
+}
+
+func (w *walker) close() {
+	w.mu.Lock()
+	w.closed = true
+	w.queue = nil
+	w.mu.Unlock()
+	w.cond.Broadcast()
+	close(w.done)
+}
+
+func fileInfo(path string, entry fs.DirEntry) (fs.FileInfo, error) {
+	if entry.Type()&fs.ModeSymlink != 0 {
+		if info, err := os.Stat(path); err == nil {
+			return info, nil
+		}
+	}
+	return entry.Info()
+}
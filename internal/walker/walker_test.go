@@ -0,0 +1,343 @@
+package walker
+
+import (
+	"archive/tar"
+	"compress/gzip"
+	"io/fs"
+	"os"
+	"path/filepath"
+	"reflect"
+	"runtime"
+	"testing"
+
+	"github.com/vitruves/gop/internal/corpus"
+)
+
+func createTree(t *testing.T, root string, files []string) {
+	t.Helper()
+	for _, file := range files {
+		path := filepath.Join(root, file)
+		if err := os.MkdirAll(filepath.Dir(path), 0755); err != nil {
+			t.Fatalf("Failed to create directory: %v", err)
+		}
+		if err := os.WriteFile(path, []byte("content"), 0644); err != nil {
+			t.Fatalf("Failed to create file: %v", err)
+		}
+	}
+}
+
+func paths(files []File) []string {
+	var result []string
+	for _, file := range files {
+		result = append(result, file.Path)
+	}
+	return result
+}
+
+func TestStreamMatchesWalkDirOrder(t *testing.T) {
+	root := t.TempDir()
+	var tree []string
+	for _, dir := range []string{"a", "b", "c", "a/x", "a/y", "b/z", "c/x/y"} {
+		for _, name := range []string{"one.go", "two.go", "three.py"} {
+			tree = append(tree, filepath.Join(dir, name))
+		}
+	}
+	createTree(t, root, tree)
+
+	var expected []string
+	filepath.WalkDir(root, func(path string, d fs.DirEntry, err error) error {
+		if err == nil && !d.IsDir() && filepath.Ext(path) == ".go" {
+			expected = append(expected, path)
+		}
+		return err
+	})
+
+	for _, jobs := range []int{1, 4, 16} {
+		files, err := Collect(Config{
+			Include:    []string{root},
+			Recursive:  true,
+			Jobs:       jobs,
+			Extensions: []string{".go"},
+		})
+		if err != nil {
+			t.Fatalf("Failed to walk: %v", err)
+		}
+
+		got := paths(files)
+		if len(got) != len(expected) {
+			t.Fatalf("Expected %d files, got %d", len(expected), len(got))
+		}
+		for i := range expected {
+			if got[i] != expected[i] {
+				t.Errorf("jobs=%d: expected %s at %d, got %s", jobs, expected[i], i, got[i])
+			}
+		}
+	}
+}
+
+func TestStreamRules(t *testing.T) {
+	root := t.TempDir()
+	createTree(t, root, []string{
+		"main.go",
+		"Makefile",
+		"notes.txt",
+		"pkg/lib.go",
+		"pkg/deep/more.go",
+		"node_modules/dep.go",
+	})
+
+	files, err := Collect(Config{
+		Include:      []string{root},
+		Recursive:    true,
+		Depth:        1,
+		Jobs:         4,
+		Extensions:   []string{".go"},
+		SpecialFiles: map[string]bool{"Makefile": true},
+	})
+	if err != nil {
+		t.Fatalf("Failed to walk: %v", err)
+	}
+
+	got := make(map[string]int64)
+	for _, file := range files {
+		rel, _ := filepath.Rel(root, file.Path)
+		got[rel] = file.Size
+	}
+
+	for _, expected := range []string{"main.go", "Makefile", "pkg/lib.go"} {
+		if _, ok := got[expected]; !ok {
+			t.Errorf("Should include %s", expected)
+		}
+	}
+	for _, unexpected := range []string{"notes.txt", "pkg/deep/more.go", "node_modules/dep.go"} {
+		if _, ok := got[unexpected]; ok {
+			t.Errorf("Should not include %s", unexpected)
+		}
+	}
+	if got["main.go"] != int64(len("content")) {
+		t.Errorf("Expected size %d for main.go, got %d", len("content"), got["main.go"])
+	}
+
+	files, err = Collect(Config{Include: []string{root}, Jobs: 2})
+	if err != nil {
+		t.Fatalf("Failed to walk: %v", err)
+	}
+	if len(files) != 3 {
+		t.Errorf("Non-recursive walk should only return the 3 top-level files, got %d", len(files))
+	}
+}
+
+func TestMatcher(t *testing.T) {
+	m := NewMatcher([]string{"*.pb.go", "generated", "docs/", "internal/legacy", "**/testdata/**", "*.min.js"})
+
+	cases := []struct {
+		path     string
+		isDir    bool
+		expected bool
+	}{
+		{"api/service.pb.go", false, true},
+		{"api/service.go", false, false},
+		{"pkg/generated", true, true},
+		{"pkg/generated", false, true},
+		{"docs", true, true},
+		{"docs", false, false},
+		{"internal/legacy", true, true},
+		{"pkg/internal/legacy", true, false},
+		{"pkg/testdata/input.go", false, true},
+		{"web/app.min.js", false, true},
+	}
+
+	for _, c := range cases {
+		if got := m.Excluded(c.path, c.isDir); got != c.expected {
+			t.Errorf("Excluded(%q, %v) = %v, expected %v", c.path, c.isDir, got, c.expected)
+		}
+	}
+
+	if !m.ExcludedDir("src/build") || !m.ExcludedDir("node_modules") {
+		t.Error("Should exclude default build and dependency directories")
+	}
+	if m.ExcludedDir("rebuild_tools") || m.ExcludedDir("src/distance") {
+		t.Error("Should not exclude directories that only contain a default name")
+	}
+}
+
+func TestStreamHonoursGitignore(t *testing.T) {
+	root := t.TempDir()
+	createTree(t, root, []string{
+		"main.go",
+		"debug.log",
+		"keep.log",
+		"out/bin.go",
+		"rebuild_tools/tool.go",
+		"pkg/lib.go",
+		"pkg/gen.go",
+	})
+	os.WriteFile(filepath.Join(root, ".gitignore"), []byte("# comment\n*.log\n!keep.log\n/out/\n"), 0644)
+	os.WriteFile(filepath.Join(root, "pkg", ".gitignore"), []byte("gen.go\n"), 0644)
+
+	files, err := Collect(Config{Include: []string{root}, Recursive: true, Jobs: 4})
+	if err != nil {
+		t.Fatalf("Failed to walk: %v", err)
+	}
+
+	got := make(map[string]bool)
+	for _, file := range files {
+		rel, _ := filepath.Rel(root, file.Path)
+		got[rel] = true
+	}
+
+	for _, expected := range []string{"main.go", "keep.log", "rebuild_tools/tool.go", "pkg/lib.go"} {
+		if !got[expected] {
+			t.Errorf("Should include %s", expected)
+		}
+	}
+	for _, unexpected := range []string{"debug.log", "out/bin.go", "pkg/gen.go"} {
+		if got[unexpected] {
+			t.Errorf("Should not include %s", unexpected)
+		}
+	}
+
+	files, err = Collect(Config{Include: []string{root}, Recursive: true, Jobs: 4, NoGitignore: true})
+	if err != nil {
+		t.Fatalf("Failed to walk: %v", err)
+	}
+	if len(files) != 9 {
+		t.Errorf("Expected 9 files with .gitignore disabled, got %d", len(files))
+	}
+}
+
+func TestStreamListedFiles(t *testing.T) {
+	root := t.TempDir()
+	tree := []string{"main.go", "a-b/x.go", "a/x.go", "a/deep/y.go", "gen/out.go", "pkg/lib.go", "pkg/gen.go", "node_modules/m.go", "notes.txt"}
+	createTree(t, root, tree)
+	os.WriteFile(filepath.Join(root, "pkg", ".gitignore"), []byte("gen.go\n"), 0644)
+
+	config := Config{Include: []string{root}, Recursive: true, Depth: 2, Jobs: 2, Exclude: []string{"gen/"}, Extensions: []string{".go"}}
+	walked, err := Collect(config)
+	if err != nil {
+		t.Fatalf("Failed to walk: %v", err)
+	}
+
+	// Listing every file, plus a directory and a deleted file, must give
+	// exactly what the walk found, in the same order.
+	for _, file := range append(tree, "a", "gone.go") {
+		config.Files = append(config.Files, filepath.Join(root, file))
+	}
+	listed, err := Collect(config)
+	if err != nil {
+		t.Fatalf("Failed to list: %v", err)
+	}
+	want, got := paths(walked), paths(listed)
+	if len(got) != len(want) {
+		t.Fatalf("Expected %v, got %v", want, got)
+	}
+	for i := range want {
+		if got[i] != want[i] {
+			t.Errorf("Expected %s at %d, got %s", want[i], i, got[i])
+		}
+	}
+
+	config.Files = []string{filepath.Join(root, "pkg/lib.go"), filepath.Join(root, "pkg/gen.go"), "elsewhere/x.go"}
+	listed, err = Collect(config)
+	if err != nil {
+		t.Fatalf("Failed to list: %v", err)
+	}
+	if got := paths(listed); len(got) != 1 || got[0] != filepath.Join(root, "pkg/lib.go") {
+		t.Errorf("Expected only pkg/lib.go, got %v", got)
+	}
+
+	config.Files = []string{}
+	if listed, _ := Collect(config); len(listed) != 0 {
+		t.Errorf("An empty list should yield nothing, got %v", paths(listed))
+	}
+}
+
+func TestStreamArchiveRoot(t *testing.T) {
+	root := t.TempDir()
+	tree := []string{"main.go", "a/one.go", "a/x/two.go", "a.go", "b/three.go", "b/skip.py", "c/x/y/four.go"}
+	dir := filepath.Join(root, "snap")
+	createTree(t, dir, tree)
+
+	snapshot := filepath.Join(root, "snap.tar.gz")
+	file, err := os.Create(snapshot)
+	if err != nil {
+		t.Fatalf("Failed to create archive: %v", err)
+	}
+	zw := gzip.NewWriter(file)
+	tw := tar.NewWriter(zw)
+	for _, name := range tree {
+		tw.WriteHeader(&tar.Header{Name: "./" + name, Mode: 0644, Size: int64(len("content")), Typeflag: tar.TypeReg})
+		tw.Write([]byte("content"))
+	}
+	tw.Close()
+	zw.Close()
+	file.Close()
+
+	for _, config := range []Config{
+		{Recursive: true},
+		{Recursive: true, Depth: 1},
+		{Recursive: true, Exclude: []string{"x/"}},
+		{},
+	} {
+		config.Extensions = []string{".go"}
+		config.Include = []string{dir}
+		want, err := Collect(config)
+		if err != nil {
+			t.Fatalf("Failed to walk directory: %v", err)
+		}
+		config.Include = []string{snapshot}
+		got, err := Collect(config)
+		if err != nil {
+			t.Fatalf("Failed to walk archive: %v", err)
+		}
+
+		if len(got) != len(want) {
+			t.Fatalf("%+v: expected %v, got %v", config, paths(want), paths(got))
+		}
+		for i := range want {
+			rel, _ := filepath.Rel(dir, want[i].Path)
+			if got[i].Path != filepath.Join(snapshot, rel) || got[i].Size != want[i].Size {
+				t.Errorf("%+v: expected %s, got %+v", config, rel, got[i])
+			}
+		}
+
+		// Listing every member keeps to the same rules as the walk.
+		for _, name := range tree {
+			config.Files = append(config.Files, filepath.Join(snapshot, name))
+		}
+		listed, err := Collect(config)
+		if err != nil || !reflect.DeepEqual(paths(listed), paths(got)) {
+			t.Errorf("%+v: listed members gave %v, expected %v (%v)", config, paths(listed), paths(got), err)
+		}
+	}
+}
+
+func BenchmarkStream(b *testing.B) {
+	corpus.EachTree(b, "go", 1<<10, func(b *testing.B, dir string, files int) {
+		config := Config{Include: []string{dir}, Recursive: true, Jobs: runtime.NumCPU(), Extensions: []string{".go"}}
+		for i := 0; i < b.N; i++ {
+			found, err := Collect(config)
+			if err != nil || len(found) != files {
+				b.Fatalf("Expected %d files, got %d (%v)", files, len(found), err)
+			}
+		}
+	})
+}
+
+func BenchmarkStreamListedFiles(b *testing.B) {
+	corpus.EachTree(b, "go", 1<<10, func(b *testing.B, dir string, files int) {
+		b.StopTimer()
+		listed, err := Collect(Config{Include: []string{dir}, Recursive: true, Extensions: []string{".go"}})
+		if err != nil {
+			b.Fatalf("Failed to walk: %v", err)
+		}
+		config := Config{Include: []string{dir}, Recursive: true, Extensions: []string{".go"}, Files: paths(listed)}
+		b.StartTimer()
+		for i := 0; i < b.N; i++ {
+			found, err := Collect(config)
+			if err != nil || len(found) != files {
+				b.Fatalf("Expected %d files, got %d (%v)", files, len(found), err)
+			}
+		}
+	})
+}
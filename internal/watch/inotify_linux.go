@@ -0,0 +1,100 @@
+//go:build linux
+
+package watch
+
+import (
+	"bytes"
+	"os"
+	"path/filepath"
+	"syscall"
+	"unsafe"
+)
+
+const inotifyMask = syscall.IN_CREATE | syscall.IN_MODIFY | syscall.IN_CLOSE_WRITE | syscall.IN_ATTRIB |
+	syscall.IN_DELETE | syscall.IN_MOVED_FROM | syscall.IN_MOVED_TO | syscall.IN_DELETE_SELF
+
+// startNative puts an inotify watch on every directory below the roots and
+// adds one to each directory created later. A full event queue reports the
+// roots, so everything is looked at again.
+func startNative(config Config, raw chan<- string, done <-chan struct{}) (func() error, error) {
+	fd, err := syscall.InotifyInit1(syscall.IN_CLOEXEC | syscall.IN_NONBLOCK)
+	if err != nil {
+		return nil, os.NewSyscallError("inotify_init1", err)
+	}
+	// A non-blocking descriptor goes through the runtime poller, so Close
+	// wakes the reader up.
+	file := os.NewFile(uintptr(fd), "inotify")
+
+	dirs := make(map[int32]string)
+	add := func(dir string) error {
+		wd, err := syscall.InotifyAddWatch(fd, dir, inotifyMask)
+		if err != nil {
+			return os.NewSyscallError("inotify_add_watch", err)
+		}
+		dirs[int32(wd)] = dir
+		return nil
+	}
+	for _, root := range config.Roots {
+		if _, err := os.Stat(root); err != nil {
+			file.Close()
+			return nil, err
+		}
+		walkDirs(config, root, func(dir string) {
+			if err == nil {
+				err = add(dir)
+			}
+		})
+		if err != nil {
+			// Usually fs.inotify.max_user_watches; polling still works.
+			file.Close()
+			return nil, err
+		}
+	}
+
+	go func() {
+		buf := make([]byte, 64<<10)
+		for {
+			n, err := file.Read(buf)
+			if err != nil {
+				return
+			}
+			for offset := 0; offset+syscall.SizeofInotifyEvent <= n; {
+				event := (*syscall.InotifyEvent)(unsafe.Pointer(&buf[offset]))
+				name := buf[offset+syscall.SizeofInotifyEvent : offset+syscall.SizeofInotifyEvent+int(event.Len)]
+				offset += syscall.SizeofInotifyEvent + int(event.Len)
+
+				if event.Mask&syscall.IN_Q_OVERFLOW != 0 {
+					for _, root := range config.Roots {
+						if !send(raw, done, root) {
+							return
+						}
+					}
+					continue
+				}
+				dir, ok := dirs[event.Wd]
+				if !ok {
+					continue
+				}
+				if event.Mask&syscall.IN_IGNORED != 0 {
+					delete(dirs, event.Wd)
+					continue
+				}
+
+				path := dir
+				if name = bytes.TrimRight(name, "\x00"); len(name) > 0 {
+					path = filepath.Join(dir, string(name))
+				}
+				if event.Mask&syscall.IN_ISDIR != 0 && event.Mask&(syscall.IN_CREATE|syscall.IN_MOVED_TO) != 0 &&
+					(config.SkipDir == nil || !config.SkipDir(path)) {
+					// Files may have been created before the watch was in place;
+					// reporting the directory has them looked at.
+					walkDirs(config, path, func(dir string) { add(dir) })
+				}
+				if !send(raw, done, path) {
+					return
+				}
+			}
+		}
+	}()
+	return file.Close, nil
+}
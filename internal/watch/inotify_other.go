@@ -0,0 +1,9 @@
+//go:build !linux
+
+package watch
+
+import "errors"
+
+func startNative(config Config, raw chan<- string, done <-chan struct{}) (func() error, error) {
+	return nil, errors.New("file notifications are not supported on this platform")
+}
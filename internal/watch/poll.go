@@ -0,0 +1,74 @@
+package watch
+
+import (
+	"os"
+	"path/filepath"
+	"time"
+)
+
+type fileState struct {
+	size    int64
+	modTime time.Time
+}
+
+// startPolling lists every file below the roots each PollInterval and
+// reports what was added, changed or removed since the last look.
+func startPolling(config Config, raw chan<- string, done <-chan struct{}) (func() error, error) {
+	for _, root := range config.Roots {
+		if _, err := os.Stat(root); err != nil {
+			return nil, err
+		}
+	}
+
+	previous := snapshot(config)
+	go func() {
+		ticker := time.NewTicker(config.PollInterval)
+		defer ticker.Stop()
+		for {
+			select {
+			case <-done:
+				return
+			case <-ticker.C:
+			}
+
+			current := snapshot(config)
+			for path, state := range current {
+				if old, ok := previous[path]; !ok || old != state {
+					if !send(raw, done, path) {
+						return
+					}
+				}
+			}
+			for path := range previous {
+				if _, ok := current[path]; !ok {
+					if !send(raw, done, path) {
+						return
+					}
+				}
+			}
+			previous = current
+		}
+	}()
+	return func() error { return nil }, nil
+}
+
+func snapshot(config Config) map[string]fileState {
+	files := make(map[string]fileState)
+	for _, root := range config.Roots {
+		walkDirs(config, root, func(dir string) {
+			entries, err := os.ReadDir(dir)
+			if err != nil {
+				return
+			}
+			for _, entry := range entries {
+				if entry.IsDir() {
+					continue
+				}
+				if info, err := entry.Info(); err == nil {
+					files[filepath.Join(dir, entry.Name())] = fileState{size: info.Size(), modTime: info.ModTime()}
+				}
+			}
+		})
+	}
+	return files
+}
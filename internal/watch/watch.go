@@ -0,0 +1,145 @@
+// Package watch reports paths that change below a set of directories, for
+// gop serve. It uses inotify on Linux and polls where that is not
+// available.
+package watch
+
+import (
+	"io/fs"
+	"path/filepath"
+	"sort"
+	"time"
+)
+
+// Config says what to watch.
+type Config struct {
+	// Roots are the directories watched, with everything below them.
+	Roots []string
+	// SkipDir, when set, names directories not to watch, such as .git.
+	SkipDir func(path string) bool
+	// Latency is how long changes are gathered before they are reported
+	// together. It defaults to 100ms.
+	Latency time.Duration
+	// PollInterval is how often the polling watcher looks. It defaults to
+	// one second.
+	PollInterval time.Duration
+	// Poll forces the polling watcher.
+	Poll bool
+}
+
+// Watcher sends batches of changed paths. A path is a file or directory that
+// was created, written, removed or renamed; a directory means anything below
+// it may have changed, and a path that no longer exists was removed with
+// everything below it.
+type Watcher struct {
+	changes chan []string
+	raw     chan string
+	done    chan struct{}
+	stop    func() error
+	native  bool
+}
+
+// New starts watching config.Roots.
+func New(config Config) (*Watcher, error) {
+	if config.Latency <= 0 {
+		config.Latency = 100 * time.Millisecond
+	}
+	if config.PollInterval <= 0 {
+		config.PollInterval = time.Second
+	}
+
+	w := &Watcher{
+		changes: make(chan []string),
+		raw:     make(chan string, 1024),
+		done:    make(chan struct{}),
+	}
+
+	var err error
+	if !config.Poll {
+		w.stop, err = startNative(config, w.raw, w.done)
+		w.native = err == nil
+	}
+	if config.Poll || err != nil {
+		w.stop, err = startPolling(config, w.raw, w.done)
+		if err != nil {
+			return nil, err
+		}
+	}
+
+	go w.batch(config.Latency)
+	return w, nil
+}
+
+// Changes returns the channel the batches arrive on, each sorted and
+// without duplicates. It is closed by Close.
+func (w *Watcher) Changes() <-chan []string {
+	return w.changes
+}
+
+// Native reports whether the watcher gets notifications from the operating
+// system rather than polling.
+func (w *Watcher) Native() bool {
+	return w.native
+}
+
+// Close stops watching.
+func (w *Watcher) Close() error {
+	close(w.done)
+	return w.stop()
+}
+
+// batch gathers raw paths until none has come for latency, then sends them.
+func (w *Watcher) batch(latency time.Duration) {
+	defer close(w.changes)
+
+	pending := make(map[string]bool)
+	timer := time.NewTimer(latency)
+	timer.Stop()
+
+	for {
+		select {
+		case <-w.done:
+			return
+		case path := <-w.raw:
+			pending[path] = true
+			timer.Reset(latency)
+		case <-timer.C:
+			paths := make([]string, 0, len(pending))
+			for path := range pending {
+				paths = append(paths, path)
+			}
+			sort.Strings(paths)
+			pending = make(map[string]bool)
+
+			select {
+			case w.changes <- paths:
+			case <-w.done:
+				return
+			}
+		}
+	}
+}
+
+// send hands path to the batcher unless the watcher is closing.
+func send(raw chan<- string, done <-chan struct{}, path string) bool {
+	select {
+	case raw <- path:
+		return true
+	case <-done:
+		return false
+	}
+}
+
+// walkDirs calls fn for root and every directory below it that SkipDir
+// allows.
+func walkDirs(config Config, root string, fn func(dir string)) {
+	filepath.WalkDir(root, func(path string, entry fs.DirEntry, err error) error {
+		if err != nil || !entry.IsDir() {
+			return nil
+		}
+		if path != root && config.SkipDir != nil && config.SkipDir(path) {
+			return filepath.SkipDir
+		}
+		fn(path)
+		return nil
+	})
+}
@@ -0,0 +1,78 @@
+package watch
+
+import (
+	"os"
+	"path/filepath"
+	"strings"
+	"testing"
+	"time"
+)
+
+// waitFor reads batches until one contains want or the time is up.
+func waitFor(t *testing.T, w *Watcher, want string) {
+	t.Helper()
+	timeout := time.After(5 * time.Second)
+	for {
+		select {
+		case paths := <-w.Changes():
+			for _, path := range paths {
+				if path == want || strings.HasPrefix(want, path+string(filepath.Separator)) {
+					return
+				}
+			}
+		case <-timeout:
+			t.Fatalf("No change reported for %s", want)
+		}
+	}
+}
+
+func TestWatcher(t *testing.T) {
+	for _, poll := range []bool{false, true} {
+		dir := t.TempDir()
+		if err := os.Mkdir(filepath.Join(dir, "pkg"), 0755); err != nil {
+			t.Fatalf("Failed to create directory: %v", err)
+		}
+		if err := os.Mkdir(filepath.Join(dir, ".git"), 0755); err != nil {
+			t.Fatalf("Failed to create directory: %v", err)
+		}
+
+		w, err := New(Config{
+			Roots:        []string{dir},
+			SkipDir:      func(path string) bool { return filepath.Base(path) == ".git" },
+			Latency:      10 * time.Millisecond,
+			PollInterval: 20 * time.Millisecond,
+			Poll:         poll,
+		})
+		if err != nil {
+			t.Fatalf("New failed: %v", err)
+		}
+
+		file := filepath.Join(dir, "pkg", "main.go")
+		if err := os.WriteFile(file, []byte("package main\n"), 0644); err != nil {
+			t.Fatalf("Failed to write file: %v", err)
+		}
+		waitFor(t, w, file)
+
+		nested := filepath.Join(dir, "new", "deep")
+		if err := os.MkdirAll(nested, 0755); err != nil {
+			t.Fatalf("Failed to create directory: %v", err)
+		}
+		nestedFile := filepath.Join(nested, "lib.go")
+		if err := os.WriteFile(nestedFile, []byte("package deep\n"), 0644); err != nil {
+			t.Fatalf("Failed to write file: %v", err)
+		}
+		waitFor(t, w, nestedFile)
+
+		if err := os.Remove(file); err != nil {
+			t.Fatalf("Failed to remove file: %v", err)
+		}
+		waitFor(t, w, file)
+
+		if err := w.Close(); err != nil {
+			t.Errorf("Close failed: %v", err)
+		}
+		if _, ok := <-w.Changes(); ok {
+			t.Error("Changes should be closed after Close")
+		}
+	}
+}